@@ -33,6 +33,12 @@ if [ ! -f "$LOG_FILE" ]; then
     exit 1
 fi
 
+# One pass over the log with the C++ analyzer when it builds; grep below otherwise
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+if "$SCRIPT_DIR/log-analyzer.sh" --check; then
+    exec "$SCRIPT_DIR/log-analyzer.sh" log "$LOG_FILE"
+fi
+
 # Get basic file info
 FILENAME=$(basename "$LOG_FILE")
 FILESIZE=$(du -h "$LOG_FILE" | cut -f1)
@@ -17,6 +17,12 @@ if [ ! -f "$LOG_FILE" ]; then
     exit 1
 fi
 
+# One pass over the log with the C++ analyzer when it builds; awk below otherwise
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+if "$SCRIPT_DIR/log-analyzer.sh" --check; then
+    exec "$SCRIPT_DIR/log-analyzer.sh" spiffs "$LOG_FILE"
+fi
+
 echo "=== SPIFFS Write Analysis ==="
 echo "Log: $LOG_FILE"
 echo ""
@@ -41,6 +41,12 @@ if [ ! -f "$LOG_FILE" ]; then
     exit 1
 fi
 
+# One pass over the log with the C++ analyzer when it builds; grep below otherwise
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+if "$SCRIPT_DIR/log-analyzer.sh" --check; then
+    exec "$SCRIPT_DIR/log-analyzer.sh" analyze "$LOG_FILE"
+fi
+
 # Extract test parameters from filename
 # Expected format: test-NNN_<type>_<wind>kn_<depth>m.log
 BASENAME=$(basename "$LOG_FILE")
@@ -58,7 +64,6 @@ else
 fi
 
 # Get test parameters from parse script
-SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
 if [ "$TEST_NUM" != "unknown" ] && [ -x "$SCRIPT_DIR/parse-test-number.sh" ]; then
     eval "$("$SCRIPT_DIR/parse-test-number.sh" "$TEST_NUM")"
     TARGET_RODE="$targetRode"
@@ -0,0 +1,60 @@
+#!/bin/bash
+
+# SensESP Chain Counter - Capture UDP Log
+# Usage: ./scripts/capture-udp-log.sh <session-name> [port]
+#
+# Receives the log lines a CHAIN_LOG_UDP_HOST/CHAIN_LOG_UDP_PORT build sends
+# over WiFi and writes them to logs/ in the same format as a serial capture,
+# so analyze-log.sh and analyze-test-result.sh work on the result.
+#
+# Build flags (platformio.ini, then flash):
+#   -D CHAIN_LOG_UDP_HOST=\"192.168.1.10\"   ; this machine
+#   -D CHAIN_LOG_UDP_PORT=5140
+
+set -e
+
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+NC='\033[0m' # No Color
+
+PROJECT_ROOT="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+LOGS_DIR="${PROJECT_ROOT}/logs"
+
+if [ -z "$1" ]; then
+    echo -e "${RED}Error: Session name required${NC}"
+    echo "Usage: $0 <session-name> [port]"
+    exit 1
+fi
+
+SESSION_NAME="$1"
+PORT="${2:-5140}"
+
+if ! command -v nc > /dev/null 2>&1; then
+    echo -e "${RED}Error: nc (netcat) not found${NC}"
+    exit 1
+fi
+
+mkdir -p "$LOGS_DIR"
+TIMESTAMP=$(date +%Y-%m-%d_%H-%M-%S)
+LOG_FILE="${LOGS_DIR}/${TIMESTAMP}_${SESSION_NAME}.log"
+
+HEADER="=========================================================="
+HEADER="${HEADER}\nSensESP Chain Counter - Log Capture"
+HEADER="${HEADER}\nStarted: $(date '+%Y-%m-%d %H:%M:%S')"
+HEADER="${HEADER}\nSession: ${SESSION_NAME}"
+HEADER="${HEADER}\nUDP port: ${PORT}"
+HEADER="${HEADER}\n=========================================================="
+echo -e "$HEADER" > "$LOG_FILE"
+
+echo -e "${BLUE}SensESP Chain Counter - UDP Log Capture${NC}"
+echo -e "Session:  ${GREEN}${SESSION_NAME}${NC}"
+echo -e "Log file: ${GREEN}${LOG_FILE}${NC}"
+echo -e "Port:     ${GREEN}${PORT}${NC}"
+echo -e "${YELLOW}Listening... (Press Ctrl+C to stop)${NC}"
+echo ""
+
+# -k keeps listening after the first sender (OpenBSD netcat, the macOS and
+# Debian default)
+nc -kul "$PORT" | tee -a "$LOG_FILE"
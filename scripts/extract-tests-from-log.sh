@@ -52,6 +52,11 @@ fi
 # Create output directory
 mkdir -p "$OUTPUT_DIR"
 
+# One pass over the log with the C++ analyzer when it builds; grep/sed below otherwise
+if "$SCRIPT_DIR/log-analyzer.sh" --check; then
+    exec "$SCRIPT_DIR/log-analyzer.sh" extract "$LOG_FILE" "$OUTPUT_DIR"
+fi
+
 # Print startup banner
 echo -e "${BLUE}============================================================${NC}"
 echo -e "${BLUE}SensESP Chain Counter - Test Log Extraction${NC}"
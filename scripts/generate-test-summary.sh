@@ -35,6 +35,12 @@ if [ ! -d "$TEST_DIR" ]; then
     exit 1
 fi
 
+# The C++ analyzer reads the analyses in one go when it builds; grep below otherwise
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+if "$SCRIPT_DIR/log-analyzer.sh" --check; then
+    exec "$SCRIPT_DIR/log-analyzer.sh" summary "$TEST_DIR"
+fi
+
 # Initialize counters
 TOTAL=0
 PASSED=0
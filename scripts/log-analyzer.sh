@@ -0,0 +1,40 @@
+#!/bin/bash
+# log-analyzer.sh - Build (on first use) and run the one-pass log analyzer
+#
+# Usage: ./log-analyzer.sh <command> [args...]
+#        ./log-analyzer.sh --check    # Exit 0 if the analyzer is built or builds
+#
+# Commands are listed in log-analyzer/log_analyzer.cpp. analyze-log.sh,
+# analyze-spiffs-writes.sh, extract-tests-from-log.sh, analyze-test-result.sh
+# and generate-test-summary.sh forward to it and fall back to grep/awk when
+# no C++17 compiler is found. LOG_ANALYZER=awk forces the fallback, CXX
+# picks the compiler.
+
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+SOURCE="$SCRIPT_DIR/log-analyzer/log_analyzer.cpp"
+BINARY="$SCRIPT_DIR/log-analyzer/build/log-analyzer"
+CXX="${CXX:-c++}"
+
+build() {
+    if [ -x "$BINARY" ] && [ "$BINARY" -nt "$SOURCE" ]; then
+        return 0
+    fi
+    command -v "$CXX" >/dev/null 2>&1 || return 1
+    mkdir -p "$(dirname "$BINARY")"
+    "$CXX" -std=c++17 -O2 -o "$BINARY" "$SOURCE"
+}
+
+if [ "${1:-}" = "--check" ]; then
+    [ "${LOG_ANALYZER:-}" != "awk" ] && build >/dev/null 2>&1
+    exit $?
+fi
+
+if ! build; then
+    echo "Error: cannot build $BINARY (set CXX to a C++17 compiler)" >&2
+    exit 1
+fi
+
+export LOG_ANALYZER_SCRIPTS="$SCRIPT_DIR"
+exec "$BINARY" "$@"
@@ -0,0 +1,1325 @@
+// log_analyzer.cpp - One-pass analysis of serial captures
+//
+// Built on first use by scripts/log-analyzer.sh (c++ -std=c++17 -O2).
+//
+// Usage: log-analyzer <command> [args]
+//   log <log-file>                        Event counts (analyze-log.sh)
+//   spiffs <log-file>                     SPIFFS writes per test (analyze-spiffs-writes.sh)
+//   extract [--analyze] <log-file> <dir>  One file per test (extract-tests-from-log.sh);
+//                                         --analyze also writes each .analysis.txt
+//   analyze <test-log>                    PASS/FAIL of one test (analyze-test-result.sh)
+//   summary <test-run-dir>                summary.txt from the analyses (generate-test-summary.sh)
+//   compare <baseline-log> <new-log>      Markdown comparison of two 56-test runs
+//
+// The scripts run grep/awk over the capture once per figure, which on a
+// multi-hundred-MB 56-test capture adds up to minutes. Here the capture is
+// mapped, every line is classified once into columns (time stamp, match
+// flags, rode), and each report is a walk over the columns. Each command
+// prints what the script it stands in for prints, so the scripts forward
+// to it and keep their grep/awk path only for hosts without a compiler.
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <regex>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* const RED = "\033[0;31m";
+const char* const GREEN = "\033[0;32m";
+const char* const YELLOW = "\033[1;33m";
+const char* const BLUE = "\033[0;34m";
+const char* const CYAN = "\033[0;36m";
+const char* const NC = "\033[0m";
+
+constexpr int TOTAL_TESTS = 56;
+constexpr int TESTS_PER_TYPE = TOTAL_TESTS / 2;
+
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        if (fstat(fd, &info_) == 0) {
+            size_ = (size_t)info_.st_size;
+            if (size_ == 0) {
+                ok_ = true;
+            } else {
+                void* map = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (map != MAP_FAILED) {
+                    madvise(map, size_, MADV_SEQUENTIAL);
+                    data_ = (const char*)map;
+                    ok_ = true;
+                }
+            }
+        }
+        close(fd);
+    }
+    ~MappedFile() {
+        if (data_) munmap((void*)data_, size_);
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool ok() const { return ok_; }
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    const struct stat& info() const { return info_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    struct stat info_ = {};
+    bool ok_ = false;
+};
+
+// What a line matched. The L_ bits are the case-insensitive patterns of
+// analyze-log.sh, the T_ bits the case-sensitive markers the test scripts
+// grep for.
+enum : uint32_t {
+    L_ERROR = 1u << 0,             // error|exception|fatal|critical
+    L_WARN = 1u << 1,              // warn
+    L_INFO = 1u << 2,              // info
+    L_DEBUG = 1u << 3,             // debug
+    L_DEPLOY_STATE = 1u << 4,      // deployment.*state
+    L_RETRIEVAL_STATE = 1u << 5,   // retrieval.*state
+    L_AUTO_STAGE = 1u << 6,        // auto.*stage
+    L_MOTOR_UP = 1u << 7,          // motor.*up|raising|retrieve
+    L_MOTOR_DOWN = 1u << 8,        // motor.*down|deploy|lower
+    L_MOTOR_STOP = 1u << 9,        // motor.*stop|halt
+    L_SLACK = 1u << 10,            // slack
+    L_PUBLISH = 1u << 11,          // publishing|published
+    L_SUBSCRIBE = 1u << 12,        // subscrib
+    L_DEPTH = 1u << 13,            // depth
+    L_DISTANCE = 1u << 14,         // distance
+    L_RESET = 1u << 15,            // reset|reboot|restart
+    L_WIFI_CONNECT = 1u << 16,     // wifi.*connect|connected to
+    L_WIFI_DISCONNECT = 1u << 17,  // wifi.*disconnect|lost connection
+    T_COMMAND = 1u << 18,          // Command received is
+    T_MARKER = 1u << 19,           // Command received is testNotification
+    T_DROP_DONE = 1u << 20,        // autoDrop completed
+    T_RETRIEVE_STOP = 1u << 21,    // Auto-retrieve.*stopping
+    T_SAVED = 1u << 22,            // Chain position saved:|Chain position force-saved:
+    T_ERROR = 1u << 23,            // ERROR
+    T_WARNING = 1u << 24,          // WARNING
+    T_NEGATIVE_SLACK = 1u << 25,   // Slack.*-[0-9]
+    T_FREE_FALL = 1u << 26,        // Direction: free fall
+    T_RODE = 1u << 27,             // Rode:
+    T_SESSION = 1u << 28,          // Session:
+    T_STARTED = 1u << 29,          // Started:
+};
+
+// The capture, one entry per line, in columns
+struct Capture {
+    const char* data = nullptr;
+    size_t size = 0;
+    std::vector<uint64_t> offset;   // Start of the line in the file
+    std::vector<uint32_t> length;   // Without the newline
+    std::vector<int64_t> ms;        // "I (ms)" stamp, -1 without one
+    std::vector<uint32_t> flags;
+    std::vector<float> rode;        // "Rode: x.y", NaN elsewhere
+    std::vector<uint32_t> markers;  // Lines with T_MARKER
+    size_t newlines = 0;            // What wc -l counts
+
+    size_t lines() const { return offset.size(); }
+    std::string line(size_t i) const { return std::string(data + offset[i], length[i]); }
+    bool has(size_t i, const char* text) const {
+        return memmem(data + offset[i], length[i], text, strlen(text)) != nullptr;
+    }
+};
+
+const char* find(const char* s, size_t n, const char* pattern) {
+    return (const char*)memmem(s, n, pattern, strlen(pattern));
+}
+
+// First "I (digits)" of the line, as grep -oE "I \([0-9]+\)" in the scripts
+int64_t stamp(const char* s, size_t n) {
+    const char* end = s + n;
+    for (const char* p = s; (p = find(p, (size_t)(end - p), "I (")) != nullptr; p += 3) {
+        const char* q = p + 3;
+        int64_t value = 0;
+        while (q < end && isdigit((unsigned char)*q)) value = value * 10 + (*q++ - '0');
+        if (q > p + 3 && q < end && *q == ')') return value;
+    }
+    return -1;
+}
+
+// Leftmost [0-9]+\.[0-9]+ of the line, empty if there is none
+std::string firstDecimal(const char* s, size_t n) {
+    size_t i = 0;
+    while (i < n) {
+        if (!isdigit((unsigned char)s[i])) {
+            i++;
+            continue;
+        }
+        size_t j = i;
+        while (j < n && isdigit((unsigned char)s[j])) j++;
+        if (j + 1 < n && s[j] == '.' && isdigit((unsigned char)s[j + 1])) {
+            size_t k = j + 1;
+            while (k < n && isdigit((unsigned char)s[k])) k++;
+            return std::string(s + i, k - i);
+        }
+        i = j;
+    }
+    return std::string();
+}
+
+// "Rode: x.y" as grep -oE "Rode: [0-9]+\.[0-9]+"
+float rodeValue(const char* s, size_t n) {
+    const char* end = s + n;
+    for (const char* p = s; (p = find(p, (size_t)(end - p), "Rode: ")) != nullptr; p += 6) {
+        const char* q = p + 6;
+        const std::string value = firstDecimal(q, (size_t)(end - q));
+        if (!value.empty() && memcmp(q, value.data(), value.size()) == 0) return strtof(value.c_str(), nullptr);
+    }
+    return NAN;
+}
+
+// Everything classify() looks for. FOLDED patterns match in any case, as
+// grep -i; the rest match exactly.
+enum Pattern : uint8_t {
+    P_ERROR, P_EXCEPTION, P_FATAL, P_CRITICAL, P_WARN, P_INFO, P_DEBUG, P_DEPLOYMENT, P_RETRIEVAL, P_STATE,
+    P_AUTO, P_STAGE, P_MOTOR, P_UP, P_DOWN, P_STOP, P_RAISING, P_RETRIEVE, P_DEPLOY, P_LOWER, P_HALT, P_SLACK,
+    P_PUBLISHING, P_PUBLISHED, P_SUBSCRIB, P_DEPTH, P_DISTANCE, P_RESET, P_REBOOT, P_RESTART, P_WIFI,
+    P_CONNECT, P_DISCONNECT, P_CONNECTED_TO, P_LOST_CONNECTION,
+    FOLDED,
+    P_COMMAND = FOLDED, P_MARKER, P_DROP_DONE, P_AUTO_RETRIEVE, P_STOPPING, P_SAVED, P_FORCE_SAVED, P_ERROR_TAG,
+    P_WARNING_TAG, P_SLACK_TAG, P_FREE_FALL, P_RODE, P_SESSION, P_STARTED,
+    PATTERNS
+};
+
+const char* const PATTERN_TEXT[PATTERNS] = {
+    "error", "exception", "fatal", "critical", "warn", "info", "debug", "deployment", "retrieval", "state",
+    "auto", "stage", "motor", "up", "down", "stop", "raising", "retrieve", "deploy", "lower", "halt", "slack",
+    "publishing", "published", "subscrib", "depth", "distance", "reset", "reboot", "restart", "wifi",
+    "connect", "disconnect", "connected to", "lost connection",
+    "Command received is ", "Command received is testNotification", "autoDrop completed", "Auto-retrieve",
+    "stopping", "Chain position saved:", "Chain position force-saved:", "ERROR", "WARNING", "Slack",
+    "Direction: free fall", "Rode:", "Session:", "Started:",
+};
+
+// Patterns by first byte, so a line is scanned once for all of them
+struct PatternTable {
+    uint8_t fold[256];
+    std::vector<uint8_t> by_byte[256];
+    uint8_t length[PATTERNS];
+
+    PatternTable() {
+        for (int ch = 0; ch < 256; ch++) fold[ch] = (uint8_t)tolower(ch);
+        for (int p = 0; p < PATTERNS; p++) {
+            length[p] = (uint8_t)strlen(PATTERN_TEXT[p]);
+            const uint8_t first = (uint8_t)PATTERN_TEXT[p][0];
+            by_byte[first].push_back((uint8_t)p);
+            if (p < FOLDED && toupper(first) != first) by_byte[toupper(first)].push_back((uint8_t)p);
+        }
+    }
+};
+
+uint32_t classify(const char* s, size_t n) {
+    static const PatternTable table;
+    // Start of the first and the last occurrence of each pattern, -1 if none
+    int32_t first[PATTERNS];
+    int32_t last[PATTERNS];
+    std::fill(first, first + PATTERNS, -1);
+    std::fill(last, last + PATTERNS, -1);
+
+    for (size_t i = 0; i < n; i++) {
+        for (const uint8_t p : table.by_byte[(uint8_t)s[i]]) {
+            const size_t length = table.length[p];
+            if (i + length > n) continue;
+            const char* text = PATTERN_TEXT[p];
+            size_t k = 1;
+            if (p < FOLDED) {
+                while (k < length && table.fold[(uint8_t)s[i + k]] == (uint8_t)text[k]) k++;
+            } else {
+                while (k < length && s[i + k] == text[k]) k++;
+            }
+            if (k < length) continue;
+            if (first[p] < 0) first[p] = (int32_t)i;
+            last[p] = (int32_t)i;
+        }
+    }
+
+    auto has = [&](Pattern p) { return first[p] >= 0; };
+    // grep "a.*b": b starts after the end of the first a
+    auto followedBy = [&](Pattern a, Pattern b) { return has(a) && last[b] >= first[a] + table.length[a]; };
+
+    uint32_t flags = 0;
+    if (has(P_ERROR) || has(P_EXCEPTION) || has(P_FATAL) || has(P_CRITICAL)) flags |= L_ERROR;
+    if (has(P_WARN)) flags |= L_WARN;
+    if (has(P_INFO)) flags |= L_INFO;
+    if (has(P_DEBUG)) flags |= L_DEBUG;
+    if (followedBy(P_DEPLOYMENT, P_STATE)) flags |= L_DEPLOY_STATE;
+    if (followedBy(P_RETRIEVAL, P_STATE)) flags |= L_RETRIEVAL_STATE;
+    if (followedBy(P_AUTO, P_STAGE)) flags |= L_AUTO_STAGE;
+    if (followedBy(P_MOTOR, P_UP) || has(P_RAISING) || has(P_RETRIEVE)) flags |= L_MOTOR_UP;
+    if (followedBy(P_MOTOR, P_DOWN) || has(P_DEPLOY) || has(P_LOWER)) flags |= L_MOTOR_DOWN;
+    if (followedBy(P_MOTOR, P_STOP) || has(P_HALT)) flags |= L_MOTOR_STOP;
+    if (has(P_SLACK)) flags |= L_SLACK;
+    if (has(P_PUBLISHING) || has(P_PUBLISHED)) flags |= L_PUBLISH;
+    if (has(P_SUBSCRIB)) flags |= L_SUBSCRIBE;
+    if (has(P_DEPTH)) flags |= L_DEPTH;
+    if (has(P_DISTANCE)) flags |= L_DISTANCE;
+    if (has(P_RESET) || has(P_REBOOT) || has(P_RESTART)) flags |= L_RESET;
+    if (followedBy(P_WIFI, P_CONNECT) || has(P_CONNECTED_TO)) flags |= L_WIFI_CONNECT;
+    if (followedBy(P_WIFI, P_DISCONNECT) || has(P_LOST_CONNECTION)) flags |= L_WIFI_DISCONNECT;
+
+    if (has(P_COMMAND)) flags |= T_COMMAND;
+    if (has(P_MARKER)) flags |= T_MARKER;
+    if (has(P_DROP_DONE)) flags |= T_DROP_DONE;
+    if (followedBy(P_AUTO_RETRIEVE, P_STOPPING)) flags |= T_RETRIEVE_STOP;
+    if (has(P_SAVED) || has(P_FORCE_SAVED)) flags |= T_SAVED;
+    if (has(P_ERROR_TAG)) flags |= T_ERROR;
+    if (has(P_WARNING_TAG)) flags |= T_WARNING;
+    if (has(P_SLACK_TAG)) {
+        for (size_t i = (size_t)first[P_SLACK_TAG] + table.length[P_SLACK_TAG]; i + 1 < n; i++) {
+            if (s[i] == '-' && isdigit((unsigned char)s[i + 1])) {
+                flags |= T_NEGATIVE_SLACK;
+                break;
+            }
+        }
+    }
+    if (has(P_FREE_FALL)) flags |= T_FREE_FALL;
+    if (has(P_RODE)) flags |= T_RODE;
+    if (has(P_SESSION)) flags |= T_SESSION;
+    if (has(P_STARTED)) flags |= T_STARTED;
+    return flags;
+}
+
+Capture parse(const MappedFile& file) {
+    Capture c;
+    c.data = file.data();
+    c.size = file.size();
+    const size_t estimate = c.size / 64 + 1;
+    c.offset.reserve(estimate);
+    c.length.reserve(estimate);
+    c.ms.reserve(estimate);
+    c.flags.reserve(estimate);
+    c.rode.reserve(estimate);
+
+    for (size_t pos = 0; pos < c.size;) {
+        const char* line = c.data + pos;
+        const char* newline = (const char*)memchr(line, '\n', c.size - pos);
+        const size_t n = newline ? (size_t)(newline - line) : c.size - pos;
+        if (newline) c.newlines++;
+
+        const uint32_t flags = classify(line, n);
+
+        if (flags & T_MARKER) c.markers.push_back((uint32_t)c.lines());
+        c.offset.push_back(pos);
+        c.length.push_back((uint32_t)n);
+        c.ms.push_back(stamp(line, n));
+        c.flags.push_back(flags);
+        c.rode.push_back((flags & T_RODE) ? rodeValue(line, n) : NAN);
+        pos += n + 1;
+    }
+    return c;
+}
+
+// ---- Formatting ----
+
+// What bc prints for "scale=1; x / d": truncated, "0" for zero, no leading zero
+std::string bcQuotient(long long x, long long d) {
+    if (d == 0) return "0";
+    const long long tenths = x * 10 / d;
+    if (tenths == 0) return "0";
+    char text[32];
+    const long long whole = std::llabs(tenths) / 10;
+    snprintf(text, sizeof text, "%s%s.%lld", tenths < 0 ? "-" : "", whole ? std::to_string(whole).c_str() : "",
+             std::llabs(tenths) % 10);
+    return text;
+}
+
+// The percentage printf "%.1f" makes of bc's truncated quotient
+double truncatedRate(long long pass, long long total) {
+    return total ? (double)(pass * 1000 / total) / 10.0 : 0.0;
+}
+
+std::string minutesSeconds(long long seconds) {
+    return std::to_string(seconds / 60) + "m " + std::to_string(seconds % 60) + "s";
+}
+
+// du -h of the file
+std::string diskUsage(const struct stat& info) {
+    double value = (double)info.st_blocks * 512;
+    if (value < 1024) return std::to_string((long long)value);
+    const char* units = "KMGT";
+    int unit = 0;
+    value /= 1024;
+    while (value >= 1024 && unit < 3) {
+        value /= 1024;
+        unit++;
+    }
+    char text[32];
+    const double tenths = std::ceil(value * 10) / 10;
+    if (tenths < 10) {
+        snprintf(text, sizeof text, "%.1f%c", tenths, units[unit]);
+    } else {
+        snprintf(text, sizeof text, "%.0f%c", std::ceil(value), units[unit]);
+    }
+    return text;
+}
+
+std::string withThousands(long long value) {
+    std::string digits = std::to_string(std::llabs(value));
+    for (int i = (int)digits.size() - 3; i > 0; i -= 3) digits.insert((size_t)i, ",");
+    return (value < 0 ? "-" : "") + digits;
+}
+
+std::string baseName(const std::string& path) {
+    const size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+bool writeFile(const std::string& path, const char* data, size_t size) {
+    FILE* out = fopen(path.c_str(), "wb");
+    if (!out) return false;
+    const bool ok = fwrite(data, 1, size, out) == size;
+    return fclose(out) == 0 && ok;
+}
+
+// ---- Tests ----
+
+struct TestParams {
+    std::string number;   // As in the file name, e.g. "007"
+    std::string type;
+    std::string wind;
+    std::string depth;
+    std::string target;   // Rode in m, as parse-test-number.sh prints it
+};
+
+// parse-test-number.sh: four depth blocks of seven wind speeds, each an
+// autoDrop (odd) and autoRetrieve (even) pair
+bool testParams(int number, TestParams* params) {
+    static const char* const DEPTHS[] = {"3", "5", "8", "12"};
+    static const char* const TARGETS[] = {"15.0", "25.0", "40.0", "60.0"};
+    static const char* const WINDS[] = {"1", "4", "8", "12", "18", "20", "25"};
+    if (number < 1 || number > TOTAL_TESTS) return false;
+    const int block = (number - 1) / 14;
+    params->type = number % 2 ? "autoDrop" : "autoRetrieve";
+    params->depth = DEPTHS[block];
+    params->wind = WINDS[((number - 1) % 14) / 2];
+    params->target = number % 2 ? TARGETS[block] : "2.0";
+    return true;
+}
+
+// One test between two testNotification markers
+struct Segment {
+    int number;          // 1-based, in marker order
+    size_t first;        // Lines [first, end)
+    size_t end;
+    std::string type;    // From "Command received is auto...", empty if none
+};
+
+std::vector<Segment> segments(const Capture& c) {
+    std::vector<Segment> result;
+    for (size_t k = 0; k < c.markers.size(); k++) {
+        Segment segment{(int)k + 1, c.markers[k], k + 1 < c.markers.size() ? c.markers[k + 1] : c.lines(), ""};
+        for (size_t i = segment.first; i < segment.end; i++) {
+            if (!(c.flags[i] & T_COMMAND) || !c.has(i, "Command received is auto")) continue;
+            // grep -oE "auto[A-Za-z]+": the first match on the line
+            const char* s = c.data + c.offset[i];
+            const char* end = s + c.length[i];
+            for (const char* p = s; (p = find(p, (size_t)(end - p), "auto")) != nullptr; p += 4) {
+                const char* q = p + 4;
+                while (q < end && isalpha((unsigned char)*q)) q++;
+                if (q > p + 4) {
+                    segment.type.assign(p, (size_t)(q - p));
+                    break;
+                }
+            }
+            break;
+        }
+        result.push_back(segment);
+    }
+    return result;
+}
+
+std::string finalRode(const Capture& c, size_t first, size_t end) {
+    for (size_t i = end; i > first; i--) {
+        if (c.flags[i - 1] & T_RODE) return firstDecimal(c.data + c.offset[i - 1], c.length[i - 1]);
+    }
+    return std::string();
+}
+
+size_t writes(const Capture& c, size_t first, size_t end) {
+    size_t count = 0;
+    for (size_t i = first; i < end; i++) count += (c.flags[i] & T_SAVED) != 0;
+    return count;
+}
+
+// |final - target| > tolerance / 10, and the difference as bc prints it
+bool missesTarget(const std::string& final_rode, const std::string& target, int tolerance_tenths,
+                  std::string* diff) {
+    auto decimal = [](const std::string& text, long long* value, int* scale) {
+        *value = 0;
+        *scale = 0;
+        bool point = false;
+        for (char ch : text) {
+            if (ch == '.' && !point) {
+                point = true;
+            } else if (isdigit((unsigned char)ch)) {
+                *value = *value * 10 + (ch - '0');
+                *scale += point;
+            } else {
+                return false;
+            }
+        }
+        return !text.empty();
+    };
+    long long a, b;
+    int scale_a, scale_b;
+    if (!decimal(final_rode, &a, &scale_a) || !decimal(target, &b, &scale_b)) return false;
+    const int scale = std::max(scale_a, scale_b);
+    long long unit = 1;
+    for (int i = 0; i < scale; i++) unit *= 10;
+    for (int i = scale_a; i < scale; i++) a *= 10;
+    for (int i = scale_b; i < scale; i++) b *= 10;
+    const long long d = std::llabs(a - b);
+
+    *diff = d / unit ? std::to_string(d / unit) : "";
+    if (scale > 0) {
+        const std::string fraction = std::to_string(d % unit);
+        *diff += "." + std::string((size_t)scale - fraction.size(), '0') + fraction;
+    }
+    return d * 10 > tolerance_tenths * unit;
+}
+
+struct Analysis {
+    TestParams params;
+    bool pass = false;
+    bool completed = false;
+    std::string final_rode = "unknown";
+    std::string duration = "unknown";
+    size_t errors = 0;
+    size_t warnings = 0;
+    size_t negative_slack = 0;
+    size_t writes = 0;   // Position saves, i.e. SPIFFS writes
+    std::vector<std::string> issues;
+};
+
+// The checks of analyze-test-result.sh, in one walk over the test's lines
+Analysis analyze(const Capture& c, size_t first, size_t end, const TestParams& params) {
+    Analysis a;
+    a.params = params;
+    const std::string command = "Command received is " + params.type;
+
+    int64_t start_ms = 0;
+    bool started = false;
+    size_t drop_done = SIZE_MAX;
+    size_t retrieve_stop = SIZE_MAX;
+    size_t last_marker = SIZE_MAX;
+    size_t free_fall = 0;
+    size_t run = 0;
+    size_t longest_run = 0;
+    size_t increases = 0;
+    float previous = NAN;
+
+    for (size_t i = first; i < end; i++) {
+        const uint32_t flags = c.flags[i];
+        if (!started && (flags & T_COMMAND) && c.has(i, command.c_str())) {
+            started = true;
+            start_ms = std::max<int64_t>(c.ms[i], 0);
+        }
+        if ((flags & T_DROP_DONE) && drop_done == SIZE_MAX) drop_done = i;
+        if ((flags & T_RETRIEVE_STOP) && retrieve_stop == SIZE_MAX) retrieve_stop = i;
+        if (flags & T_MARKER) last_marker = i;
+        a.errors += (flags & T_ERROR) != 0;
+        a.warnings += (flags & T_WARNING) != 0;
+        a.negative_slack += (flags & T_NEGATIVE_SLACK) != 0;
+        a.writes += (flags & T_SAVED) != 0;
+        free_fall += (flags & T_FREE_FALL) != 0;
+
+        const float rode = c.rode[i];
+        if (std::isnan(rode)) continue;
+        if (!std::isnan(previous) && rode > previous) increases++;
+        run = (!std::isnan(previous) && rode == previous) ? run + 1 : 1;
+        longest_run = std::max(longest_run, run);
+        previous = rode;
+    }
+
+    // As in the script, a segment that holds a testNotification counts as
+    // completed, ending at its last one
+    const size_t end_line = drop_done != SIZE_MAX       ? drop_done
+                            : retrieve_stop != SIZE_MAX ? retrieve_stop
+                                                        : last_marker;
+    int64_t end_ms = 0;
+    if (end_line != SIZE_MAX) {
+        a.completed = true;
+        end_ms = c.ms[end_line] >= 0 ? c.ms[end_line] : start_ms;
+    } else {
+        a.issues.push_back("Test did not complete");
+    }
+    if (end_ms > 0) {
+        const int64_t seconds = (end_ms - start_ms) / 1000;
+        a.duration = minutesSeconds(seconds);
+    }
+
+    const std::string rode = finalRode(c, first, end);
+    if (!rode.empty()) a.final_rode = rode;
+
+    if (a.errors > 0) a.issues.push_back("Found " + std::to_string(a.errors) + " ERROR messages");
+
+    std::string diff;
+    auto checkTarget = [&](int tolerance_tenths) {
+        if (a.final_rode == "unknown" || params.target == "unknown") return;
+        if (missesTarget(a.final_rode, params.target, tolerance_tenths, &diff)) {
+            a.issues.push_back("Target not reached: " + a.final_rode + "m vs " + params.target + "m (diff: " + diff +
+                               "m)");
+        }
+    };
+    if (params.type == "autoDrop") {
+        checkTarget(10);
+        if (a.negative_slack >= 10) {
+            a.issues.push_back("Excessive negative slack events: " + std::to_string(a.negative_slack));
+        }
+        if (longest_run > 20) {
+            a.issues.push_back("Stuck condition detected: same rode value repeated " + std::to_string(longest_run) +
+                               " times");
+        }
+    } else if (params.type == "autoRetrieve") {
+        checkTarget(5);
+        if (free_fall > 0) {
+            a.issues.push_back("Free fall detected during retrieval: " + std::to_string(free_fall) + " occurrences");
+        }
+        if (increases > 5) {
+            a.issues.push_back("Rode increased during retrieval: " + std::to_string(increases) +
+                               " times (possible runaway)");
+        }
+    }
+
+    a.pass = a.completed && a.issues.empty();
+    return a;
+}
+
+bool writeAnalysis(const std::string& path, const Analysis& a) {
+    const char* rule = "==============================================";
+    const char* thin = "----------------------------------------------";
+    std::string text;
+    auto line = [&text](const std::string& s) { text += s + "\n"; };
+    line(rule);
+    line("Test Analysis Report");
+    line(rule);
+    line("Test Number: " + a.params.number);
+    line("Test Type: " + a.params.type);
+    line("Depth: " + a.params.depth + "m");
+    line("Wind Speed: " + a.params.wind + "kn");
+    line("Target Rode: " + a.params.target + "m");
+    line(thin);
+    line(std::string("STATUS: ") + (a.pass ? "PASS" : "FAIL"));
+    line("Final Rode: " + a.final_rode + "m");
+    line("Duration: " + a.duration);
+    line(std::string("Completed: ") + (a.completed ? "true" : "false"));
+    line(thin);
+    line("Errors: " + std::to_string(a.errors));
+    line("Warnings: " + std::to_string(a.warnings));
+    line("Negative Slack Events: " + std::to_string(a.negative_slack));
+    line(thin);
+    if (a.issues.empty()) {
+        line("Issues: None");
+    } else {
+        line("Issues:");
+        for (const std::string& issue : a.issues) line("  - " + issue);
+    }
+    line(rule);
+    return writeFile(path, text.data(), text.size());
+}
+
+void printVerdict(const Analysis& a) {
+    const TestParams& p = a.params;
+    if (a.pass) {
+        printf("%s[PASS]%s Test %s (%s @ %skn, %sm): %sm / %sm in %s\n", GREEN, NC, p.number.c_str(), p.type.c_str(),
+               p.wind.c_str(), p.depth.c_str(), a.final_rode.c_str(), p.target.c_str(), a.duration.c_str());
+    } else {
+        printf("%s[FAIL]%s Test %s (%s @ %skn, %sm): %s\n", RED, NC, p.number.c_str(), p.type.c_str(),
+               p.wind.c_str(), p.depth.c_str(), a.issues.empty() ? "No details" : a.issues[0].c_str());
+    }
+}
+
+// Every test of a capture, as extract + analyze would judge it
+std::vector<Analysis> analyzeRun(const Capture& c) {
+    std::vector<Analysis> run;
+    for (const Segment& segment : segments(c)) {
+        TestParams params;
+        if (segment.type.empty() || !testParams(segment.number, &params)) continue;
+        params.number = std::to_string(segment.number);
+        run.push_back(analyze(c, segment.first, segment.end, params));
+    }
+    return run;
+}
+
+// ---- Commands ----
+
+int commandLog(const std::string& path) {
+    MappedFile file(path);
+    if (!file.ok()) {
+        printf("%sError: Log file not found: %s%s\n", RED, path.c_str(), NC);
+        return 1;
+    }
+    const Capture c = parse(file);
+
+    size_t counts[18] = {};
+    size_t session = SIZE_MAX;
+    size_t started = SIZE_MAX;
+    std::vector<size_t> errors;
+    std::vector<size_t> warnings;
+    for (size_t i = 0; i < c.lines(); i++) {
+        const uint32_t flags = c.flags[i];
+        for (int bit = 0; bit < 18; bit++) counts[bit] += (flags >> bit) & 1u;
+        if ((flags & T_SESSION) && session == SIZE_MAX) session = i;
+        if ((flags & T_STARTED) && started == SIZE_MAX) started = i;
+        if (flags & L_ERROR) errors.push_back(i);
+        if (flags & L_WARN) warnings.push_back(i);
+    }
+    auto count = [&counts](uint32_t flag) { return counts[__builtin_ctz(flag)]; };
+
+    char modified[32];
+    strftime(modified, sizeof modified, "%Y-%m-%d %H:%M:%S", localtime(&file.info().st_mtime));
+
+    printf("%s==========================================================\n", BLUE);
+    printf("SensESP Chain Counter - Log Analysis\n");
+    printf("==========================================================%s\n", NC);
+    printf("File:     %s%s%s\n", GREEN, baseName(path).c_str(), NC);
+    printf("Size:     %s%s%s\n", GREEN, diskUsage(file.info()).c_str(), NC);
+    printf("Lines:    %s%zu%s\n", GREEN, c.newlines, NC);
+    printf("Modified: %s%s%s\n", GREEN, modified, NC);
+    printf("\n");
+    if (session != SIZE_MAX) printf("%s%s%s\n", CYAN, c.line(session).c_str(), NC);
+    if (started != SIZE_MAX) printf("%s%s%s\n", CYAN, c.line(started).c_str(), NC);
+
+    printf("\n");
+    printf("%s=== Event Counts ===%s\n", BLUE, NC);
+    printf("Errors:   %s%zu%s\n", count(L_ERROR) ? RED : GREEN, count(L_ERROR), NC);
+    printf("Warnings: %s%zu%s\n", count(L_WARN) ? YELLOW : GREEN, count(L_WARN), NC);
+    printf("Info:     %s%zu%s\n", CYAN, count(L_INFO), NC);
+    printf("Debug:    %s%zu%s\n", CYAN, count(L_DEBUG), NC);
+
+    printf("\n");
+    printf("%s=== State Transitions ===%s\n", BLUE, NC);
+    printf("Deployment state changes: %s%zu%s\n", GREEN, count(L_DEPLOY_STATE), NC);
+    printf("Retrieval state changes:  %s%zu%s\n", GREEN, count(L_RETRIEVAL_STATE), NC);
+    printf("Auto stage updates:       %s%zu%s\n", GREEN, count(L_AUTO_STAGE), NC);
+
+    printf("\n");
+    printf("%s=== Chain Events ===%s\n", BLUE, NC);
+    printf("Motor up events:   %s%zu%s\n", GREEN, count(L_MOTOR_UP), NC);
+    printf("Motor down events: %s%zu%s\n", GREEN, count(L_MOTOR_DOWN), NC);
+    printf("Motor stop events: %s%zu%s\n", GREEN, count(L_MOTOR_STOP), NC);
+    printf("Slack calculations: %s%zu%s\n", GREEN, count(L_SLACK), NC);
+
+    printf("\n");
+    printf("%s=== Signal K Events ===%s\n", BLUE, NC);
+    printf("Signal K publishes:   %s%zu%s\n", GREEN, count(L_PUBLISH), NC);
+    printf("Signal K subscribes:  %s%zu%s\n", GREEN, count(L_SUBSCRIBE), NC);
+    printf("Depth updates:        %s%zu%s\n", GREEN, count(L_DEPTH), NC);
+    printf("Distance updates:     %s%zu%s\n", GREEN, count(L_DISTANCE), NC);
+
+    printf("\n");
+    printf("%s=== System Events ===%s\n", BLUE, NC);
+    printf("Resets/Reboots:    %s%zu%s\n", YELLOW, count(L_RESET), NC);
+    printf("WiFi connects:     %s%zu%s\n", GREEN, count(L_WIFI_CONNECT), NC);
+    printf("WiFi disconnects:  %s%zu%s\n", YELLOW, count(L_WIFI_DISCONNECT), NC);
+    printf("\n");
+
+    if (!errors.empty()) {
+        printf("%s=== Recent Errors (last 5) ===%s\n", RED, NC);
+        for (size_t k = errors.size() > 5 ? errors.size() - 5 : 0; k < errors.size(); k++) {
+            printf("%s\n", c.line(errors[k]).c_str());
+        }
+        printf("\n");
+    }
+    if (!warnings.empty() && warnings.size() < 20) {
+        printf("%s=== Recent Warnings ===%s\n", YELLOW, NC);
+        for (size_t k = warnings.size() > 5 ? warnings.size() - 5 : 0; k < warnings.size(); k++) {
+            printf("%s\n", c.line(warnings[k]).c_str());
+        }
+        printf("\n");
+    }
+
+    printf("%s==========================================================\n", BLUE);
+    printf("Analysis Complete\n");
+    printf("==========================================================%s\n", NC);
+    printf("\n");
+    printf("View full log: cat %s\n", path.c_str());
+    printf("Search log:    grep -i '<pattern>' %s\n", path.c_str());
+    printf("Tail log:      tail -f %s\n", path.c_str());
+    return 0;
+}
+
+int commandSpiffs(const std::string& path) {
+    MappedFile file(path);
+    if (!file.ok()) {
+        fprintf(stderr, "Error: Log file not found: %s\n", path.c_str());
+        return 1;
+    }
+    const Capture c = parse(file);
+
+    printf("=== SPIFFS Write Analysis ===\n");
+    printf("Log: %s\n", path.c_str());
+    printf("\n");
+
+    int last_number = 0;
+    long long total = 0;
+    long long by_type[2] = {};   // autoDrop, autoRetrieve
+    for (size_t k = 0; k < c.markers.size(); k++) {
+        const size_t first = c.markers[k];
+        if (!c.has(first, "Command received is testNotification:test")) continue;
+
+        // testNotification:test<N>/56:<type>:<wind>:<depth>
+        const std::string line = c.line(first);
+        std::vector<std::string> fields;
+        for (size_t start = 0;;) {
+            const size_t colon = line.find(':', start);
+            fields.push_back(line.substr(start, colon == std::string::npos ? std::string::npos : colon - start));
+            if (colon == std::string::npos) break;
+            start = colon + 1;
+        }
+        size_t field = 0;
+        while (field < fields.size() &&
+               !(fields[field].compare(0, 4, "test") == 0 && fields[field].size() > 4 && isdigit((unsigned char)fields[field][4]))) {
+            field++;
+        }
+        if (field == fields.size()) continue;
+        auto at = [&fields](size_t i) { return i < fields.size() ? fields[i] : std::string(); };
+        last_number = atoi(fields[field].c_str() + 4);
+        const std::string type = at(field + 1);
+        const std::string name = type + " " + at(field + 2) + " " + at(field + 3);
+
+        size_t end = c.lines();
+        for (size_t next = k + 1; next < c.markers.size(); next++) {
+            if (c.has(c.markers[next], "Command received is testNotification:test")) {
+                end = c.markers[next];
+                break;
+            }
+        }
+        const long long count = (long long)writes(c, first, end);
+        printf("Test %2d (%-30s): %3lld writes\n", last_number, name.c_str(), count);
+        total += count;
+        if (type == "autoDrop") by_type[0] += count;
+        if (type == "autoRetrieve") by_type[1] += count;
+    }
+
+    printf("\n");
+    printf("=== Summary ===\n");
+    printf("Total tests: %d\n", last_number);
+    printf("Total writes: %lld\n", total);
+    printf("Average per test: %.1f\n", last_number ? (double)total / last_number : 0.0);
+
+    printf("\n");
+    printf("=== Breakdown by Operation ===\n");
+    printf("autoDrop tests: %lld total (avg: %s per test)\n", by_type[0], bcQuotient(by_type[0], TESTS_PER_TYPE).c_str());
+    printf("autoRetrieve tests: %lld total (avg: %s per test)\n", by_type[1],
+           bcQuotient(by_type[1], TESTS_PER_TYPE).c_str());
+    return 0;
+}
+
+int commandExtract(const std::string& path, const std::string& output_dir, bool with_analysis) {
+    MappedFile file(path);
+    if (!file.ok()) {
+        fprintf(stderr, "%sError: Log file not found: %s%s\n", RED, path.c_str(), NC);
+        return 1;
+    }
+
+    printf("%s============================================================%s\n", BLUE, NC);
+    printf("%sSensESP Chain Counter - Test Log Extraction%s\n", BLUE, NC);
+    printf("%s============================================================%s\n", BLUE, NC);
+    printf("Source Log:   %s%s%s\n", CYAN, path.c_str(), NC);
+    printf("Output Dir:   %s%s%s\n", CYAN, output_dir.c_str(), NC);
+    printf("%s============================================================%s\n", BLUE, NC);
+    printf("\n");
+
+    printf("%sStep 1: Scanning for test boundaries...%s\n", YELLOW, NC);
+    const Capture c = parse(file);
+    if (c.markers.empty()) {
+        printf("%sNo test notifications found in log%s\n", RED, NC);
+        return 1;
+    }
+    printf("%sFound %zu test notifications%s\n", GREEN, c.markers.size(), NC);
+    printf("\n");
+
+    printf("%sStep 2: Extracting test segments...%s\n", YELLOW, NC);
+    const bool ends_with_newline = c.size > 0 && c.data[c.size - 1] == '\n';
+    size_t extracted = 0;
+    for (const Segment& segment : segments(c)) {
+        if (segment.type.empty()) {
+            printf("%s  Test %d: Type unknown, skipping%s\n", YELLOW, segment.number, NC);
+            continue;
+        }
+        TestParams params;
+        if (!testParams(segment.number, &params)) {
+            printf("%s  Test %d: Cannot parse parameters, using defaults%s\n", YELLOW, segment.number, NC);
+            params = TestParams{"", segment.type, "0", "0", "0.0"};
+        }
+        char number[16];
+        snprintf(number, sizeof number, "%03d", segment.number);
+        params.number = number;
+
+        const std::string output = output_dir + "/test-" + params.number + "_" + params.type + "_" + params.wind +
+                                   "kn_" + params.depth + "m.log";
+        const size_t from = c.offset[segment.first];
+        const size_t to = segment.end < c.lines() ? c.offset[segment.end] : c.size;
+        if (!writeFile(output, c.data + from, to - from)) {
+            fprintf(stderr, "%sError: cannot write %s%s\n", RED, output.c_str(), NC);
+            return 1;
+        }
+        const size_t lines = segment.end - segment.first - (segment.end == c.lines() && !ends_with_newline);
+        const std::string rode = finalRode(c, segment.first, segment.end);
+
+        printf("%s  ✓ Test %d%s: %s @ %skn, %sm → %sm (final: %sm, %zu lines)\n", GREEN, segment.number, NC,
+               params.type.c_str(), params.wind.c_str(), params.depth.c_str(), params.target.c_str(),
+               rode.empty() ? "?" : rode.c_str(), lines);
+        if (with_analysis) {
+            const Analysis analysis = analyze(c, segment.first, segment.end, params);
+            writeAnalysis(output + ".analysis.txt", analysis);
+            printf("    ");
+            printVerdict(analysis);
+        }
+        extracted++;
+    }
+
+    printf("\n");
+    printf("%s============================================================%s\n", BLUE, NC);
+    printf("%sExtraction Complete%s\n", GREEN, NC);
+    printf("%s============================================================%s\n", BLUE, NC);
+    printf("Tests Extracted: %s%zu%s / %zu\n", GREEN, extracted, NC, c.markers.size());
+    printf("Output Directory: %s%s%s\n", CYAN, output_dir.c_str(), NC);
+    // Set by log-analyzer.sh
+    const char* scripts = getenv("LOG_ANALYZER_SCRIPTS") ? getenv("LOG_ANALYZER_SCRIPTS") : "scripts";
+    printf("\n");
+    printf("%sNext Steps:%s\n", YELLOW, NC);
+    if (with_analysis) {
+        printf("1. Analyses written next to each test log (*.analysis.txt)\n");
+    } else {
+        printf("1. Analyze individual tests:\n");
+        printf("   cd %s && for log in test-*.log; do %s/analyze-test-result.sh $log; done\n", output_dir.c_str(),
+               scripts);
+    }
+    printf("\n");
+    printf("2. Generate summary:\n");
+    printf("   %s/generate-test-summary.sh %s\n", scripts, output_dir.c_str());
+    printf("\n");
+    printf("3. View specific test:\n");
+    printf("   cat %s/test-001_*.log\n", output_dir.c_str());
+    printf("\n");
+    return 0;
+}
+
+int commandAnalyze(const std::string& path) {
+    MappedFile file(path);
+    if (!file.ok()) {
+        fprintf(stderr, "Error: Log file not found: %s\n", path.c_str());
+        return 1;
+    }
+
+    // test-NNN_<type>_<wind>kn_<depth>m.log
+    TestParams params{"unknown", "unknown", "unknown", "unknown", ""};
+    std::smatch match;
+    const std::string name = baseName(path);
+    if (std::regex_search(name, match, std::regex("test-([0-9]+)_([a-zA-Z]+)_([0-9]+)kn_([0-9]+)m\\.log"))) {
+        params.number = match[1];
+        params.type = match[2];
+        params.wind = match[3];
+        params.depth = match[4];
+    } else {
+        fprintf(stderr, "Warning: Cannot parse filename, using defaults\n");
+    }
+    TestParams by_number;
+    if (params.number != "unknown" && testParams(atoi(params.number.c_str()), &by_number)) {
+        params.target = by_number.target;
+    } else if (params.type == "autoDrop") {
+        static const std::map<std::string, std::string> TARGETS = {
+            {"3", "15.0"}, {"5", "25.0"}, {"8", "40.0"}, {"12", "60.0"}};
+        const auto target = TARGETS.find(params.depth);
+        params.target = target == TARGETS.end() ? "unknown" : target->second;
+    } else {
+        params.target = "2.0";
+    }
+
+    const Capture c = parse(file);
+    const Analysis analysis = analyze(c, 0, c.lines(), params);
+    const std::string output = path + ".analysis.txt";
+    if (!writeAnalysis(output, analysis)) {
+        fprintf(stderr, "Error: cannot write %s\n", output.c_str());
+        return 1;
+    }
+    printVerdict(analysis);
+    printf("Analysis saved to: %s\n", output.c_str());
+    return analysis.pass ? 0 : 1;
+}
+
+int commandSummary(const std::string& dir) {
+    DIR* listing = opendir(dir.c_str());
+    if (!listing) {
+        fprintf(stderr, "Error: Directory not found: %s\n", dir.c_str());
+        return 1;
+    }
+    std::vector<std::string> files;
+    const std::string suffix = ".analysis.txt";
+    while (const dirent* entry = readdir(listing)) {
+        const std::string name = entry->d_name;
+        if (name[0] != '.' && name.size() > suffix.size() &&
+            name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+            files.push_back(name);
+        }
+    }
+    closedir(listing);
+    std::sort(files.begin(), files.end());
+
+    struct Tally {
+        int total = 0;
+        int pass = 0;
+    };
+    std::map<std::string, Tally> types, depths, winds;
+    std::vector<std::string> failed;
+    int total = 0, passed = 0, failures = 0, incomplete = 0;
+    long long total_seconds = 0, min_seconds = 999999, max_seconds = 0;
+
+    for (const std::string& name : files) {
+        MappedFile file(dir + "/" + name);
+        if (!file.ok()) continue;
+        total++;
+
+        // First "<key>" line of the report, split into whitespace fields
+        std::vector<std::string> lines;
+        for (size_t pos = 0; pos < file.size();) {
+            const char* newline = (const char*)memchr(file.data() + pos, '\n', file.size() - pos);
+            const size_t n = newline ? (size_t)(newline - file.data()) - pos : file.size() - pos;
+            lines.emplace_back(file.data() + pos, n);
+            pos += n + 1;
+        }
+        auto field = [&lines](const char* key, size_t index) {
+            for (const std::string& line : lines) {
+                if (line.compare(0, strlen(key), key) != 0) continue;
+                std::vector<std::string> words;
+                for (size_t pos = 0; (pos = line.find_first_not_of(" \t", pos)) != std::string::npos;) {
+                    const size_t end = line.find_first_of(" \t", pos);
+                    words.push_back(line.substr(pos, end - pos));
+                    pos = end;
+                }
+                return index < words.size() ? words[index] : std::string();
+            }
+            return std::string();
+        };
+        auto dropFirst = [](std::string value, const char* unit) {
+            const size_t at = value.find(unit);
+            if (at != std::string::npos) value.erase(at, strlen(unit));
+            return value;
+        };
+        const std::string status = field("STATUS:", 1);
+        const std::string type = field("Test Type:", 2);
+        const std::string depth = dropFirst(field("Depth:", 1), "m");
+        const std::string wind = dropFirst(field("Wind Speed:", 2), "kn");
+        const std::string number = field("Test Number:", 2);
+
+        int minutes, seconds;
+        char m, s;
+        const std::string duration = field("Duration:", 1) + " " + field("Duration:", 2);
+        if (sscanf(duration.c_str(), "%d%c %d%c", &minutes, &m, &seconds, &s) == 4 && m == 'm' && s == 's' &&
+            minutes >= 0 && seconds >= 0) {
+            const long long sec = minutes * 60LL + seconds;
+            total_seconds += sec;
+            min_seconds = std::min(min_seconds, sec);
+            max_seconds = std::max(max_seconds, sec);
+        }
+
+        types[type].total++;
+        depths[depth].total++;
+        winds[wind].total++;
+        if (status == "PASS") {
+            passed++;
+            types[type].pass++;
+            depths[depth].pass++;
+            winds[wind].pass++;
+        } else if (status == "FAIL") {
+            failures++;
+            std::string issue;
+            for (size_t i = 0; i < lines.size(); i++) {
+                if (lines[i].find("Issues:") == std::string::npos) continue;
+                for (size_t j = i + 1; j < lines.size() && j <= i + 10 && issue.empty(); j++) {
+                    if (lines[j].compare(0, 4, "  - ") == 0) issue = lines[j].substr(4);
+                }
+                break;
+            }
+            failed.push_back("Test " + number + " (" + type + " @ " + wind + "kn, " + depth + "m): " + issue);
+        } else {
+            incomplete++;
+        }
+    }
+
+    const std::string success_rate = total ? bcQuotient(passed * 100LL, total) : "0";
+    std::string average = "N/A", minimum = "N/A", maximum = "N/A";
+    const long long average_seconds = total ? total_seconds / total : 0;
+    if (total > 0 && total_seconds > 0) {
+        average = minutesSeconds(average_seconds);
+        minimum = minutesSeconds(min_seconds);
+        maximum = minutesSeconds(max_seconds);
+    }
+
+    std::string text;
+    char row[256];
+    auto line = [&text](const std::string& s) { text += s + "\n"; };
+    // sort -n of the printed rows: by the leading number, then the row
+    auto rates = [&](const std::map<std::string, Tally>& tallies, const char* unit, bool numeric) {
+        std::vector<std::string> rows;
+        for (const auto& [key, tally] : tallies) {
+            if (key.empty()) continue;   // The script's ".total" file is hidden from its glob
+            snprintf(row, sizeof row, "%-15s: %2d/%2d (%.1f%%)", (key + unit).c_str(), tally.pass, tally.total,
+                     truncatedRate(tally.pass, tally.total));
+            rows.push_back(row);
+        }
+        if (numeric) {
+            std::stable_sort(rows.begin(), rows.end(), [](const std::string& a, const std::string& b) {
+                const double x = atof(a.c_str()), y = atof(b.c_str());
+                return x != y ? x < y : a < b;
+            });
+        }
+        for (const std::string& r : rows) line(r);
+    };
+
+    char generated[32];
+    const time_t now = time(nullptr);
+    strftime(generated, sizeof generated, "%Y-%m-%d %H:%M:%S", localtime(&now));
+    const char* rule = "============================================================";
+    const char* thin = "------------------------------------------------------------";
+
+    line(rule);
+    line("SensESP Chain Counter - Test Run Summary");
+    line(rule);
+    line(std::string("Generated: ") + generated);
+    line("Test Directory: " + dir);
+    line(rule);
+    line("");
+    line("OVERALL RESULTS");
+    line(thin);
+    line("Total Tests: " + std::to_string(total) + " / " + std::to_string(TOTAL_TESTS));
+    line("Passed: " + std::to_string(passed));
+    line("Failed: " + std::to_string(failures));
+    line("Incomplete: " + std::to_string(incomplete));
+    line("Success Rate: " + success_rate + "%");
+    line("");
+    line(rule);
+    line("SUCCESS RATE BY TEST TYPE");
+    line(thin);
+    rates(types, "", false);
+    line("");
+    line(rule);
+    line("SUCCESS RATE BY DEPTH");
+    line(thin);
+    rates(depths, "m", true);
+    line("");
+    line(rule);
+    line("SUCCESS RATE BY WIND SPEED");
+    line(thin);
+    rates(winds, "kn", true);
+    line("");
+    line(rule);
+    line("TIMING STATISTICS");
+    line(thin);
+    line("Average Duration: " + average);
+    line("Minimum Duration: " + minimum);
+    line("Maximum Duration: " + maximum);
+    if (total > 0 && total_seconds > 0) {
+        line("Total Test Time: " + std::to_string(total_seconds / 3600) + "h " +
+             std::to_string((total_seconds % 3600) / 60) + "m");
+        if (total < TOTAL_TESTS) {
+            const long long remaining = (TOTAL_TESTS - total) * average_seconds;
+            line("Estimated Remaining: " + std::to_string(remaining / 3600) + "h " +
+                 std::to_string((remaining % 3600) / 60) + "m (" + std::to_string(TOTAL_TESTS - total) + " tests)");
+        }
+    }
+    line("");
+    line(rule);
+    line("FAILED TESTS");
+    line(thin);
+    if (failed.empty()) line("None");
+    for (const std::string& f : failed) line("- " + f);
+    line("");
+    line(rule);
+    line("END OF SUMMARY");
+    line(rule);
+
+    const std::string summary = dir + "/summary.txt";
+    if (!writeFile(summary, text.data(), text.size())) {
+        fprintf(stderr, "Error: cannot write %s\n", summary.c_str());
+        return 1;
+    }
+
+    printf("%s============================================================%s\n", BLUE, NC);
+    printf("%sTest Run Summary%s\n", BLUE, NC);
+    printf("%s============================================================%s\n", BLUE, NC);
+    printf("Total Tests: %s%d / %d%s\n", YELLOW, total, TOTAL_TESTS, NC);
+    if (passed > 0) printf("Passed: %s%d%s\n", GREEN, passed, NC);
+    if (failures > 0) printf("Failed: %s%d%s\n", RED, failures, NC);
+    if (incomplete > 0) printf("Incomplete: %s%d%s\n", YELLOW, incomplete, NC);
+    printf("Success Rate: %s%s%%%s\n", YELLOW, success_rate.c_str(), NC);
+    printf("\n");
+    printf("%sSummary saved to:%s %s\n", BLUE, NC, summary.c_str());
+    printf("%s============================================================%s\n", BLUE, NC);
+    return 0;
+}
+
+// The tables of logs/test-comparison-*.md that come straight from the captures
+int commandCompare(const std::string& baseline_path, const std::string& new_path) {
+    MappedFile baseline_file(baseline_path);
+    MappedFile new_file(new_path);
+    if (!baseline_file.ok() || !new_file.ok()) {
+        fprintf(stderr, "Error: Log file not found: %s\n", (baseline_file.ok() ? new_path : baseline_path).c_str());
+        return 1;
+    }
+    const std::vector<Analysis> runs[2] = {analyzeRun(parse(baseline_file)), analyzeRun(parse(new_file))};
+
+    auto percent = [](long long part, long long whole) { return whole ? 100.0 * (double)part / (double)whole : 0.0; };
+    auto delta = [](long long change, const char* unit) {
+        if (change == 0) return std::string("Same");
+        char text[64];
+        snprintf(text, sizeof text, "%+lld %s%s", change, unit, std::llabs(change) == 1 ? "" : "s");
+        return std::string(text);
+    };
+    auto count = [](const std::vector<Analysis>& run, const std::string& type, bool passing) {
+        long long n = 0;
+        for (const Analysis& a : run) n += (type.empty() || a.params.type == type) && (!passing || a.pass);
+        return n;
+    };
+    auto saves = [](const std::vector<Analysis>& run, const std::string& type, const std::string& depth,
+                     long long* tests) {
+        long long total = 0;
+        *tests = 0;
+        for (const Analysis& a : run) {
+            if ((!type.empty() && a.params.type != type) || (!depth.empty() && a.params.depth != depth)) continue;
+            total += (long long)a.writes;
+            (*tests)++;
+        }
+        return total;
+    };
+
+    printf("# Test Comparison Report: Baseline vs New Run\n\n");
+    printf("**Baseline Run:** %s\n", baseName(baseline_path).c_str());
+    printf("**New Run:** %s\n\n", baseName(new_path).c_str());
+    printf("---\n\n## Executive Summary\n\n### Overall Results\n\n");
+    printf("| Metric | Baseline | New Run | Change |\n");
+    printf("|--------|----------|---------|--------|\n");
+    const long long tests[2] = {count(runs[0], "", false), count(runs[1], "", false)};
+    const long long passed[2] = {count(runs[0], "", true), count(runs[1], "", true)};
+    printf("| **Total Tests** | %lld | %lld | %s |\n", tests[0], tests[1], delta(tests[1] - tests[0], "test").c_str());
+    printf("| **Passed** | %lld (%.1f%%) | %lld (%.1f%%) | %s |\n", passed[0], percent(passed[0], tests[0]), passed[1],
+           percent(passed[1], tests[1]), delta(passed[1] - passed[0], "test").c_str());
+    printf("| **Failed** | %lld (%.1f%%) | %lld (%.1f%%) | %s |\n", tests[0] - passed[0],
+           percent(tests[0] - passed[0], tests[0]), tests[1] - passed[1], percent(tests[1] - passed[1], tests[1]),
+           delta((tests[1] - passed[1]) - (tests[0] - passed[0]), "test").c_str());
+    for (const char* type : {"autoDrop", "autoRetrieve"}) {
+        long long t[2], p[2];
+        for (int r = 0; r < 2; r++) {
+            t[r] = count(runs[r], type, false);
+            p[r] = count(runs[r], type, true);
+        }
+        printf("| **%s Success** | %lld/%lld (%.1f%%) | %lld/%lld (%.1f%%) | %s |\n", type, p[0], t[0],
+               percent(p[0], t[0]), p[1], t[1], percent(p[1], t[1]), delta(p[1] - p[0], "test").c_str());
+    }
+
+    printf("\n---\n\n## Detailed Comparison\n\n### Test Failures\n");
+    const char* titles[2] = {"Baseline Failures", "New Run Failures"};
+    for (int r = 0; r < 2; r++) {
+        printf("\n**%s (%lld tests):**\n", titles[r], tests[r] - passed[r]);
+        int index = 0;
+        for (const Analysis& a : runs[r]) {
+            if (a.pass) continue;
+            bool in_other = false;
+            for (const Analysis& b : runs[1 - r]) in_other |= b.params.number == a.params.number && !b.pass;
+            printf("%d. Test %s: %s %skn %sm ❌%s\n", ++index, a.params.number.c_str(), a.params.type.c_str(),
+                   a.params.wind.c_str(), a.params.depth.c_str(), r == 1 && !in_other ? " (NEW)" : "");
+        }
+    }
+
+    printf("\n### Failure Pattern by Depth\n\n");
+    printf("| Depth | Baseline Failures | New Run Failures | Change |\n");
+    printf("|-------|-------------------|------------------|--------|\n");
+    for (const char* depth : {"3", "5", "8", "12"}) {
+        long long t[2] = {}, f[2] = {};
+        for (int r = 0; r < 2; r++) {
+            for (const Analysis& a : runs[r]) {
+                if (a.params.depth != depth) continue;
+                t[r]++;
+                f[r] += !a.pass;
+            }
+        }
+        printf("| %sm | %lld/%lld (%.0f%%) | %lld/%lld (%.0f%%) | %s |\n", depth, f[0], t[0], percent(f[0], t[0]),
+               f[1], t[1], percent(f[1], t[1]), delta(f[1] - f[0], "failure").c_str());
+    }
+
+    printf("\n---\n\n## SPIFFS Write Analysis\n\n### Summary Comparison\n\n");
+    printf("| Metric | Baseline | New Run | Difference |\n");
+    printf("|--------|----------|---------|------------|\n");
+    long long n[2];
+    const long long total[2] = {saves(runs[0], "", "", &n[0]), saves(runs[1], "", "", &n[1])};
+    printf("| **Total Writes** | %s | %s | %+lld (%+.1f%%) |\n", withThousands(total[0]).c_str(),
+           withThousands(total[1]).c_str(), total[1] - total[0], percent(total[1] - total[0], total[0]));
+    auto averageRow = [&](const char* label, const std::string& type) {
+        long long t[2];
+        const double average[2] = {(double)saves(runs[0], type, "", &t[0]), (double)saves(runs[1], type, "", &t[1])};
+        const double a = t[0] ? average[0] / t[0] : 0.0;
+        const double b = t[1] ? average[1] / t[1] : 0.0;
+        printf("| **%s** | %.1f | %.1f | %+.1f |\n", label, a, b, b - a);
+    };
+    averageRow("Avg per Test", "");
+    averageRow("autoDrop Avg", "autoDrop");
+    averageRow("autoRetrieve Avg", "autoRetrieve");
+
+    printf("\n### Write Breakdown by Depth\n\n");
+    printf("| Depth | Baseline autoDrop | New autoDrop | Baseline autoRetrieve | New autoRetrieve |\n");
+    printf("|-------|-------------------|--------------|----------------------|-----------------|\n");
+    for (const char* depth : {"3", "5", "8", "12"}) {
+        printf("| %sm", depth);
+        for (const char* type : {"autoDrop", "autoRetrieve"}) {
+            for (int r = 0; r < 2; r++) {
+                long long t;
+                const long long w = saves(runs[r], type, depth, &t);
+                printf(" | %.1f", t ? (double)w / t : 0.0);
+            }
+        }
+        printf(" |\n");
+    }
+    return 0;
+}
+
+int usage() {
+    fprintf(stderr,
+            "Usage: log-analyzer <command> [args]\n"
+            "  log <log-file>                        Event counts (analyze-log.sh)\n"
+            "  spiffs <log-file>                     SPIFFS writes per test (analyze-spiffs-writes.sh)\n"
+            "  extract [--analyze] <log-file> <dir>  One file per test (extract-tests-from-log.sh)\n"
+            "  analyze <test-log>                    PASS/FAIL of one test (analyze-test-result.sh)\n"
+            "  summary <test-run-dir>                summary.txt (generate-test-summary.sh)\n"
+            "  compare <baseline-log> <new-log>      Markdown comparison of two runs\n");
+    return 2;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) return usage();
+    const std::string command = argv[1];
+    if (command == "log" && argc == 3) return commandLog(argv[2]);
+    if (command == "spiffs" && argc == 3) return commandSpiffs(argv[2]);
+    if (command == "analyze" && argc == 3) return commandAnalyze(argv[2]);
+    if (command == "summary" && argc == 3) return commandSummary(argv[2]);
+    if (command == "compare" && argc == 4) return commandCompare(argv[2], argv[3]);
+    if (command == "extract") {
+        const bool with_analysis = std::string(argv[2]) == "--analyze";
+        if (argc == 4 + with_analysis) return commandExtract(argv[2 + with_analysis], argv[3 + with_analysis], with_analysis);
+    }
+    return usage();
+}
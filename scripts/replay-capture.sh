@@ -0,0 +1,41 @@
+#!/bin/bash
+
+# SensESP Chain Counter - Capture Replay
+# Usage: ./scripts/replay-capture.sh [capture.log | directory]
+#
+# Feeds trace captures (logs of the pioarduino_esp32_trace build, see
+# src/ChainTrace.h) back through ChainController/DeploymentManager on the
+# host (platformio env "native_replay") and compares the relay actions,
+# stage transitions and NVS writes with the ones in the capture. Without an
+# argument every .log/.txt in logs/replay is replayed. Output is kept in
+# replay_output.txt at the repo root.
+
+set -e
+
+GREEN='\033[0;32m'
+RED='\033[0;31m'
+NC='\033[0m' # No Color
+
+cd "$(dirname "$0")/.."
+
+CAPTURES="${1:-logs/replay}"
+if [ ! -e "$CAPTURES" ]; then
+    echo -e "${RED}Error: $CAPTURES not found${NC}"
+    exit 1
+fi
+export CHAIN_REPLAY="$(cd "$(dirname "$CAPTURES")" && pwd)/$(basename "$CAPTURES")"
+
+if ! command -v pio >/dev/null 2>&1; then
+    echo -e "${RED}Error: PlatformIO (pio) not found in PATH${NC}"
+    exit 1
+fi
+
+if pio test -e native_replay -v 2>&1 | tee replay_output.txt; then
+    echo -e "${GREEN}Replay matches the captures${NC}"
+else
+    echo -e "${RED}Replay differs - see replay_output.txt${NC}"
+    exit 1
+fi
+
+echo ""
+grep -E " records .* outputs |^    (output|missing|not in)" replay_output.txt || true
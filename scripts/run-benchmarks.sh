@@ -0,0 +1,31 @@
+#!/bin/bash
+
+# SensESP Chain Counter - Host Benchmarks
+# Usage: ./scripts/run-benchmarks.sh
+#
+# Builds ChainController/DeploymentManager for the host (platformio env
+# "native") and runs the benchmark suite. Output is kept in bench_output.txt
+# at the repo root so runs can be compared between commits.
+
+set -e
+
+GREEN='\033[0;32m'
+RED='\033[0;31m'
+NC='\033[0m' # No Color
+
+cd "$(dirname "$0")/.."
+
+if ! command -v pio >/dev/null 2>&1; then
+    echo -e "${RED}Error: PlatformIO (pio) not found in PATH${NC}"
+    exit 1
+fi
+
+if pio test -e native -f test_benchmarks -v 2>&1 | tee bench_output.txt; then
+    echo -e "${GREEN}Benchmarks passed${NC}"
+else
+    echo -e "${RED}Benchmarks failed - see bench_output.txt${NC}"
+    exit 1
+fi
+
+echo ""
+grep -E "ns/call|real time" bench_output.txt || true
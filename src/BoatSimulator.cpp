@@ -0,0 +1,225 @@
+#include "BoatSimulator.h"
+#include <cmath>
+
+BoatSimulator::BoatSimulator(const Config& config) {
+    reset(config);
+}
+
+void BoatSimulator::reset(const Config& config) {
+    config_ = config;
+    elapsed_ms_ = 0;
+    boat_accum_ms_ = 0;
+
+    down_coil_ = up_coil_ = false;
+    down_coil_since_ = up_coil_since_ = 0;
+    down_contact_ = up_contact_ = false;
+
+    gypsy_v_mps_ = 0.0;
+    rode_m_ = constrain(config.initial_rode_m, 0.0f, config.chain_total_m);
+    gypsy_turns_ = (int32_t)floorf(rode_m_ / config_.gypsy_circumference_m);
+
+    // A rode already past the bottom starts lying straight down-wind, just slack
+    float vertical = config_.depth_m + config_.bow_height_m;
+    anchor_down_ = anchor_was_down_ = rode_m_ > vertical;
+    boat_pos_m_ = anchor_down_ ? rode_m_ - vertical : 0.0f;
+    anchor_pos_m_ = drop_pos_m_ = 0.0;
+    boat_v_mps_ = 0.0;
+    tension_h_n_ = 0.0;
+    engine_thrust_n_ = 0.0;
+    peak_bow_tension_n_ = 0.0;
+    set_s_ = anchor_down_ ? config_.set_time_s : 0.0f;
+    dragged_m_ = 0.0;
+
+    // Spread small seeds over the state (xorshift starts out tiny from 1, 2, ...)
+    rng_state_ = (config.seed != 0 ? config.seed : 1) * 2654435761u;
+}
+
+int32_t BoatSimulator::step(unsigned long dt_ms, bool down_relay, bool up_relay) {
+    if (down_relay != down_coil_) {
+        down_coil_ = down_relay;
+        down_coil_since_ = elapsed_ms_;
+    }
+    if (up_relay != up_coil_) {
+        up_coil_ = up_relay;
+        up_coil_since_ = elapsed_ms_;
+    }
+
+    int32_t start_turns = gypsy_turns_;
+    // The windlass runs at 1 ms (pulse timing matters), the boat at BOAT_STEP_MS
+    for (unsigned long i = 0; i < dt_ms; i++) {
+        elapsed_ms_++;
+        if (elapsed_ms_ - down_coil_since_ >= config_.relay_latency_ms) down_contact_ = down_coil_;
+        if (elapsed_ms_ - up_coil_since_ >= config_.relay_latency_ms) up_contact_ = up_coil_;
+
+        stepWindlass(0.001f);
+        if (++boat_accum_ms_ >= BOAT_STEP_MS) {
+            boat_accum_ms_ = 0;
+            stepBoat(BOAT_STEP_MS / 1000.0f);
+        }
+    }
+    return gypsy_turns_ - start_turns;
+}
+
+void BoatSimulator::stepWindlass(float dt_s) {
+    float target = 0.0;
+    if (down_contact_ && !up_contact_) {
+        target = config_.down_speed_mps;
+    } else if (up_contact_ && !down_contact_) {
+        target = -config_.up_speed_mps * loadFactor();
+    }
+
+    // Spin-up lag towards a faster target, coast lag otherwise
+    bool speeding_up = fabsf(target) > fabsf(gypsy_v_mps_) && target * gypsy_v_mps_ >= 0.0f;
+    float tau = speeding_up ? config_.spinup_tau_s : config_.coast_tau_s;
+    gypsy_v_mps_ += (target - gypsy_v_mps_) * fminf(1.0f, dt_s / tau);
+
+    rode_m_ += gypsy_v_mps_ * dt_s;
+    if (rode_m_ <= 0.0f || rode_m_ >= config_.chain_total_m) {
+        rode_m_ = constrain(rode_m_, 0.0f, config_.chain_total_m);
+        gypsy_v_mps_ = 0.0;
+    }
+    gypsy_turns_ = (int32_t)floorf(rode_m_ / config_.gypsy_circumference_m);
+}
+
+void BoatSimulator::stepBoat(float dt_s) {
+    float vertical = config_.depth_m + config_.bow_height_m;
+
+    bool on_bottom = rode_m_ > vertical;
+    if (on_bottom && !anchor_down_) {
+        anchor_pos_m_ = drop_pos_m_ = boat_pos_m_;  // Lands under the bow
+        anchor_was_down_ = true;
+    }
+    if (!on_bottom) {
+        anchor_pos_m_ = boat_pos_m_;                // Hanging, or broken out
+        set_s_ = 0.0;
+    }
+    anchor_down_ = on_bottom;
+
+    float tension = 0.0;
+    if (anchor_down_) {
+        tension = tensionFor(boat_pos_m_ - anchor_pos_m_, rode_m_);
+        if (tension != 0.0f) {
+            set_s_ = fminf(config_.set_time_s, set_s_ + dt_s);
+        }
+        // Over the holding force the anchor slides towards the boat. Pulled
+        // from above it breaks out instead, which is not a drag.
+        bool breakout = breakingOut(boat_pos_m_ - anchor_pos_m_, rode_m_);
+        float holding = breakout ? fminf(holdingForce(), config_.breakout_force_n) : holdingForce();
+        if (fabsf(tension) > holding) {
+            float slide = (fabsf(tension) - holding) / DRAG_DAMPING_N_PER_MPS * dt_s;
+            anchor_pos_m_ += tension > 0.0f ? slide : -slide;
+            if (breakout) {
+                set_s_ = 0.0;
+            } else {
+                dragged_m_ += slide;
+            }
+            tension = tension > 0.0f ? holding : -holding;
+        }
+    }
+    tension_h_n_ = tension;
+
+    float hull_force = config_.hull_drag_n_per_mps2 * boat_v_mps_ * fabsf(boat_v_mps_);
+    float accel = (windForce() - engine_thrust_n_ - tension - hull_force) / config_.mass_kg;
+    boat_v_mps_ += accel * dt_s;
+    boat_pos_m_ += boat_v_mps_ * dt_s;
+
+    float bow = bowTension();
+    if (bow > peak_bow_tension_n_) peak_bow_tension_n_ = bow;
+}
+
+// Hauled short with the whole rode suspended: the pull on the anchor is steep
+bool BoatSimulator::breakingOut(float x_m, float rode_m) const {
+    const float h = config_.depth_m + config_.bow_height_m;
+    if (rode_m <= h || rode_m >= config_.breakout_scope * h) return false;
+    float a_max = (rode_m * rode_m - h * h) / (2.0f * h);
+    return fabsf(x_m) >= a_max * acoshf(1.0f + h / a_max);
+}
+
+float BoatSimulator::tensionFor(float x_m, float rode_m) const {
+    const float h = config_.depth_m + config_.bow_height_m;
+    const float w = config_.chain_weight_n_per_m;
+    if (rode_m <= h) return 0.0;
+
+    float span = fabsf(x_m);
+    if (span <= rode_m - h) return 0.0;  // Hangs straight down, rest on the bottom
+
+    // Catenary with touchdown: parameter a = H / w, suspended length
+    // s = sqrt(h^2 + 2ha), horizontal reach = (L - s) + a * acosh(1 + h/a).
+    // The whole rode is suspended (shank about to lift) at s = L.
+    float a_max = (rode_m * rode_m - h * h) / (2.0f * h);
+    float reach_max = a_max * acoshf(1.0f + h / a_max);
+    float tension;
+    if (span >= reach_max) {
+        tension = w * a_max + config_.taut_stiffness_n_per_m * (span - reach_max);
+    } else {
+        float lo = 0.0;
+        float hi = a_max;
+        for (int i = 0; i < CATENARY_ITERATIONS; i++) {
+            float a = 0.5f * (lo + hi);
+            float reach = rode_m - sqrtf(h * h + 2.0f * h * a) + a * acoshf(1.0f + h / a);
+            if (reach < span) lo = a; else hi = a;
+        }
+        tension = w * 0.5f * (lo + hi);
+    }
+    return x_m >= 0.0f ? tension : -tension;
+}
+
+float BoatSimulator::suspendedLength() const {
+    const float h = config_.depth_m + config_.bow_height_m;
+    if (!anchor_down_) return rode_m_;
+    float a = fabsf(tension_h_n_) / config_.chain_weight_n_per_m;
+    return fminf(rode_m_, sqrtf(h * h + 2.0f * h * a));
+}
+
+float BoatSimulator::bowTension() const {
+    float vertical = config_.chain_weight_n_per_m * suspendedLength();
+    if (!anchor_down_) vertical += config_.anchor_weight_n;
+    return sqrtf(tension_h_n_ * tension_h_n_ + vertical * vertical);
+}
+
+float BoatSimulator::holdingForce() const {
+    // A fresh anchor holds a fifth of its set value
+    float set = config_.set_time_s > 0.0f ? set_s_ / config_.set_time_s : 1.0f;
+    return config_.holding_force_n * (0.2f + 0.8f * set);
+}
+
+float BoatSimulator::loadFactor() const {
+    return fmaxf(0.0f, 1.0f - bowTension() / config_.stall_tension_n);
+}
+
+float BoatSimulator::sampleDepth() {
+    return config_.depth_m + noise(config_.depth_noise_m);
+}
+
+float BoatSimulator::sampleDistance() {
+    if (!anchor_was_down_) return 0.0;
+    return fmaxf(0.0f, fabsf(boat_pos_m_ - drop_pos_m_) + noise(config_.distance_noise_m));
+}
+
+float BoatSimulator::sampleWindSpeed() {
+    return fmaxf(0.0f, windAt(elapsedSeconds()) + noise(config_.wind_noise_mps));
+}
+
+float BoatSimulator::windForce() const {
+    float wind = windAt(elapsedSeconds());
+    return 0.5f * AIR_DENSITY * config_.wind_drag_coefficient * config_.windage_area_m2 * wind * wind;
+}
+
+float BoatSimulator::windAt(float t_s) const {
+    if (config_.gust_period_s <= 0.0f) return config_.wind_mps;
+    return config_.wind_mps * (1.0f + config_.gust_fraction * sinf(2.0f * (float)M_PI * t_s / config_.gust_period_s));
+}
+
+float BoatSimulator::noise(float sigma) {
+    if (sigma <= 0.0f) return 0.0;
+    // xorshift32 + Box-Muller: deterministic per seed, same on host and device
+    auto uniform = [this]() {
+        rng_state_ ^= rng_state_ << 13;
+        rng_state_ ^= rng_state_ >> 17;
+        rng_state_ ^= rng_state_ << 5;
+        return (rng_state_ >> 8) * (1.0f / 16777216.0f) + (0.5f / 16777216.0f);
+    };
+    float u1 = uniform();
+    float u2 = uniform();
+    return sigma * sqrtf(-2.0f * logf(u1)) * cosf(2.0f * (float)M_PI * u2);
+}
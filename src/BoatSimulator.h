@@ -0,0 +1,165 @@
+// BoatSimulator.h
+#ifndef BOATSIMULATOR_H
+#define BOATSIMULATOR_H
+
+#include <Arduino.h>
+
+/**
+ * Physics model of the boat, rode and windlass for driving the controller
+ * without water.
+ *
+ * One axis, down-wind. The boat is a mass pushed by wind drag (with an
+ * optional sinusoidal gust), resisted by quadratic hull drag and by the
+ * horizontal chain tension. The rode is an inextensible catenary with the
+ * lower part lying on the seabed; when the boat is further out than the
+ * rode can reach with the anchor shank still flat, the tension rises
+ * steeply (chain lifting the anchor, snubber stretch). Tension above the
+ * anchor's holding force drags the anchor. Holding builds up as the anchor
+ * sets under load; hauled short with the shank lifting it falls to the
+ * breakout force, so the windlass breaks the anchor out as on a real boat.
+ *
+ * The windlass follows the relay outputs through a contact latency, spins
+ * up and coasts down with first-order lags, and slows under load while
+ * hauling (stalling at stall_tension_n). Every gypsy circumference passed is
+ * one hall edge, whichever way the gypsy turns - direction is the
+ * counter's business, as on the boat.
+ *
+ * Nothing here reads the clock or touches SensESP; the caller advances it
+ * with step() and delivers the pulses and sensor samples, so the same model
+ * runs faster than real time on the host and in real time on the device.
+ */
+class BoatSimulator {
+public:
+    struct Config {
+        // Site
+        float depth_m = 10.0;                    // Water depth below the transducer
+        float bow_height_m = 2.0;                // Bow roller above the water
+        float wind_mps = 8.0;
+        float gust_fraction = 0.2;               // Wind varies by +/- this fraction...
+        float gust_period_s = 45.0;              // ...over this period
+
+        // Boat
+        float mass_kg = 8000.0;
+        float windage_area_m2 = 15.0;
+        float wind_drag_coefficient = 1.2;
+        float hull_drag_n_per_mps2 = 2500.0;     // Quadratic hull resistance (~1 kn drift in 8 m/s)
+
+        // Ground tackle
+        float chain_weight_n_per_m = 21.6;       // Submerged, 8 mm chain
+        float chain_total_m = 80.0;
+        float anchor_weight_n = 180.0;
+        float holding_force_n = 8000.0;          // Once fully set
+        float set_time_s = 60.0;                 // Time under load to reach full holding
+        float breakout_force_n = 1500.0;         // Holding once hauled short with the shank lifting...
+        float breakout_scope = 1.5;              // ...at a scope below this (steep pull)
+        float taut_stiffness_n_per_m = 50000.0;  // Beyond the flat-shank reach
+
+        // Windlass
+        float gypsy_circumference_m = 0.25;
+        float down_speed_mps = 1.0;
+        float up_speed_mps = 0.8;                // Unloaded
+        float stall_tension_n = 10000.0;         // Hauling speed falls to zero here (max pull)
+        unsigned long relay_latency_ms = 30;     // Coil to contact, both ways
+        float spinup_tau_s = 0.15;
+        float coast_tau_s = 0.12;
+
+        // Sensors
+        float distance_noise_m = 0.3;            // GPS-derived bow-to-anchor distance
+        float depth_noise_m = 0.05;
+        float wind_noise_mps = 0.3;
+        uint32_t seed = 1;
+
+        // Start state
+        float initial_rode_m = 0.0;
+    };
+
+    explicit BoatSimulator(const Config& config);
+
+    void reset(const Config& config);
+
+    // Advance by dt_ms with the given relay coil states. Returns the signed
+    // gypsy edges passed (+ paying out, - hauling); |value| is the number of
+    // hall pulses.
+    int32_t step(unsigned long dt_ms, bool down_relay, bool up_relay);
+
+    // Engine thrust towards the anchor (up-wind), e.g. a skipper motoring up the rode
+    void setEngineThrust(float thrust_n) { engine_thrust_n_ = thrust_n; }
+    float windForce() const;                     // Current wind drag on the boat (N)
+
+    // Relay contacts, i.e. what the ACTIVE-LOW sense lines see
+    bool downContact() const { return down_contact_; }
+    bool upContact() const { return up_contact_; }
+
+    // Sensor readings with noise - call once per sensor period
+    float sampleDepth();
+    float sampleDistance();                      // 0 until the anchor has been on the bottom
+    float sampleWindSpeed();
+
+    // Ground truth
+    const Config& config() const { return config_; }
+    float elapsedSeconds() const { return elapsed_ms_ / 1000.0f; }
+    float rode() const { return rode_m_; }
+    float distance() const { return fabsf(boat_pos_m_ - anchor_pos_m_); }
+    float boatSpeed() const { return boat_v_mps_; }
+    float gypsySpeed() const { return gypsy_v_mps_; }
+    float horizontalTension() const { return tension_h_n_; }
+    float bowTension() const;
+    float peakBowTension() const { return peak_bow_tension_n_; }
+    void clearPeakBowTension() { peak_bow_tension_n_ = 0.0; }
+    float holdingForce() const;
+    float dragged() const { return dragged_m_; }
+    bool anchorOnBottom() const { return anchor_down_; }
+    bool stalled() const { return up_contact_ && loadFactor() <= 0.0f; }  // Hauling against stall tension
+
+    // Horizontal tension for a boat x_m out from the anchor (exposed for checks)
+    float tensionFor(float x_m, float rode_m) const;
+
+    static constexpr unsigned long BOAT_STEP_MS = 10;   // Boat/catenary integration step
+
+private:
+    static constexpr float AIR_DENSITY = 1.225;
+    static constexpr float DRAG_DAMPING_N_PER_MPS = 4000.0;  // Anchor sliding resistance above holding
+    static constexpr int CATENARY_ITERATIONS = 32;
+
+    void stepWindlass(float dt_s);
+    void stepBoat(float dt_s);
+    float windAt(float t_s) const;
+    float loadFactor() const;
+    float suspendedLength() const;
+    bool breakingOut(float x_m, float rode_m) const;
+    float noise(float sigma);
+
+    Config config_;
+    unsigned long elapsed_ms_ = 0;
+    unsigned long boat_accum_ms_ = 0;
+
+    // Relays: coil commands become contacts after relay_latency_ms
+    bool down_coil_ = false;
+    bool up_coil_ = false;
+    unsigned long down_coil_since_ = 0;
+    unsigned long up_coil_since_ = 0;
+    bool down_contact_ = false;
+    bool up_contact_ = false;
+
+    // Windlass and rode
+    float gypsy_v_mps_ = 0.0;
+    float rode_m_ = 0.0;
+    int32_t gypsy_turns_ = 0;                    // floor(rode / circumference)
+
+    // Boat and anchor, positions down-wind from the start point (bow roller)
+    float boat_pos_m_ = 0.0;
+    float anchor_pos_m_ = 0.0;                   // Hangs under the bow while off the bottom
+    float drop_pos_m_ = 0.0;                     // Last touchdown - what the distance sensor measures from
+    float boat_v_mps_ = 0.0;
+    float tension_h_n_ = 0.0;
+    float engine_thrust_n_ = 0.0;
+    float peak_bow_tension_n_ = 0.0;
+    bool anchor_down_ = false;
+    bool anchor_was_down_ = false;
+    float set_s_ = 0.0;
+    float dragged_m_ = 0.0;
+
+    uint32_t rng_state_ = 1;
+};
+
+#endif // BOATSIMULATOR_H
@@ -0,0 +1,85 @@
+#include "CatenaryTable.h"
+#include <cmath>
+
+CatenaryTable::CatenaryTable(float chain_weight_n_per_m)
+  : chain_weight_n_per_m_(chain_weight_n_per_m)
+{
+    unsigned long start = micros();
+    for (int i = 0; i < RATIO_POINTS; i++) {
+        float r = i * RATIO_STEP;
+        inverseCosine_[i] = 1.0f / sqrtf(1.0f - r * r);
+    }
+    ESP_LOGI(__FILE__, "CatenaryTable built: %d entries (%u bytes) in %lu us",
+             RATIO_POINTS, (unsigned)sizeof(inverseCosine_), micros() - start);
+}
+
+float CatenaryTable::reductionFactor(float chainLength, float depth, float horizontalForce) const {
+    // The light-force branch is a cheap step function - no table needed
+    if (horizontalForce < LIGHT_FORCE_N || chainLength <= 0.0f || depth < 0.0f) {
+        return exactReductionFactor(chainLength, depth, horizontalForce, chain_weight_n_per_m_);
+    }
+
+    float ratio = depth / chainLength;
+    if (ratio >= MAX_RATIO) {
+        return exactReductionFactor(chainLength, depth, horizontalForce, chain_weight_n_per_m_);
+    }
+
+    float pos = ratio / RATIO_STEP;
+    int i = (int)pos;
+    float t = pos - i;
+    float h = inverseCosine_[i] + (inverseCosine_[i + 1] - inverseCosine_[i]) * t;
+
+    // sag / straight-line distance = (w * L^2 / 8H) / sqrt(L^2 - d^2) = w * L * h(r) / 8H
+    float factor = 1.0f - (chain_weight_n_per_m_ * chainLength * h) / (8.0f * horizontalForce);
+    return fmaxf(MIN_FACTOR, fminf(MAX_FACTOR, factor));
+}
+
+float CatenaryTable::exactReductionFactor(float chainLength, float anchorDepth, float horizontalForce,
+                                          float chain_weight_n_per_m) {
+    // This function calculates the reduction factor due to chain catenary
+    // Based on catenary curve physics with chain weight and horizontal tension
+    //
+    // KEY PHYSICS:
+    // - LOW force (light wind) → MORE sag → LESS horizontal distance → LOWER reduction factor
+    // - HIGH force (strong wind) → LESS sag → MORE horizontal distance → HIGHER reduction factor
+
+    // Chain weight per meter in water (N/m)
+    float w = chain_weight_n_per_m;
+
+    // If horizontal force is very small, there's significant sag
+    if (horizontalForce < LIGHT_FORCE_N) {
+        // Light wind/current: LOTS of catenary sag (low tension)
+        // Lower reduction factors = more sag = less horizontal distance
+        float scopeRatio = chainLength / fmaxf(anchorDepth, 1.0f);
+        if (scopeRatio < 3.0f) {
+            return 0.90;  // Significant sag even on short scope
+        } else if (scopeRatio < 5.0f) {
+            return 0.85;  // More sag on typical scope
+        } else {
+            return 0.80;  // Lots of sag on long scope
+        }
+    }
+
+    // For a catenary with horizontal force H and vertical drop of anchorDepth,
+    // the relationship is complex. Using approximation for moderate sag:
+    // horizontal_distance ≈ sqrt(chainLength² - anchorDepth²) - (w * chainLength²)/(8*H)
+    //
+    // The sag reduction term (w * L²)/(8*H) gets SMALLER as H increases (tighter chain)
+
+    // Calculate theoretical straight-line horizontal distance
+    float straightLineDistance = sqrtf(chainLength * chainLength - anchorDepth * anchorDepth);
+
+    // Calculate catenary sag reduction (horizontal distance lost to sag)
+    // This gets SMALLER with higher force (less sag when chain is pulled tight)
+    float catenarySagReduction = (w * chainLength * chainLength) / (8.0f * horizontalForce);
+
+    // Actual horizontal distance accounting for catenary
+    float actualHorizontalDistance = straightLineDistance - catenarySagReduction;
+
+    // Reduction factor is the ratio
+    // Higher force → smaller sag reduction → higher actual distance → higher factor
+    float reductionFactor = actualHorizontalDistance / straightLineDistance;
+
+    // Clamp between reasonable bounds (0.80 to 0.99)
+    return fmaxf(MIN_FACTOR, fminf(MAX_FACTOR, reductionFactor));
+}
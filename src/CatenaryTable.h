@@ -0,0 +1,44 @@
+// CatenaryTable.h
+#ifndef CATENARYTABLE_H
+#define CATENARYTABLE_H
+
+#include <Arduino.h>
+
+/**
+ * Precomputed catenary reduction factors.
+ *
+ * The moderate-sag model is
+ *     factor = 1 - (w / 8H) * L^2 / sqrt(L^2 - d^2)
+ * clamped to [MIN_FACTOR, MAX_FACTOR]. The force term separates out exactly,
+ * and with r = d / L the geometric part is L * h(r), h(r) = 1 / sqrt(1 - r^2).
+ * Only h(r) is tabulated (built once at boot) and read with linear
+ * interpolation in float, so the lookup is exact in chain length and force
+ * and the slack loop and DeploymentManager avoid sqrt/pow on every call.
+ *
+ * Near-vertical chain (r > MAX_RATIO), where h(r) is too steep to
+ * interpolate, falls back to the exact model.
+ */
+class CatenaryTable {
+public:
+    explicit CatenaryTable(float chain_weight_n_per_m);
+
+    float reductionFactor(float chainLength, float depth, float horizontalForce) const;
+
+    // Exact model - used for out-of-range inputs and as the reference
+    static float exactReductionFactor(float chainLength, float depth, float horizontalForce,
+                                      float chain_weight_n_per_m);
+
+    static constexpr float MIN_FACTOR = 0.80;
+    static constexpr float MAX_FACTOR = 0.99;
+    static constexpr float LIGHT_FORCE_N = 50.0;   // Below this the model uses fixed scope-based factors
+
+private:
+    static constexpr int RATIO_POINTS = 257;
+    static constexpr float MAX_RATIO = 0.98;       // depth / chain length covered by the table
+    static constexpr float RATIO_STEP = MAX_RATIO / (RATIO_POINTS - 1);
+
+    float chain_weight_n_per_m_;
+    float inverseCosine_[RATIO_POINTS];            // h(r) = 1 / sqrt(1 - r^2)
+};
+
+#endif // CATENARYTABLE_H
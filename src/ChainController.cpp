@@ -1,7 +1,11 @@
 #include "ChainController.h"
 #include <Arduino.h>     // For pinMode, digitalWrite, millis, etc.
 #include <Preferences.h> // For saving/loading speeds
-#include <cmath>         // For pow, sqrt, fabs, isnan, isinf
+#include <cmath>         // For sqrtf, fabs, isnan, isinf
+#include "ChainTrace.h"
+#include "LogSink.h"
+#include "PerfStats.h"
+#include "SetupArena.h"
 
 // ============================================================================
 // Utility: computeTargetHorizontalDistance
@@ -9,24 +13,25 @@
 // using chain weight and horizontal force from wind/current.
 // ============================================================================
 float ChainController::computeTargetHorizontalDistance(float chainLength, float depth) {
+    return computeTargetHorizontalDistance(chainLength, depth, estimateHorizontalForce());
+}
+
+float ChainController::computeTargetHorizontalDistance(float chainLength, float depth, float horizontalForce) {
     // Guard against NaN/Inf inputs directly
     if (isnan(chainLength) || isinf(chainLength) || isnan(depth) || isinf(depth)) {
-        ESP_LOGE(__FILE__, "ChainController::computeTargetHorizontalDistance: NaN/Inf input detected! chainLength=%.2f, depth=%.2f. Returning 0.0", chainLength, depth);
+        SINK_LOGE_EVERY(LOG_INTERVAL_MS, __FILE__, "ChainController::computeTargetHorizontalDistance: NaN/Inf input detected! chainLength=%.2f, depth=%.2f. Returning 0.0", chainLength, depth);
         return 0.0;
     }
 
     // Mathematically, chainLength must be >= depth for a real solution
-    float arg = pow(chainLength, 2) - pow(depth, 2);
+    float arg = chainLength * chainLength - depth * depth;
     if (arg < 0.0) {
-        ESP_LOGW(__FILE__, "ChainController::computeTargetHorizontalDistance: Negative argument for sqrt! chainLength=%.2f, depth=%.2f, arg=%.2f. This usually means chainLength < depth. Returning 0.0", chainLength, depth, arg);
+        SINK_LOGW_EVERY(LOG_INTERVAL_MS, __FILE__, "ChainController::computeTargetHorizontalDistance: Negative argument for sqrt! chainLength=%.2f, depth=%.2f, arg=%.2f. This usually means chainLength < depth. Returning 0.0", chainLength, depth, arg);
         return 0.0;
     }
 
-    // Get estimated horizontal force for catenary calculation
-    float horizontalForce = estimateHorizontalForce();
-
     // Calculate straight-line distance (Pythagorean)
-    float straightLineDistance = sqrt(arg);
+    float straightLineDistance = sqrtf(arg);
 
     // Apply catenary reduction factor to account for chain sag
     float reductionFactor = computeCatenaryReductionFactor(chainLength, depth, horizontalForce);
@@ -38,229 +43,316 @@ float ChainController::computeTargetHorizontalDistance(float chainLength, float
 // ============================================================================
 // Constructor
 // ============================================================================
+ChainController::Environment ChainController::Environment::create() {
+    Environment environment;
+    // Depth <= 1 cm is a sensor fault, not a reading
+    environment.depth = SetupArena::make<SensorInput>("environment.depth.belowSurface", 2000, "/depth/sk", 0.01, INFINITY, DEPTH_MAX_AGE_MS);
+    environment.windSpeed = SetupArena::make<SensorInput>("environment.wind.speedTrue", 30000, "/wind/sk", 0.0, INFINITY, WIND_MAX_AGE_MS);  // 30s - only for catenary estimate
+    environment.tideHeightNow = SetupArena::make<SensorInput>("environment.tide.heightNow", 60000, "/tide/heightNow/sk", -INFINITY, INFINITY, TIDE_NOW_MAX_AGE_MS);  // 60s - tide changes slowly
+    environment.tideHeightHigh = SetupArena::make<SensorInput>("environment.tide.heightHigh", 300000, "/tide/heightHigh/sk", -INFINITY, INFINITY, TIDE_HIGH_MAX_AGE_MS);  // 5min - rarely changes
+    return environment;
+}
+
+SensorInput* ChainController::createDistanceInput(const String& sk_prefix, const String& config_prefix) {
+    // Negative distances are sensor faults
+    return SetupArena::make<SensorInput>(sk_prefix + ".distanceFromBow", 2000, config_prefix + "/distance/sk",
+                                         0.0, INFINITY, DISTANCE_MAX_AGE_MS);
+}
+
 ChainController::ChainController(
                 float min_length,
                 float max_length,
                 float stop_before_max,
-                sensesp::Integrator<float, float>* acc,
+                ChainPosition* position,
                 int downRelayPin,
                 int upRelayPin
             )
-  : min_length_(min_length),
-    max_length_(max_length),
-    stop_before_max_(stop_before_max),
-    accumulator_(acc),
+  : ChainController(min_length, max_length, stop_before_max, position, downRelayPin, upRelayPin,
+                    Environment::create(), createDistanceInput(), 0) {}
+
+ChainController::ChainController(
+                float min_length,
+                float max_length,
+                float stop_before_max,
+                ChainPosition* position,
+                int downRelayPin,
+                int upRelayPin,
+                const Environment& environment,
+                SensorInput* distance,
+                uint8_t unit
+            )
+  : position_(position),
+    min_pulses_(position->metersToPulsesFloor(min_length)),     // Raising stops at or below min_length
+    max_pulses_(position->metersToPulsesFloor(max_length)),
+    stop_before_max_pulses_(position->metersToPulsesCeil(stop_before_max)), // Lowering stops at or above
     downRelayPin_(downRelayPin),
     upRelayPin_(upRelayPin),
-    state_(ChainState::IDLE), // Default state
-    movement_start_time_(0),  // Initialize to prevent undefined behavior
+    unit_(unit),
     move_timeout_(10000),     // Safe default timeout (10 seconds)
-    horizontalSlack_(new sensesp::ObservableValue<float>(0.0)),
-    depthListener_(new sensesp::SKValueListener<float>("environment.depth.belowSurface", 2000, "/depth/sk")),
-    distanceListener_(new sensesp::SKValueListener<float>("navigation.anchor.distanceFromBow", 2000, "/distance/sk")),
-    windSpeedListener_(new sensesp::SKValueListener<float>("environment.wind.speedTrue", 30000, "/wind/sk")),  // 30s - only for catenary estimate
-    tideHeightNowListener_(new sensesp::SKValueListener<float>("environment.tide.heightNow", 60000, "/tide/heightNow/sk")),  // 60s - tide changes slowly
-    tideHeightHighListener_(new sensesp::SKValueListener<float>("environment.tide.heightHigh", 300000, "/tide/heightHigh/sk"))  // 5min - rarely changes
+    core_(nullptr),
+    depth_(environment.depth),
+    distance_(distance),
+    windSpeed_(environment.windSpeed),
+    tideHeightNow_(environment.tideHeightNow),
+    tideHeightHigh_(environment.tideHeightHigh),
+    horizontalSlack_(SetupArena::make<sensesp::ObservableValue<float>>(0.0)),
+    catenaryTable_(CHAIN_WEIGHT_PER_METER_KG * GRAVITY)
 {
-    // Ensure relays are off at startup. PinMode setup should happen in main.cpp.
-    digitalWrite(upRelayPin_, LOW);
-    digitalWrite(downRelayPin_, LOW);
-    ESP_LOGI(__FILE__, "ChainController initialized. UpRelay: %d, DownRelay: %d.", upRelayPin_, downRelayPin_);
+    // The first windlass keeps the namespace of the single-windlass firmware
+    if (unit_ == 0) {
+        snprintf(prefs_namespace_, sizeof(prefs_namespace_), "speeds");
+    } else {
+        snprintf(prefs_namespace_, sizeof(prefs_namespace_), "speeds%u", (unsigned)unit_ + 1);
+    }
+    // The core turns the relays off at construction. PinMode setup should happen in main.cpp.
+    core_ = SetupArena::make<WindlassCore>(position_->metersPerPulse(), min_pulses_, max_pulses_,
+                                          stop_before_max_pulses_, position_->pulses(),
+                                          downRelayPin_, upRelayPin_, unit_);
+    SINK_LOGI(__FILE__, "ChainController %u initialized. UpRelay: %d, DownRelay: %d.", (unsigned)unit_,
+              upRelayPin_, downRelayPin_);
+}
+
+bool ChainController::begin(PulseCounter* counter, int up_sense_gpio, int down_sense_gpio) {
+    if (counter != nullptr) {
+        core_->setPulseCounter(counter, up_sense_gpio, down_sense_gpio);
+    }
+    CHAIN_TRACE_RECORD(begin(unit_, position_->pulses(), min_pulses_, max_pulses_, stop_before_max_pulses_,
+                             position_->metersPerPulse(), core_->relayDeadTime()));
+    CHAIN_TRACE_RECORD(speeds(unit_, upSpeed_, downSpeed_, upCoastMs_, downCoastMs_));
+    publishControlInputs();
+    sensesp::event_loop()->onRepeat(SYNC_INTERVAL_MS, [this]() { sync(); });
+    return core_->start();
 }
 
 
 // ============================================================================
-// Anchor Control Methods
+// Windlass Task Interface
 // ============================================================================
 
-void ChainController::lowerAnchor(float amount) {
-    float current = accumulator_->get();
-    start_position_ = current;
-    movement_start_time_ = millis();
-    ESP_LOGI(__FILE__, "lowerAnchor() called, start_time=%lu, start_pos=%.2f",
-         movement_start_time_, start_position_);
-
-    // Set target: amount is relative, target_ becomes absolute
-    target_ = current + amount;
+WindlassCore::Command ChainController::makeCommand(WindlassCore::Command::Type type, int32_t pulses) {
+    WindlassCore::Command command = {};
+    command.type = type;
+    command.pulses = pulses;
+    return command;
+}
 
-    // Apply limits:
-    if (target_ > max_length_) {
-        ESP_LOGW(__FILE__, "lowerAnchor: Requested target %.2f m exceeds max_length_ %.2f m. Limiting target.", target_, max_length_);
-        target_ = max_length_;
-    }
-    // Also limit by stop_before_max_ if it's set to be less than max_length_
-    if (target_ > stop_before_max_) {
-        ESP_LOGW(__FILE__, "lowerAnchor: Requested target %.2f m exceeds stop_before_max_ %.2f m. Limiting target.", target_, stop_before_max_);
-        target_ = stop_before_max_;
-    }
-    if (target_ < min_length_) { // Should not be an issue for lowering, but defensive
-        ESP_LOGW(__FILE__, "lowerAnchor: Requested target %.2f m falls below min_length_ %.2f m. Limiting target.", target_, min_length_);
-        target_ = min_length_;
+bool ChainController::sendCommand(WindlassCore::Command command) {
+    command.seq = next_seq_ + 1;
+    if (!core_->post(command)) {
+        SINK_LOGE(__FILE__, "ChainController: windlass task command queue full - is the task running?");
+        return false;
     }
+    next_seq_ = command.seq;
+    return true;
+}
 
-    updateTimeout(amount, downSpeed_); // Use the requested 'amount' for timeout calculation
-    state_ = ChainState::LOWERING;
+WindlassCore::Command ChainController::makeMoveCommand(WindlassCore::Command::Type type, int32_t target_pulses,
+                                                       float speed_ms_per_m, float coast_ms) const {
+    WindlassCore::Command command = makeCommand(type, target_pulses);
+    command.timeout_ms = move_timeout_;
+    command.pulse_interval_ms = expectedPulseInterval(speed_ms_per_m);
+    command.coast_ms = (unsigned long)coast_ms;
+    command.slack_control = slack_control_;
+    return command;
+}
 
-    // Activate relay immediately - turn OFF opposite relay FIRST to prevent relay fighting
-    digitalWrite(upRelayPin_, LOW);     // Turn OFF opposite relay FIRST
-    digitalWrite(downRelayPin_, HIGH);  // Turn ON desired relay SECOND
+unsigned long ChainController::expectedPulseInterval(float speed_ms_per_m) const {
+    // The stall window is a multiple of this, so an unlearned speed just falls back to the default
+    if (speed_ms_per_m <= 0.01) return 0;
+    return (unsigned long)(speed_ms_per_m * position_->metersPerPulse());
+}
 
-    ESP_LOGI(__FILE__, "lowerAnchor: lowering to absolute target %.2f m (requested %.2f m from current %.2f m)", target_, amount, current);
+void ChainController::addPulses(int32_t delta) {
+    WindlassCore::Command command = makeCommand(WindlassCore::Command::Type::ADD_PULSES, delta);
+    command.timestamp_us = micros();
+    sendCommand(command);
+}
 
-    // Ensure control reacts instantly. This will immediately check if target is met.
-    control(current);
+void ChainController::resetPosition() {
+    sendCommand(makeCommand(WindlassCore::Command::Type::SET_PULSES, 0));
 }
 
-void ChainController::raiseAnchor(float amount) {
-    float current = accumulator_->get();
-    start_position_ = current;
-    movement_start_time_ = millis();
-    ESP_LOGI(__FILE__, "raiseAnchor() called, start_time=%lu, start_pos=%.2f",
-         movement_start_time_, start_position_);
+void ChainController::enableCounting() {
+    sendCommand(makeCommand(WindlassCore::Command::Type::ENABLE_COUNTING));
+}
 
-    // Set target: amount is relative, target_ becomes absolute
-    target_ = current - amount; // raising decreases height
+void ChainController::setAnchorWatch(bool watch) {
+    core_->setAnchorWatch(watch);
+}
 
-    // Apply limits:
-    if (target_ < min_length_) { // Min_length_ usually 0 for chain on deck
-        ESP_LOGW(__FILE__, "raiseAnchor: Requested target %.2f m falls below min_length_ %.2f m. Limiting target.", target_, min_length_);
-        target_ = min_length_;
+void ChainController::publishControlInputs() {
+    core_->publishInputs({horizontalSlack_->get(), getCurrentDepth(), slack_rate_mps_});
+}
+
+void ChainController::sync() {
+    // Finished moves first, so position observers (DeploymentManager) see
+    // the controller state that goes with the new position.
+    WindlassCore::Event event;
+    while (core_->nextEvent(&event)) {
+        handleEvent(event);
     }
-    if (target_ > max_length_) { // Should not be an issue for raising, but defensive
-        ESP_LOGW(__FILE__, "raiseAnchor: Requested target %.2f m exceeds max_length_ %.2f m. Limiting target.", target_, max_length_);
-        target_ = max_length_;
+
+    WindlassCore::Snapshot snapshot = core_->snapshot();
+    if (snapshot.dropped_events != reported_dropped_events_) {
+        SINK_LOGW(__FILE__, "ChainController: %lu windlass task events dropped - event loop fell behind",
+                  (unsigned long)(snapshot.dropped_events - reported_dropped_events_));
+        reported_dropped_events_ = snapshot.dropped_events;
+    }
+    if (snapshot.pulses != position_->pulses()) {
+        position_->setPulses(snapshot.pulses);
     }
+}
 
-    updateTimeout(amount, upSpeed_); // Use the requested 'amount' for timeout calculation
-    state_ = ChainState::RAISING;
+void ChainController::handleEvent(const WindlassCore::Event& event) {
+    switch (event.type) {
+        case WindlassCore::Event::Type::MOVE_ENDED:
+            if (event.reason == WindlassCore::StopReason::TIMEOUT) {
+                SINK_LOGE(__FILE__, "control: MOVEMENT TIMEOUT - elapsed=%lu ms, timeout=%lu ms, state=%s. Stopping windlass for safety.",
+                          event.duration_ms, move_timeout_, toString(event.direction));
+            } else if (event.reason == WindlassCore::StopReason::STALL) {
+                SINK_LOGE(__FILE__, "control: STALL - no gypsy pulse for %lu ms while %s at %.2f m. Stopping windlass (jammed chain or sensor fault?)",
+                          event.pulse_gap_ms, toString(event.direction), position_->pulsesToMeters(event.end_pulses));
+                break;  // Time spent stalled would corrupt the learned speed
+            } else if (event.reason == WindlassCore::StopReason::COMMAND) {
+                SINK_LOGD(__FILE__, "stop: all relays off, state IDLE.");
+            } else if (event.direction == ChainState::LOWERING) {
+                SINK_LOGD(__FILE__, "control: target reached (lowering), stopping at %.2f m.",
+                          position_->pulsesToMeters(event.end_pulses));
+            } else {
+                SINK_LOGI(__FILE__, "control: RAISING STOPPED - current_pos=%.2f, target=%.2f, min_length=%.2f, reason=%s",
+                          position_->pulsesToMeters(event.end_pulses), position_->pulsesToMeters(event.target_pulses),
+                          position_->pulsesToMeters(min_pulses_),
+                          (event.reason == WindlassCore::StopReason::TARGET) ? "target reached" : "min_length reached");
+            }
+            if (event.predicted) {
+                SINK_LOGD(__FILE__, "control: relay cut early at %.2f m for a %.0f ms coast (%.2f m/s)",
+                          position_->pulsesToMeters(event.end_pulses),
+                          event.direction == ChainState::LOWERING ? downCoastMs_ : upCoastMs_, event.speed_mps);
+            }
+            calcSpeed(event.direction, event.duration_ms, event.end_pulses - event.start_pulses,
+                      event.cruise_ms_per_m);
+            break;
 
-    // Reset slack monitoring state for new raise
-    paused_for_slack_ = false;
-    last_slack_action_time_ = 0;
+        case WindlassCore::Event::Type::COAST_MEASURED:
+            learnCoast(event.direction, event.speed_mps, event.end_pulses);
+            break;
 
-    // Activate relay immediately - turn OFF opposite relay FIRST to prevent relay fighting
-    digitalWrite(downRelayPin_, LOW);   // Turn OFF opposite relay FIRST
-    digitalWrite(upRelayPin_, HIGH);    // Turn ON desired relay SECOND
+        case WindlassCore::Event::Type::SLACK_PAUSE:
+            SINK_LOGI(__FILE__, "Pausing raise - slack low (%.2fm < %.2fm)", event.slack, event.slack_threshold);
+            break;
 
-    ESP_LOGI(__FILE__, "raiseAnchor: raising to absolute target %.2f m (requested %.2f m from current %.2f m)", target_, amount, current);
+        case WindlassCore::Event::Type::SLACK_RESUME:
+            SINK_LOGI(__FILE__, "Resuming raise - slack available (%.2fm >= %.2fm)", event.slack, event.slack_threshold);
+            break;
 
-    // React immediately
-    control(current);
+        case WindlassCore::Event::Type::SAFETY_VIOLATION:
+            SINK_LOGE_EVERY(LOG_INTERVAL_MS, __FILE__, "SAFETY VIOLATION: Both relays HIGH! UP=1 DOWN=1 - Ignoring %ld counter pulses",
+                            (long)event.end_pulses);
+            break;
+    }
 }
 
-void ChainController::control(float current_pos) {
-    if (state_ == ChainState::IDLE) return;
 
-    // Defensive guard - prevent undefined behavior if movement_start_time_ not set
-    if (movement_start_time_ == 0) {
-        ESP_LOGW(__FILE__, "control: movement_start_time_ is 0 but state is not IDLE. This should not happen.");
-        return;
+// ============================================================================
+// Anchor Control Methods
+// ============================================================================
+
+void ChainController::lowerAnchor(float amount) {
+    int32_t current = core_->snapshot().pulses;
+    SINK_LOGI(__FILE__, "lowerAnchor() called, start_time=%lu, start_pos=%.2f",
+         millis(), position_->pulsesToMeters(current));
+
+    // Set target: amount is relative, target becomes absolute.
+    // Lowering stops on the first pulse at or past the requested length.
+    float requested = position_->pulsesToMeters(current) + amount;
+    int32_t target_pulses = position_->metersToPulsesCeil(requested);
+
+    // Apply limits:
+    if (target_pulses > max_pulses_) {
+        SINK_LOGW(__FILE__, "lowerAnchor: Requested target %.2f m exceeds max_length_ %.2f m. Limiting target.",
+                  requested, position_->pulsesToMeters(max_pulses_));
+        target_pulses = max_pulses_;
+    }
+    // Also limit by stop_before_max_ if it's set to be less than max_length_
+    if (target_pulses > stop_before_max_pulses_) {
+        SINK_LOGW(__FILE__, "lowerAnchor: Requested target %.2f m exceeds stop_before_max_ %.2f m. Limiting target.",
+                  requested, position_->pulsesToMeters(stop_before_max_pulses_));
+        target_pulses = stop_before_max_pulses_;
+    }
+    if (target_pulses < min_pulses_) { // Should not be an issue for lowering, but defensive
+        SINK_LOGW(__FILE__, "lowerAnchor: Requested target %.2f m falls below min_length_ %.2f m. Limiting target.",
+                  requested, position_->pulsesToMeters(min_pulses_));
+        target_pulses = min_pulses_;
     }
 
-    // Check if movement has exceeded calculated timeout
-    unsigned long elapsed = millis() - movement_start_time_;
-    if (elapsed > move_timeout_) {
-        ESP_LOGE(__FILE__, "control: MOVEMENT TIMEOUT - elapsed=%lu ms, timeout=%lu ms, state=%s. Stopping windlass for safety.",
-                 elapsed, move_timeout_,
-                 (state_ == ChainState::LOWERING) ? "LOWERING" : "RAISING");
-        stop();
-        return;
+    updateTimeout(amount, downSpeed_); // Use the requested 'amount' for timeout calculation
+
+    // The task switches the relays (opposite relay off first) and checks the
+    // target on its next tick.
+    if (sendCommand(makeMoveCommand(WindlassCore::Command::Type::LOWER, target_pulses, downSpeed_, downCoastMs_))) {
+        commanded_state_ = ChainState::LOWERING;
     }
 
-    switch (state_) {
-        case ChainState::LOWERING:
-            // Check if current position has reached or exceeded the target.
-            // Also checking against stop_before_max_ ensures a stop if that limit is hit.
-            if (current_pos >= target_ || current_pos >= stop_before_max_) {
-                digitalWrite(downRelayPin_, LOW);
-                calcSpeed(movement_start_time_, start_position_);
-                state_ = ChainState::IDLE;
-                ESP_LOGD(__FILE__, "control: target reached (lowering), stopping at %.2f m.", current_pos);
-            } else {
-                digitalWrite(downRelayPin_, HIGH); // Keep relay HIGH if still lowering
-            }
-            break;
+    SINK_LOGI(__FILE__, "lowerAnchor: lowering to absolute target %.2f m (requested %.2f m from current %.2f m)",
+              position_->pulsesToMeters(target_pulses), amount, position_->pulsesToMeters(current));
+}
 
-        case ChainState::RAISING: {
-            // Check if target reached first (highest priority)
-            if (current_pos <= target_ || current_pos <= min_length_) {
-                digitalWrite(upRelayPin_, LOW);
-                calcSpeed(movement_start_time_, start_position_);
-                state_ = ChainState::IDLE;
-                paused_for_slack_ = false;  // Reset slack state
-                ESP_LOGI(__FILE__, "control: RAISING STOPPED - current_pos=%.2f, target=%.2f, min_length=%.2f, reason=%s",
-                         current_pos, target_, min_length_,
-                         (current_pos <= target_) ? "target reached" : "min_length reached");
-                break;
-            }
+void ChainController::raiseAnchor(float amount) {
+    int32_t current = core_->snapshot().pulses;
+    SINK_LOGI(__FILE__, "raiseAnchor() called, start_time=%lu, start_pos=%.2f",
+         millis(), position_->pulsesToMeters(current));
 
-            // Check if we're in final pull phase (chain nearly vertical)
-            float depth = getCurrentDepth();
-            bool inFinalPull = (current_pos <= depth + BOW_HEIGHT_M + FINAL_PULL_THRESHOLD_M);
-
-            // Skip slack monitoring in final pull - chain is nearly vertical, catenary model breaks down
-            if (inFinalPull) {
-                // Just keep raising until target reached
-                if (!paused_for_slack_) {
-                    digitalWrite(upRelayPin_, HIGH);
-                }
-                break;
-            }
+    // Set target: amount is relative, target becomes absolute (raising decreases length).
+    // Raising stops on the first pulse at or below the requested length.
+    float requested = position_->pulsesToMeters(current) - amount;
+    int32_t target_pulses = position_->metersToPulsesFloor(requested);
 
-            // Normal raising - monitor slack and pause/resume as needed
-            float current_slack = horizontalSlack_->get();
-            unsigned long now = millis();
-
-            // Check if we should pause due to low slack
-            if (!paused_for_slack_ && current_slack < PAUSE_SLACK_M) {
-                unsigned long time_since_last_action = now - last_slack_action_time_;
-                if (time_since_last_action >= SLACK_COOLDOWN_MS || last_slack_action_time_ == 0) {
-                    // Pause the raise - chain getting too tight
-                    digitalWrite(upRelayPin_, LOW);
-                    paused_for_slack_ = true;
-                    last_slack_action_time_ = now;
-                    ESP_LOGI(__FILE__, "Pausing raise - slack low (%.2fm < %.2fm)", current_slack, PAUSE_SLACK_M);
-                }
-            }
-            // Check if we should resume from pause
-            else if (paused_for_slack_ && current_slack >= RESUME_SLACK_M) {
-                unsigned long time_since_last_action = now - last_slack_action_time_;
-                if (time_since_last_action >= SLACK_COOLDOWN_MS) {
-                    // Resume the raise - enough slack available
-                    digitalWrite(upRelayPin_, HIGH);
-                    paused_for_slack_ = false;
-                    last_slack_action_time_ = now;
-                    ESP_LOGI(__FILE__, "Resuming raise - slack available (%.2fm >= %.2fm)", current_slack, RESUME_SLACK_M);
-                }
-            }
-            // Otherwise maintain current state (raising or paused)
-            else if (!paused_for_slack_) {
-                digitalWrite(upRelayPin_, HIGH); // Keep raising
-            }
-            break;
-        }
+    // Apply limits:
+    if (target_pulses < min_pulses_) { // Min_length_ usually 0 for chain on deck
+        SINK_LOGW(__FILE__, "raiseAnchor: Requested target %.2f m falls below min_length_ %.2f m. Limiting target.",
+                  requested, position_->pulsesToMeters(min_pulses_));
+        target_pulses = min_pulses_;
+    }
+    if (target_pulses > max_pulses_) { // Should not be an issue for raising, but defensive
+        SINK_LOGW(__FILE__, "raiseAnchor: Requested target %.2f m exceeds max_length_ %.2f m. Limiting target.",
+                  requested, position_->pulsesToMeters(max_pulses_));
+        target_pulses = max_pulses_;
+    }
+
+    updateTimeout(amount, upSpeed_); // Use the requested 'amount' for timeout calculation
+
+    // Fresh slack/depth for the task's pause/resume decisions, then start
+    publishControlInputs();
+    if (sendCommand(makeMoveCommand(WindlassCore::Command::Type::RAISE, target_pulses, upSpeed_, upCoastMs_))) {
+        commanded_state_ = ChainState::RAISING;
     }
+
+    SINK_LOGI(__FILE__, "raiseAnchor: raising to absolute target %.2f m (requested %.2f m from current %.2f m)",
+              position_->pulsesToMeters(target_pulses), amount, position_->pulsesToMeters(current));
 }
 
 void ChainController::stop() {
-    if(state_ == ChainState::IDLE) {
-        ESP_LOGD(__FILE__, "stop() called but already IDLE.");
+    if (!isActive()) {
+        SINK_LOGD(__FILE__, "stop() called but already IDLE.");
+        return;
+    }
+    if (sendCommand(makeCommand(WindlassCore::Command::Type::STOP))) {
+        commanded_state_ = ChainState::IDLE;
         return;
     }
+    // The task is not draining its queue - drop the relays from here as a last
+    // resort, behind the back of its RelayDriver
+    SINK_LOGE(__FILE__, "stop: command not delivered, switching relays off directly");
     digitalWrite(upRelayPin_, LOW);
     digitalWrite(downRelayPin_, LOW);
-    calcSpeed(movement_start_time_, start_position_); // Calculate speed for the movement that was stopped
-    state_ = ChainState::IDLE;
-
-    // Reset slack monitoring state
-    paused_for_slack_ = false;
-    last_slack_action_time_ = 0;
-
-    ESP_LOGD(__FILE__, "stop: all relays off, state IDLE.");
 }
 
 bool ChainController::isActive() const {
-    return state_ != ChainState::IDLE;
+    WindlassCore::Snapshot snapshot = core_->snapshot();
+    if (snapshot.acked_seq != next_seq_) {
+        return commanded_state_ != ChainState::IDLE;  // Command still in flight
+    }
+    return snapshot.state != ChainState::IDLE;
 }
 
 
@@ -274,77 +366,124 @@ unsigned long ChainController::getTimeout() const {
 
 void ChainController::loadSpeedsFromPrefs() {
     Preferences prefs;
-    if (prefs.begin("speeds", true)) {  // true = read-only
+    if (prefs.begin(prefs_namespace_, true)) {  // true = read-only
         upSpeed_ = prefs.getFloat("upSpeed", 1000.0);    // default 1000 ms/m
         downSpeed_ = prefs.getFloat("downSpeed", 1000.0);
+        upCoastMs_ = prefs.getFloat("upCoast", 0.0);     // 0 = not learned, stop on target
+        downCoastMs_ = prefs.getFloat("downCoast", 0.0);
         prefs.end();
-        // ESP_LOGI(__FILE__, "Loaded speeds from prefs: upSpeed=%.2f ms/m, downSpeed=%.2f ms/m", upSpeed_, downSpeed_);
+        // SINK_LOGI(__FILE__, "Loaded speeds from prefs: upSpeed=%.2f ms/m, downSpeed=%.2f ms/m", upSpeed_, downSpeed_);
     } else {
         // If begin() fails, we skip loading; keep defaults
-        ESP_LOGW(__FILE__, "Preferences could not be opened for reading speeds.");
+        SINK_LOGW(__FILE__, "Preferences could not be opened for reading speeds.");
+    }
+    markSpeedsSaved();
+}
+
+void ChainController::markSpeedsSaved() {
+    saved_up_speed_ = upSpeed_;
+    saved_down_speed_ = downSpeed_;
+    saved_up_coast_ms_ = upCoastMs_;
+    saved_down_coast_ms_ = downCoastMs_;
+}
+
+void ChainController::saveSpeedsIfChanged() {
+    // Every stop nudges the averages a little; only write NVS when the
+    // stored values are meaningfully out of date.
+    bool speed_changed = fabs(upSpeed_ - saved_up_speed_) > SPEED_SAVE_FRACTION * saved_up_speed_ ||
+                         fabs(downSpeed_ - saved_down_speed_) > SPEED_SAVE_FRACTION * saved_down_speed_;
+    bool coast_changed = fabs(upCoastMs_ - saved_up_coast_ms_) > COAST_SAVE_MS ||
+                         fabs(downCoastMs_ - saved_down_coast_ms_) > COAST_SAVE_MS;
+    if (speed_changed || coast_changed) {
+        saveSpeedsToPrefs();
     }
 }
 
 void ChainController::saveSpeedsToPrefs() {
+    PERF_SCOPE(PerfSite::NVS_SAVE);
     Preferences prefs;
-    if (prefs.begin("speeds", false)) { // false = writable
+    if (prefs.begin(prefs_namespace_, false)) { // false = writable
         prefs.putFloat("upSpeed", upSpeed_);
         prefs.putFloat("downSpeed", downSpeed_);
+        prefs.putFloat("upCoast", upCoastMs_);
+        prefs.putFloat("downCoast", downCoastMs_);
         prefs.end();
-        // ESP_LOGI(__FILE__, "Saved speeds to prefs: upSpeed=%.2f ms/m, downSpeed=%.2f ms/m", upSpeed_, downSpeed_);
+        markSpeedsSaved();
+        CHAIN_TRACE_RECORD(nvs(unit_, prefs_namespace_, upSpeed_, downSpeed_, upCoastMs_, downCoastMs_));
+        // SINK_LOGI(__FILE__, "Saved speeds to prefs: upSpeed=%.2f ms/m, downSpeed=%.2f ms/m", upSpeed_, downSpeed_);
     } else {
-        ESP_LOGE(__FILE__, "Preferences could not be opened for writing speeds.");
+        SINK_LOGE(__FILE__, "Preferences could not be opened for writing speeds.");
     }
 }
 
-void ChainController::calcSpeed(unsigned long start_time, float start_position) {
-    if (start_time == 0) return; // No movement recorded if start_time is 0
-    
-    unsigned long now = millis();
-    float current_position = accumulator_->get();
-    unsigned long duration_ms = now - start_time;
-    float delta_distance = current_position - start_position;
+void ChainController::calcSpeed(ChainState direction, unsigned long duration_ms, int32_t delta_pulses,
+                                float cruise_ms_per_m) {
+    float delta_distance = position_->pulsesToMeters(delta_pulses);
 
     // Only calculate if significant movement (>= 1cm) and a measurable duration (>= 100ms)
     if (fabs(delta_distance) >= 0.01 && duration_ms >= 100) { 
-        float raw_speed_ms_per_m = (float)duration_ms / fabs(delta_distance);
+        // Prefer the cruise speed from pulse timing; the whole-move average
+        // also contains spin-up and is only the fallback for short moves
+        float raw_speed_ms_per_m = (cruise_ms_per_m > 0.0) ? cruise_ms_per_m
+                                                           : (float)duration_ms / fabs(delta_distance);
         float* target_speed_ptr = nullptr;
 
-        if (state_ == ChainState::LOWERING) {
+        if (direction == ChainState::LOWERING) {
             target_speed_ptr = &downSpeed_;
-        } else if (state_ == ChainState::RAISING) {
+        } else if (direction == ChainState::RAISING) {
             target_speed_ptr = &upSpeed_;
         }
 
         if (target_speed_ptr != nullptr) {
             // Exponential smoothing
             *target_speed_ptr = smoothing_factor_ * raw_speed_ms_per_m + (1 - smoothing_factor_) * (*target_speed_ptr);
-            saveSpeedsToPrefs();
-            // ESP_LOGI(__FILE__, "Updated %s speed: %.2f ms/m (raw %.2f ms/m)",
-            //          (state_ == ChainState::LOWERING ? "down" : "up"), *target_speed_ptr, raw_speed_ms_per_m);
+            saveSpeedsIfChanged();
+            // SINK_LOGI(__FILE__, "Updated %s speed: %.2f ms/m (raw %.2f ms/m)",
+            //          (direction == ChainState::LOWERING ? "down" : "up"), *target_speed_ptr, raw_speed_ms_per_m);
         }
     }
-    // Reset for next movement
-    movement_start_time_ = 0; 
-    start_position_ = 0.0;
+}
+
+void ChainController::learnCoast(ChainState direction, float cut_speed_mps, int32_t overrun_pulses) {
+    if (cut_speed_mps <= 0.0 || (direction != ChainState::LOWERING && direction != ChainState::RAISING)) return;
+
+    // Coast time: how long the chain keeps running at the cut speed after the relay opens
+    float sample_ms = position_->pulsesToMeters(overrun_pulses) / cut_speed_mps * 1000.0;
+    sample_ms = fminf(sample_ms, MAX_COAST_MS);
+    float* coast_ms = (direction == ChainState::LOWERING) ? &downCoastMs_ : &upCoastMs_;
+    *coast_ms = COAST_SMOOTHING * sample_ms + (1 - COAST_SMOOTHING) * (*coast_ms);
+    SINK_LOGD(__FILE__, "Coast after %s cut: %ld pulses at %.2f m/s (%.0f ms), learned %.0f ms",
+              toString(direction), (long)overrun_pulses, cut_speed_mps, sample_ms, *coast_ms);
+    saveSpeedsIfChanged();
+}
+
+float ChainController::getChainSpeed() const {
+    return core_->snapshot().speed_mps;
+}
+
+float ChainController::getChainAcceleration() const {
+    return core_->snapshot().accel_mps2;
 }
 
 void ChainController::updateTimeout(float distance, float speed_ms_per_m) {
     // Only calculate timeout if speed is valid and distance is positive
     if (speed_ms_per_m > 0.01 && distance > 0.01) {
         unsigned long expected_time_ms = (unsigned long)(distance * speed_ms_per_m);
-        move_timeout_ = expected_time_ms + 5000; // 5s buffer
-        // ESP_LOGI(__FILE__, "updateTimeout(): Expected duration=%.0f ms (for %.2f m at %.2f ms/m). Actual timeout set to %lu ms.",
+        // Cruise speed is learned from pulse timing and slack pauses don't
+        // count, so a 25% margin plus spin-up is enough; stalls are caught
+        // separately by the windlass task within a second
+        move_timeout_ = expected_time_ms + expected_time_ms / 4 + TIMEOUT_MARGIN_MS;
+        // SINK_LOGI(__FILE__, "updateTimeout(): Expected duration=%.0f ms (for %.2f m at %.2f ms/m). Actual timeout set to %lu ms.",
         //          (float)expected_time_ms, distance, speed_ms_per_m, move_timeout_);
     } else {
         move_timeout_ = 10000; // Default timeout if speed/distance are invalid (e.g., 10 seconds)
-        // ESP_LOGW(__FILE__, "updateTimeout(): Invalid speed (%.2f ms/m) or distance (%.2f m) for timeout calculation. Using default %lu ms.",
+        // SINK_LOGW(__FILE__, "updateTimeout(): Invalid speed (%.2f ms/m) or distance (%.2f m) for timeout calculation. Using default %lu ms.",
         //          speed_ms_per_m, distance, move_timeout_);
     }
 }
 
 float ChainController::getChainLength() const {
-    return accumulator_->get();
+    return position_->meters();
 }
 
 
@@ -352,39 +491,22 @@ float ChainController::getChainLength() const {
 // Horizontal Slack Calculation Methods
 // ============================================================================
 
+// Missing, invalid or stale inputs read as 0.0 - "no data" to the slack math
+
 float ChainController::getCurrentDepth() const {
-    float depth = depthListener_->get(); 
-    // If the listener has never received a value, or returns NaN/Inf/a very small number
-    if (isnan(depth) || isinf(depth) || depth <= 0.01) { // Consider 0.01 as effectively zero for depth
-        // ESP_LOGD(__FILE__, "ChainController: getCurrentDepth() returning 0.0, depthListener has no valid data (%.2f).", depth);
-        return 0.0;
-    }
-    return depth;
+    return depth_->valueOr(0.0);
 }
 
 float ChainController::getCurrentDistance() const {
-    float distance = distanceListener_->get(); // Get the current value
-    // If the listener has never received a value, or returns NaN/Inf/a very small number
-    if (isnan(distance) || isinf(distance) || distance <= 0.01) { // Consider 0.01 as effectively zero for distance
-        return 0.0;
-    }
-    return distance;
+    return distance_->valueOr(0.0);
 }
 
 float ChainController::getTideHeightNow() const {
-    float tideNow = tideHeightNowListener_->get();
-    if (isnan(tideNow) || isinf(tideNow)) {
-        return 0.0;
-    }
-    return tideNow;
+    return tideHeightNow_->valueOr(0.0);
 }
 
 float ChainController::getTideHeightHigh() const {
-    float tideHigh = tideHeightHighListener_->get();
-    if (isnan(tideHigh) || isinf(tideHigh)) {
-        return 0.0;
-    }
-    return tideHigh;
+    return tideHeightHigh_->valueOr(0.0);
 }
 
 float ChainController::getTideAdjustedDepth() const {
@@ -404,10 +526,56 @@ float ChainController::getTideAdjustedDepth() const {
     return fmax(0.0, adjustedDepth);
 }
 
+bool ChainController::updateSlackRate(float chain) {
+    if (!distance_->usable()) {
+        if (!rate_valid_) return false;
+        rate_valid_ = false;
+        slack_rate_mps_ = 0.0;
+        return true;
+    }
+    uint32_t sample = distance_->sampleCount();
+    if (rate_valid_ && sample == rate_sample_) return false;
+
+    // One estimate per distance sample, timed by its arrival
+    unsigned long received_ms = millis() - distance_->ageMs();
+    float needed = chain - horizontalSlack_->get();
+    if (rate_valid_ && received_ms > rate_ms_) {
+        float raw = (rate_needed_m_ - needed) * 1000.0f / (float)(received_ms - rate_ms_);
+        slack_rate_mps_ += SLACK_RATE_SMOOTHING * (raw - slack_rate_mps_);
+    }
+    rate_sample_ = sample;
+    rate_needed_m_ = needed;
+    rate_ms_ = received_ms;
+    rate_valid_ = true;
+    return true;
+}
+
+bool ChainController::slackInputsChanged(const SlackInputs& inputs) const {
+    // Also true while slack_inputs_ is NAN (nothing computed yet)
+    return !(fabsf(inputs.chain - slack_inputs_.chain) <= SLACK_CHAIN_TOLERANCE_M &&
+             fabsf(inputs.depth - slack_inputs_.depth) <= SLACK_DEPTH_TOLERANCE_M &&
+             fabsf(inputs.distance - slack_inputs_.distance) <= SLACK_DISTANCE_TOLERANCE_M &&
+             fabsf(inputs.force - slack_inputs_.force) <= SLACK_FORCE_TOLERANCE_N);
+}
+
 void ChainController::calculateAndPublishHorizontalSlack() {
+    PERF_SCOPE(PerfSite::SLACK);
     float current_chain = getChainLength();
     float current_depth = getCurrentDepth();
     float current_distance = getCurrentDistance();
+    float horizontalForce = estimateHorizontalForce();   // Memoized per wind sample
+
+    // At anchor nothing moves for hours: keep the last result until an input
+    // does (a stale depth or distance reads as 0.0, which is a change too)
+    SlackInputs inputs = {current_chain, current_depth, current_distance, horizontalForce};
+    if (!slackInputsChanged(inputs)) {
+        if (updateSlackRate(current_chain)) {
+            publishControlInputs();
+        }
+        return;
+    }
+    slack_inputs_ = inputs;
+    slack_recomputes_++;
 
     // Account for bow height (2m above water) when calculating effective depth for catenary math
     static constexpr float BOW_HEIGHT_M = 2.0;
@@ -420,7 +588,8 @@ void ChainController::calculateAndPublishHorizontalSlack() {
     // We need chain and depth to calculate slack. Distance can be 0 (boat directly over anchor).
     // Note: Slack = horizontal_distance_taut - current_distance
     // If distance=0, slack = all of the horizontal_distance_taut (chain sag on seabed)
-    if (current_chain <= 0.01 || current_depth <= 0.01 || isnan(current_chain) || isinf(current_chain) || isnan(current_depth) || isinf(current_depth) || isnan(current_distance) || isinf(current_distance)) {
+    // Inputs are validated on arrival (SensorInput); no depth reads as 0.0.
+    if (current_chain <= 0.01 || current_depth <= 0.01) {
         calculated_slack = 0.0;
     }
     // --- Check if anchor has touched bottom ---
@@ -456,22 +625,22 @@ void ChainController::calculateAndPublishHorizontalSlack() {
         if (current_chain < total_depth_from_bow) {
             // Anchor lifted - all deployed chain is slack
             calculated_slack = current_chain;
-            ESP_LOGD(__FILE__, "Anchor lifted off bottom: rode %.2fm < depth %.2fm - slack = rode",
-                     current_chain, total_depth_from_bow);
+            SINK_LOGD(__FILE__, "Anchor lifted off bottom: rode %.2fm < depth %.2fm - slack = rode",
+                      current_chain, total_depth_from_bow);
         }
         // If distance is unavailable (0.0), minimum chain is just vertical drop
         else if (current_distance <= 0.01) {
             calculated_slack = current_chain - total_depth_from_bow;
         } else {
             // Use catenary-aware calculation to find required chain length
-            // Step 1: Estimate horizontal force (same as in computeTargetHorizontalDistance)
-            float horizontalForce = estimateHorizontalForce();
+            // Step 1: Horizontal force (same as in computeTargetHorizontalDistance), estimated above
 
             // Step 2: We need to find chain length that produces current_distance
             // This requires iterative solving OR we can use an approximation.
             // For simplicity, we'll use inverse catenary calculation:
             // Start with straight-line chain needed for this distance
-            float straightLineChainForDistance = sqrt(pow(current_distance, 2) + pow(total_depth_from_bow, 2));
+            float straightLineChainForDistance = sqrtf(current_distance * current_distance +
+                                                      total_depth_from_bow * total_depth_from_bow);
 
             // Apply INVERSE reduction factor to account for catenary
             // If reductionFactor reduces distance, we need MORE chain to reach same distance
@@ -481,8 +650,9 @@ void ChainController::calculateAndPublishHorizontalSlack() {
             // The actual chain needed is more than straight-line due to sag
             // We need chain such that: current_distance = sqrt(chain² - depth²) * reductionFactor
             // Solving: chain = sqrt((current_distance / reductionFactor)² + depth²)
-            float adjustedDistance = current_distance / fmax(0.01, reductionFactor); // Prevent divide by zero
-            float minimum_chain_needed = sqrt(pow(adjustedDistance, 2) + pow(total_depth_from_bow, 2));
+            float adjustedDistance = current_distance / fmaxf(0.01f, reductionFactor); // Prevent divide by zero
+            float minimum_chain_needed = sqrtf(adjustedDistance * adjustedDistance +
+                                               total_depth_from_bow * total_depth_from_bow);
 
             // Slack is excess chain beyond what's needed
             // Positive = chain lying on seabed
@@ -499,10 +669,14 @@ void ChainController::calculateAndPublishHorizontalSlack() {
     // --- Update the ObservableValue (only if significantly changed) ---
     if (fabs(horizontalSlack_->get() - calculated_slack) > 0.01) { // 1cm tolerance
         horizontalSlack_->set(calculated_slack);
-        // ESP_LOGD(__FILE__, "ChainController: Horizontal Slack ObservableValue set to %.2f m", calculated_slack);
+        // SINK_LOGD(__FILE__, "ChainController: Horizontal Slack ObservableValue set to %.2f m", calculated_slack);
     } else {
-        // ESP_LOGD(__FILE__, "ChainController: Horizontal Slack calculated (%.2f m) but no significant change. Not updating observable.", calculated_slack);
+        // SINK_LOGD(__FILE__, "ChainController: Horizontal Slack calculated (%.2f m) but no significant change. Not updating observable.", calculated_slack);
     }
+
+    // Hand slack, depth and slack rate to the windlass task for raise pause/resume
+    updateSlackRate(current_chain);
+    publishControlInputs();
 }
 
 // ============================================================================
@@ -513,17 +687,25 @@ float ChainController::estimateHorizontalForce() {
     // Estimate horizontal force on the boat from wind
     // This combines wind drag force with a baseline for current/resistance
 
-    float windSpeed = windSpeedListener_->get(); // m/s from Signal K
+    // Same wind sample (and freshness) as last time - same force
+    bool wind_usable = windSpeed_->usable();
+    if (force_valid_ && windSpeed_->sampleCount() == force_sample_ && wind_usable == force_wind_usable_) {
+        return force_;
+    }
 
-    // Validate wind speed data - if invalid, use 10 knots as default
-    if (isnan(windSpeed) || isinf(windSpeed) || windSpeed < 0.0) {
+    // Missing, invalid or stale wind - use 10 knots as default
+    float windSpeed;
+    if (wind_usable) {
+        windSpeed = windSpeed_->value(); // m/s from Signal K
+    } else {
         windSpeed = 10.0 / 1.944; // 10 knots converted to m/s (~5.14 m/s)
-        ESP_LOGW(__FILE__, "Invalid wind speed data. Using default: 10 knots (%.2f m/s)", windSpeed);
+        SINK_LOGW_EVERY(LOG_INTERVAL_MS, __FILE__, "Invalid wind speed data (%s). Using default: 10 knots (%.2f m/s)",
+                        toString(windSpeed_->quality()), windSpeed);
     }
 
     // Wind force formula: F = 0.5 * ρ * Cd * A * v²
     // where: ρ = air density, Cd = drag coefficient, A = windage area, v = wind speed
-    float windForce = 0.5 * AIR_DENSITY * DRAG_COEFFICIENT * BOAT_WINDAGE_AREA_M2 * pow(windSpeed, 2);
+    float windForce = 0.5f * AIR_DENSITY * DRAG_COEFFICIENT * BOAT_WINDAGE_AREA_M2 * windSpeed * windSpeed;
 
     // Add baseline force for current and hull resistance (typically 20-50N)
     float baselineForce = 30.0;
@@ -531,66 +713,17 @@ float ChainController::estimateHorizontalForce() {
     float totalForce = windForce + baselineForce;
 
     // Clamp to reasonable bounds (min 30N, max 2000N for safety)
-    totalForce = fmax(30.0, fmin(2000.0, totalForce));
+    totalForce = fmaxf(30.0f, fminf(2000.0f, totalForce));
 
+    force_ = totalForce;
+    force_sample_ = windSpeed_->sampleCount();
+    force_wind_usable_ = wind_usable;
+    force_valid_ = true;
     return totalForce;
 }
 
 float ChainController::computeCatenaryReductionFactor(float chainLength, float anchorDepth, float horizontalForce) {
-    // This function calculates the reduction factor due to chain catenary
-    // Based on catenary curve physics with chain weight and horizontal tension
-    //
-    // KEY PHYSICS:
-    // - LOW force (light wind) → MORE sag → LESS horizontal distance → LOWER reduction factor
-    // - HIGH force (strong wind) → LESS sag → MORE horizontal distance → HIGHER reduction factor
-
-    // Chain weight per meter in water (N/m)
-    float w = CHAIN_WEIGHT_PER_METER_KG * GRAVITY;
-
-    // If horizontal force is very small, there's significant sag
-    if (horizontalForce < 50.0) {
-        // Light wind/current: LOTS of catenary sag (low tension)
-        // Lower reduction factors = more sag = less horizontal distance
-        float scopeRatio = chainLength / fmax(anchorDepth, 1.0);
-        if (scopeRatio < 3.0) {
-            return 0.90;  // Significant sag even on short scope
-        } else if (scopeRatio < 5.0) {
-            return 0.85;  // More sag on typical scope
-        } else {
-            return 0.80;  // Lots of sag on long scope
-        }
-    }
-
-    // Calculate catenary parameter: a = H/w
-    // where H is horizontal tension at anchor, w is weight per unit length
-    float a = horizontalForce / w;
-
-    // For a catenary with horizontal force H and vertical drop of anchorDepth,
-    // the relationship is complex. Using approximation for moderate sag:
-    // horizontal_distance ≈ sqrt(chainLength² - anchorDepth²) - (w * chainLength²)/(8*H)
-    //
-    // The sag reduction term (w * L²)/(8*H) gets SMALLER as H increases (tighter chain)
-
-    // Calculate theoretical straight-line horizontal distance
-    float straightLineDistance = sqrt(pow(chainLength, 2) - pow(anchorDepth, 2));
-
-    // Calculate catenary sag reduction (horizontal distance lost to sag)
-    // This gets SMALLER with higher force (less sag when chain is pulled tight)
-    float catenarySagReduction = (w * pow(chainLength, 2)) / (8.0 * horizontalForce);
-
-    // Actual horizontal distance accounting for catenary
-    float actualHorizontalDistance = straightLineDistance - catenarySagReduction;
-
-    // Reduction factor is the ratio
-    // Higher force → smaller sag reduction → higher actual distance → higher factor
-    float reductionFactor = actualHorizontalDistance / straightLineDistance;
-
-    // Clamp between reasonable bounds (0.80 to 0.99)
-    reductionFactor = fmax(0.80, fmin(0.99, reductionFactor));
-
-    // ESP_LOGD(__FILE__, "Catenary calc: chainLen=%.2f, depth=%.2f, force=%.0fN, a=%.2f, sagReduction=%.2f, factor=%.3f",
-    //          chainLength, anchorDepth, horizontalForce, a, catenarySagReduction, reductionFactor);
-
-    return reductionFactor;
+    // h(d/L) read from the table with linear interpolation, chain length and
+    // force applied exactly. See CatenaryTable::exactReductionFactor for the physics.
+    return catenaryTable_.reductionFactor(chainLength, anchorDepth, horizontalForce);
 }
-
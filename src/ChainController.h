@@ -3,38 +3,94 @@
 #define CHAINCONTROLLER_H
 
 #include <Arduino.h>
-#include "sensesp/transforms/linear.h"
 #include "sensesp_app.h"
 #include "sensesp/signalk/signalk_value_listener.h"
+#include "CatenaryTable.h"
+#include "ChainPosition.h"
+#include "ChainTypes.h"
+#include "SensorInput.h"
+#include "WindlassCore.h"
 
-enum class ChainState {
-    IDLE,
-    LOWERING,
-    RAISING
-};
-
+/**
+ * Event-loop side of the windlass controller.
+ *
+ * Motion itself (relays, pulse accumulator, limit stops) runs on the
+ * WindlassCore task. lowerAnchor/raiseAnchor/stop compute targets here and
+ * post commands to it; sync() runs on the event loop, mirrors the task's
+ * pulse count into the ChainPosition producer and handles finished moves
+ * (speed learning, logging).
+ */
 class ChainController {
 public:
+    /**
+     * Signal K inputs that are the same for every windlass on the board:
+     * depth, wind and tide. create() makes one set of listeners, and the
+     * controllers of all units share it (see WindlassUnit.h). The distance
+     * to the anchor belongs to each windlass and is passed on its own.
+     */
+    struct Environment {
+        SensorInput* depth;
+        SensorInput* windSpeed;
+        SensorInput* tideHeightNow;
+        SensorInput* tideHeightHigh;
+
+        static Environment create();
+    };
+
+    // <sk_prefix>.distanceFromBow, configured at <config_prefix>/distance/sk
+    static SensorInput* createDistanceInput(const String& sk_prefix = "navigation.anchor",
+                                            const String& config_prefix = "");
+
+    // A single windlass: unit 0 with listeners of its own
     ChainController(
         float min_length,
         float max_length,
         float stop_before_max,
-        sensesp::Integrator<float, float>* acc,
+        ChainPosition* position,
         int downRelayPin,
         int upRelayPin
     );
+    // One of several windlasses on the board. The unit index selects the
+    // RTC snapshot slots and the NVS namespace of the learned speeds.
+    ChainController(
+        float min_length,
+        float max_length,
+        float stop_before_max,
+        ChainPosition* position,
+        int downRelayPin,
+        int upRelayPin,
+        const Environment& environment,
+        SensorInput* distance,
+        uint8_t unit
+    );
+    uint8_t unit() const { return unit_; }
     void lowerAnchor(float amount);
     void raiseAnchor(float amount);
 
     void stop();
     bool isActive() const;
-    void control(float current_pos);
-    void calcSpeed(unsigned long start_time, float start_position);
+    void calcSpeed(ChainState direction, unsigned long duration_ms, int32_t delta_pulses,
+                   float cruise_ms_per_m = 0.0);
     void loadSpeedsFromPrefs();
     void saveSpeedsToPrefs();
+    // Start the windlass task. counter may be null when pulses arrive via addPulses().
+    bool begin(PulseCounter* counter = nullptr, int up_sense_gpio = -1, int down_sense_gpio = -1);
+    void addPulses(int32_t delta);     // Pulses counted on the event loop, not by a PulseCounter
+    void resetPosition();
+    void enableCounting();             // Hall input settled (see InputReadiness)
+    void setAnchorWatch(bool watch);   // Slow the idle windlass task (see PowerManager)
+    void setRelayDeadTime(unsigned long dead_time_ms) { core_->setRelayDeadTime(dead_time_ms); }  // Before begin()
+    void setSlackControl(WindlassCore::SlackControl control) { slack_control_ = control; }  // From the next raise
+    WindlassCore::SlackControl getSlackControl() const { return slack_control_; }
+    float getSlackRate() const { return slack_rate_mps_; }   // Slack the boat adds per second, windlass stopped (m/s)
+    void sync();                       // Mirror task state to the event loop (runs every SYNC_INTERVAL_MS)
+
     unsigned long getTimeout() const;
     float getChainLength() const;
     float getDownSpeed() const { return downSpeed_; }
+    float getChainSpeed() const;         // Live, from pulse timestamps (m/s, + lowering)
+    float getChainAcceleration() const;  // m/s^2
+    RelayDriver::Stats getRelayStats() const { return core_->snapshot().relays; }
 
     void setDepthBelowSurface(float depth);
     void setDistanceBowToAnchor(float distance);
@@ -43,7 +99,8 @@ public:
     float getCurrentDepth() const; 
     float getCurrentDistance() const;
 
-    void calculateAndPublishHorizontalSlack();
+    void calculateAndPublishHorizontalSlack();   // No-op unless an input moved past its tolerance
+    unsigned long slackRecomputeCount() const { return slack_recomputes_; }
 
     // Method to allow the calculation logic (in main.cpp) to update the slack value
     
@@ -53,10 +110,17 @@ public:
         return horizontalSlack_;
     }
 
-    sensesp::SKValueListener<float>* getDepthListener() const { return depthListener_; }
-    sensesp::SKValueListener<float>* getDistanceListener() const { return distanceListener_; }
-    sensesp::SKValueListener<float>* getTideHeightNowListener() const { return tideHeightNowListener_; }
-    sensesp::SKValueListener<float>* getTideHeightHighListener() const { return tideHeightHighListener_; }
+    ChainPosition* getPosition() const { return position_; }
+    sensesp::SKValueListener<float>* getDepthListener() const { return depth_->listener(); }
+    sensesp::SKValueListener<float>* getDistanceListener() const { return distance_->listener(); }
+    sensesp::SKValueListener<float>* getWindSpeedListener() const { return windSpeed_->listener(); }
+    sensesp::SKValueListener<float>* getTideHeightNowListener() const { return tideHeightNow_->listener(); }
+    sensesp::SKValueListener<float>* getTideHeightHighListener() const { return tideHeightHigh_->listener(); }
+
+    // Validated inputs: usable() = valid and no older than its max age
+    const SensorInput* getDepthInput() const { return depth_; }
+    const SensorInput* getDistanceInput() const { return distance_; }
+    const SensorInput* getWindSpeedInput() const { return windSpeed_; }
 
     // Tide-related getters
     float getTideHeightNow() const;
@@ -64,10 +128,13 @@ public:
     float getTideAdjustedDepth() const;
 
     // Public method to check if controller is actively controlling the windlass
-    bool isActivelyControlling() const { return state_ != ChainState::IDLE; }
+    bool isActivelyControlling() const { return isActive(); }
 
     // Public catenary physics method for use by DeploymentManager
     float computeTargetHorizontalDistance(float chainLength, float depth);
+    // ... for a given horizontal force instead of the current wind estimate
+    float computeTargetHorizontalDistance(float chainLength, float depth, float horizontalForce);
+    float estimateHorizontalForce();  // Estimate force from wind/current (N), memoized per wind sample
 
     // Slack monitoring constants
     static constexpr float PAUSE_SLACK_M = 0.2;                      // Pause raising when slack drops below this
@@ -75,43 +142,114 @@ public:
     static constexpr unsigned long SLACK_COOLDOWN_MS = 3000;         // 3s cooldown between pause/resume actions
     static constexpr float BOW_HEIGHT_M = 2.0;                       // Height from bow roller to water surface
     static constexpr float FINAL_PULL_THRESHOLD_M = 3.0;             // When rode < depth + bow + threshold, skip slack checks
+    static constexpr unsigned long SYNC_INTERVAL_MS = 10;            // Event-loop mirror of the windlass task
+    static constexpr unsigned long TIMEOUT_MARGIN_MS = 2000;         // Added to expected time (+25%) for the movement timeout
+    static constexpr uint32_t LOG_INTERVAL_MS = 10000;               // Rate limit for log lines that can repeat at 10 Hz
+    // Slack update period (main.cpp). 10 Hz keeps pause/resume tight while
+    // raising; it relies on the rate-limited warnings above, the publish
+    // scheduler and the skip when no input moved (SLACK_*_TOLERANCE).
+    static constexpr unsigned long SLACK_UPDATE_MS = 100;
+
+    // Slack is recomputed only when an input moves by more than this
+    static constexpr float SLACK_CHAIN_TOLERANCE_M = 0.01;           // Below one gypsy pulse - every pulse counts
+    static constexpr float SLACK_DEPTH_TOLERANCE_M = 0.02;
+    static constexpr float SLACK_DISTANCE_TOLERANCE_M = 0.02;
+    static constexpr float SLACK_FORCE_TOLERANCE_N = 10.0;           // ~0.5% of the force range
+    static constexpr float SLACK_RATE_SMOOTHING = 0.3;               // EMA weight of each distance sample
+
+    // Input freshness - a value older than this is treated as missing
+    static constexpr unsigned long DEPTH_MAX_AGE_MS = 10000;         // Sounders report at ~1 Hz
+    static constexpr unsigned long DISTANCE_MAX_AGE_MS = 10000;
+    static constexpr unsigned long WIND_MAX_AGE_MS = 120000;         // Only scales the catenary estimate
+    static constexpr unsigned long TIDE_NOW_MAX_AGE_MS = 3600000UL;
+    static constexpr unsigned long TIDE_HIGH_MAX_AGE_MS = 86400000UL;
+
+    // Speed/coast learning
+    static constexpr float SPEED_SAVE_FRACTION = 0.05;               // Persist speeds when they move by more than 5%
+    static constexpr float COAST_SAVE_MS = 50.0;                     // ... or a coast by more than 50 ms
+    static constexpr float COAST_SMOOTHING = 0.3;
+    static constexpr float MAX_COAST_MS = 2000.0;
 
 private:
-    float min_length_;
-    float max_length_;
-    float stop_before_max_;
-    sensesp::Integrator<float, float>* accumulator_;
+    // Limits and target are whole gypsy pulses - meters only at the API edges
+    ChainPosition* position_;
+    int32_t min_pulses_;
+    int32_t max_pulses_;
+    int32_t stop_before_max_pulses_;
     int downRelayPin_;
     int upRelayPin_;
-    float target_;
-    ChainState state_;
-    unsigned long movement_start_time_;
-    float start_position_= 0.0;
-    float move_speed_ms_per_m_;
+    uint8_t unit_;
+    char prefs_namespace_[12];   // Learned speeds: "speeds", "speeds2", ...
     unsigned long move_timeout_;
 
+    // Real-time side and the commands in flight to it
+    WindlassCore* core_;
+    uint32_t next_seq_ = 0;
+    ChainState commanded_state_ = ChainState::IDLE;  // Until the task acks next_seq_
+    uint32_t reported_dropped_events_ = 0;
+
+    static WindlassCore::Command makeCommand(WindlassCore::Command::Type type, int32_t pulses = 0);
+    WindlassCore::Command makeMoveCommand(WindlassCore::Command::Type type, int32_t target_pulses,
+                                          float speed_ms_per_m, float coast_ms) const;
+    bool sendCommand(WindlassCore::Command command);
+    unsigned long expectedPulseInterval(float speed_ms_per_m) const;
+    void learnCoast(ChainState direction, float cut_speed_mps, int32_t overrun_pulses);
+    void saveSpeedsIfChanged();
+    void markSpeedsSaved();
+    void handleEvent(const WindlassCore::Event& event);
+    void publishControlInputs();
     void updateTimeout(float, float);
 
     float upSpeed_ = 1000.0;   // default 1 sec per meter
     float downSpeed_ = 1000.0; // default 1 sec per meter
+    float upCoastMs_ = 0.0;    // Learned coast after the relay opens (0 = not learned)
+    float downCoastMs_ = 0.0;
+    float saved_up_speed_ = 1000.0;    // Values last written to NVS
+    float saved_down_speed_ = 1000.0;
+    float saved_up_coast_ms_ = 0.0;
+    float saved_down_coast_ms_ = 0.0;
     const float smoothing_factor_ = 0.2;
 
-    // Slack monitoring state
-    bool paused_for_slack_ = false;
-    unsigned long last_slack_action_time_ = 0;
-
-    sensesp::SKValueListener<float>* depthListener_;
-    sensesp::SKValueListener<float>* distanceListener_;
-    sensesp::SKValueListener<float>* windSpeedListener_;  // Wind speed for catenary calculations
-    sensesp::SKValueListener<float>* tideHeightNowListener_;   // Current tide height
-    sensesp::SKValueListener<float>* tideHeightHighListener_;  // High tide height
+    SensorInput* depth_;
+    SensorInput* distance_;
+    SensorInput* windSpeed_;        // Wind speed for catenary calculations
+    SensorInput* tideHeightNow_;    // Current tide height
+    SensorInput* tideHeightHigh_;   // High tide height
     sensesp::ObservableValue<float>* horizontalSlack_; // The ObservableValue for the calculated slack
 
+    // Inputs of the last slack computation; NAN until the first one
+    struct SlackInputs {
+        float chain;
+        float depth;
+        float distance;
+        float force;
+    };
+    SlackInputs slack_inputs_ = {NAN, NAN, NAN, NAN};
+    unsigned long slack_recomputes_ = 0;
+    bool slackInputsChanged(const SlackInputs& inputs) const;
+
+    // Closing speed expressed as slack: how fast the chain needed to reach
+    // the boat (rode - slack) shrinks between distance samples. Going
+    // through the slack model folds in the catenary, so the windlass task
+    // can add it straight to the slack for adaptive control.
+    WindlassCore::SlackControl slack_control_ = WindlassCore::SlackControl::HYSTERESIS;
+    float slack_rate_mps_ = 0.0;
+    float rate_needed_m_ = 0.0;     // Chain needed at the last distance sample
+    unsigned long rate_ms_ = 0;     // ... and its arrival
+    uint32_t rate_sample_ = 0;
+    bool rate_valid_ = false;
+    bool updateSlackRate(float chain);   // True if the estimate changed
+
+    // estimateHorizontalForce() result for the wind sample it was computed from
+    float force_ = 0.0;
+    uint32_t force_sample_ = 0;
+    bool force_wind_usable_ = false;
+    bool force_valid_ = false;
+
     void updateHorizontalSlack(float slack);
 
     // Catenary physics calculation methods (private helpers)
     float computeCatenaryReductionFactor(float chainLength, float anchorDepth, float horizontalForce);
-    float estimateHorizontalForce();  // Estimate force from wind/current
 
     // Chain and boat physical constants
     static constexpr float CHAIN_WEIGHT_PER_METER_KG = 2.2;  // kg/m in water (adjusted for buoyancy)
@@ -120,6 +258,8 @@ private:
     static constexpr float AIR_DENSITY = 1.225;               // kg/m³ at sea level
     static constexpr float DRAG_COEFFICIENT = 1.2;            // typical for boat hull + rigging
 
+    CatenaryTable catenaryTable_;                             // Reduction factors, built at boot
+
 };
 
 #endif // CHAINCONTROLLER_H
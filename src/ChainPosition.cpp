@@ -0,0 +1,49 @@
+#include "ChainPosition.h"
+#include <cmath>
+
+ChainPosition::ChainPosition(float meters_per_pulse, float max_length, int32_t initial_pulses)
+  : meters_per_pulse_(meters_per_pulse > 0.0 ? meters_per_pulse : 0.25),
+    max_pulses_(0),
+    pulses_(0)
+{
+    if (meters_per_pulse <= 0.0) {
+        ESP_LOGE(__FILE__, "ChainPosition: invalid gypsy circumference %.3f m, using %.3f m",
+                 meters_per_pulse, meters_per_pulse_);
+    }
+    max_pulses_ = metersToPulsesFloor(max_length);
+    pulses_ = clamp(initial_pulses);
+    output_ = meters();
+}
+
+int32_t ChainPosition::clamp(int32_t pulses) const {
+    if (pulses < 0) return 0;
+    if (pulses > max_pulses_) return max_pulses_;
+    return pulses;
+}
+
+int32_t ChainPosition::addPulses(int32_t delta) {
+    int32_t next = clamp(pulses_ + delta);
+    int32_t applied = next - pulses_;
+    if (applied != 0) {
+        pulses_ = next;
+        emit(meters());
+    }
+    return applied;
+}
+
+void ChainPosition::setPulses(int32_t pulses) {
+    pulses_ = clamp(pulses);
+    emit(meters());
+}
+
+int32_t ChainPosition::metersToPulsesFloor(float meters) const {
+    return (int32_t)floor(meters / meters_per_pulse_ + PULSE_EPSILON);
+}
+
+int32_t ChainPosition::metersToPulsesCeil(float meters) const {
+    return (int32_t)ceil(meters / meters_per_pulse_ - PULSE_EPSILON);
+}
+
+int32_t ChainPosition::metersToPulsesNearest(float meters) const {
+    return (int32_t)lround(meters / meters_per_pulse_);
+}
@@ -0,0 +1,47 @@
+// ChainPosition.h
+#ifndef CHAINPOSITION_H
+#define CHAINPOSITION_H
+
+#include <Arduino.h>
+#include "sensesp/system/valueproducer.h"
+
+/**
+ * Canonical chain position as a signed 32-bit gypsy pulse count.
+ *
+ * All limit checks and targets work on whole pulses, so thousands of up/down
+ * cycles cannot drift the way an integrating float does. Meters exist only at
+ * the edges: the producer emits pulses * meters_per_pulse for Signal K and
+ * the slack/catenary math, and metersToPulses*() converts requested lengths.
+ * Because the pulse count is what gets persisted, changing the gypsy
+ * circumference re-scales the reported length instead of corrupting it.
+ */
+class ChainPosition : public sensesp::ValueProducer<float> {
+public:
+    ChainPosition(float meters_per_pulse, float max_length, int32_t initial_pulses = 0);
+
+    int32_t pulses() const { return pulses_; }
+    int32_t maxPulses() const { return max_pulses_; }
+    float meters() const { return pulsesToMeters(pulses_); }
+    float metersPerPulse() const { return meters_per_pulse_; }
+
+    int32_t addPulses(int32_t delta);  // Clamped to [0, maxPulses()], returns pulses actually applied
+    void setPulses(int32_t pulses);
+    void reset() { setPulses(0); }
+
+    float pulsesToMeters(int32_t pulses) const { return pulses * meters_per_pulse_; }
+    int32_t metersToPulsesFloor(float meters) const;  // Largest count with length <= meters
+    int32_t metersToPulsesCeil(float meters) const;   // Smallest count with length >= meters
+    int32_t metersToPulsesNearest(float meters) const;
+
+private:
+    float meters_per_pulse_;
+    int32_t max_pulses_;
+    int32_t pulses_;
+
+    int32_t clamp(int32_t pulses) const;
+
+    // Float slack when converting lengths that are exact multiples of the circumference
+    static constexpr float PULSE_EPSILON = 0.0001;
+};
+
+#endif // CHAINPOSITION_H
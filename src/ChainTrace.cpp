@@ -0,0 +1,285 @@
+#include "ChainTrace.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "LogSink.h"
+
+namespace {
+
+const char TAG[] = "Trace";
+const char MARKER[] = ") Trace: ";
+
+// Next space-separated token of s into out; returns the rest, or null if there is none
+const char* token(const char* s, char* out, size_t len) {
+    while (*s == ' ') s++;
+    if (*s == '\0' || *s == '\n' || *s == '\r') return nullptr;
+    size_t n = 0;
+    while (*s != '\0' && *s != ' ' && *s != '\n' && *s != '\r') {
+        if (n + 1 < len) out[n++] = *s;
+        s++;
+    }
+    out[n] = '\0';
+    return s;
+}
+
+bool parseInts(const char* s, int32_t* ints, int count) {
+    char word[24];
+    for (int i = 0; i < count; i++) {
+        if (s == nullptr || (s = token(s, word, sizeof(word))) == nullptr) return false;
+        char* end;
+        ints[i] = (int32_t)strtol(word, &end, 10);
+        if (*end != '\0') return false;
+    }
+    return true;
+}
+
+bool parseFloats(const char* s, float* values, int count) {
+    char word[24];
+    for (int i = 0; i < count; i++) {
+        if (s == nullptr || (s = token(s, word, sizeof(word))) == nullptr) return false;
+        char* end;
+        values[i] = strtof(word, &end);   // Takes "nan" and "inf" too
+        if (*end != '\0') return false;
+    }
+    return true;
+}
+
+// Skips n tokens; null if there are fewer
+const char* skip(const char* s, int n) {
+    char word[24];
+    for (int i = 0; i < n && s != nullptr; i++) s = token(s, word, sizeof(word));
+    return s;
+}
+
+}  // namespace
+
+ChainTrace& ChainTrace::global() {
+    static ChainTrace trace;
+    return trace;
+}
+
+ChainTrace::ChainTrace() {
+    memset(sense_, -1, sizeof(sense_));
+}
+
+ChainTrace::Record ChainTrace::make(Type type, uint8_t unit) const {
+    Record record = {};
+    record.ms = millis();
+    record.type = type;
+    record.unit = unit;
+    return record;
+}
+
+void ChainTrace::begin(uint8_t unit, int32_t pulses, int32_t min_pulses, int32_t max_pulses,
+                       int32_t stop_before_max_pulses, float meters_per_pulse, unsigned long dead_time_ms) {
+    if (unit < UNITS) {
+        sense_[unit] = -1;
+        relay_[unit] = RelayDriver::Output::OFF;
+    }
+    SINK_LOGI(TAG, "u%u begin %ld %ld %ld %ld %.9g %lu", (unsigned)unit, (long)pulses, (long)min_pulses,
+              (long)max_pulses, (long)stop_before_max_pulses, meters_per_pulse, dead_time_ms);
+    Record r = make(Type::BEGIN, unit);
+    r.ints[0] = pulses;
+    r.ints[1] = min_pulses;
+    r.ints[2] = max_pulses;
+    r.ints[3] = stop_before_max_pulses;
+    r.values[0] = meters_per_pulse;
+    r.values[1] = dead_time_ms;
+    record(r);
+}
+
+void ChainTrace::speeds(uint8_t unit, float up_speed, float down_speed, float up_coast_ms, float down_coast_ms) {
+    SINK_LOGI(TAG, "u%u speeds %.9g %.9g %.9g %.9g", (unsigned)unit, up_speed, down_speed, up_coast_ms, down_coast_ms);
+    Record r = make(Type::SPEEDS, unit);
+    r.values[0] = up_speed;
+    r.values[1] = down_speed;
+    r.values[2] = up_coast_ms;
+    r.values[3] = down_coast_ms;
+    record(r);
+}
+
+void ChainTrace::input(const char* sk_path, float value) {
+    SINK_LOGI(TAG, "in %s %.9g", sk_path, value);
+    Record r = make(Type::VALUE, 0);
+    strncpy(r.text, sk_path, TEXT_BYTES - 1);
+    r.values[0] = value;
+    record(r);
+}
+
+void ChainTrace::command(uint8_t unit, const char* text) {
+    SINK_LOGI(TAG, "u%u cmd %s", (unsigned)unit, text);
+    Record r = make(Type::COMMAND, unit);
+    strncpy(r.text, text, TEXT_BYTES - 1);
+    record(r);
+}
+
+void ChainTrace::sense(uint8_t unit, bool up_active, bool down_active) {
+    int8_t state = (up_active ? 1 : 0) | (down_active ? 2 : 0);
+    if (unit >= UNITS || sense_[unit] == state) return;
+    sense_[unit] = state;
+    SINK_LOGI(TAG, "u%u sense %d %d", (unsigned)unit, up_active ? 1 : 0, down_active ? 1 : 0);
+    Record r = make(Type::SENSE, unit);
+    r.ints[0] = up_active ? 1 : 0;
+    r.ints[1] = down_active ? 1 : 0;
+    record(r);
+}
+
+void ChainTrace::pulses(uint8_t unit, int32_t delta) {
+    if (delta == 0) return;
+    SINK_LOGI(TAG, "u%u pulses %ld", (unsigned)unit, (long)delta);
+    Record r = make(Type::PULSES, unit);
+    r.ints[0] = delta;
+    record(r);
+}
+
+void ChainTrace::relay(uint8_t unit, RelayDriver::Output output) {
+    if (unit >= UNITS || relay_[unit] == output) return;
+    relay_[unit] = output;
+    SINK_LOGI(TAG, "u%u relay %s", (unsigned)unit, toString(output));
+    Record r = make(Type::RELAY, unit);
+    strncpy(r.text, toString(output), TEXT_BYTES - 1);
+    record(r);
+}
+
+void ChainTrace::stage(uint8_t unit, int from, int to) {
+    SINK_LOGI(TAG, "u%u stage %d %d", (unsigned)unit, from, to);
+    Record r = make(Type::STAGE, unit);
+    r.ints[0] = from;
+    r.ints[1] = to;
+    record(r);
+}
+
+void ChainTrace::nvs(uint8_t unit, const char* name, float up_speed, float down_speed,
+                     float up_coast_ms, float down_coast_ms) {
+    SINK_LOGI(TAG, "u%u nvs %s %.9g %.9g %.9g %.9g", (unsigned)unit, name, up_speed, down_speed,
+              up_coast_ms, down_coast_ms);
+    Record r = make(Type::NVS, unit);
+    strncpy(r.text, name, TEXT_BYTES - 1);
+    r.values[0] = up_speed;
+    r.values[1] = down_speed;
+    r.values[2] = up_coast_ms;
+    r.values[3] = down_coast_ms;
+    record(r);
+}
+
+bool ChainTrace::parse(const char* line, Record* record) {
+    const char* marker = strstr(line, MARKER);
+    if (marker == nullptr) return false;
+    const char* open = marker;
+    while (open > line && open[-1] >= '0' && open[-1] <= '9') open--;
+    if (open == marker || open == line || open[-1] != '(') return false;
+
+    Record r = {};
+    r.ms = (uint32_t)strtoul(open, nullptr, 10);
+    const char* s = marker + strlen(MARKER);
+    char word[TEXT_BYTES];
+
+    s = token(s, word, sizeof(word));
+    if (s == nullptr) return false;
+    if (strcmp(word, "in") == 0) {
+        r.type = Type::VALUE;
+        s = token(s, r.text, sizeof(r.text));
+        if (s == nullptr || !parseFloats(s, r.values, 1)) return false;
+        *record = r;
+        return true;
+    }
+    if (word[0] != 'u' || word[1] < '0' || word[1] > '9') return false;
+    r.unit = (uint8_t)atoi(word + 1);
+
+    const char* args = token(s, word, sizeof(word));
+    if (args == nullptr) return false;
+    bool ok = false;
+    if (strcmp(word, "begin") == 0) {
+        r.type = Type::BEGIN;
+        ok = parseInts(args, r.ints, 4) && parseFloats(skip(args, 4), r.values, 2);
+    } else if (strcmp(word, "speeds") == 0) {
+        r.type = Type::SPEEDS;
+        ok = parseFloats(args, r.values, 4);
+    } else if (strcmp(word, "cmd") == 0) {
+        r.type = Type::COMMAND;
+        while (*args == ' ') args++;
+        size_t n = strcspn(args, "\r\n");   // The rest of the line, spaces and all
+        if (n >= TEXT_BYTES) n = TEXT_BYTES - 1;
+        memcpy(r.text, args, n);
+        ok = true;
+    } else if (strcmp(word, "sense") == 0) {
+        r.type = Type::SENSE;
+        ok = parseInts(args, r.ints, 2);
+    } else if (strcmp(word, "pulses") == 0) {
+        r.type = Type::PULSES;
+        ok = parseInts(args, r.ints, 1);
+    } else if (strcmp(word, "relay") == 0) {
+        RelayDriver::Output output;
+        r.type = Type::RELAY;
+        ok = token(args, r.text, sizeof(r.text)) != nullptr && parseOutput(r.text, &output);
+    } else if (strcmp(word, "stage") == 0) {
+        r.type = Type::STAGE;
+        ok = parseInts(args, r.ints, 2);
+    } else if (strcmp(word, "nvs") == 0) {
+        r.type = Type::NVS;
+        args = token(args, r.text, sizeof(r.text));
+        ok = args != nullptr && parseFloats(args, r.values, 4);
+    }
+    if (ok) *record = r;
+    return ok;
+}
+
+size_t ChainTrace::format(const Record& r, char* out, size_t len) {
+    int n = 0;
+    switch (r.type) {
+        case Type::BEGIN:
+            n = snprintf(out, len, "u%u begin %ld %ld %ld %ld %.9g %.9g", (unsigned)r.unit, (long)r.ints[0],
+                         (long)r.ints[1], (long)r.ints[2], (long)r.ints[3], r.values[0], r.values[1]);
+            break;
+        case Type::SPEEDS:
+            n = snprintf(out, len, "u%u speeds %.9g %.9g %.9g %.9g", (unsigned)r.unit,
+                         r.values[0], r.values[1], r.values[2], r.values[3]);
+            break;
+        case Type::VALUE:
+            n = snprintf(out, len, "in %s %.9g", r.text, r.values[0]);
+            break;
+        case Type::COMMAND:
+            n = snprintf(out, len, "u%u cmd %s", (unsigned)r.unit, r.text);
+            break;
+        case Type::SENSE:
+            n = snprintf(out, len, "u%u sense %ld %ld", (unsigned)r.unit, (long)r.ints[0], (long)r.ints[1]);
+            break;
+        case Type::PULSES:
+            n = snprintf(out, len, "u%u pulses %ld", (unsigned)r.unit, (long)r.ints[0]);
+            break;
+        case Type::RELAY:
+            n = snprintf(out, len, "u%u relay %s", (unsigned)r.unit, r.text);
+            break;
+        case Type::STAGE:
+            n = snprintf(out, len, "u%u stage %ld %ld", (unsigned)r.unit, (long)r.ints[0], (long)r.ints[1]);
+            break;
+        case Type::NVS:
+            n = snprintf(out, len, "u%u nvs %s %.9g %.9g %.9g %.9g", (unsigned)r.unit, r.text,
+                         r.values[0], r.values[1], r.values[2], r.values[3]);
+            break;
+    }
+    if (n < 0) return 0;
+    return (size_t)n < len ? (size_t)n : len - 1;
+}
+
+const char* ChainTrace::toString(RelayDriver::Output output) {
+    switch (output) {
+        case RelayDriver::Output::OFF:  return "off";
+        case RelayDriver::Output::DOWN: return "down";
+        case RelayDriver::Output::UP:   return "up";
+    }
+    return "?";
+}
+
+bool ChainTrace::parseOutput(const char* text, RelayDriver::Output* output) {
+    if (strcmp(text, "off") == 0) {
+        *output = RelayDriver::Output::OFF;
+    } else if (strcmp(text, "down") == 0) {
+        *output = RelayDriver::Output::DOWN;
+    } else if (strcmp(text, "up") == 0) {
+        *output = RelayDriver::Output::UP;
+    } else {
+        return false;
+    }
+    return true;
+}
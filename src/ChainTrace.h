@@ -0,0 +1,117 @@
+// ChainTrace.h
+#ifndef CHAINTRACE_H
+#define CHAINTRACE_H
+
+#include <Arduino.h>
+#include <functional>
+#include "PositionSnapshot.h"
+#include "RelayDriver.h"
+
+/**
+ * Replay trace: everything the controller logic reads, and what it did,
+ * as log lines.
+ *
+ * The regular log says what the firmware decided but not what it saw:
+ * depth, distance and wind samples, gypsy pulses and the relay sense lines
+ * never appear in it. A trace build (-D CHAIN_TRACE=1, env
+ * pioarduino_esp32_trace) adds a "Trace" line for each of them, and for
+ * the outputs a replay checks, through the LogSink like any other line
+ * ("I (<ms>) Trace: ..."):
+ *
+ *   Trace: u0 begin <pulses> <min> <max> <stop before max> <m/pulse> <dead ms>
+ *   Trace: u0 speeds <up ms/m> <down ms/m> <up coast ms> <down coast ms>
+ *   Trace: in <sk path> <value>          Signal K input, as received
+ *   Trace: u0 cmd <text>                 navigation.anchor.command PUT
+ *   Trace: u0 sense <up> <down>          Relay sense lines (1 = active)
+ *   Trace: u0 pulses <delta>             PCNT count taken by the task
+ *   Trace: u0 relay <off|down|up>        Relay output
+ *   Trace: u0 stage <from> <to>          DeploymentManager stage
+ *   Trace: u0 nvs <namespace> <up> <down> <up coast> <down coast>
+ *
+ * The time is the millis() of the record. Inputs are written as they arrive
+ * with %.9g, so a parsed value is the float the firmware saw. sense and
+ * relay are only written when they change. begin/speeds come from
+ * ChainController::begin(), so a capture starts at boot.
+ *
+ * parse() reads a line back (serial monitor time prefixes and other lines
+ * are skipped), and a recorder, if set, gets every record as it is made -
+ * the host replay (test/support/Replay.h) uses both to drive the logic from
+ * a capture and compare its outputs.
+ *
+ * The windlass task writes sense, pulses and relay; the event loop the
+ * rest. Each keeps to its own per-unit state.
+ */
+#ifndef CHAIN_TRACE
+#define CHAIN_TRACE 0
+#endif
+
+class ChainTrace {
+public:
+    enum class Type : uint8_t {
+        BEGIN,
+        SPEEDS,
+        VALUE,
+        COMMAND,
+        SENSE,
+        PULSES,
+        RELAY,
+        STAGE,
+        NVS
+    };
+
+    static constexpr size_t TEXT_BYTES = 48;   // Signal K path, command or namespace
+    static constexpr uint8_t UNITS = PositionSnapshot::UNITS;
+
+    struct Record {
+        uint32_t ms;
+        Type type;
+        uint8_t unit;          // Not used by VALUE (the environment is shared)
+        int32_t ints[4];       // BEGIN: pulses, limits; SENSE: up, down; PULSES: delta; STAGE: from, to
+        float values[4];       // BEGIN: m/pulse, dead time; SPEEDS, NVS: speeds; VALUE: value
+        char text[TEXT_BYTES]; // VALUE: path; COMMAND: command; RELAY: off/down/up; NVS: namespace
+    };
+
+    using Recorder = std::function<void(const Record&)>;
+
+    static ChainTrace& global();
+
+    void setRecorder(Recorder recorder) { recorder_ = recorder; }
+
+    void begin(uint8_t unit, int32_t pulses, int32_t min_pulses, int32_t max_pulses,
+               int32_t stop_before_max_pulses, float meters_per_pulse, unsigned long dead_time_ms);
+    void speeds(uint8_t unit, float up_speed, float down_speed, float up_coast_ms, float down_coast_ms);
+    void input(const char* sk_path, float value);
+    void command(uint8_t unit, const char* text);
+    void sense(uint8_t unit, bool up_active, bool down_active);   // Written on change
+    void pulses(uint8_t unit, int32_t delta);                      // Written when not 0
+    void relay(uint8_t unit, RelayDriver::Output output);          // Written on change
+    void stage(uint8_t unit, int from, int to);
+    void nvs(uint8_t unit, const char* name, float up_speed, float down_speed,
+             float up_coast_ms, float down_coast_ms);
+
+    // One trace line as the LogSink writes it; false for any other line
+    static bool parse(const char* line, Record* record);
+    // The text after "Trace: " (for diffs and captures written by a harness)
+    static size_t format(const Record& record, char* out, size_t len);
+
+    static const char* toString(RelayDriver::Output output);
+    static bool parseOutput(const char* text, RelayDriver::Output* output);
+
+private:
+    ChainTrace();
+
+    Record make(Type type, uint8_t unit) const;
+    void record(const Record& record) { if (recorder_) recorder_(record); }
+
+    Recorder recorder_ = nullptr;
+    int8_t sense_[UNITS] = {};                   // up | down << 1, -1 = not written yet
+    RelayDriver::Output relay_[UNITS] = {};
+};
+
+#if CHAIN_TRACE
+#define CHAIN_TRACE_RECORD(call) ChainTrace::global().call
+#else
+#define CHAIN_TRACE_RECORD(call) ((void)0)
+#endif
+
+#endif // CHAINTRACE_H
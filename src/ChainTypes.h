@@ -0,0 +1,140 @@
+// ChainTypes.h
+#ifndef CHAINTYPES_H
+#define CHAINTYPES_H
+
+#include <Arduino.h>
+#include "SetupArena.h"
+#include "sensesp/signalk/signalk_output.h"
+#include "sensesp/system/valueproducer.h"
+#include "sensesp/transforms/lambda_transform.h"
+
+/**
+ * Enum forms of the chain counter's text states. The core only passes these
+ * around; the Signal K string is produced at the output boundary (see
+ * connectAsString) and only when the value actually changes.
+ */
+
+// Windlass motion state owned by the windlass task (see WindlassCore)
+enum class ChainState : uint8_t {
+    IDLE,
+    LOWERING,
+    RAISING
+};
+
+enum class ChainDirection : uint8_t {
+    FREE_FALL,
+    UP,
+    DOWN
+};
+
+enum class AnchorCommand : uint8_t {
+    IDLE,
+    DROP,
+    RAISE,
+    LOWER,
+    AUTO_DROP,
+    AUTO_RETRIEVE,
+    TEST_NOTIFICATION
+};
+
+// Power mode (see PowerManager)
+enum class PowerMode : uint8_t {
+    ACTIVE,
+    ANCHOR_WATCH
+};
+
+// Signal K display form of the DeploymentManager stages (several FSM stages share one)
+enum class AutoStage : uint8_t {
+    IDLE,
+    INITIAL_DROP,
+    ALIGNMENT,
+    DEPLOY_40,
+    DIGIN_40,
+    DEPLOY_80,
+    DIGIN_80,
+    FINAL_DEPLOY
+};
+
+inline const char* toString(ChainState state) {
+    switch (state) {
+        case ChainState::IDLE:     return "IDLE";
+        case ChainState::LOWERING: return "LOWERING";
+        case ChainState::RAISING:  return "RAISING";
+    }
+    return "UNKNOWN";
+}
+
+inline const char* toString(ChainDirection direction) {
+    switch (direction) {
+        case ChainDirection::UP:        return "up";
+        case ChainDirection::DOWN:      return "down";
+        case ChainDirection::FREE_FALL: return "free fall";
+    }
+    return "unknown";
+}
+
+inline const char* toString(AnchorCommand command) {
+    switch (command) {
+        case AnchorCommand::IDLE:              return "idle";
+        case AnchorCommand::DROP:              return "drop";
+        case AnchorCommand::RAISE:             return "raise";
+        case AnchorCommand::LOWER:             return "lower";
+        case AnchorCommand::AUTO_DROP:         return "autoDrop";
+        case AnchorCommand::AUTO_RETRIEVE:     return "autoRetrieve";
+        case AnchorCommand::TEST_NOTIFICATION: return "testNotification";
+    }
+    return "unknown";
+}
+
+inline const char* toString(PowerMode mode) {
+    switch (mode) {
+        case PowerMode::ACTIVE:       return "active";
+        case PowerMode::ANCHOR_WATCH: return "anchor watch";
+    }
+    return "unknown";
+}
+
+inline const char* toString(AutoStage stage) {
+    switch (stage) {
+        case AutoStage::IDLE:         return "Idle";
+        case AutoStage::INITIAL_DROP: return "Initial Drop";
+        case AutoStage::ALIGNMENT:    return "Alignment";
+        case AutoStage::DEPLOY_40:    return "Deploy 40";
+        case AutoStage::DIGIN_40:     return "Digin 40";
+        case AutoStage::DEPLOY_80:    return "Deploy 80";
+        case AutoStage::DIGIN_80:     return "Digin 80";
+        case AutoStage::FINAL_DEPLOY: return "Final Deploy";
+    }
+    return "Unknown";
+}
+
+/**
+ * Enum-valued producer that only notifies observers when the value changes.
+ * notify() still re-emits the current value for periodic heartbeats.
+ */
+template <typename E>
+class EnumValue : public sensesp::ValueProducer<E> {
+public:
+    explicit EnumValue(E initial) { this->output_ = initial; }
+
+    void set(E value) {
+        if (value == this->output_) return;
+        this->emit(value);
+    }
+};
+
+/**
+ * Connect an enum producer to a Signal K string output. This is the only
+ * place the String form is built, once per emitted (i.e. changed) value.
+ */
+template <typename E>
+sensesp::SKOutputString* connectAsString(sensesp::ValueProducer<E>* producer,
+                                         const String& sk_path, const String& config_path) {
+    auto* output = SetupArena::make<sensesp::SKOutputString>(sk_path, config_path);
+    producer->connect_to(SetupArena::make<sensesp::LambdaTransform<E, String>>(
+        [](E value) { return String(toString(value)); }))
+        ->connect_to(output);
+    return output;
+}
+
+#endif // CHAINTYPES_H
@@ -0,0 +1,83 @@
+#include "CommandDispatcher.h"
+#include <cstdlib>
+#include <cstring>
+#include "LogSink.h"
+#include "PerfStats.h"
+
+CommandDispatcher::CommandDispatcher(StopHook stop_hook)
+  : stop_hook_(stop_hook) {}
+
+void CommandDispatcher::registerCommand(const char* name, ArgType arg_type, Handler handler,
+                                        bool stops_windlass) {
+    commands_.push_back({name, strlen(name), arg_type, stops_windlass, handler});
+}
+
+const CommandDispatcher::CommandSpec* CommandDispatcher::match(const char* input, float* arg,
+                                                               bool* has_arg, bool* arg_error) const {
+    *arg = 0.0;
+    *has_arg = false;
+    *arg_error = false;
+
+    for (const CommandSpec& spec : commands_) {
+        if (strncmp(input, spec.name, spec.name_len) != 0) continue;
+        const char* rest = input + spec.name_len;
+
+        switch (spec.arg_type) {
+            case ArgType::NONE:
+                if (*rest != '\0') continue;  // Exact match only
+                return &spec;
+
+            case ArgType::ANY_SUFFIX:
+                return &spec;
+
+            case ArgType::FLOAT:
+            case ArgType::OPTIONAL_FLOAT: {
+                while (*rest == ' ') rest++;
+                if (*rest == '\0') {
+                    *arg_error = (spec.arg_type == ArgType::FLOAT);
+                    return &spec;
+                }
+                char* end = nullptr;
+                float value = strtof(rest, &end);
+                if (end == rest || *end != '\0') {
+                    *arg_error = true;
+                    return &spec;
+                }
+                *arg = value;
+                *has_arg = true;
+                return &spec;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void CommandDispatcher::dispatch(const String& input) {
+    PERF_SCOPE(PerfSite::COMMAND);
+    SINK_LOGI(__FILE__, "Command received is %s", input.c_str());
+
+    float arg;
+    bool has_arg, arg_error;
+    const CommandSpec* spec = match(input.c_str(), &arg, &has_arg, &arg_error);
+    if (spec != nullptr && !spec->stops_windlass) {
+        spec->handler(arg, has_arg);
+        return;
+    }
+
+    // Every windlass command (and anything unknown) stops current movement first
+    stop_hook_();
+
+    Handler handler = nullptr;
+    if (spec == nullptr) {
+        SINK_LOGI(__FILE__, "Unknown command '%s' - windlass stopped", input.c_str());
+        handler = unknown_handler_;
+    } else if (arg_error) {
+        SINK_LOGW(__FILE__, "Command '%s': invalid or missing argument - windlass stopped", input.c_str());
+        handler = unknown_handler_;
+    } else {
+        handler = spec->handler;
+    }
+    if (handler) {
+        handler(arg, has_arg);
+    }
+}
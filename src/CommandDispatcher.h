@@ -0,0 +1,52 @@
+// CommandDispatcher.h
+#ifndef COMMANDDISPATCHER_H
+#define COMMANDDISPATCHER_H
+
+#include <Arduino.h>
+#include <functional>
+#include <vector>
+
+/**
+ * Table-driven dispatcher for navigation.anchor.command.
+ *
+ * Commands are registered once with a name and an argument type; dispatch()
+ * matches the input against the table and parses the argument in place (no
+ * substring copies). Commands that move the windlass first run the stop
+ * hook, then their handler right away: the windlass task's RelayDriver
+ * holds a direction reversal until the released relay has dropped out.
+ */
+class CommandDispatcher {
+public:
+    enum class ArgType : uint8_t {
+        NONE,            // Exact match, e.g. "stop"
+        FLOAT,           // Required number after the name, e.g. "raise10" or "raise 10"
+        OPTIONAL_FLOAT,  // Number may follow, e.g. "autoDrop" or "autoDrop7"
+        ANY_SUFFIX       // Prefix match, suffix ignored, e.g. "testNotification:..."
+    };
+
+    using Handler = std::function<void(float arg, bool has_arg)>;
+    using StopHook = std::function<void()>;  // Stops the windlass and any automation
+
+    explicit CommandDispatcher(StopHook stop_hook);
+
+    void registerCommand(const char* name, ArgType arg_type, Handler handler, bool stops_windlass = true);
+    void setUnknownHandler(Handler handler) { unknown_handler_ = handler; }
+    void dispatch(const String& input);
+
+private:
+    struct CommandSpec {
+        const char* name;
+        size_t name_len;
+        ArgType arg_type;
+        bool stops_windlass;
+        Handler handler;
+    };
+
+    const CommandSpec* match(const char* input, float* arg, bool* has_arg, bool* arg_error) const;
+
+    StopHook stop_hook_;
+    Handler unknown_handler_ = nullptr;
+    std::vector<CommandSpec> commands_;
+};
+
+#endif // COMMANDDISPATCHER_H
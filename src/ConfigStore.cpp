@@ -0,0 +1,163 @@
+#include "ConfigStore.h"
+#include <Preferences.h>
+#include <cmath>
+#include "LogSink.h"
+
+namespace {
+
+uint32_t fnv1a(const uint8_t* bytes, size_t len, uint32_t hash = 2166136261u) {
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+}  // namespace
+
+ConfigStore::ConfigStore(const char* nvs_namespace) : namespace_(nvs_namespace) {}
+
+ConfigStore& ConfigStore::global() {
+    static ConfigStore store;
+    return store;
+}
+
+uint32_t ConfigStore::keyFor(const char* path) {
+    return fnv1a(reinterpret_cast<const uint8_t*>(path), strlen(path));
+}
+
+ConfigStore::Field* ConfigStore::find(uint32_t key) {
+    for (size_t i = 0; i < count_; i++) {
+        if (fields_[i].key == key) return &fields_[i];
+    }
+    return nullptr;
+}
+
+const ConfigStore::Field* ConfigStore::find(uint32_t key) const {
+    return const_cast<ConfigStore*>(this)->find(key);
+}
+
+bool ConfigStore::begin() {
+    begun_ = true;
+    has_record_ = false;
+    count_ = 0;
+
+    uint8_t buffer[sizeof(Header) + MAX_FIELDS * sizeof(Entry) + sizeof(uint32_t)];
+    size_t len = 0;
+    Preferences prefs;
+    if (prefs.begin(namespace_, true)) {
+        len = prefs.getBytes(RECORD_KEY, buffer, sizeof(buffer));
+        prefs.end();
+        stats_.reads++;
+    }
+    if (len < sizeof(Header) + sizeof(uint32_t)) {
+        return false;   // No record yet
+    }
+
+    Header header;
+    memcpy(&header, buffer, sizeof(header));
+    const size_t expected = sizeof(Header) + header.count * sizeof(Entry) + sizeof(uint32_t);
+    uint32_t checksum;
+    memcpy(&checksum, buffer + len - sizeof(checksum), sizeof(checksum));
+    if (header.magic != MAGIC || header.version != RECORD_VERSION || header.count > MAX_FIELDS ||
+        len != expected || checksum != fnv1a(buffer, len - sizeof(checksum))) {
+        SINK_LOGW(__FILE__, "ConfigStore: record in \"%s\" is invalid, falling back to the legacy files", namespace_);
+        return false;
+    }
+
+    for (size_t i = 0; i < header.count; i++) {
+        Entry entry;
+        memcpy(&entry, buffer + sizeof(Header) + i * sizeof(Entry), sizeof(entry));
+        fields_[count_++] = {entry.key, entry.value, NAN, false};
+    }
+    has_record_ = true;
+    return true;
+}
+
+float ConfigStore::add(const char* path, float default_value, std::function<float()> legacy) {
+    if (!begun_) begin();
+
+    const uint32_t key = keyFor(path);
+    Field* field = find(key);
+    if (field != nullptr && field->registered) {
+        SINK_LOGE(__FILE__, "ConfigStore: %s registered twice (or its key collides)", path);
+        return field->value;
+    }
+    if (field == nullptr) {
+        if (count_ >= MAX_FIELDS) {
+            SINK_LOGE(__FILE__, "ConfigStore: no room for %s, using its default", path);
+            return default_value;
+        }
+        field = &fields_[count_++];
+        field->key = key;
+        field->value = default_value;
+        if (!has_record_ && legacy) {
+            field->value = legacy();
+            stats_.migrated++;
+        }
+        if (!has_record_) dirty_ = true;   // The first commit writes the record
+    }
+    field->default_value = default_value;
+    field->registered = true;
+    return field->value;
+}
+
+float ConfigStore::get(const char* path) const {
+    const Field* field = find(keyFor(path));
+    return field != nullptr && field->registered ? field->value : NAN;
+}
+
+bool ConfigStore::set(const char* path, float value) {
+    Field* field = find(keyFor(path));
+    if (field == nullptr || !field->registered) return false;
+    if (field->value == value) return false;
+    field->value = value;
+    dirty_ = true;
+    return true;
+}
+
+size_t ConfigStore::storedCount() const {
+    size_t stored = 0;
+    for (size_t i = 0; i < count_; i++) {
+        // Unregistered entries are kept as they were
+        if (!fields_[i].registered || fields_[i].value != fields_[i].default_value) stored++;
+    }
+    return stored;
+}
+
+bool ConfigStore::commit() {
+    if (!dirty_) return true;
+
+    uint8_t buffer[sizeof(Header) + MAX_FIELDS * sizeof(Entry) + sizeof(uint32_t)];
+    Header header = {MAGIC, RECORD_VERSION, 0};
+    size_t len = sizeof(Header);
+    for (size_t i = 0; i < count_; i++) {
+        const Field& field = fields_[i];
+        if (field.registered && field.value == field.default_value) continue;
+        Entry entry = {field.key, field.value};
+        memcpy(buffer + len, &entry, sizeof(entry));
+        len += sizeof(entry);
+        header.count++;
+    }
+    memcpy(buffer, &header, sizeof(header));
+    uint32_t checksum = fnv1a(buffer, len);
+    memcpy(buffer + len, &checksum, sizeof(checksum));
+    len += sizeof(checksum);
+
+    Preferences prefs;
+    if (!prefs.begin(namespace_, false)) {
+        SINK_LOGE(__FILE__, "ConfigStore: Preferences \"%s\" could not be opened for writing", namespace_);
+        return false;
+    }
+    bool ok = prefs.putBytes(RECORD_KEY, buffer, len) == len;
+    prefs.end();
+    if (!ok) {
+        SINK_LOGE(__FILE__, "ConfigStore: writing the record failed");
+        return false;
+    }
+    stats_.writes++;
+    has_record_ = true;
+    dirty_ = false;
+    SINK_LOGI(__FILE__, "ConfigStore: saved %u of %u settings (the rest are at their defaults)",
+              (unsigned)header.count, (unsigned)count_);
+    return true;
+}
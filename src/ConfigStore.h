@@ -0,0 +1,90 @@
+// ConfigStore.h
+#ifndef CONFIGSTORE_H
+#define CONFIGSTORE_H
+
+#include <Arduino.h>
+#include <functional>
+
+/**
+ * The numeric settings of the web UI as one NVS record.
+ *
+ * Each setting used to be a SensESP NumberConfig: a JSON file per path,
+ * opened and parsed at boot. Here they share a single blob - magic,
+ * version, entries and a checksum - read with one NVS call:
+ *
+ *  - Entries are keyed by a hash of the config path, so settings can be
+ *    added, removed or reordered between firmware versions.
+ *  - Only values that differ from their compiled-in default are stored
+ *    (delta encoding); a device that was never configured stores nothing.
+ *  - set() only marks a change; commit() writes the record, and only if a
+ *    value actually changed.
+ *  - Entries this firmware does not register are carried over unchanged.
+ *
+ * Without a valid record (first boot after the update, or a bad checksum)
+ * add() takes each value from its legacy source - the old per-path JSON
+ * file - and the first commit() writes the record. After that the legacy
+ * files are only written (see StoredNumberConfig), never read.
+ */
+class ConfigStore {
+public:
+    static constexpr size_t MAX_FIELDS = 64;
+    static constexpr uint16_t RECORD_VERSION = 1;
+
+    struct Stats {
+        unsigned reads = 0;        // NVS reads of the record
+        unsigned writes = 0;       // NVS writes of the record
+        unsigned migrated = 0;     // Values taken from a legacy source
+    };
+
+    explicit ConfigStore(const char* nvs_namespace = "config");
+    static ConfigStore& global();
+
+    bool begin();                  // Read the record; false if there is none or it is invalid
+    bool hasRecord() const { return has_record_; }
+
+    // Register a setting and return its value: from the record, or from
+    // legacy() (else the default) when there is no record
+    float add(const char* path, float default_value, std::function<float()> legacy = nullptr);
+    float get(const char* path) const;    // Registered settings only; NAN otherwise
+    bool set(const char* path, float value);   // True if the value changed
+    bool commit();                 // Write the record if anything changed
+
+    size_t storedCount() const;    // Entries the record holds (non-default values)
+    const Stats& stats() const { return stats_; }
+
+private:
+    struct Field {
+        uint32_t key;
+        float value;
+        float default_value;
+        bool registered;
+    };
+
+    struct Entry {
+        uint32_t key;
+        float value;
+    };
+
+    struct Header {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t count;
+    };
+
+    static uint32_t keyFor(const char* path);
+    Field* find(uint32_t key);
+    const Field* find(uint32_t key) const;
+
+    const char* namespace_;
+    Field fields_[MAX_FIELDS] = {};
+    size_t count_ = 0;
+    bool begun_ = false;
+    bool has_record_ = false;
+    bool dirty_ = false;
+    Stats stats_;
+
+    static constexpr uint32_t MAGIC = 0x43464731;   // "CFG1"
+    static constexpr const char* RECORD_KEY = "record";
+};
+
+#endif // CONFIGSTORE_H
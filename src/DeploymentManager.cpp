@@ -1,22 +1,36 @@
 #include "DeploymentManager.h"
+#include "ChainTrace.h"
 #include "events.h"
+#include "sensesp/system/lambda_consumer.h"
 #include <cmath>
 #include <Arduino.h>
+#include "LogSink.h"
+#include "SetupArena.h"
 
 DeploymentManager::DeploymentManager(ChainController* chainCtrl)
   : chainController(chainCtrl),
     currentStage(IDLE),
     isRunning(false),
     dropInitiated(false),
-    updateEvent(nullptr),
-    autoStageObservable_(new sensesp::ObservableValue<String>("Idle")) {
-
-  // Connect autoStage observable to Signal K output
-  autoStageObservable_->connect_to(
-      new sensesp::SKOutputString("navigation.anchor.autoStage", "/anchor/autoStage")
-  );
-
-  ESP_LOGI(__FILE__, "DeploymentManager initialized, autoStage publishing to Signal K");
+    autoStageObservable_(SetupArena::make<EnumValue<AutoStage>>(AutoStage::IDLE)),
+    stageDurationObservable_(SetupArena::make<sensesp::ObservableValue<float>>(0.0)),
+    planObservable_(SetupArena::make<sensesp::ObservableValue<String>>("")),
+    planner_(chainCtrl) {
+
+  // Stage wake-up events. ChainController::sync() handles finished moves
+  // before it updates the position, so stages see the controller state
+  // that results from the same pulse.
+  chainController->getPosition()->connect_to(SetupArena::make<sensesp::LambdaConsumer<float>>(
+      [this](float) { onWake(WAKE_CHAIN); }));
+  chainController->getDistanceListener()->connect_to(SetupArena::make<sensesp::LambdaConsumer<float>>(
+      [this](float) {
+        onDistanceSample();
+        onWake(WAKE_DISTANCE);
+      }));
+  chainController->getHorizontalSlackObservable()->connect_to(SetupArena::make<sensesp::LambdaConsumer<float>>(
+      [this](float) { onWake(WAKE_SLACK); }));
+
+  SINK_LOGI(__FILE__, "DeploymentManager initialized");
 }
 
 void DeploymentManager::start(float scopeRatio) {
@@ -25,103 +39,158 @@ void DeploymentManager::start(float scopeRatio) {
 
   isRunning = true;
 
-  // Validate and clamp scope ratio
-  if (scopeRatio < MIN_SCOPE_RATIO) {
-      ESP_LOGW(__FILE__, "Scope ratio %.1f below minimum, clamping to %.1f", scopeRatio, MIN_SCOPE_RATIO);
-      scopeRatio = MIN_SCOPE_RATIO;
-  } else if (scopeRatio > MAX_SCOPE_RATIO) {
-      ESP_LOGW(__FILE__, "Scope ratio %.1f above maximum, clamping to %.1f", scopeRatio, MAX_SCOPE_RATIO);
-      scopeRatio = MAX_SCOPE_RATIO;
-  }
-  scopeRatio_ = scopeRatio;
+  scopeRatio_ = clampScope(scopeRatio);
 
   // Get current depth and tide-adjusted depth for chain calculations
+  // Use tide-adjusted depth for deployment calculations to ensure adequate chain for high tide
   float currentDepth = chainController->getCurrentDepth();
   float tideAdjustedDepth = chainController->getTideAdjustedDepth();
-  float currentDistance = chainController->getDistanceListener()->get();
 
-  // Calculate total chain needed based on scope ratio
-  // Use tide-adjusted depth for deployment calculations to ensure adequate chain for high tide
-  anchorDepth = tideAdjustedDepth + 2.0;  // Add 2m for bow height
-  totalChainLength = scopeRatio_ * anchorDepth;  // Scope based on total depth including bow height
-  chain30 = 0.40 * totalChainLength;
-  chain75 = 0.80 * totalChainLength;
-
-  // Calculate catenary-adjusted distances for each stage
-  // These are the horizontal distances the boat should drift to
-  targetDistance30 = computeTargetHorizontalDistance(chain30, anchorDepth);
-  targetDistance75 = computeTargetHorizontalDistance(chain75, anchorDepth);
-
-  // IMPROVED: Calculate initial drop to ensure boat can drift to proper distance
-  // The initial drop should create enough slack for boat to drift to ~50% of scope
-  // For a 5:1 scope, we want boat to initially drift to about 2.5x depth
-  // With catenary sag, we need MORE chain than the straight-line distance
-  //
-  // Strategy: Deploy enough chain so that with ~2-3m of slack, the boat can
-  // drift to approximately half the final scope distance
-  float desiredInitialDistance = 0.5 * computeTargetHorizontalDistance(totalChainLength, anchorDepth);
-
-  // To find chain length needed for this distance with slack:
-  // We want: chain = distance_needed + slack_buffer
-  // Use iterative approach: start with straight-line estimate, adjust for catenary
-  float straightLineToDesiredDistance = sqrt(pow(desiredInitialDistance, 2) + pow(anchorDepth, 2));
-
-  // Add slack buffer (4-6 meters depending on depth)
-  float slackBuffer = fmin(6.0, fmax(4.0, tideAdjustedDepth * 0.3));
-  targetDropDepth = straightLineToDesiredDistance + slackBuffer;
-
-  // Ensure initial drop is at least depth + bow height + minimum slack
-  float minimumInitialDrop = anchorDepth + 3.0;
-  targetDropDepth = fmax(targetDropDepth, minimumInitialDrop);
-
-  // Calculate what distance this initial drop will produce
-  targetDistanceInit = computeTargetHorizontalDistance(targetDropDepth, anchorDepth);
-
-  ESP_LOGI(__FILE__, "DeploymentManager: Target distances - Init: %.2f, 30%%: %.2f, 75%%: %.2f",
-           targetDistanceInit, targetDistance30, targetDistance75);
-
-    if (totalChainLength < 10.0) {
-      ESP_LOGW(__FILE__, "DeploymentManager: Calculated totalChainLength (%.2f m) is too small. Capping at 10.0 m.", totalChainLength);
-      totalChainLength = 10.0;
-  }
-  if (anchorDepth < 0.0) {
-      ESP_LOGW(__FILE__, "DeploymentManager: Calculated anchorDepth (%.2f m) was negative, setting to 0.0 m.", anchorDepth);
-      anchorDepth = 0.0;
-  }
+  // Stage chain targets and catenary-adjusted distances, cached per depth,
+  // scope and wind (see DeploymentPlanner.h)
+  plan_ = planner_.plan(tideAdjustedDepth, scopeRatio_);
+  anchorDepth = plan_.anchorDepth;
+  totalChainLength = plan_.totalChain;
+  chain30 = plan_.chain40;
+  chain75 = plan_.chain80;
+  targetDropDepth = plan_.dropChain;
+  targetDistanceInit = plan_.distanceInit;
+  targetDistance30 = plan_.distance40;
+  targetDistance75 = plan_.distance80;
+  publishPlan(plan_);
+
+  SINK_LOGI(__FILE__, "DeploymentManager: Target distances - Init: %.2f, 30%%: %.2f, 75%%: %.2f",
+            targetDistanceInit, targetDistance30, targetDistance75);
 
   // Reset stage and flags
   currentStage = DROP;
   dropInitiated = false;
   currentStageTargetLength = 0.0;
+  stageStartTime = millis();
+  runStartMs_ = stageStartTime;
+  for (unsigned long& duration : stageDurationsMs_) {
+    duration = 0;
+  }
 
   // Publish initial stage to Signal K
   publishStage(currentStage);
 
-  ESP_LOGI(__FILE__, "DeploymentManager: Starting autoDrop. Scope: %.1f:1, Current depth: %.2f, Tide-adjusted: %.2f, Total Chain: %.2f",
-           scopeRatio_, currentDepth, tideAdjustedDepth, totalChainLength);
+  SINK_LOGI(__FILE__, "DeploymentManager: Starting autoDrop. Scope: %.1f:1, Current depth: %.2f, Tide-adjusted: %.2f, Total Chain: %.2f",
+            scopeRatio_, currentDepth, tideAdjustedDepth, totalChainLength);
+
+  // Arm the DROP stage wake-ups and evaluate it once to issue the drop
+  armStageWakeups(currentStage);
+  onWake(stageSpec(currentStage).wakeOn);
+}
+
+void DeploymentManager::preview(float scopeRatio) {
+  if (isRunning) {
+    SINK_LOGI(__FILE__, "DeploymentManager: autoDrop running, the published plan is the one in use");
+    return;
+  }
+  if (!isAutoAnchorValid()) return;
+  publishPlan(planner_.plan(chainController->getTideAdjustedDepth(), clampScope(scopeRatio)));
+}
+
+float DeploymentManager::clampScope(float scopeRatio) const {
+  if (scopeRatio < MIN_SCOPE_RATIO) {
+      SINK_LOGW(__FILE__, "Scope ratio %.1f below minimum, clamping to %.1f", scopeRatio, MIN_SCOPE_RATIO);
+      return MIN_SCOPE_RATIO;
+  }
+  if (scopeRatio > MAX_SCOPE_RATIO) {
+      SINK_LOGW(__FILE__, "Scope ratio %.1f above maximum, clamping to %.1f", scopeRatio, MAX_SCOPE_RATIO);
+      return MAX_SCOPE_RATIO;
+  }
+  return scopeRatio;
+}
+
+void DeploymentManager::publishPlan(const DeploymentPlan& plan) {
+  unsigned long holds_ms = tuning_.holdDropMs + tuning_.holdFirstMs + tuning_.holdSecondMs;
+  DeploymentPlanner::Times times = DeploymentPlanner::expectedTimes(plan, chainController->getDownSpeed(), holds_ms);
+  planObservable_->set(DeploymentPlanner::toJson(plan, times));
+}
+
+DeploymentManager::StageSpec DeploymentManager::stageSpec(Stage stage) const {
+  switch (stage) {
+    case DROP:
+      return {WAKE_CHAIN | WAKE_POLL, 0};
+    case WAIT_TIGHT:
+      return {WAKE_DISTANCE | WAKE_SLACK, 0};
+    case HOLD_DROP:
+      return {WAKE_TIMER, tuning_.holdDropMs};
+    case DEPLOY_FIRST:
+    case DEPLOY_SECOND:
+    case DEPLOY_100:
+      return {WAKE_CHAIN | WAKE_POLL, 0};
+    case WAIT_FIRST:
+    case WAIT_SECOND:
+      return {WAKE_DISTANCE, 0};
+    case HOLD_FIRST:
+      return {WAKE_TIMER | WAKE_DISTANCE, tuning_.holdFirstMs};
+    case HOLD_SECOND:
+      return {WAKE_TIMER | WAKE_DISTANCE, tuning_.holdSecondMs};
+    case IDLE:
+    case COMPLETE:
+    default:
+      return {WAKE_NONE, 0};
+  }
+}
+
+void DeploymentManager::armStageWakeups(Stage stage) {
+  cancelStageWakeups();
+  StageSpec spec = stageSpec(stage);
+
+  if ((spec.wakeOn & WAKE_TIMER) && spec.holdMs > 0) {
+    stageTimerEvent = sensesp::event_loop()->onDelay(spec.holdMs, [this]() {
+      stageTimerEvent = nullptr;
+      onWake(WAKE_TIMER);
+    });
+  }
+  if (spec.wakeOn & WAKE_POLL) {
+    stagePollEvent = sensesp::event_loop()->onRepeat(STAGE_POLL_MS, [this]() {
+      onWake(WAKE_POLL);
+    });
+  }
+}
 
-  // Schedule the tick/update
-  if (updateEvent != nullptr) {
-    sensesp::event_loop()->remove(updateEvent);
+void DeploymentManager::cancelStageWakeups() {
+  if (stageTimerEvent != nullptr) {
+    sensesp::event_loop()->remove(stageTimerEvent);
+    stageTimerEvent = nullptr;
+  }
+  if (stagePollEvent != nullptr) {
+    sensesp::event_loop()->remove(stagePollEvent);
+    stagePollEvent = nullptr;
   }
-  updateEvent = sensesp::event_loop()->onRepeat(1, std::bind(&DeploymentManager::updateDeployment, this));
+}
+
+void DeploymentManager::onWake(uint8_t source) {
+  if (!isRunning) return;
+  if ((stageSpec(currentStage).wakeOn & source) == 0) return;
+
+  // Evaluate the stage; if it transitioned, evaluate the new stage once on
+  // entry so it can issue its command or check an already-met condition.
+  Stage evaluated;
+  do {
+    evaluated = currentStage;
+    updateDeployment();
+  } while (isRunning && currentStage != evaluated);
 }
 
 void DeploymentManager::stop() {
   if (!isRunning) return;
   isRunning = false;
-  if (updateEvent != nullptr) {
-    sensesp::event_loop()->remove(updateEvent);
-    updateEvent = nullptr;
-  }
+  cancelStageWakeups();
   if (deployPulseEvent != nullptr) {
     sensesp::event_loop()->remove(deployPulseEvent);
     deployPulseEvent = nullptr;
   }
+  bool completed = currentStage == COMPLETE;
   currentStage = IDLE;
 
   // Publish Idle state to Signal K
   publishStage(IDLE);
+  logStageDurations(completed);
 
   // Notify completion callback if set
   if (completionCallback_) {
@@ -135,19 +204,14 @@ void DeploymentManager::reset() {
   // (e.g., reset flags, timers)
 }
 
-float DeploymentManager::computeTargetHorizontalDistance(float chainLength, float anchorDepth) {
-  // Delegate to ChainController which now has the catenary-aware calculation
-  return chainController->computeTargetHorizontalDistance(chainLength, anchorDepth);
-}
-
 void DeploymentManager::startContinuousDeployment(float stageTargetChainLength) {
     // Issue the full deployment command for the stage target
     float current_chain = chainController->getChainLength();
     float amount_to_deploy = stageTargetChainLength - current_chain;
 
     if (amount_to_deploy > 0.1) {  // Only deploy if significant amount remains
-        ESP_LOGI(__FILE__, "DeploymentManager: Starting continuous deployment of %.2fm to reach %.2fm",
-                 amount_to_deploy, stageTargetChainLength);
+        SINK_LOGI(__FILE__, "DeploymentManager: Starting continuous deployment of %.2fm to reach %.2fm",
+                  amount_to_deploy, stageTargetChainLength);
         chainController->lowerAnchor(amount_to_deploy);
     }
 
@@ -170,6 +234,15 @@ void DeploymentManager::monitorDeployment(float stageTargetChainLength) {
         return;
     }
 
+    // Without fresh depth and distance the slack is meaningless (0 with no
+    // depth would read as "resume"): hold the chain until they are back
+    if (!inputsFresh("DEPLOY")) {
+        if (chainController->isActive()) {
+            chainController->stop();
+        }
+        return;
+    }
+
     float current_chain = chainController->getChainLength();
     float current_slack = chainController->getHorizontalSlackObservable()->get();
     float current_depth = chainController->getCurrentDepth();
@@ -179,15 +252,15 @@ void DeploymentManager::monitorDeployment(float stageTargetChainLength) {
         return;  // Let updateDeployment() handle stage transition
     }
 
-    // Safety brake with hysteresis: pause at MAX_SLACK_RATIO, resume at RESUME_SLACK_RATIO
-    float pause_threshold = current_depth * MAX_SLACK_RATIO;
-    float resume_threshold = current_depth * RESUME_SLACK_RATIO;
+    // Safety brake with hysteresis: pause at maxSlackRatio, resume at resumeSlackRatio
+    float pause_threshold = current_depth * tuning_.maxSlackRatio;
+    float resume_threshold = current_depth * tuning_.resumeSlackRatio;
 
     if (current_slack > pause_threshold) {
         // Stop deployment due to excessive slack
         if (chainController->isActive()) {
-            ESP_LOGI(__FILE__, "DeploymentManager: Excessive slack (%.2fm > %.2fm). Pausing deployment.",
-                     current_slack, pause_threshold);
+            SINK_LOGI(__FILE__, "DeploymentManager: Excessive slack (%.2fm > %.2fm). Pausing deployment.",
+                      current_slack, pause_threshold);
             chainController->stop();
         }
     }
@@ -195,8 +268,8 @@ void DeploymentManager::monitorDeployment(float stageTargetChainLength) {
     else if (current_slack < resume_threshold && !chainController->isActive() && current_chain < stageTargetChainLength) {
         float amount_remaining = stageTargetChainLength - current_chain;
         if (amount_remaining > 0.1) {
-            ESP_LOGI(__FILE__, "DeploymentManager: Slack below resume threshold (%.2fm < %.2fm), resuming deployment of %.2fm",
-                     current_slack, resume_threshold, amount_remaining);
+            SINK_LOGI(__FILE__, "DeploymentManager: Slack below resume threshold (%.2fm < %.2fm), resuming deployment of %.2fm",
+                      current_slack, resume_threshold, amount_remaining);
             chainController->lowerAnchor(amount_remaining);
         }
     }
@@ -205,12 +278,11 @@ void DeploymentManager::monitorDeployment(float stageTargetChainLength) {
 
 void DeploymentManager::updateDeployment() {
   if (!isRunning) {
-    ESP_LOGD(__FILE__, "DeploymentManager: updateDeployment called but not running. Current stage: %d", (int)currentStage);
     return; // exit if stopped
   }
 
   float currentChainLength = chainController->getChainLength();
-  float currentDistance = chainController->getDistanceListener()->get(); 
+  float currentDistance = chainController->getCurrentDistance();
 
   switch (currentStage) {
     case IDLE:
@@ -224,7 +296,7 @@ void DeploymentManager::updateDeployment() {
         if (currentChainLength < targetDropDepth) {
           float amount_to_lower = targetDropDepth - currentChainLength;
           if (amount_to_lower > 0.01) { // Command only if a significant amount remains (e.g., > 1 cm)
-            ESP_LOGI(__FILE__, "DROP: Initiating initial lowerAnchor by %.2f m to reach %.2f m", amount_to_lower, targetDropDepth);
+            SINK_LOGI(__FILE__, "DROP: Initiating initial lowerAnchor by %.2f m to reach %.2f m", amount_to_lower, targetDropDepth);
             chainController->lowerAnchor(amount_to_lower);
             currentStageTargetLength = targetDropDepth; // Set the absolute target for this stage
             _commandIssuedInCurrentDeployStage = true; // Mark command as issued
@@ -233,24 +305,21 @@ void DeploymentManager::updateDeployment() {
             // Do NOT transition yet. We just started the movement.
           } else {
             // Already effectively at target or past it (within tolerance), so just transition
-            ESP_LOGI(__FILE__, "DROP: Already at or past %.2f m (current %.2f). Transitioning to WAIT_TIGHT.", targetDropDepth, currentChainLength);
+            SINK_LOGI(__FILE__, "DROP: Already at or past %.2f m (current %.2f). Transitioning to WAIT_TIGHT.", targetDropDepth, currentChainLength);
             transitionTo(WAIT_TIGHT); // This will reset _commandIssuedInCurrentDeployStage
-            stageStartTime = millis(); // Start the timer for the next (WAIT_TIGHT) stage
           }
         } else {
             // We started this DROP stage already at or past its target, so transition
-            ESP_LOGI(__FILE__, "DROP: Started at or past %.2f m (current %.2f). Transitioning to WAIT_TIGHT.", targetDropDepth, currentChainLength);
+            SINK_LOGI(__FILE__, "DROP: Started at or past %.2f m (current %.2f). Transitioning to WAIT_TIGHT.", targetDropDepth, currentChainLength);
             transitionTo(WAIT_TIGHT); // This will reset _commandIssuedInCurrentDeployStage
-            stageStartTime = millis(); // Start the timer for the next (WAIT_TIGHT) stage
         }
       }
       // PART 2: If the command HAS been issued, now we wait for ChainController to finish that movement
       else { // _commandIssuedInCurrentDeployStage is true
           // Check the *current* state of ChainController directly
           if (!chainController->isActive() || currentChainLength >= currentStageTargetLength) {
-            ESP_LOGD(__FILE__, "DROP: Initial lowerAnchor complete or target %.2f m reached (current %.2f m). Transitioning to WAIT_TIGHT.", currentStageTargetLength, currentChainLength);
+            SINK_LOGD(__FILE__, "DROP: Initial lowerAnchor complete or target %.2f m reached (current %.2f m). Transitioning to WAIT_TIGHT.", currentStageTargetLength, currentChainLength);
             transitionTo(WAIT_TIGHT); // This will reset _commandIssuedInCurrentDeployStage
-            stageStartTime = millis(); // Start the timer for the next (WAIT_TIGHT) stage
           }
       }
       break;
@@ -260,36 +329,35 @@ void DeploymentManager::updateDeployment() {
       // The chain is already deployed, now we wait for wind/current to move the boat
       float currentSlack = chainController->getHorizontalSlackObservable()->get();
 
+      // Slack reads 0 without a depth - that is not a tight chain
+      if (!inputsFresh("WAIT_TIGHT")) {
+        break;
+      }
+
       // Check if boat has reached target distance
-      if (currentDistance != -999.0 && currentDistance >= targetDistanceInit) {
-        ESP_LOGI(__FILE__, "WAIT_TIGHT: Distance target met (%.2f >= %.2f). Transitioning to HOLD_DROP.", currentDistance, targetDistanceInit);
+      if (currentDistance >= targetDistanceInit) {
+        SINK_LOGI(__FILE__, "WAIT_TIGHT: Distance target met (%.2f >= %.2f). Transitioning to HOLD_DROP.", currentDistance, targetDistanceInit);
         transitionTo(HOLD_DROP);
-        stageStartTime = millis();
         break;
       }
 
       // If slack is tight or negative, it means boat has drifted to/past target distance
       // Tight chain = boat has reached desired scope, transition to next stage
       if (currentSlack < 0.5) {
-        ESP_LOGI(__FILE__, "WAIT_TIGHT: Chain tight (slack=%.2f m), boat has reached target distance. Transitioning to HOLD_DROP.", currentSlack);
+        SINK_LOGI(__FILE__, "WAIT_TIGHT: Chain tight (slack=%.2f m), boat has reached target distance. Transitioning to HOLD_DROP.", currentSlack);
         transitionTo(HOLD_DROP);
-        stageStartTime = millis();
         break;
       }
 
       // Still waiting for boat to drift - just monitor
-      if (currentDistance == -999.0) {
-        ESP_LOGD(__FILE__, "WAIT_TIGHT: Waiting for distance sensor data (slack=%.2f m)", currentSlack);
-      } else {
-        ESP_LOGD(__FILE__, "WAIT_TIGHT: Waiting for drift - current=%.2f m, target=%.2f m, slack=%.2f m",
-                 currentDistance, targetDistanceInit, currentSlack);
-      }
+      SINK_LOGD(__FILE__, "WAIT_TIGHT: Waiting for drift - current=%.2f m, target=%.2f m, slack=%.2f m",
+                currentDistance, targetDistanceInit, currentSlack);
       break;
     }
 
     case HOLD_DROP:
-      if (millis() - stageStartTime >= 2000) { // hold for 2s
-        ESP_LOGD(__FILE__, "HOLD_DROP: Hold time complete. Transitioning to DEPLOY_FIRST.");
+      if (millis() - stageStartTime >= tuning_.holdDropMs) { // hold for 2s
+        SINK_LOGD(__FILE__, "HOLD_DROP: Hold time complete. Transitioning to DEPLOY_FIRST.");
         transitionTo(DEPLOY_FIRST);
         currentStageTargetLength = 0.0;
       }
@@ -298,7 +366,7 @@ void DeploymentManager::updateDeployment() {
      case DEPLOY_FIRST:
       // Check if we've reached the stage's target
       if (currentChainLength >= chain30) {
-        ESP_LOGI(__FILE__, "DEPLOY_FIRST: Target %.2f m reached. Transitioning to WAIT_FIRST.", chain30);
+        SINK_LOGI(__FILE__, "DEPLOY_FIRST: Target %.2f m reached. Transitioning to WAIT_FIRST.", chain30);
         if (deployPulseEvent != nullptr) {
             sensesp::event_loop()->remove(deployPulseEvent);
             deployPulseEvent = nullptr;
@@ -307,30 +375,26 @@ void DeploymentManager::updateDeployment() {
             chainController->stop();
         }
         transitionTo(WAIT_FIRST);
-        stageStartTime = millis();
         break;
       }
 
       // Start continuous deployment if not already started
       if (deployPulseEvent == nullptr) {
-        ESP_LOGI(__FILE__, "DEPLOY_FIRST: Starting continuous deployment to %.2fm", chain30);
+        SINK_LOGI(__FILE__, "DEPLOY_FIRST: Starting continuous deployment to %.2fm", chain30);
         startContinuousDeployment(chain30);
       }
       break;
 
     case WAIT_FIRST:
-      if (currentDistance != -999.0 && currentDistance >= targetDistance30) {
-        ESP_LOGI(__FILE__, "WAIT_FIRST: Distance target met (%.2f >= %.2f). Transitioning to HOLD_FIRST.", currentDistance, targetDistance30);
+      if (inputsFresh("WAIT_FIRST") && currentDistance >= targetDistance30) {
+        SINK_LOGI(__FILE__, "WAIT_FIRST: Distance target met (%.2f >= %.2f). Transitioning to HOLD_FIRST.", currentDistance, targetDistance30);
         transitionTo(HOLD_FIRST);
-        stageStartTime = millis();
-      } else if (currentDistance == -999.0) {
-          ESP_LOGW(__FILE__, "WAIT_FIRST: distanceListener has no value yet!");
       }
       break;
 
     case HOLD_FIRST:
-      if (millis() - stageStartTime >= 30000) { // hold for 30s
-        ESP_LOGD(__FILE__, "HOLD_FIRST: Hold time complete. Transitioning to DEPLOY_SECOND.");
+      if (millis() - stageStartTime >= tuning_.holdFirstMs || holdSettled("HOLD_FIRST")) { // up to 30s
+        SINK_LOGD(__FILE__, "HOLD_FIRST: Hold complete. Transitioning to DEPLOY_SECOND.");
         transitionTo(DEPLOY_SECOND);
         currentStageTargetLength = 0.0;
       }
@@ -338,7 +402,7 @@ void DeploymentManager::updateDeployment() {
 
     case DEPLOY_SECOND:
       if (currentChainLength >= chain75) {
-        ESP_LOGI(__FILE__, "DEPLOY_SECOND: Target %.2f m reached. Transitioning to WAIT_SECOND.", chain75);
+        SINK_LOGI(__FILE__, "DEPLOY_SECOND: Target %.2f m reached. Transitioning to WAIT_SECOND.", chain75);
         if (deployPulseEvent != nullptr) {
             sensesp::event_loop()->remove(deployPulseEvent);
             deployPulseEvent = nullptr;
@@ -347,29 +411,25 @@ void DeploymentManager::updateDeployment() {
             chainController->stop();
         }
         transitionTo(WAIT_SECOND);
-        stageStartTime = millis();
         break;
       }
       // Start continuous deployment if not already started
       if (deployPulseEvent == nullptr) {
-        ESP_LOGI(__FILE__, "DEPLOY_SECOND: Starting continuous deployment to %.2fm", chain75);
+        SINK_LOGI(__FILE__, "DEPLOY_SECOND: Starting continuous deployment to %.2fm", chain75);
         startContinuousDeployment(chain75);
       }
       break;
 
     case WAIT_SECOND:
-      if (currentDistance != -999.0 && currentDistance >= targetDistance75) {
-        ESP_LOGI(__FILE__, "WAIT_SECOND: Distance target met (%.2f >= %.2f). Transitioning to HOLD_SECOND.", currentDistance, targetDistance75);
+      if (inputsFresh("WAIT_SECOND") && currentDistance >= targetDistance75) {
+        SINK_LOGI(__FILE__, "WAIT_SECOND: Distance target met (%.2f >= %.2f). Transitioning to HOLD_SECOND.", currentDistance, targetDistance75);
         transitionTo(HOLD_SECOND);
-        stageStartTime = millis();
-      } else if (currentDistance == -999.0) {
-          ESP_LOGW(__FILE__, "WAIT_SECOND: distanceListener has no value yet!");
       }
       break;
 
     case HOLD_SECOND:
-      if (millis() - stageStartTime >= 75000) { // hold for 75s
-        ESP_LOGD(__FILE__, "HOLD_SECOND: Hold time complete. Transitioning to DEPLOY_100.");
+      if (millis() - stageStartTime >= tuning_.holdSecondMs || holdSettled("HOLD_SECOND")) { // up to 75s
+        SINK_LOGD(__FILE__, "HOLD_SECOND: Hold complete. Transitioning to DEPLOY_100.");
         transitionTo(DEPLOY_100);
         currentStageTargetLength = 0.0;
       }
@@ -377,7 +437,7 @@ void DeploymentManager::updateDeployment() {
 
     case DEPLOY_100:
       if (currentChainLength >= totalChainLength) {
-        ESP_LOGI(__FILE__, "DEPLOY_100: Target %.2f m reached. Transitioning to COMPLETE.", totalChainLength);
+        SINK_LOGI(__FILE__, "DEPLOY_100: Target %.2f m reached. Transitioning to COMPLETE.", totalChainLength);
         if (deployPulseEvent != nullptr) {
             sensesp::event_loop()->remove(deployPulseEvent);
             deployPulseEvent = nullptr;
@@ -391,13 +451,13 @@ void DeploymentManager::updateDeployment() {
       }
       // Start continuous deployment if not already started
       if (deployPulseEvent == nullptr) {
-        ESP_LOGI(__FILE__, "DEPLOY_100: Starting continuous deployment to %.2fm", totalChainLength);
+        SINK_LOGI(__FILE__, "DEPLOY_100: Starting continuous deployment to %.2fm", totalChainLength);
         startContinuousDeployment(totalChainLength);
       }
       break;
 
     case COMPLETE:
-      ESP_LOGI(__FILE__, "DeploymentManager: In COMPLETE stage. AutoDrop finished.");
+      SINK_LOGI(__FILE__, "DeploymentManager: In COMPLETE stage. AutoDrop finished.");
       stop(); // or leave running as needed
       break;
   }
@@ -405,56 +465,130 @@ void DeploymentManager::updateDeployment() {
 
 void DeploymentManager::transitionTo(Stage newStage) {
   if (currentStage != newStage) {
-    ESP_LOGI(__FILE__, "AutoDeploy: Transitioning from stage %d to %d", (int)currentStage, (int)newStage);
+    SINK_LOGI(__FILE__, "AutoDeploy: Transitioning from stage %d to %d", (int)currentStage, (int)newStage);
+    CHAIN_TRACE_RECORD(stage(chainController->unit(), (int)currentStage, (int)newStage));
 
     currentStage = newStage;
     _commandIssuedInCurrentDeployStage = false;
+    stageStartTime = millis();
+    drift_.reset();
 
     // Publish new stage to Signal K
     publishStage(newStage);
+
+    // Arm the wake-ups this stage declares (timers, polls)
+    if (isRunning) {
+      armStageWakeups(newStage);
+    }
+
+    // WAIT stages only wake on distance updates - warn once if none are arriving
+    if ((newStage == WAIT_FIRST || newStage == WAIT_SECOND) && !chainController->getDistanceInput()->usable()) {
+      SINK_LOGW(__FILE__, "AutoDeploy: stage %d waiting on distanceFromBow, no fresh value (%s)", (int)newStage,
+                toString(chainController->getDistanceInput()->quality()));
+    }
   }
 }
 
 bool DeploymentManager::isAutoAnchorValid() {
-    float currentDepth = chainController->getDepthListener()->get();
-  if (isnan(currentDepth) || isinf(currentDepth))
+  const SensorInput* depth = chainController->getDepthInput();
+  if (!depth->usable()) {
+    SINK_LOGW(__FILE__, "AutoDeploy: no fresh depth (%s), not starting", toString(depth->quality()));
     return false;
+  }
+  float currentDepth = depth->value();
   if (currentDepth < 3.0f || currentDepth > 45.0f)
     return false;
 
   return true;
 }
 
-String DeploymentManager::getStageDisplayName(Stage stage) const {
+void DeploymentManager::onDistanceSample() {
+  if (!isRunning || (currentStage != HOLD_FIRST && currentStage != HOLD_SECOND)) {
+    return;
+  }
+  const SensorInput* distance = chainController->getDistanceInput();
+  if (!distance->usable() || !chainController->getDepthInput()->usable()) {
+    drift_.reset();   // A gap would fit a line across it
+    return;
+  }
+  drift_.add(millis(), distance->value(), chainController->getHorizontalSlackObservable()->get());
+}
+
+// Settled: over the last settleWindowMs the boat is neither falling back
+// nor closing in faster than settleDriftMps, and the chain is not still
+// straightening. A boat that keeps drifting (anchor dragging or still
+// digging in) holds until the fixed hold time.
+bool DeploymentManager::holdSettled(const char* stage) {
+  if (!tuning_.settleEarly) {
+    return false;
+  }
+  DriftTracker::Rates rates;
+  if (!drift_.rates(millis(), tuning_.settleWindowMs, &rates)) {
+    return false;
+  }
+  if (fabsf(rates.distanceMps) > tuning_.settleDriftMps || rates.slackMps < -tuning_.settleDriftMps) {
+    return false;
+  }
+  SINK_LOGI(__FILE__, "%s: settled after %lu ms (distance %+.3f m/s, slack %+.3f m/s over %u samples)", stage,
+            millis() - stageStartTime, rates.distanceMps, rates.slackMps, (unsigned)rates.samples);
+  return true;
+}
+
+bool DeploymentManager::inputsFresh(const char* stage) const {
+  const SensorInput* depth = chainController->getDepthInput();
+  const SensorInput* distance = chainController->getDistanceInput();
+  if (depth->usable() && distance->usable()) {
+    return true;
+  }
+  SINK_LOGW_EVERY(INPUT_WARN_INTERVAL_MS, __FILE__, "%s: holding - depth %s (%lu ms), distance %s (%lu ms)", stage,
+                  toString(depth->quality()), depth->ageMs(), toString(distance->quality()), distance->ageMs());
+  return false;
+}
+
+AutoStage DeploymentManager::getStageDisplayName(Stage stage) const {
     switch (stage) {
-        case IDLE:
-            return "Idle";
         case DROP:
-            return "Initial Drop";
+            return AutoStage::INITIAL_DROP;
         case WAIT_TIGHT:
         case HOLD_DROP:
-            return "Alignment";
+            return AutoStage::ALIGNMENT;
         case DEPLOY_FIRST:
-            return "Deploy 40";
+            return AutoStage::DEPLOY_40;
         case WAIT_FIRST:
         case HOLD_FIRST:
-            return "Digin 40";
+            return AutoStage::DIGIN_40;
         case DEPLOY_SECOND:
-            return "Deploy 80";
+            return AutoStage::DEPLOY_80;
         case WAIT_SECOND:
         case HOLD_SECOND:
-            return "Digin 80";
+            return AutoStage::DIGIN_80;
         case DEPLOY_100:
-            return "Final Deploy";
+            return AutoStage::FINAL_DEPLOY;
+        case IDLE:
         case COMPLETE:
-            return "Idle";
         default:
-            return "Unknown";
+            return AutoStage::IDLE;
     }
 }
 
 void DeploymentManager::publishStage(Stage stage) {
-    String displayName = getStageDisplayName(stage);
-    autoStageObservable_->set(displayName);
+    AutoStage display = getStageDisplayName(stage);
+    unsigned long now = millis();
+    if (display != displayStage_) {
+        if (displayStage_ != AutoStage::IDLE) {
+            unsigned long duration = now - displayStageStartMs_;
+            stageDurationsMs_[(int)displayStage_] = duration;
+            SINK_LOGI(__FILE__, "AutoDeploy: %s took %lu ms", toString(displayStage_), duration);
+            stageDurationObservable_->set(duration / 1000.0f);
+        }
+        displayStage_ = display;
+        displayStageStartMs_ = now;
+    }
+    autoStageObservable_->set(display);
 }
 
+void DeploymentManager::logStageDurations(bool completed) const {
+    unsigned long digin_ms = stageDurationsMs_[(int)AutoStage::DIGIN_40] + stageDurationsMs_[(int)AutoStage::DIGIN_80];
+    SINK_LOGI(__FILE__, "AutoDeploy: %s after %lu s, %lu s of it digging in", completed ? "set" : "stopped",
+              (millis() - runStartMs_) / 1000, digin_ms / 1000);
+}
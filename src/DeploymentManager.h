@@ -2,6 +2,9 @@
 #define DEPLOYMENTMANAGER_H
 
 #include "ChainController.h"
+#include "ChainTypes.h"
+#include "DeploymentPlanner.h"
+#include "DriftTracker.h"
 #include "sensesp/signalk/signalk_value_listener.h"
 #include "sensesp/signalk/signalk_output.h"
 #include "sensesp/system/observable.h"
@@ -25,9 +28,45 @@ public:
   void reset();           // Reset internal state for new deployment
   bool isAutoAnchorValid(); // Check if auto anchor deployment is valid
 
+  // Publish the plan autoDrop would follow at this scope now, without
+  // starting it. start() publishes the plan it uses.
+  void preview(float scopeRatio = DEFAULT_SCOPE_RATIO);
+
+  // Plan as JSON for Signal K (navigation.anchor.autoPlan): chain and
+  // expected distance per stage and the chain run times, see
+  // DeploymentPlanner::toJson()
+  sensesp::ObservableValue<String>* getPlanObservable() const { return planObservable_; }
+  const DeploymentPlanner& getPlanner() const { return planner_; }
+
   // Completion callback - called when deployment finishes (success or stopped)
   void setCompletionCallback(std::function<void()> callback) { completionCallback_ = callback; }
 
+  // Display stage for Signal K (navigation.anchor.autoStage), emitted on change
+  EnumValue<AutoStage>* getAutoStageObservable() const { return autoStageObservable_; }
+
+  // Time spent in each display stage of the current (or last) run, in
+  // seconds. Emitted as each stage ends (navigation.anchor.autoStageDuration);
+  // stageDurationMs() keeps them all until the next start().
+  sensesp::ObservableValue<float>* getStageDurationObservable() const { return stageDurationObservable_; }
+  unsigned long stageDurationMs(AutoStage stage) const { return stageDurationsMs_[(int)stage]; }
+
+  // Slack hysteresis and hold times. Defaults are the constants below; the
+  // simulator sweeps them. Takes effect from the next stage that reads them.
+  // With settleEarly the dig-in holds end as soon as the boat has stopped
+  // drifting (see holdSettled()); the hold times are then upper bounds.
+  struct Tuning {
+    float maxSlackRatio = MAX_SLACK_RATIO;
+    float resumeSlackRatio = RESUME_SLACK_RATIO;
+    unsigned long holdDropMs = HOLD_DROP_MS;
+    unsigned long holdFirstMs = HOLD_FIRST_MS;
+    unsigned long holdSecondMs = HOLD_SECOND_MS;
+    bool settleEarly = true;
+    unsigned long settleWindowMs = SETTLE_WINDOW_MS;
+    float settleDriftMps = SETTLE_DRIFT_MPS;
+  };
+  void setTuning(const Tuning& tuning) { tuning_ = tuning; }
+  const Tuning& getTuning() const { return tuning_; }
+
 private:
   // References to core objects
   ChainController* chainController;
@@ -49,6 +88,22 @@ private:
   };
   Stage currentStage = IDLE;
 
+  // Wake sources - each stage declares which events re-evaluate it
+  enum WakeSource : uint8_t {
+    WAKE_NONE     = 0,
+    WAKE_CHAIN    = 1 << 0,   // ChainPosition emitted a new chain length
+    WAKE_DISTANCE = 1 << 1,   // New distanceFromBow value
+    WAKE_SLACK    = 1 << 2,   // Horizontal slack changed
+    WAKE_TIMER    = 1 << 3,   // Stage hold timer expired
+    WAKE_POLL     = 1 << 4    // Low-rate supervision poll (catches controller stops without a pulse)
+  };
+
+  struct StageSpec {
+    uint8_t wakeOn;           // Bitmask of WakeSource
+    unsigned long holdMs;     // One-shot timer armed on entry (0 = none)
+  };
+  StageSpec stageSpec(Stage stage) const;
+
   // Flags for flow control
   bool isRunning = false;     // Is deployment active?
   bool dropInitiated = false; // Has the initial drop been triggered?
@@ -75,32 +130,67 @@ private:
   static constexpr float MAX_SLACK_RATIO = 1.2;                       // Pause deployment when slack exceeds 120% of depth
   static constexpr float RESUME_SLACK_RATIO = 0.6;                    // Resume deployment when slack drops below 60% of depth
   static constexpr unsigned long MONITOR_INTERVAL_MS = 500;           // Check conditions every 500ms
+  static constexpr unsigned long STAGE_POLL_MS = 500;                 // Supervision poll for WAKE_POLL stages
+  static constexpr uint32_t INPUT_WARN_INTERVAL_MS = 10000;           // Rate limit for the stale-input warning
+
+  // Stage hold durations
+  static constexpr unsigned long HOLD_DROP_MS = 2000;
+  static constexpr unsigned long HOLD_FIRST_MS = 30000;
+  static constexpr unsigned long HOLD_SECOND_MS = 75000;
+
+  // Dig-in convergence: distance and slack trends over the trailing window
+  static constexpr unsigned long SETTLE_WINDOW_MS = 15000;   // 15 distance samples - slope noise ~0.02 m/s at 0.3 m GPS noise
+  static constexpr float SETTLE_DRIFT_MPS = 0.05;            // |distance rate| and slack fall below this = settled
 
-  // Event handle for periodic update
-  reactesp::Event* updateEvent = nullptr;
+  Tuning tuning_;
+
+  // Event handles for stage wake-ups
+  reactesp::Event* stageTimerEvent = nullptr;
+  reactesp::Event* stagePollEvent = nullptr;
   reactesp::Event* deployPulseEvent = nullptr;
 
   // Signal K stage publishing
-  sensesp::ObservableValue<String>* autoStageObservable_;
+  EnumValue<AutoStage>* autoStageObservable_;
+  sensesp::ObservableValue<float>* stageDurationObservable_;
+  sensesp::ObservableValue<String>* planObservable_;
+  unsigned long stageDurationsMs_[(int)AutoStage::FINAL_DEPLOY + 1] = {};
+  AutoStage displayStage_ = AutoStage::IDLE;
+  unsigned long displayStageStartMs_ = 0;
+  unsigned long runStartMs_ = 0;
+
+  // Boat drift during the dig-in holds
+  DriftTracker drift_;
+
+  // Stage targets, cached across starts and software resets
+  DeploymentPlanner planner_;
+  DeploymentPlan plan_ = {};
 
   // Completion callback
   std::function<void()> completionCallback_ = nullptr;
 
   // Private helper methods
-  float computeTargetHorizontalDistance(float chainLength, float anchorDepth);
   float currentStageTargetLength = 0.0;
   void transitionTo(Stage nextStage);
   void startContinuousDeployment(float stageTargetChainLength);
   void monitorDeployment(float stageTargetChainLength);
+  bool inputsFresh(const char* stage) const;   // Depth and distance valid and fresh; warns if not
+  void onDistanceSample();                     // Feed the drift tracker during hold stages
+  bool holdSettled(const char* stage);         // Dig-in converged - the hold can end early
+  void logStageDurations(bool completed) const;
+  float clampScope(float scopeRatio) const;
+  void publishPlan(const DeploymentPlan& plan);
 
   // Stage publishing helpers
-  String getStageDisplayName(Stage stage) const;
+  AutoStage getStageDisplayName(Stage stage) const;
   void publishStage(Stage stage);
 
   // Stage transition handler
   void onStageAdvance();                    // Advance to next stage
   void checkConditions();                   // Checks for stage triggers
-  void updateDeployment();                  // Main deployment logic called per tick
+  void updateDeployment();                  // Evaluate the current stage once
+  void onWake(uint8_t source);              // Event entry point - runs the stage if it listens to source
+  void armStageWakeups(Stage stage);        // Arm the timer/poll declared by the stage
+  void cancelStageWakeups();
 };
 
 #endif
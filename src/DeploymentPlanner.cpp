@@ -0,0 +1,181 @@
+#include "DeploymentPlanner.h"
+#include <cmath>
+#include <cstddef>
+#include "ChainController.h"
+#include "LogSink.h"
+
+namespace {
+
+constexpr uint32_t CACHE_MAGIC = 0x504C414E;   // "PLAN"
+
+struct CacheEntry {
+    uint16_t depthSteps;
+    uint8_t scopeSteps;
+    uint8_t forceSteps;
+    uint32_t lastUse;          // 0 = empty
+    DeploymentPlan plan;
+};
+
+struct CacheImage {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t entries;          // CACHE_ENTRIES it was built with
+    uint32_t useCounter;
+    CacheEntry entry[DeploymentPlanner::CACHE_ENTRIES];
+    uint32_t checksum;         // FNV-1a over everything above
+};
+
+// Left alone by the bootloader on a software reset - see DeploymentPlanner.h
+RTC_NOINIT_ATTR CacheImage cache;
+
+uint32_t checksumOf(const CacheImage& image) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&image);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < offsetof(CacheImage, checksum); i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+void seal() { cache.checksum = checksumOf(cache); }
+
+bool cacheValid() {
+    return cache.magic == CACHE_MAGIC && cache.version == DeploymentPlanner::PLAN_VERSION &&
+           cache.entries == DeploymentPlanner::CACHE_ENTRIES && cache.checksum == checksumOf(cache);
+}
+
+void resetCache() {
+    memset(&cache, 0, sizeof(cache));
+    cache.magic = CACHE_MAGIC;
+    cache.version = DeploymentPlanner::PLAN_VERSION;
+    cache.entries = DeploymentPlanner::CACHE_ENTRIES;
+    seal();
+}
+
+uint32_t steps(float value, float step, uint32_t max_steps) {
+    if (!(value > 0.0f)) return 0;   // Also NaN
+    uint32_t n = (uint32_t)lroundf(value / step);
+    return n < max_steps ? n : max_steps;
+}
+
+}  // namespace
+
+DeploymentPlanner::DeploymentPlanner(ChainController* controller) : controller_(controller) {
+    if (cacheValid()) {
+        stats_.restored = size();
+        SINK_LOGI(__FILE__, "DeploymentPlanner: %u cached plans kept across the reset", (unsigned)stats_.restored);
+    } else {
+        resetCache();
+    }
+}
+
+DeploymentPlanner::Key DeploymentPlanner::keyFor(float tideAdjustedDepth, float scope, float force) const {
+    Key key;
+    key.depthSteps = (uint16_t)steps(tideAdjustedDepth, PLAN_DEPTH_STEP_M, UINT16_MAX);
+    key.scopeSteps = (uint8_t)steps(scope, PLAN_SCOPE_STEP, UINT8_MAX);
+    key.forceSteps = (uint8_t)steps(force, PLAN_FORCE_STEP_N, UINT8_MAX);
+    return key;
+}
+
+DeploymentPlan DeploymentPlanner::plan(float tideAdjustedDepth, float scope) {
+    const float force = controller_->estimateHorizontalForce();
+    Key key = keyFor(tideAdjustedDepth, scope, force);
+    cache.useCounter++;
+
+    CacheEntry* victim = &cache.entry[0];
+    for (CacheEntry& entry : cache.entry) {
+        if (entry.lastUse != 0 && key == Key{entry.depthSteps, entry.scopeSteps, entry.forceSteps}) {
+            entry.lastUse = cache.useCounter;
+            seal();
+            stats_.hits++;
+            return entry.plan;
+        }
+        if (entry.lastUse < victim->lastUse) {
+            victim = &entry;
+        }
+    }
+
+    stats_.misses++;
+    victim->depthSteps = key.depthSteps;
+    victim->scopeSteps = key.scopeSteps;
+    victim->forceSteps = key.forceSteps;
+    victim->lastUse = cache.useCounter;
+    victim->plan = compute(tideAdjustedDepth, scope, force);
+    seal();
+    return victim->plan;
+}
+
+DeploymentPlan DeploymentPlanner::compute(float tideAdjustedDepth, float scope, float force) {
+    DeploymentPlan plan = {};
+    plan.depth = tideAdjustedDepth;
+    plan.scope = scope;
+    plan.horizontalForce = force;
+
+    // Scope is based on the total depth including bow height
+    plan.anchorDepth = plan.depth + ChainController::BOW_HEIGHT_M;
+    plan.totalChain = plan.scope * plan.anchorDepth;
+    plan.chain40 = 0.40 * plan.totalChain;
+    plan.chain80 = 0.80 * plan.totalChain;
+
+    // Catenary-adjusted distances the boat should drift to at each stage
+    plan.distance40 = controller_->computeTargetHorizontalDistance(plan.chain40, plan.anchorDepth, force);
+    plan.distance80 = controller_->computeTargetHorizontalDistance(plan.chain80, plan.anchorDepth, force);
+
+    // Initial drop: enough chain, plus a 4-6 m slack buffer, for the boat to
+    // fall back to about half the final distance
+    float desiredInitialDistance =
+        0.5 * controller_->computeTargetHorizontalDistance(plan.totalChain, plan.anchorDepth, force);
+    float straightLineToDesiredDistance =
+        sqrtf(desiredInitialDistance * desiredInitialDistance + plan.anchorDepth * plan.anchorDepth);
+    float slackBuffer = fmin(6.0, fmax(4.0, plan.depth * 0.3));
+    plan.dropChain = fmax(straightLineToDesiredDistance + slackBuffer, plan.anchorDepth + 3.0);
+    plan.distanceInit = controller_->computeTargetHorizontalDistance(plan.dropChain, plan.anchorDepth, force);
+
+    if (plan.totalChain < 10.0) {
+        SINK_LOGW(__FILE__, "DeploymentPlanner: Calculated totalChainLength (%.2f m) is too small. Capping at 10.0 m.",
+                  plan.totalChain);
+        plan.totalChain = 10.0;
+    }
+    if (plan.anchorDepth < 0.0) {
+        SINK_LOGW(__FILE__, "DeploymentPlanner: Calculated anchorDepth (%.2f m) was negative, setting to 0.0 m.",
+                  plan.anchorDepth);
+        plan.anchorDepth = 0.0;
+    }
+    return plan;
+}
+
+DeploymentPlanner::Times DeploymentPlanner::expectedTimes(const DeploymentPlan& plan, float downSpeedMsPerM,
+                                                          unsigned long holdsMs) {
+    Times times;
+    const float s_per_m = downSpeedMsPerM / 1000.0f;
+    times.dropS = plan.dropChain * s_per_m;
+    times.deploy40S = fmaxf(0.0f, plan.chain40 - plan.dropChain) * s_per_m;
+    times.deploy80S = fmaxf(0.0f, plan.chain80 - fmaxf(plan.chain40, plan.dropChain)) * s_per_m;
+    times.finalS = fmaxf(0.0f, plan.totalChain - fmaxf(plan.chain80, plan.dropChain)) * s_per_m;
+    times.totalS = times.dropS + times.deploy40S + times.deploy80S + times.finalS + holdsMs / 1000.0f;
+    return times;
+}
+
+String DeploymentPlanner::toJson(const DeploymentPlan& plan, const Times& times) {
+    char text[256];
+    snprintf(text, sizeof(text),
+             "{\"depth\":%.1f,\"scope\":%.1f,\"chain\":[%.1f,%.1f,%.1f,%.1f],\"distance\":[%.1f,%.1f,%.1f],"
+             "\"seconds\":[%.0f,%.0f,%.0f,%.0f,%.0f]}",
+             plan.depth, plan.scope, plan.dropChain, plan.chain40, plan.chain80, plan.totalChain,
+             plan.distanceInit, plan.distance40, plan.distance80,
+             times.dropS, times.deploy40S, times.deploy80S, times.finalS, times.totalS);
+    return String(text);
+}
+
+size_t DeploymentPlanner::size() const {
+    size_t count = 0;
+    for (const CacheEntry& entry : cache.entry) {
+        if (entry.lastUse != 0) count++;
+    }
+    return count;
+}
+
+void DeploymentPlanner::clear() {
+    resetCache();
+    stats_ = Stats();
+}
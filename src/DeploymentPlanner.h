@@ -0,0 +1,102 @@
+// DeploymentPlanner.h
+#ifndef DEPLOYMENTPLANNER_H
+#define DEPLOYMENTPLANNER_H
+
+#include <Arduino.h>
+
+class ChainController;
+
+/**
+ * autoDrop stage targets for a depth and scope ratio.
+ *
+ * The geometry (chain per stage and the distance the boat should reach)
+ * depends only on the tide-adjusted depth, the scope ratio and the
+ * horizontal force the catenary is computed for. Plans are cached under
+ * those three, quantized to PLAN_DEPTH_STEP_M, PLAN_SCOPE_STEP and
+ * PLAN_FORCE_STEP_N. A miss computes from the exact inputs, and later
+ * requests in the same bucket reuse that plan - at most half a step away,
+ * e.g. 0.05 m of depth is 0.25 m of chain at 5:1.
+ *
+ * The cache holds CACHE_ENTRIES plans, least recently used out, in
+ * RTC_NOINIT memory: it survives a software reset, a watchdog or panic
+ * reboot and an OTA restart, but not a power cycle. A magic number,
+ * PLAN_VERSION and a checksum guard it; anything else found there at boot
+ * is discarded. Bump PLAN_VERSION when the plan math changes.
+ *
+ * Durations are not cached - they follow the learned lowering speed and
+ * are derived per read with expectedTimes().
+ *
+ * DeploymentPlan stays trivial (no initializers): a constructor would run
+ * at boot and wipe the RTC copy.
+ */
+struct DeploymentPlan {
+    float depth;              // Tide-adjusted depth it was computed for
+    float scope;              // Scope ratio
+    float horizontalForce;    // N
+    float anchorDepth;        // Depth + bow height
+    float dropChain;          // Initial drop
+    float chain40;
+    float chain80;
+    float totalChain;
+    float distanceInit;       // Expected distanceFromBow after each stage
+    float distance40;
+    float distance80;
+};
+
+class DeploymentPlanner {
+public:
+    static constexpr size_t CACHE_ENTRIES = 16;
+    static constexpr float PLAN_DEPTH_STEP_M = 0.1;
+    static constexpr float PLAN_SCOPE_STEP = 0.1;
+    static constexpr float PLAN_FORCE_STEP_N = 10.0;   // As ChainController::SLACK_FORCE_TOLERANCE_N
+    static constexpr uint16_t PLAN_VERSION = 1;
+
+    // Chain run times at the learned lowering speed (ms per meter). The
+    // waits for the boat to fall back depend on the wind and are not included.
+    struct Times {
+        float dropS = 0.0;
+        float deploy40S = 0.0;
+        float deploy80S = 0.0;
+        float finalS = 0.0;
+        float totalS = 0.0;        // Chain runs plus the holds (upper bounds)
+    };
+
+    struct Stats {
+        uint32_t hits = 0;
+        uint32_t misses = 0;
+        size_t restored = 0;       // Valid entries found in RTC memory at boot
+    };
+
+    explicit DeploymentPlanner(ChainController* controller);
+
+    // Plan for the tide-adjusted depth and scope at the current wind
+    DeploymentPlan plan(float tideAdjustedDepth, float scope);
+
+    static Times expectedTimes(const DeploymentPlan& plan, float downSpeedMsPerM, unsigned long holdsMs);
+
+    // {"depth":..,"scope":..,"chain":[drop,40,80,total],"distance":[init,40,80],"seconds":[drop,40,80,final,total]}
+    static String toJson(const DeploymentPlan& plan, const Times& times);
+
+    const Stats& stats() const { return stats_; }
+    size_t size() const;
+    void clear();                  // Drop every cached plan (tests)
+
+private:
+    struct Key {
+        uint16_t depthSteps;
+        uint8_t scopeSteps;
+        uint8_t forceSteps;
+        bool operator==(const Key& other) const {
+            return depthSteps == other.depthSteps && scopeSteps == other.scopeSteps &&
+                   forceSteps == other.forceSteps;
+        }
+    };
+
+    Key keyFor(float tideAdjustedDepth, float scope, float force) const;
+    DeploymentPlan compute(float tideAdjustedDepth, float scope, float force);
+
+    ChainController* controller_;
+    Stats stats_;
+};
+
+#endif // DEPLOYMENTPLANNER_H
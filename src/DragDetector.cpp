@@ -0,0 +1,61 @@
+#include "DragDetector.h"
+
+void DragDetector::reset() {
+    slack_.reset();
+    distance_.reset();
+    clear_samples_ = 0;
+    // An alarm stays up across a reset until the next watch clears it
+}
+
+bool DragDetector::clear() {
+    reset();
+    cause_ = Cause::NONE;
+    if (!dragging_) return false;
+    dragging_ = false;
+    return true;
+}
+
+bool DragDetector::add(float slack, float distance) {
+    slack_.add(slack);
+    distance_.add(distance);
+
+    Cause cause = check();
+    if (cause != Cause::NONE) {
+        clear_samples_ = 0;
+        cause_ = cause;
+        if (dragging_) return false;
+        dragging_ = true;
+        return true;
+    }
+    if (!dragging_ || ++clear_samples_ < CLEAR_SAMPLES) return false;
+    dragging_ = false;
+    cause_ = Cause::NONE;
+    return true;
+}
+
+DragDetector::Cause DragDetector::check() const {
+    if (!slack_.full()) return Cause::NONE;
+    float mean = slack_.mean();
+    if (mean < -SLACK_DRAG_M && mean + 2 * slack_.stddev() < 0) {
+        return Cause::NEGATIVE_SLACK;
+    }
+    float drift_mps = distance_.slope() * 1000.0f / SAMPLE_MS;
+    if (mean < 0 && distance_.full() && drift_mps > DRIFT_MPS) {
+        return Cause::DISTANCE_GROWING;
+    }
+    return Cause::NONE;
+}
+
+String DragDetector::notification() const {
+    char json[192];
+    if (!dragging_) {
+        snprintf(json, sizeof(json),
+                 "{\"state\":\"normal\",\"method\":[],\"message\":\"Anchor holding\"}");
+    } else {
+        snprintf(json, sizeof(json),
+                 "{\"state\":\"alarm\",\"method\":[\"visual\",\"sound\"],"
+                 "\"message\":\"Anchor dragging: slack %.1f m, distance %.0f m, drifting %.2f m/s\"}",
+                 slack_.mean(), distance_.newest(), distance_.slope() * 1000.0f / SAMPLE_MS);
+    }
+    return String(json);
+}
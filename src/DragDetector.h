@@ -0,0 +1,69 @@
+// DragDetector.h
+#ifndef DRAGDETECTOR_H
+#define DRAGDETECTOR_H
+
+#include <Arduino.h>
+#include "RollingWindow.h"
+
+/**
+ * Anchor drag alarm from the slack and distance streams, on the device.
+ *
+ * While the windlass is at rest with the anchor down, WindlassUnit adds the
+ * horizontal slack and distanceFromBow once every SAMPLE_MS. Rolling
+ * windows (see RollingWindow.h) keep their mean, spread and trend, and the
+ * anchor is dragging when either:
+ *  - slack is sustained negative: over the last SLACK_WINDOW samples its
+ *    mean is below -SLACK_DRAG_M and two standard deviations above the
+ *    mean are still below zero (the boat is further out than the chain
+ *    reaches, not one noisy GPS fix)
+ *  - the boat is beyond scope (mean slack below zero) and still moving
+ *    away: distance over the last DISTANCE_WINDOW samples grows at more
+ *    than DRIFT_MPS
+ * The alarm holds until neither has been true for CLEAR_SAMPLES samples.
+ *
+ * A moving windlass, automation or a stale input resets the windows, so a
+ * new rode length starts a new watch instead of mixing with the old one;
+ * an alarm stays up across such a reset. Once the anchor is off the bottom
+ * or being retrieved there is nothing left to watch, and clear() drops the
+ * alarm as well.
+ */
+class DragDetector {
+public:
+    static constexpr unsigned long SAMPLE_MS = 1000;
+    static constexpr size_t SLACK_WINDOW = 10;       // Alarm within ~10 s of sustained negative slack
+    static constexpr size_t DISTANCE_WINDOW = 30;
+    static constexpr float SLACK_DRAG_M = 1.0;
+    static constexpr float DRIFT_MPS = 0.05;         // ~0.1 kn steadily away from the anchor
+    static constexpr size_t CLEAR_SAMPLES = 30;
+
+    enum class Cause : uint8_t {
+        NONE,
+        NEGATIVE_SLACK,
+        DISTANCE_GROWING
+    };
+
+    void reset();
+    // reset() and drop the alarm; true if dragging() changed
+    bool clear();
+    // One sample per SAMPLE_MS while watching; true if dragging() changed
+    bool add(float slack, float distance);
+
+    bool dragging() const { return dragging_; }
+    Cause cause() const { return cause_; }
+    const RollingWindow<SLACK_WINDOW>& slack() const { return slack_; }
+    const RollingWindow<DISTANCE_WINDOW>& distance() const { return distance_; }
+
+    // Signal K notification value for the current state
+    String notification() const;
+
+private:
+    Cause check() const;
+
+    RollingWindow<SLACK_WINDOW> slack_;
+    RollingWindow<DISTANCE_WINDOW> distance_;
+    bool dragging_ = false;
+    Cause cause_ = Cause::NONE;
+    size_t clear_samples_ = 0;
+};
+
+#endif // DRAGDETECTOR_H
@@ -0,0 +1,45 @@
+#include "DriftTracker.h"
+
+void DriftTracker::add(unsigned long ms, float distance, float slack) {
+    samples_[head_] = {ms, distance, slack};
+    head_ = (head_ + 1) % CAPACITY;
+    if (count_ < CAPACITY) {
+        count_++;
+    }
+}
+
+bool DriftTracker::rates(unsigned long now, unsigned long window_ms, Rates* out) const {
+    // Times relative to now (newest first) keep the sums small in float
+    float sum_t = 0.0, sum_tt = 0.0, sum_d = 0.0, sum_td = 0.0, sum_s = 0.0, sum_ts = 0.0;
+    size_t n = 0;
+    unsigned long span_ms = 0;
+    for (size_t i = 0; i < count_; i++) {
+        const Sample& sample = samples_[(head_ + CAPACITY - 1 - i) % CAPACITY];
+        unsigned long age_ms = now - sample.ms;
+        if (age_ms > window_ms) {
+            break;
+        }
+        float t = -(float)age_ms / 1000.0f;
+        sum_t += t;
+        sum_tt += t * t;
+        sum_d += sample.distance;
+        sum_td += t * sample.distance;
+        sum_s += sample.slack;
+        sum_ts += t * sample.slack;
+        span_ms = age_ms;
+        n++;
+    }
+
+    // The samples must cover 3/4 of the window
+    if (n < MIN_SAMPLES || span_ms * 4 < window_ms * 3) {
+        return false;
+    }
+    float denominator = n * sum_tt - sum_t * sum_t;
+    if (denominator <= 0.0f) {
+        return false;
+    }
+    out->distanceMps = (n * sum_td - sum_t * sum_d) / denominator;
+    out->slackMps = (n * sum_ts - sum_t * sum_s) / denominator;
+    out->samples = n;
+    return true;
+}
@@ -0,0 +1,54 @@
+// DriftTracker.h
+#ifndef DRIFTTRACKER_H
+#define DRIFTTRACKER_H
+
+#include <Arduino.h>
+
+/**
+ * Drift of the boat over the last few distance samples.
+ *
+ * DeploymentManager feeds it every distanceFromBow value (with the slack at
+ * that moment) while a dig-in hold runs, and asks for the least-squares
+ * rates over a trailing window: distance in m/s (positive = drifting away
+ * from the anchor) and slack in m/s (negative = chain still straightening).
+ * A boat that has stopped falling back on a chain that has stopped
+ * straightening has loaded the anchor at this scope - the hold has done its
+ * job and the next stage can start.
+ *
+ * Fixed ring, no allocation; a fit is a single pass over at most CAPACITY
+ * samples at the 1 Hz distance rate.
+ */
+class DriftTracker {
+public:
+    static constexpr size_t CAPACITY = 32;   // > longest window at 1 Hz
+    static constexpr size_t MIN_SAMPLES = 5;
+
+    struct Rates {
+        float distanceMps = 0.0;
+        float slackMps = 0.0;
+        size_t samples = 0;
+    };
+
+    void reset() { count_ = 0; }
+    void add(unsigned long ms, float distance, float slack);
+
+    // Rates over the samples no older than window_ms. False until the
+    // samples span most of the window, so a fresh hold cannot settle on a
+    // couple of points.
+    bool rates(unsigned long now, unsigned long window_ms, Rates* out) const;
+
+    size_t size() const { return count_; }
+
+private:
+    struct Sample {
+        unsigned long ms;
+        float distance;
+        float slack;
+    };
+
+    Sample samples_[CAPACITY];
+    size_t head_ = 0;    // Next slot to write
+    size_t count_ = 0;
+};
+
+#endif // DRIFTTRACKER_H
@@ -0,0 +1,96 @@
+#include "InputReadiness.h"
+#include "LogSink.h"
+
+void InputReadiness::add(const char* name, int gpio, unsigned long stable_ms) {
+    if (count_ >= MAX_INPUTS || find(gpio) != nullptr) {
+        SINK_LOGE(__FILE__, "InputReadiness: cannot add %s on GPIO %d", name, gpio);
+        return;
+    }
+    Input& input = inputs_[count_++];
+    input.name = name;
+    input.gpio = gpio;
+    input.stable_ms = stable_ms > MIN_STABLE_MS ? stable_ms : MIN_STABLE_MS;
+    input.level = digitalRead(gpio);
+    input.since_ms = millis();
+    input.ready = false;
+}
+
+InputReadiness::Input* InputReadiness::find(int gpio) {
+    for (size_t i = 0; i < count_; i++) {
+        if (inputs_[i].gpio == gpio) return &inputs_[i];
+    }
+    return nullptr;
+}
+
+const InputReadiness::Input* InputReadiness::find(int gpio) const {
+    return const_cast<InputReadiness*>(this)->find(gpio);
+}
+
+void InputReadiness::markReady(int gpio) {
+    Input* input = find(gpio);
+    if (input != nullptr && !input->ready) setReady(*input, "marked");
+}
+
+void InputReadiness::onReady(int gpio, std::function<void()> callback) {
+    Input* input = find(gpio);
+    if (input == nullptr) return;
+    if (input->ready) {
+        callback();
+    } else {
+        input->on_ready = callback;
+    }
+}
+
+bool InputReadiness::ready(int gpio) const {
+    const Input* input = find(gpio);
+    return input == nullptr || input->ready;   // Nothing to settle
+}
+
+bool InputReadiness::allReady() const {
+    for (size_t i = 0; i < count_; i++) {
+        if (!inputs_[i].ready) return false;
+    }
+    return true;
+}
+
+void InputReadiness::setReady(Input& input, const char* why) {
+    input.ready = true;
+    SINK_LOGI(__FILE__, "InputReadiness: %s (GPIO %d) ready after %lu ms, %s", input.name, input.gpio,
+              millis() - start_ms_, why);
+    if (input.on_ready) {
+        std::function<void()> callback = input.on_ready;
+        input.on_ready = nullptr;
+        callback();
+    }
+}
+
+void InputReadiness::start() {
+    start_ms_ = millis();
+    poll();
+    if (!allReady()) {
+        poll_event_ = sensesp::event_loop()->onRepeat(POLL_MS, [this]() { poll(); });
+    }
+}
+
+void InputReadiness::poll() {
+    const unsigned long now = millis();
+    const bool timed_out = now - start_ms_ >= MAX_SETTLE_MS;
+    for (size_t i = 0; i < count_; i++) {
+        Input& input = inputs_[i];
+        if (input.ready) continue;
+        int level = digitalRead(input.gpio);
+        if (level != input.level) {
+            input.level = level;
+            input.since_ms = now;
+        }
+        if (now - input.since_ms >= input.stable_ms) {
+            setReady(input, "stable");
+        } else if (timed_out) {
+            setReady(input, "still changing at the settle limit");
+        }
+    }
+    if (poll_event_ != nullptr && allReady()) {
+        sensesp::event_loop()->remove(poll_event_);
+        poll_event_ = nullptr;
+    }
+}
@@ -0,0 +1,65 @@
+// InputReadiness.h
+#ifndef INPUTREADINESS_H
+#define INPUTREADINESS_H
+
+#include <Arduino.h>
+#include <functional>
+
+#include "sensesp_app.h"
+
+/**
+ * Startup settling of the digital inputs, one input at a time.
+ *
+ * Right after boot a GPIO may still be floating up to its pull resistor, so
+ * its first edges are not real. An input is ready once it has read the same
+ * level for its stable window (its debounce time, at least MIN_STABLE_MS),
+ * polled every POLL_MS from the event loop. Until then main.cpp ignores it.
+ *
+ * Nothing waits past MAX_SETTLE_MS from start(), the fixed blackout this
+ * replaces: an input still changing by then is taken as live (a button held
+ * through the boot, a chain already running). markReady() skips the wait
+ * altogether - the hall sensor after a warm restart, when the position is
+ * known and the chain may still be coasting.
+ *
+ * Inputs are keyed by GPIO number.
+ */
+class InputReadiness {
+public:
+    static constexpr size_t MAX_INPUTS = 4;
+    static constexpr unsigned long POLL_MS = 5;
+    static constexpr unsigned long MIN_STABLE_MS = 20;
+    static constexpr unsigned long MAX_SETTLE_MS = 2000;
+
+    void add(const char* name, int gpio, unsigned long stable_ms);
+    void markReady(int gpio);
+    // Runs once, when the input becomes ready (at once if it already is)
+    void onReady(int gpio, std::function<void()> callback);
+
+    bool ready(int gpio) const;
+    bool allReady() const;
+
+    void start();      // Poll on the event loop until every input is ready
+    void poll();
+
+private:
+    struct Input {
+        const char* name;
+        int gpio;
+        unsigned long stable_ms;
+        int level;
+        unsigned long since_ms;          // Level unchanged since
+        bool ready;
+        std::function<void()> on_ready;
+    };
+
+    Input* find(int gpio);
+    const Input* find(int gpio) const;
+    void setReady(Input& input, const char* why);
+
+    Input inputs_[MAX_INPUTS] = {};
+    size_t count_ = 0;
+    unsigned long start_ms_ = 0;
+    reactesp::Event* poll_event_ = nullptr;
+};
+
+#endif // INPUTREADINESS_H
@@ -0,0 +1,226 @@
+#include "LogSink.h"
+#include <ctype.h>
+
+#if defined(CHAIN_LOG_UDP_HOST) && defined(CHAIN_LOG_UDP_PORT)
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#define CHAIN_LOG_UDP 1
+#endif
+
+namespace {
+
+constexpr char LEVEL_LETTERS[] = "NEWIDV";   // Indexed by esp_log_level_t
+
+#ifdef CHAIN_LOG_UDP
+WiFiUDP udp;
+#endif
+
+}  // namespace
+
+LogSink& LogSink::global() {
+    static LogSink sink;
+    return sink;
+}
+
+bool LogSink::start() {
+    if (task_ != nullptr) return true;
+    if (xTaskCreatePinnedToCore(taskMain, "LogSink", TASK_STACK_BYTES, this, TASK_PRIORITY,
+                                &task_, TASK_CORE) != pdPASS) {
+        task_ = nullptr;
+        ESP_LOGE(__FILE__, "LogSink: failed to create drain task, logging synchronously");
+        return false;
+    }
+    return true;
+}
+
+void LogSink::taskMain(void* arg) {
+    LogSink* sink = static_cast<LogSink*>(arg);
+    TickType_t lastWake = xTaskGetTickCount();
+    for (;;) {
+        sink->drain();
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(DRAIN_PERIOD_MS));
+    }
+}
+
+bool LogSink::admit(Site& site) {
+    if (site.min_interval_ms == 0) return true;
+    uint32_t now = millis();
+    if (site.seen && now - site.last_ms < site.min_interval_ms) {
+        site.suppressed++;
+        return false;
+    }
+    site.seen = true;
+    site.last_ms = now;
+    return true;
+}
+
+void LogSink::begin(Record& record, Site& site) {
+    record.site = &site;
+    record.ms = millis();
+    record.suppressed = site.suppressed;
+    site.suppressed = 0;
+    record.arg_count = 0;
+    record.text_used = 0;
+    record.text[TEXT_BYTES - 1] = '\0';   // Shared empty string once the text space runs out
+}
+
+void LogSink::encode(Record& record, int i, const char* value) {
+    if (value == nullptr) value = "(null)";
+    size_t room = TEXT_BYTES - 1 - record.text_used;
+    size_t n = strlen(value);
+    if (n > room) n = room;
+    record.types[i] = ARG_TEXT;
+    record.args[i].u = record.text_used;
+    if (room == 0) {
+        record.args[i].u = TEXT_BYTES - 1;
+        return;
+    }
+    memcpy(record.text + record.text_used, value, n);
+    record.text[record.text_used + n] = '\0';
+    size_t used = record.text_used + n + 1;
+    record.text_used = (uint8_t)(used < TEXT_BYTES - 1 ? used : TEXT_BYTES - 1);
+}
+
+void LogSink::commit(const Record& record) {
+    if (task_ == nullptr) {
+        write(record);
+        return;
+    }
+    portENTER_CRITICAL(&mux_);
+    if (head_ - tail_ < RING_SIZE) {
+        ring_[head_ & (RING_SIZE - 1)] = record;
+        head_++;
+    } else {
+        dropped_++;
+        dropped_total_++;
+    }
+    portEXIT_CRITICAL(&mux_);
+}
+
+size_t LogSink::pending() const {
+    return head_ - tail_;
+}
+
+size_t LogSink::drain(size_t max_records) {
+    size_t written = 0;
+    while (written < max_records) {
+        Record record;
+        uint32_t dropped = 0;
+        bool have = false;
+        portENTER_CRITICAL(&mux_);
+        if (tail_ != head_) {
+            record = ring_[tail_ & (RING_SIZE - 1)];
+            tail_++;
+            have = true;
+        }
+        dropped = dropped_;
+        dropped_ = 0;
+        portEXIT_CRITICAL(&mux_);
+
+        if (dropped > 0) {
+            char line[48];
+            snprintf(line, sizeof(line), "LogSink: %lu records dropped, ring full", (unsigned long)dropped);
+            output(ESP_LOG_WARN, millis(), __FILE__, line);
+        }
+        if (!have) break;
+        write(record);
+        written++;
+    }
+    return written;
+}
+
+void LogSink::write(const Record& record) {
+    char line[LINE_BYTES];
+    size_t n = format(record, line, sizeof(line));
+    if (record.suppressed > 0 && n < sizeof(line)) {
+        snprintf(line + n, sizeof(line) - n, " (+%lu suppressed)", (unsigned long)record.suppressed);
+    }
+    output(record.site->level, record.ms, record.site->tag, line);
+}
+
+// Re-runs the site's format one conversion at a time against the recorded
+// arguments. The length modifier in the format is replaced by the width the
+// argument was recorded at, so "%d", "%ld" and "%u" all take the stored
+// 64-bit value.
+size_t LogSink::format(const Record& record, char* out, size_t len) const {
+    const char* f = record.site->format;
+    size_t n = 0;
+    int arg = 0;
+    while (*f != '\0' && n + 1 < len) {
+        if (*f != '%') {
+            out[n++] = *f++;
+            continue;
+        }
+        if (f[1] == '%') {
+            out[n++] = '%';
+            f += 2;
+            continue;
+        }
+
+        char spec[24];
+        size_t s = 0;
+        spec[s++] = *f++;
+        while (*f != '\0' && strchr("-+ #0", *f) != nullptr && s < 12) spec[s++] = *f++;
+        while (*f != '\0' && (isdigit((unsigned char)*f) || *f == '.') && s < 16) spec[s++] = *f++;
+        while (*f != '\0' && strchr("hlLqjzt", *f) != nullptr) f++;
+        char conv = *f;
+        if (conv == '\0' || arg >= record.arg_count) break;
+        f++;
+
+        const uint8_t type = record.types[arg];
+        const auto& value = record.args[arg];
+        arg++;
+
+        long long as_int = type == ARG_DOUBLE ? (long long)value.d : value.i;
+        double as_double = type == ARG_DOUBLE ? value.d
+                         : type == ARG_UINT   ? (double)value.u
+                                              : (double)value.i;
+        int written = 0;
+        switch (conv) {
+            case 'd':
+            case 'i':
+                spec[s++] = 'l'; spec[s++] = 'l'; spec[s++] = 'd'; spec[s] = '\0';
+                written = snprintf(out + n, len - n, spec, as_int);
+                break;
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+                spec[s++] = 'l'; spec[s++] = 'l'; spec[s++] = conv; spec[s] = '\0';
+                written = snprintf(out + n, len - n, spec, (unsigned long long)as_int);
+                break;
+            case 'c':
+                spec[s++] = 'c'; spec[s] = '\0';
+                written = snprintf(out + n, len - n, spec, (int)as_int);
+                break;
+            case 's':
+                spec[s++] = 's'; spec[s] = '\0';
+                written = snprintf(out + n, len - n, spec,
+                                   type == ARG_TEXT ? record.text + value.u : "?");
+                break;
+            case 'p':
+                spec[s++] = 'p'; spec[s] = '\0';
+                written = snprintf(out + n, len - n, spec, type == ARG_POINTER ? value.p : nullptr);
+                break;
+            default:   // f F e E g G a A
+                spec[s++] = conv; spec[s] = '\0';
+                written = snprintf(out + n, len - n, spec, as_double);
+                break;
+        }
+        if (written > 0) n += (size_t)written < len - n ? (size_t)written : len - n - 1;
+    }
+    out[n] = '\0';
+    return n;
+}
+
+void LogSink::output(esp_log_level_t level, uint32_t ms, const char* tag, const char* line) {
+    // Same layout as ESP_LOGx with USE_ESP_IDF_LOG, which scripts/ parse
+    const char letter = LEVEL_LETTERS[level <= ESP_LOG_VERBOSE ? level : ESP_LOG_VERBOSE];
+    esp_log_write(level, tag, "%c (%lu) %s: %s\n", letter, (unsigned long)ms, tag, line);
+#ifdef CHAIN_LOG_UDP
+    if (WiFi.status() == WL_CONNECTED && udp.beginPacket(CHAIN_LOG_UDP_HOST, CHAIN_LOG_UDP_PORT)) {
+        udp.printf("%c (%lu) %s: %s\n", letter, (unsigned long)ms, tag, line);
+        udp.endPacket();
+    }
+#endif
+}
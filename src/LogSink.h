@@ -0,0 +1,167 @@
+// LogSink.h
+#ifndef LOGSINK_H
+#define LOGSINK_H
+
+#include <Arduino.h>
+#include <esp_log.h>
+#include <type_traits>
+
+/**
+ * Deferred log output for the hot paths.
+ *
+ * SINK_LOGx(tag, format, ...) has the signature of ESP_LOGx, but the caller
+ * only copies a pointer to its call site (level, tag, format - all static)
+ * and the raw arguments into a RAM ring. A low-priority task formats the
+ * records and writes them with esp_log_write, in the same "I (ms) tag: text"
+ * form ESP_LOGx prints, stamped with the time the record was made - so the
+ * serial monitor, the log files and the scripts/analyze-*.sh tooling see the
+ * same lines as before. The caller never formats and never waits on the
+ * UART.
+ *
+ * SINK_LOGx_EVERY(ms, tag, format, ...) also rate-limits the site: records
+ * closer together than ms are counted, not queued, and the next record that
+ * is queued says how many were suppressed.
+ *
+ * String arguments are copied into the record (TEXT_BYTES in total, then
+ * truncated), so temporaries like String::c_str() are safe. When the ring
+ * is full the record is dropped and counted; the drain reports the count.
+ * Before start() (early boot, and host tests) records are written on the
+ * spot, exactly like ESP_LOGx.
+ *
+ * With CHAIN_LOG_UDP_HOST and CHAIN_LOG_UDP_PORT defined, every line is
+ * also sent as a UDP datagram while WiFi is up (see
+ * scripts/capture-udp-log.sh).
+ */
+class LogSink {
+public:
+    struct Site {
+        esp_log_level_t level;
+        const char* tag;
+        const char* format;
+        uint32_t min_interval_ms;   // 0 = every record
+        uint32_t last_ms;           // Rate limiter state
+        uint32_t suppressed;
+        bool seen;
+    };
+
+    static constexpr int MAX_ARGS = 8;
+    static constexpr size_t TEXT_BYTES = 64;       // Copied string arguments per record
+    static constexpr size_t RING_SIZE = 32;        // Records, power of two
+    static constexpr size_t LINE_BYTES = 256;      // Formatted line, longer ones are truncated
+    static constexpr unsigned long DRAIN_PERIOD_MS = 10;
+    static constexpr UBaseType_t TASK_PRIORITY = 1;        // Just above idle
+    static constexpr BaseType_t TASK_CORE = 0;             // Away from the event loop
+    static constexpr uint32_t TASK_STACK_BYTES = 4096;
+
+    static LogSink& global();
+
+    bool start();                       // Create the drain task
+    bool started() const { return task_ != nullptr; }
+
+    template <typename... Args>
+    void post(Site& site, Args... args) {
+        static_assert(sizeof...(Args) <= MAX_ARGS, "too many log arguments");
+        if (!admit(site)) return;
+        Record record;
+        begin(record, site);
+        int index = 0;
+        int expand[] = {0, (encode(record, index++, args), 0)...};
+        (void)expand;
+        record.arg_count = (uint8_t)index;
+        commit(record);
+    }
+
+    size_t drain(size_t max_records = RING_SIZE);   // Format and write queued records; returns how many
+    uint32_t dropped() const { return dropped_total_; }
+    size_t pending() const;
+
+    // Compile-time printf checking for the SINK_LOGx macros
+    __attribute__((format(printf, 1, 2))) static inline void checkFormat(const char*, ...) {}
+
+private:
+    enum ArgType : uint8_t { ARG_INT, ARG_UINT, ARG_DOUBLE, ARG_TEXT, ARG_POINTER };
+
+    struct Record {
+        const Site* site;
+        uint32_t ms;
+        uint32_t suppressed;
+        uint8_t arg_count;
+        uint8_t text_used;
+        uint8_t types[MAX_ARGS];
+        union {
+            long long i;
+            unsigned long long u;
+            double d;
+            const void* p;
+        } args[MAX_ARGS];
+        char text[TEXT_BYTES];
+    };
+
+    LogSink() = default;
+
+    static void taskMain(void* arg);
+    bool admit(Site& site);
+    void begin(Record& record, Site& site);
+    void commit(const Record& record);
+    void write(const Record& record);
+    size_t format(const Record& record, char* out, size_t len) const;
+    void output(esp_log_level_t level, uint32_t ms, const char* tag, const char* line);
+
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+    encode(Record& record, int i, T value) {
+        record.types[i] = ARG_INT;
+        record.args[i].i = value;
+    }
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type
+    encode(Record& record, int i, T value) {
+        record.types[i] = ARG_UINT;
+        record.args[i].u = value;
+    }
+    template <typename T>
+    typename std::enable_if<std::is_enum<T>::value>::type
+    encode(Record& record, int i, T value) {
+        record.types[i] = ARG_INT;
+        record.args[i].i = (long long)value;
+    }
+    void encode(Record& record, int i, double value) {
+        record.types[i] = ARG_DOUBLE;
+        record.args[i].d = value;
+    }
+    void encode(Record& record, int i, const char* value);
+    void encode(Record& record, int i, char* value) { encode(record, i, (const char*)value); }
+    void encode(Record& record, int i, const void* value) {
+        record.types[i] = ARG_POINTER;
+        record.args[i].p = value;
+    }
+
+    Record ring_[RING_SIZE];
+    size_t head_ = 0;                   // Next slot to write (producers, under mux_)
+    size_t tail_ = 0;                   // Next slot to drain (drain task only)
+    uint32_t dropped_ = 0;              // Since the last drain report
+    uint32_t dropped_total_ = 0;
+    portMUX_TYPE mux_ = portMUX_INITIALIZER_UNLOCKED;
+    TaskHandle_t task_ = nullptr;
+};
+
+#define SINK_LOG_SITE(level, interval_ms, tag, format, ...) do { \
+        if ((level) <= LOG_LOCAL_LEVEL) { \
+            if (false) LogSink::checkFormat(format, ##__VA_ARGS__); \
+            static LogSink::Site sink_site_ = {level, tag, format, interval_ms, 0, 0, false}; \
+            LogSink::global().post(sink_site_, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+#define SINK_LOGE(tag, format, ...) SINK_LOG_SITE(ESP_LOG_ERROR, 0, tag, format, ##__VA_ARGS__)
+#define SINK_LOGW(tag, format, ...) SINK_LOG_SITE(ESP_LOG_WARN, 0, tag, format, ##__VA_ARGS__)
+#define SINK_LOGI(tag, format, ...) SINK_LOG_SITE(ESP_LOG_INFO, 0, tag, format, ##__VA_ARGS__)
+#define SINK_LOGD(tag, format, ...) SINK_LOG_SITE(ESP_LOG_DEBUG, 0, tag, format, ##__VA_ARGS__)
+#define SINK_LOGV(tag, format, ...) SINK_LOG_SITE(ESP_LOG_VERBOSE, 0, tag, format, ##__VA_ARGS__)
+
+#define SINK_LOGE_EVERY(ms, tag, format, ...) SINK_LOG_SITE(ESP_LOG_ERROR, ms, tag, format, ##__VA_ARGS__)
+#define SINK_LOGW_EVERY(ms, tag, format, ...) SINK_LOG_SITE(ESP_LOG_WARN, ms, tag, format, ##__VA_ARGS__)
+#define SINK_LOGI_EVERY(ms, tag, format, ...) SINK_LOG_SITE(ESP_LOG_INFO, ms, tag, format, ##__VA_ARGS__)
+#define SINK_LOGD_EVERY(ms, tag, format, ...) SINK_LOG_SITE(ESP_LOG_DEBUG, ms, tag, format, ##__VA_ARGS__)
+
+#endif // LOGSINK_H
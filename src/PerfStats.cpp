@@ -0,0 +1,100 @@
+#include "PerfStats.h"
+
+namespace {
+
+PerfHistogram histograms[(int)PerfSite::COUNT];
+
+const char* const SITE_NAMES[(int)PerfSite::COUNT] = {
+    "counterHandler",
+    "windlassTick",
+    "slack",
+    "nvsSave",
+    "command",
+    "loopLag",
+};
+
+}  // namespace
+
+int PerfHistogram::bucketFor(uint32_t cycles) {
+    if (cycles < (1u << FIRST_BUCKET_BITS)) return 0;
+    int bits = 32 - __builtin_clz(cycles);   // 2^(bits-1) <= cycles < 2^bits
+    int bucket = bits - FIRST_BUCKET_BITS;
+    return bucket < BUCKETS ? bucket : BUCKETS - 1;
+}
+
+uint32_t PerfHistogram::bucketUpperEdge(int bucket) {
+    if (bucket >= BUCKETS - 1) return UINT32_MAX;
+    return (1u << (bucket + FIRST_BUCKET_BITS)) - 1;
+}
+
+void PerfHistogram::record(uint32_t cycles) {
+    if (reset_requested_.load(std::memory_order_acquire)) {
+        reset_requested_.store(false, std::memory_order_relaxed);
+        memset(buckets_, 0, sizeof(buckets_));
+        count_ = 0;
+        max_ = 0;
+        total_ = 0;
+    }
+    buckets_[bucketFor(cycles)]++;
+    count_++;
+    total_ += cycles;
+    if (cycles > max_) max_ = cycles;
+}
+
+uint32_t PerfHistogram::percentile(uint32_t count, uint32_t per_mille) const {
+    if (count == 0) return 0;
+    // Rank of the sample at the percentile, rounded up (1-based)
+    uint64_t rank = ((uint64_t)count * per_mille + 999) / 1000;
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += buckets_[i];
+        if (seen >= rank) return bucketUpperEdge(i);
+    }
+    return bucketUpperEdge(BUCKETS - 1);
+}
+
+PerfHistogram::Summary PerfHistogram::summary() const {
+    Summary s = {};
+    s.count = count_;
+    s.max_cycles = max_;
+    s.total_cycles = total_;
+    s.p50_cycles = percentile(s.count, 500);
+    s.p99_cycles = percentile(s.count, 990);
+    // The edge of the top bucket is open; the max is the better bound there
+    if (s.p50_cycles > s.max_cycles) s.p50_cycles = s.max_cycles;
+    if (s.p99_cycles > s.max_cycles) s.p99_cycles = s.max_cycles;
+    return s;
+}
+
+namespace perf {
+
+PerfHistogram& site(PerfSite site) {
+    return histograms[(int)site];
+}
+
+const char* siteName(PerfSite site) {
+    return SITE_NAMES[(int)site];
+}
+
+uint32_t cyclesToMicros(uint32_t cycles) {
+    uint32_t mhz = ESP.getCpuFreqMHz();
+    return mhz > 0 ? (uint32_t)(((uint64_t)cycles + mhz - 1) / mhz) : cycles;  // Rounded up, like the bucket edges
+}
+
+uint32_t microsToCycles(uint32_t us) {
+    uint64_t cycles = (uint64_t)us * ESP.getCpuFreqMHz();
+    return cycles < UINT32_MAX ? (uint32_t)cycles : UINT32_MAX;
+}
+
+String summaryText(PerfSite which) {
+    PerfHistogram::Summary s = site(which).summary();
+    char buf[64];
+    snprintf(buf, sizeof(buf), "n=%lu p50=%lu p99=%lu max=%lu us",
+             (unsigned long)s.count,
+             (unsigned long)cyclesToMicros(s.p50_cycles),
+             (unsigned long)cyclesToMicros(s.p99_cycles),
+             (unsigned long)cyclesToMicros(s.max_cycles));
+    return String(buf);
+}
+
+}  // namespace perf
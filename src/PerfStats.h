@@ -0,0 +1,103 @@
+// PerfStats.h
+#ifndef PERFSTATS_H
+#define PERFSTATS_H
+
+#include <Arduino.h>
+#include <atomic>
+
+/**
+ * Latency histograms for the hot paths, in CPU cycles.
+ *
+ * Each instrumented site has a fixed histogram of power-of-two buckets plus
+ * a count, total and max. PERF_SCOPE(site) times the rest of the enclosing
+ * block with the cycle counter; PERF_RECORD_US(site, us) adds a duration
+ * measured some other way (event-loop lag).
+ *
+ * Every site must be recorded from one task only (its single writer). Any
+ * task may read a summary; reads are plain 32-bit loads, so a summary taken
+ * while the writer records can be one sample out, which a periodic report
+ * does not care about. reset() only raises a flag - the writer clears the
+ * histogram before its next sample.
+ *
+ * Build with -D CHAIN_PERF=0 to compile the macros to nothing.
+ */
+#ifndef CHAIN_PERF
+#define CHAIN_PERF 1
+#endif
+
+enum class PerfSite : uint8_t {
+    COUNTER_HANDLER,   // GPIO-interrupt pulse counting (PulseCounter::onEdge)
+    WINDLASS_TICK,     // One WindlassCore tick (commands, counting, control)
+    SLACK,             // calculateAndPublishHorizontalSlack
+    NVS_SAVE,          // Speed/coast Preferences writes and journal commits
+    COMMAND,           // Signal K command dispatch
+    LOOP_LAG,          // Event loop lateness against a fixed-rate probe
+    COUNT
+};
+
+class PerfHistogram {
+public:
+    static constexpr int BUCKETS = 20;
+    static constexpr int FIRST_BUCKET_BITS = 8;   // Bucket 0: < 256 cycles; bucket 19: >= 2^26
+
+    struct Summary {
+        uint32_t count;
+        uint32_t p50_cycles;   // Upper edge of the bucket holding the percentile
+        uint32_t p99_cycles;
+        uint32_t max_cycles;
+        uint64_t total_cycles;
+    };
+
+    void record(uint32_t cycles);
+    Summary summary() const;
+    uint32_t bucketCount(int bucket) const { return buckets_[bucket]; }
+    void reset() { reset_requested_.store(true, std::memory_order_release); }
+
+    static int bucketFor(uint32_t cycles);
+    static uint32_t bucketUpperEdge(int bucket);
+
+private:
+    uint32_t percentile(uint32_t count, uint32_t per_mille) const;
+
+    uint32_t buckets_[BUCKETS] = {};
+    uint32_t count_ = 0;
+    uint32_t max_ = 0;
+    uint64_t total_ = 0;
+    std::atomic<bool> reset_requested_{false};
+};
+
+namespace perf {
+
+PerfHistogram& site(PerfSite site);
+const char* siteName(PerfSite site);    // Signal K path segment
+
+inline uint32_t cycles() { return ESP.getCycleCount(); }
+uint32_t cyclesToMicros(uint32_t cycles);
+uint32_t microsToCycles(uint32_t us);
+
+// "n=600 p50=16 p99=64 max=81 us" - p50/p99 are bucket upper edges
+String summaryText(PerfSite which);
+
+class Scope {
+public:
+    explicit Scope(PerfSite site) : site_(site), start_(cycles()) {}
+    ~Scope() { perf::site(site_).record(cycles() - start_); }
+
+private:
+    PerfSite site_;
+    uint32_t start_;
+};
+
+}  // namespace perf
+
+#if CHAIN_PERF
+#define PERF_CONCAT_INNER(a, b) a##b
+#define PERF_CONCAT(a, b) PERF_CONCAT_INNER(a, b)
+#define PERF_SCOPE(which) perf::Scope PERF_CONCAT(perf_scope_, __LINE__)(which)
+#define PERF_RECORD_US(which, us) perf::site(which).record(perf::microsToCycles(us))
+#else
+#define PERF_SCOPE(which) ((void)0)
+#define PERF_RECORD_US(which, us) ((void)0)
+#endif
+
+#endif // PERFSTATS_H
@@ -0,0 +1,192 @@
+#include "PositionJournal.h"
+#include <Arduino.h>
+#include <Preferences.h>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include "PerfStats.h"
+
+PositionJournal::PositionJournal(float meters_per_pulse, const char* partition_label,
+                                 const char* prefs_namespace)
+  : meters_per_pulse_(meters_per_pulse),
+    partition_label_(partition_label),
+    prefs_namespace_(prefs_namespace) {}
+
+// ============================================================================
+// Record helpers
+// ============================================================================
+
+uint32_t PositionJournal::crc32(const uint8_t* data, size_t len) {
+    // Bitwise CRC-32 (IEEE) - records are 12 bytes, a table is not worth the RAM
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+bool PositionJournal::isValid(const Record& rec) {
+    if (rec.seq == 0 || rec.seq == 0xFFFFFFFF) return false;  // Erased or never written
+    return rec.crc == crc32(reinterpret_cast<const uint8_t*>(&rec), offsetof(Record, crc));
+}
+
+int32_t PositionJournal::legacyPreferencesPulses() const {
+    Preferences prefs;
+    prefs.begin(prefs_namespace_, true);  // true = read only
+    int32_t pulses;
+    if (prefs.isKey("pulses")) {
+        pulses = prefs.getInt("pulses", 0);
+    } else {
+        pulses = (int32_t)lround(prefs.getFloat("length", 0.0) / meters_per_pulse_);
+    }
+    prefs.end();
+    return pulses;
+}
+
+// ============================================================================
+// Recovery
+// ============================================================================
+
+bool PositionJournal::begin() {
+    partition_ = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                          partition_label_);
+    if (partition_ == nullptr) {
+        ESP_LOGW(__FILE__, "PositionJournal: no '%s' partition, falling back to Preferences", partition_label_);
+        recovered_pulses_ = legacyPreferencesPulses();
+        recovered_ = true;
+        committed_pulses_ = recovered_pulses_;
+        return true;
+    }
+
+    slot_count_ = (partition_->size / SECTOR_SIZE) * RECORDS_PER_SECTOR;
+    if (slot_count_ < 2 * RECORDS_PER_SECTOR) {
+        ESP_LOGE(__FILE__, "PositionJournal: partition '%s' too small (%u bytes), need 2 sectors",
+                 partition_label_, (unsigned)partition_->size);
+        partition_ = nullptr;
+        return false;
+    }
+
+    // Scan in small chunks (keeps the setup() stack small) for the highest valid sequence number
+    Record chunk[SCAN_CHUNK_RECORDS];
+    uint32_t best_seq = 0;
+    size_t best_slot = 0;
+    for (size_t base = 0; base < slot_count_; base += SCAN_CHUNK_RECORDS) {
+        if (esp_partition_read(partition_, base * sizeof(Record), chunk, sizeof(chunk)) != ESP_OK) {
+            ESP_LOGE(__FILE__, "PositionJournal: read failed at slot %u", (unsigned)base);
+            continue;
+        }
+        for (size_t i = 0; i < SCAN_CHUNK_RECORDS; i++) {
+            if (isValid(chunk[i]) && chunk[i].seq > best_seq) {
+                best_seq = chunk[i].seq;
+                best_slot = base + i;
+                recovered_pulses_ = chunk[i].pulses;
+            }
+        }
+    }
+
+    if (best_seq > 0) {
+        recovered_ = true;
+        next_seq_ = best_seq + 1;
+        next_slot_ = (best_slot + 1) % slot_count_;
+        ESP_LOGI(__FILE__, "PositionJournal: recovered %ld pulses / %.2fm (seq %lu, slot %u/%u)",
+                 (long)recovered_pulses_, recovered_pulses_ * meters_per_pulse_,
+                 (unsigned long)best_seq, (unsigned)best_slot, (unsigned)slot_count_);
+    } else {
+        // Empty journal - migrate the last position from the legacy Preferences key
+        recovered_pulses_ = legacyPreferencesPulses();
+        recovered_ = true;
+        next_seq_ = 1;
+        next_slot_ = 0;
+        ESP_LOGI(__FILE__, "PositionJournal: empty journal, migrated %ld pulses from Preferences",
+                 (long)recovered_pulses_);
+    }
+    committed_pulses_ = recovered_pulses_;
+    return true;
+}
+
+// ============================================================================
+// Writing
+// ============================================================================
+
+void PositionJournal::record(int32_t pulses) {
+    pending_pulses_ = pulses;
+    has_pending_ = true;
+}
+
+bool PositionJournal::commit(bool forced) {
+    if (!has_pending_) return true;
+    has_pending_ = false;
+    if (pending_pulses_ == committed_pulses_) return true;  // Nothing moved since last write
+
+    float delta = abs(pending_pulses_ - committed_pulses_) * meters_per_pulse_;
+    bool ok;
+    {
+        PERF_SCOPE(PerfSite::NVS_SAVE);
+        ok = (partition_ != nullptr) ? writeRecord(pending_pulses_) : writePreferences(pending_pulses_);
+    }
+    if (!ok) {
+        has_pending_ = true;  // Retry on the next commit
+        return false;
+    }
+
+    committed_pulses_ = pending_pulses_;
+    write_count_++;
+    float length = committed_pulses_ * meters_per_pulse_;
+    if (forced) {
+        ESP_LOGD(__FILE__, "Chain position force-saved: %.2fm (SPIFFS writes: %lu)", length, write_count_);
+    } else {
+        ESP_LOGD(__FILE__, "Chain position saved: %.2fm (delta: %.2fm, SPIFFS writes: %lu)",
+                 length, delta, write_count_);
+    }
+    return true;
+}
+
+bool PositionJournal::writeRecord(int32_t pulses) {
+    // Erase a sector only when the write pointer enters it; the other sectors
+    // still hold the most recent records in case this write is interrupted.
+    if (next_slot_ % RECORDS_PER_SECTOR == 0) {
+        if (esp_partition_erase_range(partition_, next_slot_ * sizeof(Record), SECTOR_SIZE) != ESP_OK) {
+            ESP_LOGE(__FILE__, "PositionJournal: erase failed at slot %u", (unsigned)next_slot_);
+            return false;
+        }
+    }
+
+    Record rec = {};
+    rec.seq = next_seq_;
+    rec.pulses = pulses;
+    rec.reserved = 0;
+    rec.crc = crc32(reinterpret_cast<const uint8_t*>(&rec), offsetof(Record, crc));
+
+    if (esp_partition_write(partition_, next_slot_ * sizeof(Record), &rec, sizeof(rec)) != ESP_OK) {
+        ESP_LOGE(__FILE__, "Failed to write chain position to journal slot %u", (unsigned)next_slot_);
+        return false;
+    }
+    next_seq_++;
+    next_slot_ = (next_slot_ + 1) % slot_count_;
+    return true;
+}
+
+bool PositionJournal::writePreferences(int32_t pulses) {
+    Preferences prefs;
+    if (!prefs.begin(prefs_namespace_, false)) {
+        ESP_LOGE(__FILE__, "Failed to open NVS namespace '%s' for writing", prefs_namespace_);
+        return false;
+    }
+    size_t written = prefs.putInt("pulses", pulses);
+    prefs.end();
+    if (written == 0) {
+        ESP_LOGE(__FILE__, "Failed to write chain position to NVS");
+        return false;
+    }
+    return true;
+}
+
+void PositionJournal::startDeferredCommits(unsigned long interval_ms) {
+    if (commitEvent_ != nullptr) {
+        sensesp::event_loop()->remove(commitEvent_);
+    }
+    commitEvent_ = sensesp::event_loop()->onRepeat(interval_ms, [this]() { commit(); });
+}
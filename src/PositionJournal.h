@@ -0,0 +1,89 @@
+// PositionJournal.h
+#ifndef POSITIONJOURNAL_H
+#define POSITIONJOURNAL_H
+
+#include <Arduino.h>
+#include <esp_partition.h>
+
+#include "sensesp_app.h"
+
+/**
+ * Wear-levelled chain position journal.
+ *
+ * Fixed-size records (sequence number, pulse count, CRC) are appended round-robin
+ * across a dedicated "chainlog" data partition. A sector is erased only when
+ * the write pointer wraps onto it, so each record costs one small flash
+ * program instead of an NVS commit. At boot the partition is scanned and the
+ * valid record with the highest sequence number wins, so a power cut during
+ * a write loses at most that one record.
+ *
+ * The pulse path only calls record(), which stores the value in RAM. The
+ * flash write happens from a deferred event-loop timer (or commit() on stop).
+ *
+ * If the partition table has no "chainlog" partition (e.g. the 8MB HALMET
+ * layout) the journal falls back to the legacy Preferences "chain"/"length"
+ * key, so position is still kept. A second windlass names its own partition
+ * and namespace (see WindlassUnit.cpp); without that partition it keeps its
+ * position in NVS.
+ *
+ * The journal stores the gypsy pulse count, not meters, so a changed gypsy
+ * circumference re-scales the restored length. Meters are only needed to
+ * migrate the legacy Preferences "length" key and for log output.
+ */
+class PositionJournal {
+public:
+    explicit PositionJournal(float meters_per_pulse, const char* partition_label = "chainlog",
+                             const char* prefs_namespace = "chain");
+
+    bool begin();                       // Locate partition and recover the latest record
+    bool hasRecovered() const { return recovered_; }
+    int32_t recoveredPulses() const { return recovered_pulses_; }
+
+    void record(int32_t pulses);        // Cheap - safe to call on every pulse
+    bool commit(bool forced = false);   // Write the pending record now (no-op if unchanged)
+    void startDeferredCommits(unsigned long interval_ms = COMMIT_INTERVAL_MS);
+
+    bool usingPartition() const { return partition_ != nullptr; }
+    unsigned long writeCount() const { return write_count_; }
+
+    static constexpr unsigned long COMMIT_INTERVAL_MS = 2000;  // Max position age lost on power cut
+
+private:
+    struct Record {
+        uint32_t seq;
+        int32_t pulses;
+        uint32_t reserved;       // 0; keeps a record 16 bytes so none straddles a sector
+        uint32_t crc;
+    };
+    static_assert(sizeof(Record) == 16, "Journal records must stay 16 bytes");
+
+    static uint32_t crc32(const uint8_t* data, size_t len);
+    static bool isValid(const Record& rec);
+    int32_t legacyPreferencesPulses() const;
+    bool writeRecord(int32_t pulses);
+    bool writePreferences(int32_t pulses);
+
+    float meters_per_pulse_;
+    const char* partition_label_;
+    const char* prefs_namespace_;
+    const esp_partition_t* partition_ = nullptr;
+    size_t slot_count_ = 0;
+    size_t next_slot_ = 0;
+    uint32_t next_seq_ = 1;
+
+    bool recovered_ = false;
+    int32_t recovered_pulses_ = 0;
+
+    int32_t pending_pulses_ = 0;
+    int32_t committed_pulses_ = 0;
+    bool has_pending_ = false;
+    unsigned long write_count_ = 0;
+
+    reactesp::Event* commitEvent_ = nullptr;
+
+    static constexpr size_t SECTOR_SIZE = 4096;
+    static constexpr size_t RECORDS_PER_SECTOR = SECTOR_SIZE / sizeof(Record);
+    static constexpr size_t SCAN_CHUNK_RECORDS = 16;
+};
+
+#endif // POSITIONJOURNAL_H
@@ -0,0 +1,77 @@
+#include "PositionSnapshot.h"
+#include <cstddef>
+
+namespace {
+
+struct Slot {
+    uint32_t magic;
+    uint32_t seq;
+    int32_t pulses;
+    uint8_t motion;
+    uint8_t reserved[3];
+    uint32_t checksum;         // FNV-1a over everything above
+};
+
+// Left alone by the bootloader on anything but a power-on reset
+RTC_NOINIT_ATTR Slot slots[PositionSnapshot::UNITS][2];
+
+// Next sequence number. The first write after a reset carries on from the
+// restored slot, so the slot it leaves alone can never look newer.
+uint32_t next_seq[PositionSnapshot::UNITS] = {};
+bool seq_started[PositionSnapshot::UNITS] = {};
+
+uint32_t checksumOf(const Slot& slot) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&slot);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < offsetof(Slot, checksum); i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+}  // namespace
+
+void PositionSnapshot::write(int32_t pulses, ChainState motion, uint8_t unit) {
+    if (unit >= UNITS) return;
+    if (!seq_started[unit]) {
+        State last;
+        next_seq[unit] = read(&last, unit) ? last.seq + 1 : 0;
+        seq_started[unit] = true;
+    }
+    Slot& slot = slots[unit][next_seq[unit] & 1];
+    slot.magic = MAGIC;
+    slot.seq = next_seq[unit];
+    slot.pulses = pulses;
+    slot.motion = (uint8_t)motion;
+    slot.reserved[0] = slot.reserved[1] = slot.reserved[2] = 0;
+    slot.checksum = checksumOf(slot);
+    next_seq[unit]++;
+}
+
+bool PositionSnapshot::read(State* state, uint8_t unit) {
+    if (unit >= UNITS) return false;
+    const Slot* newest = nullptr;
+    for (const Slot& slot : slots[unit]) {
+        if (slot.magic != MAGIC || slot.checksum != checksumOf(slot) ||
+            slot.motion > (uint8_t)ChainState::RAISING) {
+            continue;
+        }
+        // Seqs wrap like millis(): the newer one is ahead by less than half the range
+        if (newest == nullptr || (int32_t)(slot.seq - newest->seq) > 0) {
+            newest = &slot;
+        }
+    }
+    if (newest == nullptr) return false;
+    state->pulses = newest->pulses;
+    state->motion = (ChainState)newest->motion;
+    state->seq = newest->seq;
+    return true;
+}
+
+void PositionSnapshot::clear() {
+    memset(slots, 0, sizeof(slots));
+    for (uint8_t unit = 0; unit < UNITS; unit++) {
+        next_seq[unit] = 0;
+        seq_started[unit] = true;
+    }
+}
@@ -0,0 +1,48 @@
+// PositionSnapshot.h
+#ifndef POSITIONSNAPSHOT_H
+#define POSITIONSNAPSHOT_H
+
+#include <Arduino.h>
+#include "ChainTypes.h"
+
+/**
+ * Warm-restart copy of the windlass position in RTC slow memory.
+ *
+ * The windlass task writes its pulse count and motion state here whenever
+ * either changes - a few words, no flash. RTC_NOINIT memory keeps its
+ * contents through a software, watchdog, panic or brownout reset (as long as
+ * the supply held up for the RTC domain), so after such a reset setup() can
+ * take the position from here instead of the journal, which may be up to
+ * PositionJournal::COMMIT_INTERVAL_MS behind.
+ *
+ * Two slots are written in turn, each with a sequence number and a checksum,
+ * so a reset in the middle of a write leaves the previous slot good. After a
+ * power-on reset the memory is random; the checksums reject it and read()
+ * reports nothing.
+ *
+ * Each windlass on the board (see WindlassUnit.h) has its own pair of
+ * slots, selected by its unit index.
+ */
+class PositionSnapshot {
+public:
+    struct State {
+        int32_t pulses;
+        ChainState motion;         // What the windlass was doing at the reset
+        uint32_t seq;              // Writes since the snapshot was (re)started
+    };
+
+    static constexpr uint8_t UNITS = 2;   // Windlasses with a snapshot
+
+    // Windlass task only - a single writer per unit
+    static void write(int32_t pulses, ChainState motion, uint8_t unit = 0);
+
+    // Newest valid slot; false if there is none (power-on reset, first boot)
+    static bool read(State* state, uint8_t unit = 0);
+
+    static void clear();   // Every unit
+
+private:
+    static constexpr uint32_t MAGIC = 0x52544350;   // "RTCP"
+};
+
+#endif // POSITIONSNAPSHOT_H
@@ -0,0 +1,151 @@
+#include "PowerManager.h"
+
+#include <driver/rtc_io.h>
+#include <esp_idf_version.h>
+#include <esp_sleep.h>
+#include <esp_wifi.h>
+#include <soc/soc_caps.h>
+
+#include "sensesp_app.h"
+#include "SetupArena.h"
+
+#if defined(SOC_RTCIO_WAKE_SUPPORTED) && SOC_RTCIO_WAKE_SUPPORTED
+#define CHAIN_RTCIO_WAKE 1
+#else
+#define CHAIN_RTCIO_WAKE 0
+#endif
+
+namespace {
+
+constexpr int MIN_CPU_MHZ = 80;   // Lowest clock that keeps the APB (WiFi, PCNT) at 80 MHz
+
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+using PmConfig = esp_pm_config_t;
+#elif CONFIG_IDF_TARGET_ESP32C3
+using PmConfig = esp_pm_config_esp32c3_t;
+#else
+using PmConfig = esp_pm_config_esp32_t;
+#endif
+
+}  // namespace
+
+PowerManager::PowerManager(std::function<bool()> busy, const Config& config)
+  : busy_(busy),
+    config_(config),
+    mode_(SetupArena::make<EnumValue<PowerMode>>(PowerMode::ACTIVE)) {}
+
+void PowerManager::addWakePin(int gpio, bool required) {
+#if CHAIN_RTCIO_WAKE
+    if (rtc_gpio_is_valid_gpio((gpio_num_t)gpio)) {
+        wake_pins_.push_back(gpio);
+        return;
+    }
+#endif
+    ESP_LOGW(__FILE__, "PowerManager: GPIO %d cannot wake the chip from light sleep%s", gpio,
+             required ? " - light sleep disabled" : "");
+    if (required) {
+        wake_pins_ok_ = false;
+    }
+}
+
+void PowerManager::begin() {
+    PmConfig pm_config = {};
+    pm_config.max_freq_mhz = getCpuFrequencyMhz();
+    pm_config.min_freq_mhz = MIN_CPU_MHZ;
+    pm_config.light_sleep_enable = config_.lightSleep && wake_pins_ok_;
+    esp_err_t err = esp_pm_configure(&pm_config);
+    if (err == ESP_ERR_NOT_SUPPORTED && pm_config.light_sleep_enable) {
+        // Built without tickless idle - frequency scaling only
+        pm_config.light_sleep_enable = false;
+        err = esp_pm_configure(&pm_config);
+    }
+    pm_ = err == ESP_OK;
+    light_sleep_ = pm_ && pm_config.light_sleep_enable;
+    if (pm_) {
+        esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "chain_cpu", &cpu_lock_);
+        esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "chain_awake", &sleep_lock_);
+        esp_pm_lock_acquire(cpu_lock_);
+        esp_pm_lock_acquire(sleep_lock_);
+    }
+    if (light_sleep_) {
+        esp_sleep_enable_gpio_wakeup();
+    }
+    ESP_LOGI(__FILE__, "PowerManager: anchor watch after %lu s idle, %d-%d MHz, light sleep %s%s",
+             config_.idleMs / 1000, MIN_CPU_MHZ, (int)pm_config.max_freq_mhz, light_sleep_ ? "on" : "off",
+             pm_ ? "" : " (power management not in this build)");
+
+    last_activity_ms_ = millis();
+    sensesp::event_loop()->onRepeat(CHECK_MS, [this]() { check(); });
+}
+
+void PowerManager::wake(const char* reason) {
+    last_activity_ms_ = millis();
+    if (mode() == PowerMode::ANCHOR_WATCH) {
+        ESP_LOGI(__FILE__, "PowerManager: %s, leaving anchor watch", reason);
+        leaveWatch();
+    }
+}
+
+void PowerManager::check() {
+    const unsigned long now = millis();
+    if (busy_()) {
+        wake("windlass busy");
+        return;
+    }
+    if (mode() == PowerMode::ANCHOR_WATCH) {
+        armWakePins();   // A pin that settled at its wake level would keep the chip awake
+    } else if (now - last_activity_ms_ >= config_.idleMs) {
+        ESP_LOGI(__FILE__, "PowerManager: idle for %lu s, entering anchor watch", (now - last_activity_ms_) / 1000);
+        enterWatch();
+    }
+}
+
+void PowerManager::enterWatch() {
+    setMode(PowerMode::ANCHOR_WATCH);
+    esp_wifi_set_ps(WIFI_PS_MAX_MODEM);
+    if (light_sleep_) {
+        armWakePins();
+    }
+    if (pm_) {
+        esp_pm_lock_release(sleep_lock_);
+        esp_pm_lock_release(cpu_lock_);
+    }
+}
+
+void PowerManager::leaveWatch() {
+    if (pm_) {
+        esp_pm_lock_acquire(cpu_lock_);
+        esp_pm_lock_acquire(sleep_lock_);
+    }
+    if (light_sleep_) {
+        disarmWakePins();
+    }
+    esp_wifi_set_ps(WIFI_PS_MIN_MODEM);   // Arduino default
+    setMode(PowerMode::ACTIVE);
+}
+
+// RTC IO wake only - gpio_wakeup_enable() would switch the pin's GPIO
+// interrupt to level-triggered under the input's edge ISR
+void PowerManager::armWakePins() {
+#if CHAIN_RTCIO_WAKE
+    for (int gpio : wake_pins_) {
+        gpio_int_type_t level = digitalRead(gpio) == HIGH ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL;
+        rtc_gpio_wakeup_enable((gpio_num_t)gpio, level);
+    }
+#endif
+}
+
+void PowerManager::disarmWakePins() {
+#if CHAIN_RTCIO_WAKE
+    for (int gpio : wake_pins_) {
+        rtc_gpio_wakeup_disable((gpio_num_t)gpio);
+    }
+#endif
+}
+
+void PowerManager::setMode(PowerMode mode) {
+    mode_->set(mode);
+    for (auto& observer : observers_) {
+        observer(mode);
+    }
+}
@@ -0,0 +1,86 @@
+// PowerManager.h
+#ifndef POWERMANAGER_H
+#define POWERMANAGER_H
+
+#include <Arduino.h>
+#include <esp_pm.h>
+#include <functional>
+#include <vector>
+
+#include "ChainTypes.h"
+
+/**
+ * Anchor-watch power mode.
+ *
+ * ACTIVE is the normal mode: CPU at full clock, WiFi without power save,
+ * the event loop spinning. Once busy() has been false for idleMs (windlass
+ * idle, chain in free fall, no deployment) the manager switches to
+ * ANCHOR_WATCH:
+ *
+ *  - its ESP-IDF PM locks are released, so the CPU scales down and, with
+ *    lightSleep and a tickless-idle build, sleeps automatically between
+ *    timer events
+ *  - WiFi goes to modem sleep (packets arrive on DTIM beacons, so Signal K
+ *    commands still wake the device)
+ *  - the wake pins (hall, UP/DOWN sense, RESET) are armed as light-sleep
+ *    wake sources at the level opposite to the one they rest at
+ *  - loopDelayMs() tells the Arduino loop to yield instead of spinning, and
+ *    the mode observers slow the slack timer, the Signal K heartbeat and
+ *    the windlass task's idle poll
+ *
+ * wake() returns to ACTIVE at once. main.cpp calls it on every pulse,
+ * button edge and command; the windlass task itself drops back to its 1 ms
+ * tick on the first pulse it sees, before the event loop does.
+ *
+ * PM support is optional: if the SDK was built without it (or without
+ * tickless idle) begin() logs it once and anchor watch still yields the
+ * loop, modem-sleeps and slows the timers. Light sleep also needs the
+ * hall pin to be a wake source (an RTC GPIO on the ESP32); the edge that
+ * wakes the CPU may itself not be counted.
+ */
+class PowerManager {
+public:
+    struct Config {
+        unsigned long idleMs = 300000;   // Idle time before anchor watch
+        bool lightSleep = true;          // Allow automatic light sleep in anchor watch
+    };
+
+    static constexpr unsigned long CHECK_MS = 1000;       // Idle check and wake pin re-arm
+    static constexpr unsigned long WATCH_LOOP_MS = 10;    // Loop yield in anchor watch (= ChainController::SYNC_INTERVAL_MS)
+
+    PowerManager(std::function<bool()> busy, const Config& config);
+
+    void addWakePin(int gpio, bool required = false);   // Before begin(); required = no light sleep without it
+    void onModeChange(std::function<void(PowerMode)> observer) { observers_.push_back(observer); }
+    void begin();                  // Configure PM, start the idle check
+
+    void wake(const char* reason); // Activity - back to ACTIVE, restart the idle timer
+
+    PowerMode mode() const { return mode_->get(); }
+    EnumValue<PowerMode>* getModeObservable() const { return mode_; }
+    unsigned long loopDelayMs() const { return mode() == PowerMode::ANCHOR_WATCH ? WATCH_LOOP_MS : 0; }
+    bool lightSleepAvailable() const { return light_sleep_; }
+
+private:
+    void check();
+    void enterWatch();
+    void leaveWatch();
+    void armWakePins();
+    void disarmWakePins();
+    void setMode(PowerMode mode);
+
+    std::function<bool()> busy_;
+    Config config_;
+    std::vector<int> wake_pins_;
+    bool wake_pins_ok_ = true;   // Every required pin can wake the chip
+    std::vector<std::function<void(PowerMode)>> observers_;
+    EnumValue<PowerMode>* mode_;
+    unsigned long last_activity_ms_ = 0;
+
+    esp_pm_lock_handle_t cpu_lock_ = nullptr;     // ESP_PM_CPU_FREQ_MAX, held while ACTIVE
+    esp_pm_lock_handle_t sleep_lock_ = nullptr;   // ESP_PM_NO_LIGHT_SLEEP, held while ACTIVE
+    bool pm_ = false;            // esp_pm_configure succeeded
+    bool light_sleep_ = false;   // ... with light sleep enabled
+};
+
+#endif // POWERMANAGER_H
@@ -0,0 +1,143 @@
+#include "PublishScheduler.h"
+#include <cmath>
+#include "sensesp_app.h"
+#include "SetupArena.h"
+
+PublishScheduler::PublishScheduler(std::function<bool()> moving)
+  : PublishScheduler(moving, Config()) {}
+
+PublishScheduler::PublishScheduler(std::function<bool()> moving, const Config& config)
+  : moving_(moving), config_(config) {
+    last_flush_ms_ = millis();
+    last_heartbeat_ms_ = last_flush_ms_;
+}
+
+sensesp::SKOutputFloat* PublishScheduler::addNumber(sensesp::ValueProducer<float>* producer,
+                                                    const String& sk_path, const String& config_path,
+                                                    float deadband, sensesp::SKMetadata* metadata) {
+    auto* output = SetupArena::make<sensesp::SKOutputFloat>(sk_path, config_path, metadata);
+    auto* channel = SetupArena::make<NumberChannel>(producer, output, deadband);
+    channels_.push_back(channel);
+    producer->connect_to(channel);
+    return output;
+}
+
+sensesp::SKOutputString* PublishScheduler::addText(sensesp::ValueProducer<String>* producer,
+                                                   const String& sk_path, const String& config_path) {
+    auto* output = SetupArena::make<sensesp::SKOutputString>(sk_path, config_path);
+    auto* channel = SetupArena::make<TextChannel>(producer, output);
+    channels_.push_back(channel);
+    producer->connect_to(channel);
+    return output;
+}
+
+sensesp::SKOutputRawJson* PublishScheduler::addJson(sensesp::ValueProducer<String>* producer,
+                                                    const String& sk_path, const String& config_path) {
+    auto* output = SetupArena::make<sensesp::SKOutputRawJson>(sk_path, config_path);
+    auto* channel = SetupArena::make<TextChannel>(producer, output, true);
+    channels_.push_back(channel);
+    producer->connect_to(channel);
+    return output;
+}
+
+void PublishScheduler::NumberChannel::set(const float& value) {
+    if (!has_published_ || isnan(value) != isnan(published_) || fabsf(value - published_) > deadband_) {
+        pending_ = true;
+    }
+}
+
+bool PublishScheduler::NumberChannel::publish(SKDeltaWriter* delta) {
+    float value = producer_->get();
+    if (delta == nullptr) {
+        output_->set(value);
+    } else if (!delta->addNumber(output_->get_sk_path(), value)) {
+        return false;
+    }
+    published_ = value;
+    has_published_ = true;
+    pending_ = false;
+    return true;
+}
+
+void PublishScheduler::TextChannel::set(const String&) {
+    pending_ = true;
+    urgent_ = true;
+}
+
+bool PublishScheduler::TextChannel::publish(SKDeltaWriter* delta) {
+    if (delta == nullptr) {
+        output_->set(producer_->get());
+    } else if (json_ ? !delta->addJson(output_->get_sk_path(), producer_->get().c_str())
+                     : !delta->addText(output_->get_sk_path(), producer_->get().c_str())) {
+        return false;
+    }
+    pending_ = false;
+    urgent_ = false;
+    return true;
+}
+
+void PublishScheduler::setDeltaSink(DeltaSink sink, const String& source) {
+    sink_ = sink;
+    if (delta_ == nullptr) delta_ = SetupArena::make<SKDeltaWriter>();
+    delta_->setSource(source);
+}
+
+void PublishScheduler::start() {
+    sensesp::event_loop()->onRepeat(TICK_MS, [this]() { tick(); });
+}
+
+void PublishScheduler::tick() {
+    const unsigned long now = millis();
+
+    if (now - last_heartbeat_ms_ >= config_.heartbeatMs) {
+        flush(true);
+        last_heartbeat_ms_ = now;
+        last_flush_ms_ = now;
+        flushes_++;
+        return;
+    }
+
+    bool urgent = false;
+    bool pending = false;
+    for (Channel* channel : channels_) {
+        urgent |= channel->urgent();
+        pending |= channel->pending();
+    }
+    if (!pending) return;
+
+    const unsigned long window = moving_() ? config_.fastIntervalMs : config_.slowIntervalMs;
+    if (!urgent && now - last_flush_ms_ < window) return;
+
+    flush(false);
+    last_flush_ms_ = now;
+    flushes_++;
+}
+
+void PublishScheduler::flush(bool all) {
+    if (!sink_) {
+        for (Channel* channel : channels_) {
+            if (all || channel->pending()) channel->publish(nullptr);
+        }
+        return;
+    }
+
+    delta_->begin();
+    for (Channel* channel : channels_) {
+        if (!all && !channel->pending()) continue;
+        if (channel->publish(delta_)) continue;
+        // Full: send this part and start the next delta with the channel
+        sendDelta();
+        delta_->begin();
+        if (!channel->publish(delta_)) channel->publish(nullptr);
+    }
+    sendDelta();
+}
+
+void PublishScheduler::sendDelta() {
+    if (delta_->values() == 0) return;
+    if (sink_(delta_->finish())) {
+        deltas_++;
+    } else {
+        dropped_deltas_++;   // The heartbeat re-sends everything
+    }
+}
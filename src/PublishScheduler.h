@@ -0,0 +1,179 @@
+// PublishScheduler.h
+#ifndef PUBLISHSCHEDULER_H
+#define PUBLISHSCHEDULER_H
+
+#include <Arduino.h>
+#include <functional>
+#include <vector>
+#include "ChainTypes.h"
+#include "SetupArena.h"
+#include "SKDeltaWriter.h"
+#include "sensesp/signalk/signalk_output.h"
+#include "sensesp/system/valueconsumer.h"
+#include "sensesp/system/valueproducer.h"
+
+/**
+ * Coalesced Signal K publishing for the chain counter outputs.
+ *
+ * Producers connect to a channel here instead of straight to their SKOutput.
+ * A channel keeps the latest value and the scheduler's tick decides when to
+ * pass it on. Every channel with something new goes out in the same tick, so
+ * SensESP sends them to the server as one delta:
+ *
+ *  - State channels (direction, command, autoStage), text channels
+ *    (autoPlan) and JSON channels (notifications) flush on the next tick
+ *    and take any pending numbers with them.
+ *  - Number channels flush once the value has moved by more than the
+ *    channel's deadband, at most every fastIntervalMs while the windlass is
+ *    moving and every slowIntervalMs at anchor.
+ *  - Every heartbeatMs all channels re-send their current value, changed or
+ *    not, so a consumer that joins late (or a change inside the deadband)
+ *    is never more than one heartbeat stale.
+ *
+ * With a delta sink set, a flush does not go through the SKOutputs (one
+ * JSON document and String per value in SensESP): the channels write their
+ * values into one SKDeltaWriter and the finished delta goes to the sink.
+ * The SKOutputs still carry the configured path and the metadata. A flush
+ * that does not fit one delta is split; a value larger than a whole delta
+ * falls back to its SKOutput.
+ */
+class PublishScheduler {
+public:
+    struct Config {
+        unsigned long fastIntervalMs = 250;     // Number updates while moving
+        unsigned long slowIntervalMs = 2000;    // Number updates at anchor
+        unsigned long heartbeatMs = 11000;      // Full re-send of every channel
+    };
+
+    static constexpr unsigned long TICK_MS = 50;
+
+    explicit PublishScheduler(std::function<bool()> moving);
+    PublishScheduler(std::function<bool()> moving, const Config& config);
+
+    // producer -> deadband -> sk_path (float, e.g. rodeDeployed, chainSlack)
+    sensesp::SKOutputFloat* addNumber(sensesp::ValueProducer<float>* producer, const String& sk_path,
+                                      const String& config_path, float deadband,
+                                      sensesp::SKMetadata* metadata = nullptr);
+
+    // producer -> sk_path as toString(value); every emitted value is sent,
+    // including a notify() of an unchanged one (command acknowledgements)
+    template <typename E>
+    sensesp::SKOutputString* addState(sensesp::ValueProducer<E>* producer, const String& sk_path,
+                                      const String& config_path) {
+        auto* output = SetupArena::make<sensesp::SKOutputString>(sk_path, config_path);
+        auto* channel = SetupArena::make<StateChannel<E>>(producer, output);
+        channels_.push_back(channel);
+        producer->connect_to(channel);
+        return output;
+    }
+
+    // producer -> sk_path as is (JSON documents, e.g. autoPlan); sent like a state
+    sensesp::SKOutputString* addText(sensesp::ValueProducer<String>* producer, const String& sk_path,
+                                     const String& config_path);
+
+    // producer -> sk_path as a JSON value (notifications); sent like a state
+    sensesp::SKOutputRawJson* addJson(sensesp::ValueProducer<String>* producer, const String& sk_path,
+                                      const String& config_path);
+
+    void start();   // Run tick() every TICK_MS on the event loop
+    void tick();
+
+    // Hands a finished delta to the WebSocket; false if it could not be sent
+    using DeltaSink = std::function<bool(String& delta)>;
+    void setDeltaSink(DeltaSink sink, const String& source = "");
+
+    void setConfig(const Config& config) { config_ = config; }
+    const Config& getConfig() const { return config_; }
+    unsigned long flushCount() const { return flushes_; }
+    unsigned long deltaCount() const { return deltas_; }
+    unsigned long droppedDeltas() const { return dropped_deltas_; }   // Sink refused (not connected)
+
+private:
+    class Channel {
+    public:
+        virtual ~Channel() = default;
+        // Send the producer's current value: into delta, or through the
+        // SKOutput when delta is null. False if delta has no room for it.
+        virtual bool publish(SKDeltaWriter* delta) = 0;
+        bool pending() const { return pending_; }
+        bool urgent() const { return urgent_; }
+
+    protected:
+        bool pending_ = false;
+        bool urgent_ = false;
+    };
+
+    // Channels read the producer at publish time, so a flush always sends
+    // the latest value and a heartbeat works before the first emit
+    class NumberChannel : public Channel, public sensesp::ValueConsumer<float> {
+    public:
+        NumberChannel(sensesp::ValueProducer<float>* producer, sensesp::SKOutputFloat* output,
+                      float deadband)
+          : producer_(producer), output_(output), deadband_(deadband) {}
+        void set(const float& value) override;
+        bool publish(SKDeltaWriter* delta) override;
+
+    private:
+        sensesp::ValueProducer<float>* producer_;
+        sensesp::SKOutputFloat* output_;
+        float deadband_;
+        float published_ = 0.0;
+        bool has_published_ = false;
+    };
+
+    template <typename E>
+    class StateChannel : public Channel, public sensesp::ValueConsumer<E> {
+    public:
+        StateChannel(sensesp::ValueProducer<E>* producer, sensesp::SKOutputString* output)
+          : producer_(producer), output_(output) {}
+        void set(const E&) override {
+            pending_ = true;
+            urgent_ = true;
+        }
+        bool publish(SKDeltaWriter* delta) override {
+            const char* state = toString(producer_->get());
+            if (delta == nullptr) {
+                output_->set(String(state));
+            } else if (!delta->addText(output_->get_sk_path(), state)) {
+                return false;
+            }
+            pending_ = false;
+            urgent_ = false;
+            return true;
+        }
+
+    private:
+        sensesp::ValueProducer<E>* producer_;
+        sensesp::SKOutputString* output_;
+    };
+
+    class TextChannel : public Channel, public sensesp::ValueConsumer<String> {
+    public:
+        TextChannel(sensesp::ValueProducer<String>* producer, sensesp::SKOutputString* output,
+                    bool json = false)
+          : producer_(producer), output_(output), json_(json) {}
+        void set(const String&) override;
+        bool publish(SKDeltaWriter* delta) override;
+
+    private:
+        sensesp::ValueProducer<String>* producer_;
+        sensesp::SKOutputString* output_;
+        bool json_;    // The text is a JSON value, not a string
+    };
+
+    void flush(bool all);        // Pending channels, or every channel
+    void sendDelta();
+
+    std::function<bool()> moving_;
+    Config config_;
+    std::vector<Channel*> channels_;
+    DeltaSink sink_ = nullptr;
+    SKDeltaWriter* delta_ = nullptr;   // Made with the sink
+    unsigned long last_flush_ms_ = 0;
+    unsigned long last_heartbeat_ms_ = 0;
+    unsigned long flushes_ = 0;
+    unsigned long deltas_ = 0;
+    unsigned long dropped_deltas_ = 0;
+};
+
+#endif // PUBLISHSCHEDULER_H
@@ -0,0 +1,211 @@
+#include "PulseCounter.h"
+#include <Arduino.h>
+#include <driver/gpio.h>
+#include "PerfStats.h"
+
+PulseCounter::PulseCounter(int pulse_gpio, int up_ctrl_gpio, unsigned int filter_us, int unit)
+  : pulse_gpio_(pulse_gpio),
+    up_ctrl_gpio_(up_ctrl_gpio)
+{
+#if CHAIN_PCNT_LEGACY
+    unit_ = (pcnt_unit_t)unit;
+#else
+    (void)unit;
+#endif
+    // The PCNT glitch filter counts APB cycles in a 10-bit register, so the
+    // longest filter is ~12.8 us. That rejects electrical glitches, not the
+    // mechanical bounce the software DebounceInt handles; a hall sensor with
+    // a clean output does not need more.
+    unsigned long ticks = (unsigned long)filter_us * APB_TICKS_PER_US;
+    if (ticks > MAX_FILTER_TICKS) {
+        ESP_LOGW(__FILE__, "PulseCounter: filter %u us exceeds hardware max, clamping to %u ticks",
+                 filter_us, MAX_FILTER_TICKS);
+        ticks = MAX_FILTER_TICKS;
+    }
+    filter_ticks_ = (uint16_t)ticks;
+}
+
+#if CHAIN_PCNT_LEGACY
+
+bool PulseCounter::begin() {
+    pcnt_config_t config = {};
+    config.pulse_gpio_num = pulse_gpio_;
+    config.ctrl_gpio_num = up_ctrl_gpio_;
+    config.channel = PCNT_CHANNEL_0;
+    config.unit = unit_;
+    config.pos_mode = PCNT_COUNT_INC;      // Count rising edges (same edge as the ISR path)
+    config.neg_mode = PCNT_COUNT_DIS;
+    config.lctrl_mode = PCNT_MODE_REVERSE; // UP relay is ACTIVE-LOW: raising decrements
+    config.hctrl_mode = PCNT_MODE_KEEP;    // DOWN or free fall: increment
+    config.counter_h_lim = COUNTER_LIMIT;
+    config.counter_l_lim = -COUNTER_LIMIT;
+
+    if (pcnt_unit_config(&config) != ESP_OK) {
+        ESP_LOGE(__FILE__, "PulseCounter: pcnt_unit_config failed for unit %d", (int)unit_);
+        return false;
+    }
+
+    // pcnt_unit_config enables pull-ups on both pins; the inputs are wired
+    // for pull-downs like the DigitalInputChange path.
+    gpio_set_pull_mode((gpio_num_t)pulse_gpio_, GPIO_PULLDOWN_ONLY);
+    gpio_set_pull_mode((gpio_num_t)up_ctrl_gpio_, GPIO_PULLDOWN_ONLY);
+
+    pcnt_set_filter_value(unit_, filter_ticks_);
+    pcnt_filter_enable(unit_);
+
+    // Limit events let the ISR account for 16-bit counter wraps
+    pcnt_event_enable(unit_, PCNT_EVT_H_LIM);
+    pcnt_event_enable(unit_, PCNT_EVT_L_LIM);
+
+    pcnt_counter_pause(unit_);
+    pcnt_counter_clear(unit_);
+
+    esp_err_t err = pcnt_isr_service_install(0);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {  // INVALID_STATE = already installed
+        ESP_LOGE(__FILE__, "PulseCounter: pcnt_isr_service_install failed (%d)", (int)err);
+        return false;
+    }
+    pcnt_isr_handler_add(unit_, onLimitEvent, this);
+
+    overflow_ = 0;
+    last_total_ = 0;
+    pcnt_counter_resume(unit_);
+    running_ = true;
+
+    ESP_LOGI(__FILE__, "PulseCounter started. Pulse GPIO: %d, UP ctrl GPIO: %d, filter: %u ticks",
+             pulse_gpio_, up_ctrl_gpio_, filter_ticks_);
+    return true;
+}
+
+void IRAM_ATTR PulseCounter::onLimitEvent(void* arg) {
+    PulseCounter* self = static_cast<PulseCounter*>(arg);
+    uint32_t status = 0;
+    pcnt_get_event_status(self->unit_, &status);
+
+    if (status & PCNT_EVT_H_LIM) {
+        self->addCount(COUNTER_LIMIT);
+    } else if (status & PCNT_EVT_L_LIM) {
+        self->addCount(-COUNTER_LIMIT);
+    }
+}
+
+int32_t PulseCounter::readCount() {
+    int16_t raw = 0;
+    pcnt_get_counter_value(unit_, &raw);
+    return raw;
+}
+
+#else  // IDF 5 pulse_cnt driver
+
+bool PulseCounter::begin() {
+    pcnt_unit_config_t unit_config = {};
+    unit_config.low_limit = -COUNTER_LIMIT;
+    unit_config.high_limit = COUNTER_LIMIT;
+    esp_err_t err = pcnt_new_unit(&unit_config, &unit_);
+    if (err != ESP_OK) {
+        ESP_LOGE(__FILE__, "PulseCounter: no free PCNT unit (%d)", (int)err);
+        return false;
+    }
+
+    pcnt_glitch_filter_config_t filter_config = {};
+    filter_config.max_glitch_ns = (uint32_t)filter_ticks_ * 1000 / APB_TICKS_PER_US;
+    if (filter_config.max_glitch_ns > 0) {
+        pcnt_unit_set_glitch_filter(unit_, &filter_config);
+    }
+
+    pcnt_chan_config_t channel_config = {};
+    channel_config.edge_gpio_num = pulse_gpio_;
+    channel_config.level_gpio_num = up_ctrl_gpio_;
+    err = pcnt_new_channel(unit_, &channel_config, &channel_);
+    if (err != ESP_OK) {
+        ESP_LOGE(__FILE__, "PulseCounter: pcnt_new_channel failed (%d)", (int)err);
+        return false;
+    }
+    // Count rising edges (same edge as the ISR path)
+    pcnt_channel_set_edge_action(channel_, PCNT_CHANNEL_EDGE_ACTION_INCREASE, PCNT_CHANNEL_EDGE_ACTION_HOLD);
+    // UP relay is ACTIVE-LOW: raising decrements; DOWN or free fall: increment
+    pcnt_channel_set_level_action(channel_, PCNT_CHANNEL_LEVEL_ACTION_KEEP, PCNT_CHANNEL_LEVEL_ACTION_INVERSE);
+
+    // pcnt_new_channel enables pull-ups on both pins; the inputs are wired
+    // for pull-downs like the DigitalInputChange path.
+    gpio_set_pull_mode((gpio_num_t)pulse_gpio_, GPIO_PULLDOWN_ONLY);
+    gpio_set_pull_mode((gpio_num_t)up_ctrl_gpio_, GPIO_PULLDOWN_ONLY);
+
+    // Watch points at the limits let the callback account for 16-bit counter wraps
+    pcnt_unit_add_watch_point(unit_, COUNTER_LIMIT);
+    pcnt_unit_add_watch_point(unit_, -COUNTER_LIMIT);
+    pcnt_event_callbacks_t callbacks = {};
+    callbacks.on_reach = onWatchPoint;
+    pcnt_unit_register_event_callbacks(unit_, &callbacks, this);
+
+    overflow_ = 0;
+    last_total_ = 0;
+    if (pcnt_unit_enable(unit_) != ESP_OK || pcnt_unit_clear_count(unit_) != ESP_OK ||
+        pcnt_unit_start(unit_) != ESP_OK) {
+        ESP_LOGE(__FILE__, "PulseCounter: PCNT unit failed to start");
+        return false;
+    }
+    running_ = true;
+
+    ESP_LOGI(__FILE__, "PulseCounter started. Pulse GPIO: %d, UP ctrl GPIO: %d, filter: %u ns",
+             pulse_gpio_, up_ctrl_gpio_, (unsigned)filter_config.max_glitch_ns);
+    return true;
+}
+
+bool IRAM_ATTR PulseCounter::onWatchPoint(pcnt_unit_handle_t, const pcnt_watch_event_data_t* event, void* arg) {
+    PulseCounter* self = static_cast<PulseCounter*>(arg);
+    if (event->watch_point_value == COUNTER_LIMIT || event->watch_point_value == -COUNTER_LIMIT) {
+        self->addCount(event->watch_point_value);
+    }
+    return false;  // No task woken
+}
+
+int32_t PulseCounter::readCount() {
+    int raw = 0;
+    pcnt_unit_get_count(unit_, &raw);
+    return raw;
+}
+
+#endif  // CHAIN_PCNT_LEGACY
+
+bool PulseCounter::beginInterrupt(unsigned long debounce_ms) {
+    interrupt_ = true;
+    debounce_us_ = debounce_ms * 1000;
+    overflow_ = 0;
+    last_total_ = 0;
+    pinMode(pulse_gpio_, INPUT_PULLDOWN);
+    attachInterruptArg(pulse_gpio_, onEdge, this, RISING);
+    running_ = true;
+
+    ESP_LOGI(__FILE__, "PulseCounter started on interrupt. Pulse GPIO: %d, UP ctrl GPIO: %d, debounce: %lu ms",
+             pulse_gpio_, up_ctrl_gpio_, debounce_ms);
+    return true;
+}
+
+void IRAM_ATTR PulseCounter::onEdge(void* arg) {
+    PERF_SCOPE(PerfSite::COUNTER_HANDLER);
+    PulseCounter* self = static_cast<PulseCounter*>(arg);
+    unsigned long now = micros();
+    if (self->last_edge_us_ != 0 && now - self->last_edge_us_ < self->debounce_us_) return;  // Bounce
+    self->last_edge_us_ = now != 0 ? now : 1;
+    // UP relay is ACTIVE-LOW: raising decrements; DOWN or free fall: increment
+    self->addCount(digitalRead(self->up_ctrl_gpio_) == LOW ? -1 : 1);
+}
+
+void IRAM_ATTR PulseCounter::addCount(int32_t count) {
+    portENTER_CRITICAL_ISR(&mux_);
+    overflow_ += count;
+    portEXIT_CRITICAL_ISR(&mux_);
+}
+
+int32_t PulseCounter::takeDelta() {
+    if (!running_) return 0;
+
+    portENTER_CRITICAL(&mux_);
+    int32_t total = overflow_ + (interrupt_ ? 0 : readCount());
+    portEXIT_CRITICAL(&mux_);
+
+    int32_t delta = total - last_total_;
+    last_total_ = total;
+    return delta;
+}
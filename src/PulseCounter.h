@@ -0,0 +1,82 @@
+// PulseCounter.h
+#ifndef PULSECOUNTER_H
+#define PULSECOUNTER_H
+
+#include <Arduino.h>
+#include <esp_idf_version.h>
+
+// IDF 5 deprecates the legacy PCNT driver (and warns on every build that
+// includes it); the Arduino 2.x core (arduino_* envs, IDF 4.4) only has that one.
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+#include <driver/pulse_cnt.h>
+#define CHAIN_PCNT_LEGACY 0
+#else
+#include <driver/pcnt.h>
+#define CHAIN_PCNT_LEGACY 1
+#endif
+
+/**
+ * Gypsy pulse counter read by the windlass task.
+ *
+ * begin() counts rising edges of the hall sensor on the ESP32 PCNT
+ * peripheral, using the UP relay sense line as the PCNT control input: while
+ * UP is active (LOW) the count is reversed, otherwise it increments (DOWN or
+ * free fall). The hardware glitch filter replaces the software DebounceInt,
+ * so no interrupt or event-loop hop is needed per pulse. The counter clears
+ * itself at +/- COUNTER_LIMIT; a watch point at each limit (a limit event on
+ * the legacy driver) adds the wrap to overflow_.
+ *
+ * beginInterrupt() is the fallback for boards without a free PCNT unit (the
+ * "use PCNT" setting off): a GPIO interrupt on the rising edge reads the UP
+ * sense line and adds +/-1 to overflow_ itself, ignoring edges within the
+ * debounce time of the last one it counted. Either way the pulses never go
+ * through the event loop, so a WiFi or OTA stall cannot look like a stalled
+ * gypsy to the windlass task.
+ *
+ * The windlass task (WindlassCore) calls takeDelta() every tick and applies
+ * the net count to its pulse accumulator.
+ */
+class PulseCounter {
+public:
+    // unit: the PCNT unit on the legacy driver; IDF 5 allocates a free one
+    PulseCounter(int pulse_gpio, int up_ctrl_gpio, unsigned int filter_us, int unit = 0);
+
+    bool begin();                                     // PCNT
+    bool beginInterrupt(unsigned long debounce_ms);  // GPIO interrupt, no PCNT unit
+    int32_t takeDelta();  // Net pulses since the previous call (+ = lowering, - = raising)
+    bool isRunning() const { return running_; }
+
+private:
+    int32_t readCount();
+#if CHAIN_PCNT_LEGACY
+    static void IRAM_ATTR onLimitEvent(void* arg);
+#else
+    static bool IRAM_ATTR onWatchPoint(pcnt_unit_handle_t unit, const pcnt_watch_event_data_t* event, void* arg);
+#endif
+    static void IRAM_ATTR onEdge(void* arg);
+    void IRAM_ATTR addCount(int32_t count);
+
+    int pulse_gpio_;
+    int up_ctrl_gpio_;
+    uint16_t filter_ticks_;
+#if CHAIN_PCNT_LEGACY
+    pcnt_unit_t unit_;
+#else
+    pcnt_unit_handle_t unit_ = nullptr;
+    pcnt_channel_handle_t channel_ = nullptr;
+#endif
+    bool running_ = false;
+    bool interrupt_ = false;                // beginInterrupt(): no PCNT unit to read
+    unsigned long debounce_us_ = 0;
+    unsigned long last_edge_us_ = 0;        // Last edge the interrupt counted
+
+    volatile int32_t overflow_ = 0;  // +/- COUNTER_LIMIT wraps, or every pulse in interrupt mode
+    int32_t last_total_ = 0;
+    portMUX_TYPE mux_ = portMUX_INITIALIZER_UNLOCKED;
+
+    static constexpr int16_t COUNTER_LIMIT = 30000;       // PCNT is 16-bit, wrap well before the edge
+    static constexpr uint16_t MAX_FILTER_TICKS = 1023;    // 10-bit filter register
+    static constexpr uint16_t APB_TICKS_PER_US = 80;      // 80 MHz APB clock
+};
+
+#endif // PULSECOUNTER_H
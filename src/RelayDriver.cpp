@@ -0,0 +1,87 @@
+#include "RelayDriver.h"
+
+RelayDriver::RelayDriver(int down_pin, int up_pin, unsigned long dead_time_ms)
+  : down_pin_(down_pin),
+    up_pin_(up_pin),
+    dead_time_ms_(DEFAULT_DEAD_TIME_MS)
+{
+    setDeadTime(dead_time_ms);
+    // Known state at startup. PinMode setup happens in WindlassUnit.
+    digitalWrite(up_pin_, LOW);
+    digitalWrite(down_pin_, LOW);
+}
+
+void RelayDriver::setDeadTime(unsigned long dead_time_ms) {
+    if (dead_time_ms > MAX_DEAD_TIME_MS) {
+        ESP_LOGW(__FILE__, "RelayDriver: dead time %lu ms exceeds %lu ms, clamping", dead_time_ms, MAX_DEAD_TIME_MS);
+        dead_time_ms = MAX_DEAD_TIME_MS;
+    }
+    dead_time_ms_ = dead_time_ms;
+}
+
+void RelayDriver::set(Output output, unsigned long now) {
+    if (output == requested_) {
+        if (output == output_) {
+            stats_.skipped++;
+        } else {
+            update(now);   // Still held
+        }
+        return;
+    }
+    requested_ = output;
+    held_ = false;
+    update(now);
+}
+
+void RelayDriver::update(unsigned long now) {
+    if (requested_ == output_) return;
+
+    // Whatever is energised and not wanted goes off first, without delay
+    if (output_ != Output::OFF) release(now);
+    if (requested_ == Output::OFF) return;
+
+    if (released_ != Output::OFF && released_ != requested_ && now - released_ms_ < dead_time_ms_) {
+        held_ = true;
+        return;
+    }
+    energise(now);
+}
+
+RelayDriver::Stats RelayDriver::stats(unsigned long now) const {
+    Stats stats = stats_;
+    if (output_ == Output::DOWN) stats.down_on_ms += now - on_since_ms_;
+    if (output_ == Output::UP) stats.up_on_ms += now - on_since_ms_;
+    return stats;
+}
+
+void RelayDriver::write(int pin, int level) {
+    digitalWrite(pin, level);
+    stats_.writes++;
+}
+
+void RelayDriver::release(unsigned long now) {
+    write(pin(output_), LOW);
+    if (output_ == Output::DOWN) {
+        stats_.down_on_ms += now - on_since_ms_;
+    } else {
+        stats_.up_on_ms += now - on_since_ms_;
+    }
+    released_ = output_;
+    released_ms_ = now;
+    output_ = Output::OFF;
+}
+
+void RelayDriver::energise(unsigned long now) {
+    write(pin(requested_), HIGH);
+    if (requested_ == Output::DOWN) {
+        stats_.down_starts++;
+    } else {
+        stats_.up_starts++;
+    }
+    if (held_) {
+        stats_.held_starts++;
+        held_ = false;
+    }
+    output_ = requested_;
+    on_since_ms_ = now;
+}
@@ -0,0 +1,79 @@
+// RelayDriver.h
+#ifndef RELAYDRIVER_H
+#define RELAYDRIVER_H
+
+#include <Arduino.h>
+
+/**
+ * The DOWN and UP relay outputs of one windlass.
+ *
+ * Every relay write of the windlass task goes through here. set() asks for
+ * OFF, DOWN or UP and the driver:
+ *  - writes a pin only when its level changes, so the motion loop can ask
+ *    for the same output as often as it likes without touching the GPIO
+ *  - switches the energised relay off at once, always before the other one
+ *    comes on (off is never delayed: limit and stall stops must cut at once)
+ *  - holds a start in the other direction until the released relay has
+ *    been off for the dead time, so the contacts have dropped out before
+ *    the motor is reversed. Nothing blocks: update() completes the start
+ *    on a later tick
+ *  - counts starts per direction and the time each relay has been on
+ *
+ * A restart in the direction that was just released is not held. Minimum
+ * on and off times for slack pauses stay with the slack control in
+ * WindlassCore, which knows why the relay is switching.
+ *
+ * Only the windlass task calls into a driver; the event loop sees the
+ * counters through the WindlassCore snapshot.
+ */
+class RelayDriver {
+public:
+    enum class Output : uint8_t { OFF, DOWN, UP };
+
+    struct Stats {
+        uint32_t down_starts;
+        uint32_t up_starts;
+        uint32_t held_starts;        // Reversals that waited out the dead time
+        uint32_t writes;             // GPIO writes
+        uint32_t skipped;            // set() calls that asked for what was already there
+        uint32_t down_on_ms;         // Cumulative, including a run in progress
+        uint32_t up_on_ms;
+    };
+
+    RelayDriver(int down_pin, int up_pin, unsigned long dead_time_ms = DEFAULT_DEAD_TIME_MS);
+
+    void set(Output output, unsigned long now);
+    void update(unsigned long now);   // Completes a held start once the dead time is over
+    void setDeadTime(unsigned long dead_time_ms);     // Clamped to MAX_DEAD_TIME_MS
+    unsigned long deadTime() const { return dead_time_ms_; }
+
+    Output output() const { return output_; }        // What the pins drive now
+    Output requested() const { return requested_; }
+    bool holding() const { return requested_ != output_; }
+    Stats stats(unsigned long now) const;
+
+    static constexpr unsigned long DEFAULT_DEAD_TIME_MS = 100;
+    // A held start is waiting for its first pulse, so the dead time comes
+    // out of the stall check's spin-up allowance (WindlassCore::SPINUP_MS)
+    static constexpr unsigned long MAX_DEAD_TIME_MS = 500;
+
+private:
+    int pin(Output output) const { return output == Output::DOWN ? down_pin_ : up_pin_; }
+    void write(int pin, int level);
+    void release(unsigned long now);
+    void energise(unsigned long now);
+
+    int down_pin_;
+    int up_pin_;
+    unsigned long dead_time_ms_;
+
+    Output output_ = Output::OFF;
+    Output requested_ = Output::OFF;
+    Output released_ = Output::OFF;    // Relay that went off last (OFF = none since boot)
+    unsigned long released_ms_ = 0;
+    unsigned long on_since_ms_ = 0;
+    bool held_ = false;
+    Stats stats_ = {};
+};
+
+#endif // RELAYDRIVER_H
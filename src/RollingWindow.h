@@ -0,0 +1,80 @@
+// RollingWindow.h
+#ifndef ROLLINGWINDOW_H
+#define ROLLINGWINDOW_H
+
+#include <cmath>
+#include <cstddef>
+
+/**
+ * Mean, variance and linear trend of the last N samples of a fixed-rate
+ * stream.
+ *
+ * The samples sit in a ring; running sums of x, x^2 and k*x (k = position
+ * in the window, 0 = oldest) are updated as a sample enters and the oldest
+ * leaves, so add() and every statistic are O(1) whatever N is. Sums are
+ * double: at one sample a second the rounding of a float would add up over
+ * a night at anchor.
+ */
+template <size_t N>
+class RollingWindow {
+    static_assert(N >= 2, "RollingWindow needs room for a trend");
+
+public:
+    void reset() {
+        head_ = 0;
+        count_ = 0;
+        sum_ = sum_sq_ = sum_kx_ = 0.0;
+    }
+
+    void add(float x) {
+        if (count_ < N) {
+            sum_kx_ += (double)count_ * x;
+            count_++;
+        } else {
+            // Every sample moves one place towards the oldest; the oldest leaves
+            float oldest = samples_[head_];
+            sum_kx_ -= sum_ - oldest;
+            sum_kx_ += (double)(N - 1) * x;
+            sum_ -= oldest;
+            sum_sq_ -= (double)oldest * oldest;
+        }
+        sum_ += x;
+        sum_sq_ += (double)x * x;
+        samples_[head_] = x;
+        head_ = (head_ + 1) % N;
+    }
+
+    size_t size() const { return count_; }
+    bool full() const { return count_ == N; }
+    float newest() const { return count_ > 0 ? samples_[(head_ + N - 1) % N] : 0.0f; }
+
+    float mean() const { return count_ > 0 ? (float)(sum_ / count_) : 0.0f; }
+
+    float variance() const {
+        if (count_ < 2) return 0.0f;
+        double mean = sum_ / count_;
+        double variance = sum_sq_ / count_ - mean * mean;
+        return variance > 0.0 ? (float)variance : 0.0f;   // Rounding can dip below zero
+    }
+
+    float stddev() const { return sqrtf(variance()); }
+
+    // Least-squares slope per sample
+    float slope() const {
+        if (count_ < 2) return 0.0f;
+        double n = count_;
+        double sum_k = n * (n - 1) / 2;
+        double sum_kk = (n - 1) * n * (2 * n - 1) / 6;
+        return (float)((n * sum_kx_ - sum_k * sum_) / (n * sum_kk - sum_k * sum_k));
+    }
+
+private:
+    float samples_[N] = {};
+    size_t head_ = 0;     // Next slot to write = oldest once full
+    size_t count_ = 0;
+    double sum_ = 0.0;
+    double sum_sq_ = 0.0;
+    double sum_kx_ = 0.0;
+};
+
+#endif // ROLLINGWINDOW_H
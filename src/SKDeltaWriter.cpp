@@ -0,0 +1,147 @@
+#include "SKDeltaWriter.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const char FOOTER[] = "]}]}";
+const char PATH_OPEN[] = "{\"path\":\"";
+const char VALUE_OPEN[] = "\",\"value\":";
+constexpr uint32_t FRACTION_SCALE = 10000;   // Four decimals, trailing zeros dropped
+
+}  // namespace
+
+SKDeltaWriter::SKDeltaWriter(size_t capacity) : capacity_(capacity) {
+    buffer_.reserve(capacity_);
+    begin();
+}
+
+void SKDeltaWriter::begin() {
+    buffer_ = "";   // Keeps the reserved storage
+    buffer_ += "{\"context\":\"vessels.self\",\"updates\":[{";
+    if (source_.length() > 0) {
+        buffer_ += "\"$source\":\"";
+        appendEscaped(source_.c_str());
+        buffer_ += "\",";
+    }
+    buffer_ += "\"values\":[";
+    values_ = 0;
+}
+
+bool SKDeltaWriter::addNumber(const String& path, float value) {
+    char number[24];
+    size_t length = formatNumber(value, number, sizeof(number));
+    if (!open(path, length)) return false;
+    buffer_ += number;
+    buffer_ += '}';
+    values_++;
+    return true;
+}
+
+bool SKDeltaWriter::addText(const String& path, const char* text) {
+    if (!open(path, escapedLength(text) + 2)) return false;
+    buffer_ += '"';
+    appendEscaped(text);
+    buffer_ += '"';
+    buffer_ += '}';
+    values_++;
+    return true;
+}
+
+bool SKDeltaWriter::addJson(const String& path, const char* json) {
+    if (!open(path, strlen(json))) return false;
+    buffer_ += json;
+    buffer_ += '}';
+    values_++;
+    return true;
+}
+
+String& SKDeltaWriter::finish() {
+    buffer_ += FOOTER;
+    return buffer_;
+}
+
+bool SKDeltaWriter::open(const String& path, size_t value_length) {
+    size_t needed = (values_ > 0 ? 1 : 0) + strlen(PATH_OPEN) + escapedLength(path.c_str()) +
+                    strlen(VALUE_OPEN) + value_length + 1;
+    if (buffer_.length() + needed + strlen(FOOTER) > capacity_) return false;
+    if (values_ > 0) buffer_ += ',';
+    buffer_ += PATH_OPEN;
+    appendEscaped(path.c_str());
+    buffer_ += VALUE_OPEN;
+    return true;
+}
+
+void SKDeltaWriter::appendEscaped(const char* text) {
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+    for (const char* p = text; *p != '\0'; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c == '"' || c == '\\') {
+            buffer_ += '\\';
+            buffer_ += (char)c;
+        } else if (c == '\n') {
+            buffer_ += "\\n";
+        } else if (c == '\r') {
+            buffer_ += "\\r";
+        } else if (c == '\t') {
+            buffer_ += "\\t";
+        } else if (c < 0x20) {
+            buffer_ += "\\u00";
+            buffer_ += HEX_DIGITS[c >> 4];
+            buffer_ += HEX_DIGITS[c & 0x0f];
+        } else {
+            buffer_ += (char)c;
+        }
+    }
+}
+
+size_t SKDeltaWriter::escapedLength(const char* text) {
+    size_t length = 0;
+    for (const char* p = text; *p != '\0'; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c == '"' || c == '\\' || c == '\n' || c == '\r' || c == '\t') {
+            length += 2;
+        } else if (c < 0x20) {
+            length += 6;
+        } else {
+            length += 1;
+        }
+    }
+    return length;
+}
+
+size_t SKDeltaWriter::formatNumber(float value, char* out, size_t size) {
+    if (!std::isfinite(value)) {
+        return snprintf(out, size, "null");
+    }
+    double magnitude = fabs((double)value);
+    if (magnitude >= 1e9) {
+        return snprintf(out, size, "%.7g", (double)value);
+    }
+
+    // Fixed point by hand: snprintf("%f") goes through dtoa's heap buffers
+    uint64_t fixed = (uint64_t)(magnitude * FRACTION_SCALE + 0.5);
+    uint64_t whole = fixed / FRACTION_SCALE;
+    uint32_t fraction = (uint32_t)(fixed % FRACTION_SCALE);
+
+    char digits[12];
+    size_t n = 0;
+    do {
+        digits[n++] = (char)('0' + whole % 10);
+        whole /= 10;
+    } while (whole > 0);
+
+    size_t length = 0;
+    if (value < 0 && fixed > 0) out[length++] = '-';
+    while (n > 0) out[length++] = digits[--n];
+    if (fraction > 0) {
+        out[length++] = '.';
+        for (uint32_t scale = FRACTION_SCALE / 10; scale > 0 && fraction > 0; scale /= 10) {
+            out[length++] = (char)('0' + fraction / scale);
+            fraction %= scale;
+        }
+    }
+    out[length] = '\0';
+    return length;
+}
@@ -0,0 +1,49 @@
+// SKDeltaWriter.h
+#ifndef SKDELTAWRITER_H
+#define SKDELTAWRITER_H
+
+#include <Arduino.h>
+
+/**
+ * Signal K delta text for the chain counter outputs, built in place.
+ *
+ * The buffer is reserved once at construction. begin() writes the context
+ * and the "$source" of the update, each add*() appends one
+ * {"path":...,"value":...} to its values, and finish() closes the delta.
+ * Nothing is allocated per value: numbers are formatted on the stack, enum
+ * states and text are escaped straight into the buffer, and the finished
+ * delta is the buffer itself, handed to the WebSocket as is.
+ *
+ * An add*() that would not fit (with room left to close the delta) changes
+ * nothing and returns false; the caller sends what there is and starts a
+ * new delta.
+ */
+class SKDeltaWriter {
+public:
+    static constexpr size_t CAPACITY = 1536;   // A full heartbeat of one windlass fits
+
+    explicit SKDeltaWriter(size_t capacity = CAPACITY);
+
+    void setSource(const String& source) { source_ = source; }  // Empty: no "$source"
+    void begin();
+    bool addNumber(const String& path, float value);    // NaN and infinity go out as null
+    bool addText(const String& path, const char* text);
+    bool addJson(const String& path, const char* json);  // Already a JSON value, not escaped
+    String& finish();   // Valid until the next begin()
+
+    size_t values() const { return values_; }
+    size_t capacity() const { return capacity_; }
+
+private:
+    bool open(const String& path, size_t value_length);  // Room check, then {"path":"...","value":
+    void appendEscaped(const char* text);
+    static size_t escapedLength(const char* text);
+    static size_t formatNumber(float value, char* out, size_t size);
+
+    String buffer_;
+    String source_;
+    size_t capacity_;
+    size_t values_ = 0;
+};
+
+#endif // SKDELTAWRITER_H
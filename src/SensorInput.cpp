@@ -0,0 +1,32 @@
+#include "SensorInput.h"
+#include <cmath>
+#include "ChainTrace.h"
+#include "SetupArena.h"
+
+SensorInput::SensorInput(const String& sk_path, int listen_delay_ms, const String& config_path,
+                         float min_value, float max_value, unsigned long max_age_ms)
+  : listener_(SetupArena::make<sensesp::SKValueListener<float>>(sk_path, listen_delay_ms, config_path)),
+    min_value_(min_value),
+    max_value_(max_value),
+    max_age_ms_(max_age_ms) {
+    listener_->connect_to(this);
+}
+
+void SensorInput::set(const float& value) {
+    CHAIN_TRACE_RECORD(input(listener_->get_sk_path().c_str(), value));
+    received_ms_ = millis();
+    received_ = true;
+    samples_++;
+    valid_ = !isnan(value) && !isinf(value) && value >= min_value_ && value <= max_value_;
+    if (valid_) {
+        value_ = value;
+    } else {
+        rejected_++;
+    }
+}
+
+SensorInput::Quality SensorInput::quality() const {
+    if (!received_) return Quality::NONE;
+    if (!valid_) return Quality::INVALID;
+    return usable() ? Quality::VALID : Quality::STALE;
+}
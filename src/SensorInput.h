@@ -0,0 +1,73 @@
+// SensorInput.h
+#ifndef SENSORINPUT_H
+#define SENSORINPUT_H
+
+#include <Arduino.h>
+#include "sensesp/signalk/signalk_value_listener.h"
+#include "sensesp/system/valueconsumer.h"
+
+/**
+ * A Signal K number input with its validity and age.
+ *
+ * Owns the SKValueListener and checks each value once, as it arrives:
+ * finite and within [min, max] is VALID, anything else is INVALID. The
+ * arrival time is kept with it. usable() - the last value was valid and is
+ * no older than maxAgeMs - is one flag test and one subtraction, so the
+ * slack loop and the deployment stages can call it freely instead of
+ * re-checking NaN/Inf and sentinels on every read.
+ *
+ * An invalid value does not overwrite the last good one (value() still
+ * returns it, for logging), but the input is not usable until the next
+ * valid value arrives.
+ */
+class SensorInput : public sensesp::ValueConsumer<float> {
+public:
+    enum class Quality : uint8_t {
+        NONE,       // Nothing received yet
+        VALID,
+        INVALID,    // Last value was NaN/Inf or out of range
+        STALE       // Last value was valid but older than maxAgeMs
+    };
+
+    SensorInput(const String& sk_path, int listen_delay_ms, const String& config_path,
+                float min_value, float max_value, unsigned long max_age_ms);
+
+    sensesp::SKValueListener<float>* listener() const { return listener_; }
+
+    void set(const float& value) override;   // Called by the listener
+
+    bool usable() const { return valid_ && millis() - received_ms_ <= max_age_ms_; }
+    float value() const { return value_; }   // Last valid value (0 before the first)
+    float valueOr(float fallback) const { return usable() ? value_ : fallback; }
+
+    Quality quality() const;
+    unsigned long ageMs() const { return millis() - received_ms_; }   // Since the last value, valid or not
+    unsigned long maxAgeMs() const { return max_age_ms_; }
+    uint32_t rejectedCount() const { return rejected_; }
+    uint32_t sampleCount() const { return samples_; }     // Values received, valid or not - a change counter for caches
+
+private:
+    sensesp::SKValueListener<float>* listener_;
+    float min_value_;
+    float max_value_;
+    unsigned long max_age_ms_;
+
+    float value_ = 0.0;
+    unsigned long received_ms_ = 0;   // Arrival of the last value, valid or not
+    bool received_ = false;
+    bool valid_ = false;
+    uint32_t rejected_ = 0;
+    uint32_t samples_ = 0;
+};
+
+inline const char* toString(SensorInput::Quality quality) {
+    switch (quality) {
+        case SensorInput::Quality::NONE:    return "none";
+        case SensorInput::Quality::VALID:   return "valid";
+        case SensorInput::Quality::INVALID: return "invalid";
+        case SensorInput::Quality::STALE:   return "stale";
+    }
+    return "unknown";
+}
+
+#endif // SENSORINPUT_H
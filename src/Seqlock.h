@@ -0,0 +1,64 @@
+// Seqlock.h
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * Single-writer sequence lock for a small trivially copyable struct.
+ *
+ * The writer never waits. A reader copies the value and retries if the
+ * sequence number changed (or was odd) during the copy. tryRead() bounds the
+ * retries so a high-priority reader cannot spin forever on a writer it has
+ * preempted on the same core; it keeps the caller's previous value instead.
+ */
+template <typename T>
+class Seqlock {
+    static_assert(std::is_trivially_copyable<T>::value, "Seqlock requires a trivially copyable type");
+
+public:
+    explicit Seqlock(const T& initial = T()) { memcpy(data_, &initial, sizeof(T)); }
+
+    void write(const T& value) {
+        uint32_t seq = seq_.load(std::memory_order_relaxed);
+        seq_.store(seq + 1, std::memory_order_relaxed);  // Odd = write in progress
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(data_, &value, sizeof(T));
+        std::atomic_thread_fence(std::memory_order_release);
+        seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    bool tryRead(T* out, int attempts = MAX_READ_ATTEMPTS) const {
+        for (int i = 0; i < attempts; i++) {
+            uint32_t before = seq_.load(std::memory_order_acquire);
+            if (before & 1) continue;
+            T copy;
+            memcpy(&copy, data_, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq_.load(std::memory_order_relaxed) == before) {
+                *out = copy;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // For readers with lower priority than the writer - the writer always finishes
+    T read() const {
+        T out;
+        while (!tryRead(&out)) {
+        }
+        return out;
+    }
+
+    static constexpr int MAX_READ_ATTEMPTS = 8;
+
+private:
+    std::atomic<uint32_t> seq_{0};
+    alignas(4) unsigned char data_[sizeof(T)];
+};
+
+#endif // SEQLOCK_H
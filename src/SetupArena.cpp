@@ -0,0 +1,44 @@
+#include "SetupArena.h"
+
+namespace {
+
+#if CHAIN_STATIC_GRAPH
+alignas(16) uint8_t graph_storage[CHAIN_ARENA_BYTES];
+#endif
+
+}  // namespace
+
+SetupArena::SetupArena(void* buffer, size_t capacity)
+  : buffer_(static_cast<uint8_t*>(buffer)),
+    capacity_(buffer != nullptr ? capacity : 0) {}
+
+SetupArena& SetupArena::global() {
+#if CHAIN_STATIC_GRAPH
+    static SetupArena arena(graph_storage, sizeof(graph_storage));
+#else
+    static SetupArena arena(nullptr, 0);
+#endif
+    return arena;
+}
+
+void* SetupArena::allocate(size_t size, size_t align) {
+    if (sealed_) {
+        stats_.lateObjects++;
+    } else if (capacity_ > 0) {
+        // Pad from the buffer's real address, so any alignment up to the
+        // type's own is honoured
+        uintptr_t base = reinterpret_cast<uintptr_t>(buffer_);
+        uintptr_t start = (base + used_ + align - 1) & ~(uintptr_t)(align - 1);
+        size_t end = (size_t)(start - base) + size;
+        if (end <= capacity_) {
+            stats_.arenaObjects++;
+            stats_.arenaBytes += end - used_;
+            used_ = end;
+            return reinterpret_cast<void*>(start);
+        }
+        stats_.overflowObjects++;
+    }
+    stats_.heapObjects++;
+    stats_.heapBytes += size;
+    return nullptr;
+}
@@ -0,0 +1,83 @@
+// SetupArena.h
+#ifndef SETUPARENA_H
+#define SETUPARENA_H
+
+#include <Arduino.h>
+#include <new>
+#include <utility>
+
+/**
+ * Static storage for the object graph setup() builds.
+ *
+ * Inputs, transforms, consumers, Signal K outputs and listeners, the
+ * controllers - everything setup() wires together is created once and lives
+ * until the board resets; nothing in the graph is ever deleted. Each of
+ * them is created with SetupArena::make<T>(args...) instead of new.
+ *
+ * With -D CHAIN_STATIC_GRAPH=1 make() places the object in one arena of
+ * CHAIN_ARENA_BYTES in .bss: the graph's footprint is fixed at link time
+ * and no longer fragments the heap the web UI, OTA and WiFi allocate from
+ * later. Only the objects themselves move - what they allocate inside
+ * (String, std::function, connection vectors) stays on the heap. In the
+ * default build make() is plain new and only counts what it creates.
+ *
+ * seal() ends setup: the arena is closed and anything made afterwards goes
+ * to the heap and is counted as late, since an object in the arena can never
+ * be given back. An object that does not fit goes to the heap as well, so an
+ * undersized arena costs heap, not a crash - stats() and the setup log show
+ * both cases.
+ *
+ * Setup runs on one task; the arena is not thread-safe.
+ */
+#ifndef CHAIN_STATIC_GRAPH
+#define CHAIN_STATIC_GRAPH 0
+#endif
+
+#ifndef CHAIN_ARENA_BYTES
+#define CHAIN_ARENA_BYTES 16384
+#endif
+
+class SetupArena {
+public:
+    struct Stats {
+        size_t arenaObjects = 0;
+        size_t arenaBytes = 0;       // Including alignment padding
+        size_t heapObjects = 0;      // Made with new: default build, arena full or sealed
+        size_t heapBytes = 0;
+        size_t overflowObjects = 0;  // Did not fit in the arena
+        size_t lateObjects = 0;      // Made after seal()
+    };
+
+    SetupArena(void* buffer, size_t capacity);
+
+    static SetupArena& global();     // CHAIN_ARENA_BYTES (none in the default build)
+
+    template <typename T, typename... Args>
+    static T* make(Args&&... args) {
+        void* slot = global().allocate(sizeof(T), alignof(T));
+        if (slot != nullptr) {
+            return new (slot) T(std::forward<Args>(args)...);
+        }
+        return new T(std::forward<Args>(args)...);
+    }
+
+    // Room for size bytes at align, or nullptr - the caller then uses the
+    // heap, which is counted here
+    void* allocate(size_t size, size_t align);
+
+    void seal() { sealed_ = true; }
+    bool sealed() const { return sealed_; }
+
+    size_t capacity() const { return capacity_; }
+    size_t used() const { return used_; }
+    const Stats& stats() const { return stats_; }
+
+private:
+    uint8_t* buffer_;
+    size_t capacity_;
+    size_t used_ = 0;
+    bool sealed_ = false;
+    Stats stats_;
+};
+
+#endif // SETUPARENA_H
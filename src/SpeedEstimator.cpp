@@ -0,0 +1,87 @@
+#include "SpeedEstimator.h"
+#include <cmath>
+#include <cstdlib>
+
+SpeedEstimator::SpeedEstimator(float meters_per_pulse)
+  : meters_per_pulse_(meters_per_pulse) {}
+
+void SpeedEstimator::reset() {
+    head_ = 0;
+    count_ = 0;
+    acceleration_ = 0.0;
+    cruise_us_ = 0;
+    cruise_pulses_ = 0;
+}
+
+void SpeedEstimator::addPulses(uint32_t timestamp_us, int32_t pulses) {
+    if (pulses == 0) return;
+
+    // A long gap or a direction change starts a new run
+    if (count_ > 0) {
+        const Stamp& last = back(0);
+        if (timestamp_us - last.t_us > STALE_US || (last.pulses > 0) != (pulses > 0)) {
+            reset();
+        }
+    }
+
+    if (count_ >= 2) {
+        // Skip the first interval: it includes motor spin-up (or a partial revolution)
+        cruise_us_ += timestamp_us - back(0).t_us;
+        cruise_pulses_ += abs(pulses);
+    }
+
+    ring_[head_] = {timestamp_us, pulses};
+    head_ = (head_ + 1) & (RING_SIZE - 1);
+    if (count_ < RING_SIZE) count_++;
+
+    if (count_ >= 3) {
+        float newer = intervalSpeed(0);
+        float older = intervalSpeed(1);
+        float span_s = (back(0).t_us - back(2).t_us) * 0.5e-6f;
+        if (span_s > 0.0f) {
+            // Light smoothing - a single late pulse should not read as hard braking
+            acceleration_ = 0.5f * ((newer - older) / span_s) + 0.5f * acceleration_;
+        }
+    }
+}
+
+float SpeedEstimator::intervalSpeed(size_t newer) const {
+    uint32_t dt_us = back(newer).t_us - back(newer + 1).t_us;
+    if (dt_us == 0) dt_us = 1;
+    return back(newer).pulses * meters_per_pulse_ / (dt_us * 1e-6f);
+}
+
+float SpeedEstimator::speed(uint32_t now_us) const {
+    if (count_ < 2) return 0.0;
+
+    size_t window = count_ - 1;
+    if (window > SPEED_WINDOW) window = SPEED_WINDOW;
+    int32_t pulses = 0;
+    for (size_t i = 0; i < window; i++) {
+        pulses += back(i).pulses;
+    }
+    uint32_t dt_us = back(0).t_us - back(window).t_us;
+    if (dt_us == 0) dt_us = 1;
+    float v = pulses * meters_per_pulse_ / (dt_us * 1e-6f);
+
+    // No pulse for longer than that speed implies: the chain is slowing down
+    uint32_t since_us = now_us - back(0).t_us;
+    if (since_us > 0) {
+        float cap = meters_per_pulse_ / (since_us * 1e-6f);
+        if (fabsf(v) > cap) v = (v > 0) ? cap : -cap;
+    }
+    return v;
+}
+
+float SpeedEstimator::pulseFraction(uint32_t now_us) const {
+    if (count_ < 2) return 0.0;
+    uint32_t interval_us = (back(0).t_us - back(1).t_us) / abs(back(0).pulses);
+    if (interval_us == 0) return 0.0;
+    float fraction = (float)(now_us - back(0).t_us) / interval_us;
+    return fraction < 0.9f ? fraction : 0.9f;  // Never claim a pulse that has not arrived
+}
+
+float SpeedEstimator::cruiseMsPerMeter() const {
+    if (cruise_pulses_ <= 0) return 0.0;
+    return (cruise_us_ / 1000.0f) / (cruise_pulses_ * meters_per_pulse_);
+}
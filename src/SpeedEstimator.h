@@ -0,0 +1,56 @@
+// SpeedEstimator.h
+#ifndef SPEEDESTIMATOR_H
+#define SPEEDESTIMATOR_H
+
+#include <Arduino.h>
+
+/**
+ * Live chain speed from gypsy pulse timestamps.
+ *
+ * The windlass task records a microsecond timestamp for every counted batch
+ * of pulses (normally one pulse per tick) in a small ring. Speed comes from
+ * the last few intervals, acceleration from the change between the two most
+ * recent intervals. Between pulses the speed is capped by the time since the
+ * last pulse, so it decays to zero when the chain stops instead of holding
+ * the last value.
+ *
+ * The ring is written and read only by the windlass task; other tasks see
+ * the results through the WindlassCore snapshot.
+ */
+class SpeedEstimator {
+public:
+    explicit SpeedEstimator(float meters_per_pulse);
+
+    void reset();
+    void addPulses(uint32_t timestamp_us, int32_t pulses);  // Signed: + lowering, - raising
+
+    float speed(uint32_t now_us) const;         // m/s, + lowering, - raising
+    float acceleration() const { return acceleration_; }  // m/s^2, same sign convention
+    float pulseFraction(uint32_t now_us) const; // Estimated fraction of a pulse moved since the last one
+    float cruiseMsPerMeter() const;             // Mean ms/m over the move, first interval excluded (0 = unknown)
+    size_t intervals() const { return count_ > 0 ? count_ - 1 : 0; }
+
+    static constexpr size_t RING_SIZE = 16;         // Power of two
+    static constexpr size_t SPEED_WINDOW = 3;       // Intervals averaged for speed()
+    static constexpr uint32_t STALE_US = 2000000;   // Gap that starts a new run
+
+private:
+    struct Stamp {
+        uint32_t t_us;
+        int32_t pulses;
+    };
+    const Stamp& back(size_t i) const { return ring_[(head_ - 1 - i) & (RING_SIZE - 1)]; }
+    float intervalSpeed(size_t newer) const;    // Speed over the interval ending at back(newer)
+
+    float meters_per_pulse_;
+    Stamp ring_[RING_SIZE];
+    size_t head_ = 0;
+    size_t count_ = 0;
+    float acceleration_ = 0.0;
+
+    // Whole-run totals for the cruise speed (first interval is spin-up)
+    uint64_t cruise_us_ = 0;
+    int32_t cruise_pulses_ = 0;
+};
+
+#endif // SPEEDESTIMATOR_H
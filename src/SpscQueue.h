@@ -0,0 +1,51 @@
+// SpscQueue.h
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * Lock-free single-producer/single-consumer ring buffer.
+ *
+ * One task may call push() and one other task may call pop(); neither ever
+ * blocks or takes a lock, so a stalled consumer cannot delay the producer
+ * (push() just fails when the ring is full). Holds N - 1 items.
+ */
+template <typename T, size_t N>
+class SpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+
+public:
+    bool push(const T& item) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t next = (head + 1) & (N - 1);
+        if (next == tail_.load(std::memory_order_acquire)) {
+            return false;  // Full
+        }
+        buffer_[head] = item;
+        head_.store(next, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T* item) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) {
+            return false;  // Empty
+        }
+        *item = buffer_[tail];
+        tail_.store((tail + 1) & (N - 1), std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return tail_.load(std::memory_order_acquire) == head_.load(std::memory_order_acquire);
+    }
+
+private:
+    T buffer_[N];
+    std::atomic<size_t> head_{0};  // Written only by the producer
+    std::atomic<size_t> tail_{0};  // Written only by the consumer
+};
+
+#endif // SPSCQUEUE_H
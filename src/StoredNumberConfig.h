@@ -0,0 +1,80 @@
+// StoredNumberConfig.h
+#ifndef STOREDNUMBERCONFIG_H
+#define STOREDNUMBERCONFIG_H
+
+#include <ArduinoJson.h>
+#include "ConfigStore.h"
+#include "sensesp/system/saveable.h"
+#include "sensesp/system/serializable.h"
+#include "sensesp/ui/ui_controls.h"
+
+/**
+ * Drop-in for sensesp::NumberConfig whose value lives in the ConfigStore
+ * record instead of its own JSON file. The web UI sees the same schema and
+ * the same config path, so ConfigItem() and the config page do not change.
+ *
+ * Without a record the value is read once from the NumberConfig file at the
+ * same path (migration). A save from the web UI updates the record, and the
+ * JSON file as well, so an older firmware - or a lost record - still finds
+ * the current value there.
+ */
+class StoredNumberConfig : public sensesp::Saveable, virtual public sensesp::Serializable {
+public:
+    StoredNumberConfig(float default_value, const String& config_path,
+                       ConfigStore& store = ConfigStore::global())
+      : sensesp::Saveable(config_path), store_(store) {
+        value_ = store_.add(config_path_.c_str(), default_value, [default_value, config_path]() {
+            float legacy_value = default_value;
+            sensesp::NumberConfig legacy(legacy_value, config_path);   // Reads the file
+            return legacy.get_value();
+        });
+    }
+
+    float get_value() const { return value_; }
+
+    bool to_json(JsonObject& root) override {
+        root["value"] = value_;
+        return true;
+    }
+
+    bool from_json(const JsonObject& root) override {
+        if (!root["value"].is<float>()) {
+            return false;
+        }
+        value_ = root["value"];
+        return true;
+    }
+
+    bool load() override {
+        value_ = store_.get(config_path_.c_str());
+        return true;
+    }
+    bool refresh() override { return load(); }
+
+    bool save() override {
+        if (!store_.set(config_path_.c_str(), value_)) {
+            return true;   // Unchanged - nothing to write
+        }
+        // Keep the legacy file current
+        float legacy_value = value_;
+        sensesp::NumberConfig legacy(legacy_value, config_path_);
+        JsonDocument doc;
+        JsonObject root = doc.to<JsonObject>();
+        root["value"] = value_;
+        legacy.from_json(root);
+        legacy.save();
+        return store_.commit();
+    }
+
+private:
+    ConfigStore& store_;
+    float value_ = 0.0;
+};
+
+inline const String ConfigSchema(const StoredNumberConfig&) {
+    return R"({"type":"object","properties":{"value":{"title":"Value","type":"number"}}})";
+}
+
+inline bool ConfigRequiresRestart(const StoredNumberConfig&) { return true; }
+
+#endif // STOREDNUMBERCONFIG_H
@@ -0,0 +1,414 @@
+#include "WindlassCore.h"
+#include <Arduino.h>
+#include <cmath>
+#include "ChainController.h"  // Slack and final-pull constants
+#include "ChainTrace.h"
+#include "PerfStats.h"
+#include "PositionSnapshot.h"
+
+WindlassCore::WindlassCore(float meters_per_pulse, int32_t min_pulses, int32_t max_pulses,
+                           int32_t stop_before_max_pulses, int32_t initial_pulses,
+                           int downRelayPin, int upRelayPin, uint8_t unit)
+  : meters_per_pulse_(meters_per_pulse),
+    min_pulses_(min_pulses),
+    max_pulses_(max_pulses),
+    stop_before_max_pulses_(stop_before_max_pulses),
+    unit_(unit),
+    pulses_(initial_pulses),
+    relays_(downRelayPin, upRelayPin),   // Both off
+    estimator_(meters_per_pulse)
+{
+    publishSnapshot();
+    mirrorPosition();
+}
+
+void WindlassCore::setPulseCounter(PulseCounter* counter, int up_sense_gpio, int down_sense_gpio) {
+    counter_ = counter;
+    up_sense_gpio_ = up_sense_gpio;
+    down_sense_gpio_ = down_sense_gpio;
+}
+
+bool WindlassCore::start() {
+    if (task_ != nullptr) return true;
+    // Single-core chips (ESP32-C3) only have core 0; the priority split still applies
+    BaseType_t ok = xTaskCreatePinnedToCore(taskMain, "windlass", TASK_STACK_BYTES, this,
+                                            TASK_PRIORITY, &task_, TASK_CORE);
+    if (ok != pdPASS) {
+        task_ = nullptr;
+        ESP_LOGE(__FILE__, "WindlassCore: failed to create windlass task");
+        return false;
+    }
+    ESP_LOGI(__FILE__, "WindlassCore: task for unit %u started on core %d, priority %u, tick %lu ms",
+             (unsigned)unit_, (int)TASK_CORE, (unsigned)TASK_PRIORITY, TICK_MS);
+    return true;
+}
+
+void WindlassCore::taskMain(void* arg) {
+    WindlassCore* self = static_cast<WindlassCore*>(arg);
+    TickType_t last_wake = xTaskGetTickCount();
+    const TickType_t period = pdMS_TO_TICKS(TICK_MS) > 0 ? pdMS_TO_TICKS(TICK_MS) : 1;
+    const TickType_t watch_period = pdMS_TO_TICKS(WATCH_TICK_MS) > period ? pdMS_TO_TICKS(WATCH_TICK_MS) : period;
+    for (;;) {
+        bool busy;
+        {
+            PERF_SCOPE(PerfSite::WINDLASS_TICK);
+            busy = self->tick();
+        }
+        // Back to TICK_MS on the first pulse or command, before the event loop notices
+        vTaskDelayUntil(&last_wake, self->watch_ && !busy ? watch_period : period);
+    }
+}
+
+bool WindlassCore::tick() {
+    bool busy = false;
+    Command command;
+    while (commands_.pop(&command)) {
+        apply(command);
+        busy = true;
+    }
+
+    // Keep the last good inputs if the event loop was preempted mid-write
+    inputs_.tryRead(&inputs_cache_);
+
+    if (counter_ != nullptr) {
+        int32_t delta = counter_->takeDelta();
+        busy |= delta != 0;
+        CHAIN_TRACE_RECORD(sense(unit_, digitalRead(up_sense_gpio_) == LOW, digitalRead(down_sense_gpio_) == LOW));
+        if (delta != 0 && counting_enabled_) {  // Pulses before the hall input settled are discarded
+            CHAIN_TRACE_RECORD(pulses(unit_, delta));
+            // NOTE: Relays are ACTIVE-LOW (energized = LOW, off = HIGH)
+            bool up_relay_active = (digitalRead(up_sense_gpio_) == LOW);
+            bool down_relay_active = (digitalRead(down_sense_gpio_) == LOW);
+            if (up_relay_active && down_relay_active) {
+                Event event = {};
+                event.type = Event::Type::SAFETY_VIOLATION;
+                event.end_pulses = delta;
+                pushEvent(event);
+            } else {
+                countPulses(delta, micros());
+            }
+        }
+    }
+
+    relays_.update(millis());   // A start held for the reversal dead time
+    control();
+    superviseCoast(millis());
+    CHAIN_TRACE_RECORD(relay(unit_, relays_.output()));
+    publishSnapshot();
+    mirrorPosition();
+    return busy || state_ != ChainState::IDLE || coast_watch_;
+}
+
+void WindlassCore::apply(const Command& command) {
+    switch (command.type) {
+        case Command::Type::LOWER:
+        case Command::Type::RAISE:
+            if (state_ != ChainState::IDLE) {
+                endMove(StopReason::COMMAND);  // Report the interrupted move first
+            }
+            target_pulses_ = command.pulses;
+            start_pulses_ = pulses_;
+            movement_start_time_ = millis();
+            if (movement_start_time_ == 0) movement_start_time_ = 1;  // 0 means "no movement"
+            move_timeout_ = command.timeout_ms;
+            pulse_interval_ms_ = command.pulse_interval_ms > 0 ? command.pulse_interval_ms
+                                                               : DEFAULT_PULSE_INTERVAL_MS;
+            last_pulse_time_ = movement_start_time_;
+            awaiting_first_pulse_ = true;
+            coast_ms_ = command.coast_ms;
+            coast_watch_ = false;
+            estimator_.reset();
+            paused_for_slack_ = false;
+            slack_control_ = command.slack_control;
+            slack_estimate_ms_ = 0;
+            last_slack_action_time_ = 0;
+            paused_total_ms_ = 0;
+            // The driver drops the opposite relay first and holds a reversal
+            // for its dead time; the spin-up allowance covers the wait
+            if (command.type == Command::Type::LOWER) {
+                state_ = ChainState::LOWERING;
+                relays_.set(RelayDriver::Output::DOWN, movement_start_time_);
+            } else {
+                state_ = ChainState::RAISING;
+                relays_.set(RelayDriver::Output::UP, movement_start_time_);
+            }
+            break;
+
+        case Command::Type::STOP:
+            relays_.set(RelayDriver::Output::OFF, millis());
+            if (state_ != ChainState::IDLE) {
+                endMove(StopReason::COMMAND);
+            }
+            break;
+
+        case Command::Type::ADD_PULSES:
+            countPulses(command.pulses, command.timestamp_us);
+            break;
+
+        case Command::Type::SET_PULSES:
+            pulses_ = constrain(command.pulses, 0, max_pulses_);
+            break;
+
+        case Command::Type::ENABLE_COUNTING:
+            counting_enabled_ = true;
+            break;
+    }
+    acked_seq_ = command.seq;
+}
+
+void WindlassCore::countPulses(int32_t delta, uint32_t timestamp_us) {
+    // Same clamp as ChainPosition: whole pulses in [0, max_length]
+    pulses_ = constrain(pulses_ + delta, 0, max_pulses_);
+    last_pulse_time_ = millis();
+    awaiting_first_pulse_ = false;
+    estimator_.addPulses(timestamp_us, delta);
+    if (coast_watch_) {
+        // The sense line drops with the relay, so a raise's coast may count as
+        // lowering - only the size of the overrun matters here
+        coast_pulses_ += abs(delta);
+    }
+}
+
+unsigned long WindlassCore::movingMs(unsigned long now) const {
+    unsigned long paused = paused_total_ms_;
+    if (paused_for_slack_) paused += now - paused_since_;
+    return now - movement_start_time_ - paused;
+}
+
+bool WindlassCore::coastReachesTarget(int32_t remaining_pulses) const {
+    if (coast_ms_ == 0 || estimator_.intervals() < MIN_PREDICT_INTERVALS) return false;
+    uint32_t now_us = micros();
+    float coast_pulses = fabsf(estimator_.speed(now_us)) * coast_ms_ * 0.001f / meters_per_pulse_;
+    return remaining_pulses - estimator_.pulseFraction(now_us) <= coast_pulses;
+}
+
+void WindlassCore::superviseCoast(unsigned long now) {
+    if (!coast_watch_) return;
+    if (now - coast_start_ms_ < COAST_WINDOW_MS) return;
+    coast_watch_ = false;
+    Event event = {};
+    event.type = Event::Type::COAST_MEASURED;
+    event.direction = coast_direction_;
+    event.speed_mps = coast_speed_;
+    event.end_pulses = coast_pulses_;
+    pushEvent(event);
+}
+
+bool WindlassCore::isStalled(unsigned long now) const {
+    if (paused_for_slack_) return false;  // Relay is off on purpose
+    unsigned long window = STALL_FACTOR * pulse_interval_ms_;
+    if (window < STALL_MIN_MS) window = STALL_MIN_MS;
+    // A held reversal spends up to MAX_DEAD_TIME_MS of the spin-up allowance
+    static_assert(RelayDriver::MAX_DEAD_TIME_MS <= SPINUP_MS / 2, "dead time would eat the spin-up allowance");
+    if (awaiting_first_pulse_) window += SPINUP_MS;
+    return now - last_pulse_time_ > window;
+}
+
+void WindlassCore::control() {
+    if (state_ == ChainState::IDLE) return;
+
+    unsigned long now = millis();
+
+    // Check if movement has exceeded calculated timeout (slack pauses don't count)
+    unsigned long elapsed = movingMs(now);
+    if (elapsed > move_timeout_) {
+        relays_.set(RelayDriver::Output::OFF, now);
+        endMove(StopReason::TIMEOUT);
+        return;
+    }
+
+    // A jammed gypsy or a dead sensor shows up as missing pulses long before
+    // the overall timeout
+    if (isStalled(now)) {
+        relays_.set(RelayDriver::Output::OFF, now);
+        endMove(StopReason::STALL, now - last_pulse_time_);
+        return;
+    }
+
+    switch (state_) {
+        case ChainState::IDLE:
+            break;
+
+        case ChainState::LOWERING:
+            // Also checking against stop_before_max_ ensures a stop if that limit is hit.
+            if (pulses_ >= target_pulses_ || pulses_ >= stop_before_max_pulses_) {
+                relays_.set(RelayDriver::Output::OFF, now);
+                endMove(pulses_ >= target_pulses_ ? StopReason::TARGET : StopReason::LIMIT);
+            } else if (coastReachesTarget(target_pulses_ - pulses_)) {
+                relays_.set(RelayDriver::Output::OFF, now);
+                endMove(StopReason::TARGET, 0, true);
+            }
+            break;
+
+        case ChainState::RAISING: {
+            // Check if target reached first (highest priority)
+            if (pulses_ <= target_pulses_ || pulses_ <= min_pulses_) {
+                relays_.set(RelayDriver::Output::OFF, now);
+                endMove(pulses_ <= target_pulses_ ? StopReason::TARGET : StopReason::LIMIT);
+                break;
+            }
+            if (!paused_for_slack_ && coastReachesTarget(pulses_ - target_pulses_)) {
+                relays_.set(RelayDriver::Output::OFF, now);
+                endMove(StopReason::TARGET, 0, true);
+                break;
+            }
+
+            // Skip slack monitoring in final pull - chain is nearly vertical, catenary model breaks down
+            float rode = pulses_ * meters_per_pulse_;
+            if (rode <= inputs_cache_.depth + ChainController::BOW_HEIGHT_M + ChainController::FINAL_PULL_THRESHOLD_M) {
+                break;
+            }
+
+            // Normal raising - monitor slack and pause/resume as needed
+            updateSlackEstimate(now);
+            float slack = 0.0f, threshold = 0.0f;
+
+            if (!paused_for_slack_ && slackWantsPause(now, slack, threshold)) {
+                relays_.set(RelayDriver::Output::OFF, now);
+                paused_for_slack_ = true;
+                last_slack_action_time_ = now;
+                paused_since_ = now;
+                Event event = {};
+                event.type = Event::Type::SLACK_PAUSE;
+                event.slack = slack;
+                event.slack_threshold = threshold;
+                pushEvent(event);
+            } else if (paused_for_slack_ && slackWantsResume(now, slack, threshold)) {
+                relays_.set(RelayDriver::Output::UP, now);
+                paused_for_slack_ = false;
+                last_slack_action_time_ = now;
+                paused_total_ms_ += now - paused_since_;
+                last_pulse_time_ = now;          // Motor spins up again
+                awaiting_first_pulse_ = true;
+                Event event = {};
+                event.type = Event::Type::SLACK_RESUME;
+                event.slack = slack;
+                event.slack_threshold = threshold;
+                pushEvent(event);
+            }
+            break;
+        }
+    }
+}
+
+void WindlassCore::endMove(StopReason reason, unsigned long pulse_gap_ms, bool predicted) {
+    float speed = estimator_.speed(micros());
+    Event event = {};
+    event.type = Event::Type::MOVE_ENDED;
+    event.direction = state_;
+    event.reason = reason;
+    event.duration_ms = movingMs(millis());  // Slack pauses excluded
+    event.start_pulses = start_pulses_;
+    event.end_pulses = pulses_;
+    event.target_pulses = target_pulses_;
+    event.pulse_gap_ms = pulse_gap_ms;
+    event.speed_mps = speed;
+    event.cruise_ms_per_m = estimator_.cruiseMsPerMeter();
+    event.predicted = predicted;
+    pushEvent(event);
+
+    // Count the overrun after the cut to learn the coast (not after a stall - nothing is moving)
+    coast_watch_ = (reason != StopReason::STALL && !paused_for_slack_ && fabsf(speed) >= MIN_COAST_SPEED_MPS);
+    if (coast_watch_) {
+        coast_start_ms_ = millis();
+        coast_direction_ = state_;
+        coast_speed_ = fabsf(speed);
+        coast_pulses_ = 0;
+    }
+
+    state_ = ChainState::IDLE;
+    movement_start_time_ = 0;
+    paused_for_slack_ = false;
+    last_slack_action_time_ = 0;
+}
+
+void WindlassCore::pushEvent(const Event& event) {
+    if (!events_.push(event)) {
+        dropped_events_++;  // Event loop is behind; the snapshot still carries the state
+    }
+}
+
+void WindlassCore::mirrorPosition() {
+    if (mirrored_ && pulses_ == mirrored_pulses_ && state_ == mirrored_state_) return;
+    PositionSnapshot::write(pulses_, state_, unit_);
+    mirrored_pulses_ = pulses_;
+    mirrored_state_ = state_;
+    mirrored_ = true;
+}
+
+void WindlassCore::publishSnapshot() {
+    Snapshot snapshot;
+    snapshot.pulses = pulses_;
+    snapshot.target_pulses = target_pulses_;
+    snapshot.state = state_;
+    snapshot.paused_for_slack = paused_for_slack_;
+    snapshot.acked_seq = acked_seq_;
+    snapshot.dropped_events = dropped_events_;
+    snapshot.speed_mps = estimator_.speed(micros());
+    snapshot.accel_mps2 = estimator_.acceleration();
+    snapshot.relays = relays_.stats(millis());
+    snapshot_.write(snapshot);
+}
+
+// ============================================================================
+// Slack pause/resume while raising
+// ============================================================================
+
+float WindlassCore::cruiseMps() const {
+    return meters_per_pulse_ * 1000.0f / (float)pulse_interval_ms_;
+}
+
+void WindlassCore::updateSlackEstimate(unsigned long now) {
+    if (slack_estimate_ms_ == 0) {
+        slack_estimate_ = inputs_cache_.slack;
+    } else {
+        float dt_s = (now - slack_estimate_ms_) * 0.001f;
+        slack_estimate_ += (pulses_ - slack_estimate_pulses_) * meters_per_pulse_;  // Hauled in: negative
+        slack_estimate_ += inputs_cache_.slack_rate_mps * dt_s;
+        slack_estimate_ += (inputs_cache_.slack - slack_estimate_) * fminf(1.0f, dt_s / SLACK_FILTER_TAU_S);
+    }
+    slack_estimate_pulses_ = pulses_;
+    slack_estimate_ms_ = now != 0 ? now : 1;
+}
+
+bool WindlassCore::slackWantsPause(unsigned long now, float& slack, float& threshold) const {
+    slack = inputs_cache_.slack;
+    threshold = ChainController::PAUSE_SLACK_M;
+    if (slack_control_ == SlackControl::HYSTERESIS) {
+        return slack < threshold &&
+               (last_slack_action_time_ == 0 || now - last_slack_action_time_ >= ChainController::SLACK_COOLDOWN_MS);
+    }
+
+    // PAUSE_SLACK_M is a hard floor: measured or estimated slack under it
+    // pauses at once, whatever the prediction says
+    if (slack < threshold) return true;
+    slack = slack_estimate_;
+    if (slack < threshold) return true;
+    // The on-window started with the move or the last resume
+    unsigned long on_since = last_slack_action_time_ != 0 ? last_slack_action_time_ : movement_start_time_;
+    if (now - on_since < SLACK_MIN_ON_MS) return false;
+    float rate = inputs_cache_.slack_rate_mps - cruiseMps();
+    float horizon_s = SLACK_LOOKAHEAD_S + coast_ms_ * 0.001f;
+    slack = slack_estimate_ + rate * horizon_s;
+    return slack < threshold;
+}
+
+bool WindlassCore::slackWantsResume(unsigned long now, float& slack, float& threshold) const {
+    if (slack_control_ == SlackControl::HYSTERESIS) {
+        slack = inputs_cache_.slack;
+        threshold = ChainController::RESUME_SLACK_M;
+        return slack >= threshold && now - last_slack_action_time_ >= ChainController::SLACK_COOLDOWN_MS;
+    }
+
+    if (now - paused_since_ < SLACK_MIN_OFF_MS) return false;
+    if (inputs_cache_.slack < ChainController::PAUSE_SLACK_M) return false;  // Would pause again at once
+    // A full on-window and the top of the band, unless the boat has stopped
+    // adding slack; what it adds during spin-up counts too
+    float rate = inputs_cache_.slack_rate_mps;
+    float needed = ChainController::PAUSE_SLACK_M + (cruiseMps() - rate) * SLACK_WINDOW_MS * 0.001f;
+    needed = fmaxf(needed, SLACK_BAND_HIGH_M);
+    needed = fminf(needed, ChainController::RESUME_SLACK_M + fmaxf(0.0f, rate) * SLACK_MAX_WAIT_S);
+    slack = slack_estimate_ + rate * SLACK_LOOKAHEAD_S;
+    threshold = needed;
+    return slack >= threshold;
+}
@@ -0,0 +1,258 @@
+// WindlassCore.h
+#ifndef WINDLASSCORE_H
+#define WINDLASSCORE_H
+
+#include <Arduino.h>
+#include "ChainTypes.h"
+#include "PulseCounter.h"
+#include "RelayDriver.h"
+#include "Seqlock.h"
+#include "SpeedEstimator.h"
+#include "SpscQueue.h"
+
+/**
+ * Real-time half of the windlass controller.
+ *
+ * A FreeRTOS task pinned to TASK_CORE owns the gypsy pulse accumulator, the
+ * relays (through a RelayDriver) and the motion loop (target/limit stops, movement timeout,
+ * stall detection, predictive stopping and slack pause/resume during a
+ * raise). It runs every
+ * TICK_MS regardless of what the SensESP event loop is doing, so
+ * position-limit stops keep their latency through WiFi reconnects, OTA and
+ * web UI traffic.
+ *
+ * Nothing here touches SensESP objects. The event-loop side (ChainController)
+ * talks to the task only through:
+ *  - a lock-free SPSC queue of Commands (event loop -> task)
+ *  - a lock-free SPSC queue of Events (task -> event loop): finished moves,
+ *    slack pauses and safety violations, so logging and NVS writes stay off
+ *    the real-time task
+ *  - a seqlock Snapshot of the task state (task -> event loop)
+ *  - a seqlock of control Inputs, i.e. slack and depth (event loop -> task)
+ *
+ * Every change of the pulse count or motion state is also mirrored to RTC
+ * memory (PositionSnapshot, in the slots of its unit) for a warm restart.
+ * Each windlass on the board runs its own task.
+ *
+ * Flash writes (journal commits, NVS, OTA) still suspend both CPUs for their
+ * duration; that is an ESP32 cache limitation, not something a task split
+ * can avoid.
+ */
+class WindlassCore {
+public:
+    // How a raise pauses for slack (see control())
+    enum class SlackControl : uint8_t {
+        HYSTERESIS,                  // Pause below PAUSE_SLACK_M, resume at RESUME_SLACK_M, 3 s cooldown
+        ADAPTIVE                     // Predict slack from closing and chain speed, minimum on/off windows
+    };
+
+    struct Command {
+        enum class Type : uint8_t {
+            LOWER,             // Move to target_pulses with the DOWN relay
+            RAISE,             // Move to target_pulses with the UP relay
+            STOP,              // Relays off, report the move
+            ADD_PULSES,        // Pulses counted outside the task, not by a PulseCounter
+            SET_PULSES,        // Chain reset
+            ENABLE_COUNTING    // Hall input settled (see InputReadiness)
+        };
+        Type type;
+        uint32_t seq;
+        int32_t pulses;              // Target for LOWER/RAISE, count for ADD/SET_PULSES
+        unsigned long timeout_ms;    // LOWER/RAISE movement timeout
+        unsigned long pulse_interval_ms;  // LOWER/RAISE expected time between pulses (0 = unknown)
+        unsigned long coast_ms;      // LOWER/RAISE learned coast after relay cut (0 = stop on target)
+        uint32_t timestamp_us;       // ADD_PULSES: micros() when the pulses were counted
+        SlackControl slack_control;  // RAISE: pause/resume policy
+    };
+
+    struct Inputs {
+        float slack;                 // Horizontal slack (m)
+        float depth;                 // Validated depth below surface (m)
+        float slack_rate_mps;        // Slack the boat adds with the windlass stopped (m/s, - drifting back)
+    };
+
+    enum class StopReason : uint8_t {
+        TARGET,                      // Requested length reached
+        LIMIT,                       // min_length / stop_before_max reached
+        TIMEOUT,                     // Movement took longer than the timeout
+        STALL,                       // Relay on but no pulse within the stall window
+        COMMAND                      // Stopped by a STOP command
+    };
+
+    struct Event {
+        enum class Type : uint8_t {
+            MOVE_ENDED,
+            SLACK_PAUSE,
+            SLACK_RESUME,
+            SAFETY_VIOLATION,        // Both relay sense lines active - pulses discarded
+            COAST_MEASURED           // Pulses counted in COAST_WINDOW_MS after a relay cut
+        };
+        Type type;
+        ChainState direction;
+        StopReason reason;
+        unsigned long duration_ms;
+        int32_t start_pulses;
+        int32_t end_pulses;
+        int32_t target_pulses;
+        float slack;                 // SLACK_*: the slack the policy compared (measured or estimated)
+        float slack_threshold;       // SLACK_*: what it was compared against
+        unsigned long pulse_gap_ms;  // STALL: time since the last pulse
+        float speed_mps;             // Chain speed when the relay was cut
+        float cruise_ms_per_m;       // MOVE_ENDED: cruise speed from pulse timing (0 = unknown)
+        bool predicted;              // MOVE_ENDED: relay cut early so the coast lands on target
+    };
+
+    struct Snapshot {
+        int32_t pulses;
+        int32_t target_pulses;
+        ChainState state;
+        bool paused_for_slack;
+        uint32_t acked_seq;          // Seq of the last command the task applied
+        uint32_t dropped_events;     // Events lost because the event loop fell behind
+        float speed_mps;             // Live chain speed, + lowering
+        float accel_mps2;
+        RelayDriver::Stats relays;   // Starts, writes and motor on-time since boot
+    };
+
+    WindlassCore(float meters_per_pulse, int32_t min_pulses, int32_t max_pulses,
+                 int32_t stop_before_max_pulses, int32_t initial_pulses,
+                 int downRelayPin, int upRelayPin, uint8_t unit = 0);
+
+    // Optional hardware counter read by the task; the sense GPIOs are the
+    // ACTIVE-LOW relay inputs used for the both-relays safety check.
+    void setPulseCounter(PulseCounter* counter, int up_sense_gpio, int down_sense_gpio);
+    // Before start(): how long a released relay stays off before the other direction starts
+    void setRelayDeadTime(unsigned long dead_time_ms) { relays_.setDeadTime(dead_time_ms); }
+    unsigned long relayDeadTime() const { return relays_.deadTime(); }
+    bool start();
+    bool isRunning() const { return task_ != nullptr; }
+
+    // Event-loop side
+    bool post(const Command& command) { return commands_.push(command); }
+    bool nextEvent(Event* event) { return events_.pop(event); }
+    Snapshot snapshot() const { return snapshot_.read(); }
+    void publishInputs(const Inputs& inputs) { inputs_.write(inputs); }
+    // Anchor watch: while nothing moves the task polls every WATCH_TICK_MS
+    // instead of every TICK_MS, so the core is idle long enough to sleep
+    void setAnchorWatch(bool watch) { watch_ = watch; }
+
+    static constexpr unsigned long TICK_MS = 1;
+    static constexpr unsigned long WATCH_TICK_MS = 20;   // One pulse at full speed is ~250 ms
+    static constexpr BaseType_t TASK_CORE = 0;           // SensESP/Arduino loop runs on core 1
+    static constexpr UBaseType_t TASK_PRIORITY = 20;     // Above lwIP/async_tcp, below the WiFi driver
+    static constexpr uint32_t TASK_STACK_BYTES = 3072;
+
+    // Stall supervision: with a relay on, a pulse must arrive within
+    // STALL_FACTOR expected intervals (at least STALL_MIN_MS). The first pulse
+    // after a start or slack resume also gets SPINUP_MS for the motor.
+    static constexpr unsigned long STALL_MIN_MS = 400;
+    static constexpr unsigned long STALL_FACTOR = 3;
+    static constexpr unsigned long SPINUP_MS = 1000;
+    static constexpr unsigned long DEFAULT_PULSE_INTERVAL_MS = 250;  // 1 s/m at 0.25 m/pulse
+
+    // Adaptive slack control. The measured slack jumps with every GPS
+    // distance sample, so the task tracks its own estimate: each pulse
+    // hauled in takes its length off, the boat closing in adds
+    // slack_rate_mps per second, and the measurement pulls the estimate in
+    // with time constant SLACK_FILTER_TAU_S. The estimate is kept in the
+    // band PAUSE_SLACK_M..SLACK_BAND_HIGH_M:
+    //  - on: slack falls at cruise - slack_rate; the relay goes off once the
+    //    estimate would be under the band by the end of the coast plus
+    //    SLACK_LOOKAHEAD_S, but not before SLACK_MIN_ON_MS (noise)
+    //  - off: after at least SLACK_MIN_OFF_MS it comes on again once there
+    //    is slack for a whole SLACK_WINDOW_MS at that rate, and at least the
+    //    top of the band - waiting no longer than it takes the boat to add
+    //    SLACK_MAX_WAIT_S worth over RESUME_SLACK_M, so a boat that has
+    //    stopped closing in gets the hysteresis threshold
+    // PAUSE_SLACK_M stays a hard floor: measured or estimated slack under it
+    // stops the relay at once, and it does not come on again while the
+    // measured slack is under it.
+    static constexpr float SLACK_FILTER_TAU_S = 3.0;
+    static constexpr float SLACK_BAND_HIGH_M = 1.5;
+    static constexpr unsigned long SLACK_MIN_ON_MS = 3000;
+    static constexpr unsigned long SLACK_MIN_OFF_MS = 2000;
+    static constexpr unsigned long SLACK_WINDOW_MS = 3000;
+    static constexpr float SLACK_LOOKAHEAD_S = 0.5;
+    static constexpr float SLACK_MAX_WAIT_S = 4.0;
+
+    // Predictive stop: cut the relay once the learned coast at the live speed
+    // covers the remaining distance, after a few intervals of steady timing
+    static constexpr size_t MIN_PREDICT_INTERVALS = 3;
+    static constexpr unsigned long COAST_WINDOW_MS = 1500;  // Overrun counted after a cut
+    static constexpr float MIN_COAST_SPEED_MPS = 0.05;      // Below this a cut has no measurable coast
+
+private:
+    static void taskMain(void* arg);
+    bool tick();   // True while there is motion, a coast or new pulses/commands
+    void apply(const Command& command);
+    void countPulses(int32_t delta, uint32_t timestamp_us);
+    bool coastReachesTarget(int32_t remaining_pulses) const;
+    unsigned long movingMs(unsigned long now) const;  // Elapsed, excluding slack pauses
+    void superviseCoast(unsigned long now);
+    void control();
+    bool isStalled(unsigned long now) const;
+    void updateSlackEstimate(unsigned long now);
+    // slack and threshold are what the policy compared, for the log
+    bool slackWantsPause(unsigned long now, float& slack, float& threshold) const;
+    bool slackWantsResume(unsigned long now, float& slack, float& threshold) const;
+    float cruiseMps() const;         // Expected chain speed from the commanded pulse interval
+    void endMove(StopReason reason, unsigned long pulse_gap_ms = 0, bool predicted = false);
+    void pushEvent(const Event& event);
+    void publishSnapshot();
+    void mirrorPosition();           // PositionSnapshot, when the count or state changed
+
+    // Geometry and limits - fixed at construction
+    float meters_per_pulse_;
+    int32_t min_pulses_;
+    int32_t max_pulses_;
+    int32_t stop_before_max_pulses_;
+    uint8_t unit_;   // PositionSnapshot slots
+
+    PulseCounter* counter_ = nullptr;
+    int up_sense_gpio_ = -1;
+    int down_sense_gpio_ = -1;
+    TaskHandle_t task_ = nullptr;
+    volatile bool watch_ = false;   // Written by the event loop
+
+    // Task-owned state
+    int32_t pulses_;
+    int32_t target_pulses_ = 0;
+    int32_t start_pulses_ = 0;
+    ChainState state_ = ChainState::IDLE;
+    unsigned long movement_start_time_ = 0;
+    unsigned long move_timeout_ = 10000;
+    unsigned long pulse_interval_ms_ = DEFAULT_PULSE_INTERVAL_MS;
+    unsigned long last_pulse_time_ = 0;      // Last counted pulse, or (re)start of the motor
+    bool awaiting_first_pulse_ = false;
+    bool counting_enabled_ = false;
+    bool paused_for_slack_ = false;
+    SlackControl slack_control_ = SlackControl::HYSTERESIS;
+    float slack_estimate_ = 0.0;            // ADAPTIVE: filtered slack (m)
+    int32_t slack_estimate_pulses_ = 0;     // Rode the estimate was last moved for
+    unsigned long slack_estimate_ms_ = 0;   // Last estimate update (0 = start from the measurement)
+    unsigned long last_slack_action_time_ = 0;
+    unsigned long paused_since_ = 0;
+    unsigned long paused_total_ms_ = 0;
+    uint32_t acked_seq_ = 0;
+    uint32_t dropped_events_ = 0;
+    bool mirrored_ = false;
+    int32_t mirrored_pulses_ = 0;
+    ChainState mirrored_state_ = ChainState::IDLE;
+    Inputs inputs_cache_ = {0.0, 0.0, 0.0};
+    RelayDriver relays_;
+
+    SpeedEstimator estimator_;
+    unsigned long coast_ms_ = 0;
+    bool coast_watch_ = false;
+    unsigned long coast_start_ms_ = 0;
+    ChainState coast_direction_ = ChainState::IDLE;
+    float coast_speed_ = 0.0;
+    int32_t coast_pulses_ = 0;
+
+    SpscQueue<Command, 16> commands_;
+    SpscQueue<Event, 16> events_;
+    Seqlock<Snapshot> snapshot_;
+    Seqlock<Inputs> inputs_;
+};
+
+#endif // WINDLASSCORE_H
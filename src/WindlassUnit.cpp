@@ -0,0 +1,665 @@
+#include "WindlassUnit.h"
+#include "sensesp/sensors/digital_input.h"
+#include "sensesp/signalk/signalk_put_request_listener.h"
+#include "sensesp/system/lambda_consumer.h"
+#include "sensesp/signalk/signalk_output.h"
+#include "sensesp/transforms/debounce.h"
+#include "sensesp/ui/status_page_item.h"
+#include "sensesp/ui/ui_controls.h"
+#include "BoatSimulator.h"
+#include "ChainTrace.h"
+#include "CommandDispatcher.h"
+#include "DragDetector.h"
+#include "LogSink.h"
+#include "PulseCounter.h"
+#include "SetupArena.h"
+#include "StoredNumberConfig.h"
+
+using namespace sensesp;
+
+/**
+ * Per-unit defaults. Unit 0 is the single-windlass firmware: its paths,
+ * pins, journal partition and NVS namespace are the ones it always had.
+ * Unit 1 (a stern windlass) uses pins free on the default board and a
+ * journal partition the default table does not have, so its position is
+ * kept in NVS unless "chainlog2" is added to the partition table.
+ */
+struct WindlassUnit::Defaults {
+    const char* name;
+    const char* configPrefix;
+    const char* skPrefix;
+    const char* journalPartition;
+    const char* journalNamespace;
+    float upGpio;          // di1, UP button / relay sense
+    float downGpio;        // di2, DOWN button / relay sense
+    float counterGpio;     // di3, hall effect sensor
+    float resetGpio;       // di4, RESET button
+    float upRelay;
+    float downRelay;
+};
+
+const WindlassUnit::Defaults WindlassUnit::DEFAULTS[WindlassUnit::MAX_UNITS] = {
+    {"Bow",   "",       "navigation.anchor",       "chainlog",  "chain",  23, 25, 27, 26, 16, 19},
+    {"Stern", "/stern", "navigation.anchor.stern", "chainlog2", "chain2", 32, 33, 14, 13, 17, 18},
+};
+
+namespace {
+
+// Web UI entries of unit n sort after those of unit n - 1
+constexpr int SORT_ORDER_PER_UNIT = 10000;
+
+}  // namespace
+
+WindlassUnit::WindlassUnit(uint8_t index)
+  : index_(index),
+    defaults_(DEFAULTS[index < MAX_UNITS ? index : 0]),
+    name_(defaults_.name),
+    config_prefix_(defaults_.configPrefix),
+    sk_prefix_(defaults_.skPrefix) {}
+
+float WindlassUnit::setting(const char* path, float default_value, const char* title, const char* description,
+                            int sort_order) {
+  auto config = std::make_shared<StoredNumberConfig>(default_value, config_prefix_ + path);
+  // Unit 0 keeps the titles of the single-windlass firmware
+  String label = index_ == 0 ? String(title) : String(name_ + ": " + title);
+  ConfigItem(config)
+    ->set_title(label)
+    ->set_description(description)
+    ->set_sort_order(sort_order + index_ * SORT_ORDER_PER_UNIT);
+  return config->get_value();
+}
+
+void WindlassUnit::configure() {
+  gypsy_circum_ = setting("/gypsy/circum", 0.25, "Gypsy Circumference",
+                          "Circumference of the gypsy in meters", 100);
+  up_delay_     = setting("/up/delay", 2000, "Up delay",
+                          "Time after a push to up button go to free fall", 200);
+  down_delay_   = setting("/down/delay", 2000, "Down delay",
+                          "Time after a push to down button go to free fall", 200);
+  di1_gpio_     = setting("/di1/gpio", defaults_.upGpio, "GPIO for UP button",
+                          "GPIO number connected to UP Button relay", 1100);
+  up_relay_     = setting("/di5/gpio", defaults_.upRelay, "GPIO for UP relay",
+                          "GPIO number connected to UP Button relay", 1125);
+  di1_dtime_    = setting("/di1/dbounce", 15, "Debounce Time for UP button",
+                          "Debounce time in ms for UP Button relay", 1150);
+  di2_gpio_     = setting("/di2/gpio", defaults_.downGpio, "GPIO for DOWN button",
+                          "GPIO number connected to DOWN Button relay", 1200);
+  dn_relay_     = setting("/di6/gpio", defaults_.downRelay, "GPIO for DOWN relay",
+                          "GPIO number connected to DOWN Button relay", 1135);
+  relay_dead_ms_ = setting("/relay/dead_time", RelayDriver::DEFAULT_DEAD_TIME_MS, "Relay reversal dead time",
+                           "Time in ms a released relay stays off before the other direction starts (at most 500). Reboot to apply.",
+                           1140);
+  di2_dtime_    = setting("/di2/dbounce", 15, "Debounce Time for DOWN button",
+                          "Debounce time in ms for DOWN Button relay", 1250);
+  di3_gpio_     = setting("/di3/gpio", defaults_.counterGpio, "GPIO for Hall effect sensor",
+                          "GPIO number connected to hall effect sensor", 1300);
+  di3_dtime_    = setting("/di3/dbounce", 15, "Debounce Time for hall effect sensor",
+                          "Debounce time in ms for hall effect sensor", 1350);
+  di3_use_pcnt_ = setting("/di3/source", 0, "Hall sensor counter source",
+                          "0 = GPIO interrupt with software debounce, 1 = ESP32 hardware pulse counter (PCNT). Reboot to apply.",
+                          1360) >= 1;
+  di3_filter_   = setting("/di3/pcnt_filter", 10, "PCNT glitch filter for hall effect sensor",
+                          "Hardware glitch filter in microseconds (max ~12 us), used only with the PCNT counter source",
+                          1370);
+  di4_gpio_     = setting("/di4/gpio", defaults_.resetGpio, "GPIO for RESET button",
+                          "GPIO number connected to RESET button", 1400);
+  di4_dtime_    = setting("/di4/dbounce", 15, "Debounce Time for RESET button",
+                          "Debounce time in ms for RESET button", 1450);
+  max_chain_    = setting("/chain/max_length", 80.0, "Max chain length",
+                          "Maximum length of the chain in meters", 1500);
+  slack_adaptive_ = setting("/chain/slack_control", 0, "Adaptive slack control",
+                            "1 = time raise pauses from the predicted slack, 0 = fixed pause/resume slack thresholds. Reboot to apply.",
+                            1510) >= 1;
+  settle_early_   = setting("/anchor/settle_early", 1, "Early dig-in settle",
+                            "1 = end the autoDrop dig-in holds once the boat has stopped drifting (hold times become upper bounds), 0 = fixed holds. Reboot to apply.",
+                            1520) >= 1;
+  drag_alarm_     = setting("/anchor/drag_alarm", 1, "Anchor drag alarm",
+                            "1 = raise a Signal K notification when slack stays negative or the boat keeps moving away beyond scope, 0 = off. Reboot to apply.",
+                            1530) >= 1;
+
+  // Signal K prefix of every path this unit publishes or listens on
+  auto sk_prefix_config = std::make_shared<StringConfig>(sk_prefix_, config_prefix_ + "/windlass/sk_prefix");
+  String label = index_ == 0 ? String("Signal K path prefix") : String(name_ + ": Signal K path prefix");
+  ConfigItem(sk_prefix_config)
+    ->set_title(label)
+    ->set_description("Prefix of this windlass' Signal K paths, e.g. navigation.anchor. Reboot to apply.")
+    ->set_sort_order(90 + index_ * SORT_ORDER_PER_UNIT);
+  sk_prefix_ = sk_prefix_config->get_value();
+}
+
+void WindlassUnit::begin(const Shared& shared) {
+  shared_ = shared;
+  PublishScheduler* publisher = shared_.publisher;
+
+  /**
+   * Chain position: after a warm restart (anything but power-on) the RTC
+   * snapshot the windlass task keeps is as fresh as the last pulse, so it
+   * comes first; the journal, up to a commit interval behind, is the
+   * fallback (see PositionSnapshot.h).
+   */
+  PositionSnapshot::State warm_state = {};
+  warm_start_ = shared_.warmReset && PositionSnapshot::read(&warm_state, index_);
+  journal_ = SetupArena::make<PositionJournal>(gypsy_circum_, defaults_.journalPartition, defaults_.journalNamespace);
+  journal_->begin();
+  int32_t saved_pulses = journal_->recoveredPulses();
+  if (warm_start_) {
+    SINK_LOGI(__FILE__, "%s: warm restart while %s: %ld pulses (%f m) from RTC memory, journal had %ld",
+              name_.c_str(), toString(warm_state.motion), (long)warm_state.pulses,
+              warm_state.pulses * gypsy_circum_, (long)saved_pulses);
+    saved_pulses = warm_state.pulses;
+    journal_->record(saved_pulses);   // Flash catches up on the next commit
+  }
+
+  SINK_LOGD(__FILE__, "%s: the saved chain length is %ld pulses (%f m)", name_.c_str(), (long)saved_pulses,
+            saved_pulses * gypsy_circum_);
+
+  /* Digital inputs - each one is ignored until it has settled (see InputReadiness.h) */
+  inputs_ = SetupArena::make<InputReadiness>();
+
+  /*Digital Outputs*/
+  pinMode(up_relay_, OUTPUT);
+  pinMode(dn_relay_, OUTPUT);
+  digitalWrite(up_relay_, LOW); // Relay off
+  digitalWrite(dn_relay_, LOW); // Relay off
+
+  /**
+   * position_ keeps the rode as a whole number of gypsy pulses and emits it
+   * in meters (pulses * gypsy_circum, the amount of chain moved by each
+   * revolution of the windlass). Limits are exact at 0 and max_chain, and a
+   * calibration change to gypsy_circum re-scales the saved count.
+   */
+  position_ = SetupArena::make<ChainPosition>(gypsy_circum_, max_chain_, saved_pulses);
+
+  /* Observable direction ("up", "down" or "free fall"), published only on change */
+  direction_ = SetupArena::make<EnumValue<ChainDirection>>(ChainDirection::FREE_FALL);
+  publisher->addState(direction_, sk_prefix_ + ".chainDirection", config_prefix_ + "/chain/direction");
+
+  /**
+   * There is no path for the amount of anchor rode deployed in the current
+   * Signal K specification. By creating an instance of SKMetaData, we can send
+   * a partial or full definition of the metadata that other consumers of Signal
+   * K data might find useful. (For example, Instrument Panel will benefit from
+   * knowing the units to be displayed.) The metadata is sent only the first
+   * time the data value is sent to the server.
+   *
+   * The rode has no deadband: every pulse is sent, at most one per window.
+   */
+  SKMetadata* metadata = SetupArena::make<SKMetadata>();
+  metadata->units_ = "m";
+  metadata->description_ = "Anchor Rode Deployed";
+  metadata->display_name_ = "Rode Deployed";
+  metadata->short_name_ = "Rode Out";
+  publisher->addNumber(position_, sk_prefix_ + ".rodeDeployed", config_prefix_ + "/rodeDeployed/sk", 0.0, metadata);
+
+  /* Persist every position change, whichever source counted it */
+  position_->connect_to(SetupArena::make<LambdaConsumer<float>>([this](float) {
+    shared_.wake("chain moved");
+    saveChainLength(false);
+  }));
+  journal_->startDeferredCommits();
+
+  //////////////////////////////////////////////////////////////////////////
+  //      Windlass Control Section
+  //////////////////////////////////////////////////////////////////////////
+
+  float min_length = 2.0;  // stop 2 meters before anchor is fully up
+  float stop_before_max = max_chain_ - 5.0;  // stop 5 meters before max
+
+  controller_ = SetupArena::make<ChainController>(
+    min_length,
+    max_chain_,
+    stop_before_max,
+    position_,
+    dn_relay_,
+    up_relay_,
+    shared_.environment,
+    ChainController::createDistanceInput(sk_prefix_, config_prefix_),
+    index_
+  );
+
+  controller_->setRelayDeadTime(relay_dead_ms_);
+  // initialize up and down speeds from preferences
+  controller_->loadSpeedsFromPrefs();
+  controller_->setSlackControl(slack_adaptive_ ? WindlassCore::SlackControl::ADAPTIVE
+                                               : WindlassCore::SlackControl::HYSTERESIS);
+
+  beginButtons();
+  // Starts the windlass task: it owns the pulse count, the relays and the
+  // limit stops, and position_ follows it on the event loop
+  beginCounter();
+
+  deployment_ = SetupArena::make<DeploymentManager>(controller_);
+  DeploymentManager::Tuning deploy_tuning = deployment_->getTuning();
+  deploy_tuning.settleEarly = settle_early_;
+  deployment_->setTuning(deploy_tuning);
+
+  publisher->addNumber(
+    controller_->getHorizontalSlackObservable(),
+    sk_prefix_ + ".chainSlack",
+    config_prefix_ + "/slack/sk",
+    shared_.slackDeadband,
+    SetupArena::make<SKMetadata>("m", "Anchor Chain Slack", "Chain Slack", "Slack")
+  );
+  publisher->addState(deployment_->getAutoStageObservable(), sk_prefix_ + ".autoStage",
+                      config_prefix_ + "/anchor/autoStage");
+  publisher->addNumber(
+    deployment_->getStageDurationObservable(),
+    sk_prefix_ + ".autoStageDuration",
+    config_prefix_ + "/anchor/autoStageDuration",
+    0.0,
+    SetupArena::make<SKMetadata>("s", "Duration of the last finished autoDrop stage", "Stage Duration", "Stage")
+  );
+  // Stage chain, expected distances and run times, at autoDrop start or on "plan"
+  publisher->addText(deployment_->getPlanObservable(), sk_prefix_ + ".autoPlan", config_prefix_ + "/anchor/autoPlan");
+
+  // Relay wear (see RelayDriver.h): motor run time since boot, and starts,
+  // held reversals and GPIO writes on the status page, every 10 s
+  auto* run_time = SetupArena::make<ObservableValue<float>>(0.0);
+  publisher->addNumber(
+    run_time,
+    sk_prefix_ + ".motorRunTime",
+    config_prefix_ + "/relay/runtime/sk",
+    1.0,
+    SetupArena::make<SKMetadata>("s", "Windlass motor run time since boot", "Motor Run Time", "Run Time")
+  );
+  auto* relay_item = SetupArena::make<StatusPageItem<String>>("Relays " + name_, "", "Relays", 3200 + index_);
+  event_loop()->onRepeat(10000, [this, run_time, relay_item]() {
+    RelayDriver::Stats relays = controller_->getRelayStats();
+    run_time->set((relays.down_on_ms + relays.up_on_ms) / 1000.0);
+    relay_item->set(String("down ") + relays.down_starts + " starts " + relays.down_on_ms / 1000 + " s, up " +
+                    relays.up_starts + " starts " + relays.up_on_ms / 1000 + " s, " + relays.held_starts +
+                    " held reversals, " + relays.writes + " writes (" + relays.skipped + " skipped)");
+  });
+
+  /**
+   * Anchor drag alarm (see DragDetector.h). Once a second, while this
+   * windlass is at rest with the anchor on the bottom and depth and
+   * distance are current, slack and distance go into the detector; anything
+   * else starts its watch over. An alarm holds across that, unless the
+   * anchor is off the bottom or being retrieved: then it is cleared and
+   * "normal" published, or the heartbeat would repeat the alarm until the
+   * next anchoring. Its state goes to
+   * notifications.<prefix without "navigation.">.drag, e.g.
+   * notifications.anchor.drag.
+   */
+  if (drag_alarm_) {
+    auto* drag = SetupArena::make<DragDetector>();
+    auto* drag_notification = SetupArena::make<ObservableValue<String>>(drag->notification());
+    String drag_path = sk_prefix_.startsWith("navigation.") ? sk_prefix_.substring(11) : sk_prefix_;
+    publisher->addJson(drag_notification, "notifications." + drag_path + ".drag", config_prefix_ + "/anchor/drag/sk");
+    event_loop()->onRepeat(DragDetector::SAMPLE_MS, [this, drag, drag_notification]() {
+      bool depth_usable = controller_->getDepthInput()->usable();
+      bool off_bottom = depth_usable &&
+                        controller_->getChainLength() <= controller_->getCurrentDepth() + ChainController::BOW_HEIGHT_M;
+      bool anchor_up = off_bottom || command_->get() == AnchorCommand::AUTO_RETRIEVE;
+      bool changed;
+      if (anchor_up) {
+        changed = drag->clear();
+      } else if (busy() || !depth_usable || !controller_->getDistanceInput()->usable()) {
+        drag->reset();
+        return;
+      } else {
+        changed = drag->add(controller_->getHorizontalSlackObservable()->get(), controller_->getCurrentDistance());
+      }
+      if (!changed) return;
+      if (drag->dragging()) {
+        SINK_LOGW(__FILE__, "%s: anchor dragging (%s): slack %.2f m, distance %.1f m", name_.c_str(),
+                  drag->cause() == DragDetector::Cause::NEGATIVE_SLACK ? "negative slack" : "distance growing",
+                  drag->slack().mean(), drag->distance().newest());
+      } else {
+        SINK_LOGI(__FILE__, "%s: %s", name_.c_str(), anchor_up ? "drag alarm cleared, anchor coming up" : "anchor holding again");
+      }
+      drag_notification->set(drag->notification());
+    });
+  }
+
+  beginCommands();
+
+  SINK_LOGD(__FILE__, "%s: initial counter state: %d, UP relay: %d, DOWN relay: %d", name_.c_str(),
+            digitalRead(di3_gpio_), digitalRead(up_relay_), digitalRead(dn_relay_));
+
+  /**
+   * Each input is live once its level has held for its debounce time (at
+   * most 2 s after boot). After a warm restart the hall sensor counts from
+   * here on: the position is known and the chain may still be coasting.
+   */
+  inputs_->add("UP", di1_gpio_, di1_dtime_);
+  inputs_->add("DOWN", di2_gpio_, di2_dtime_);
+  inputs_->add("COUNTER", di3_gpio_, di3_use_pcnt_ ? 0 : di3_dtime_);
+  inputs_->add("RESET", di4_gpio_, di4_dtime_);
+  if (warm_start_) {
+    inputs_->markReady(di3_gpio_);
+  }
+  inputs_->onReady(di3_gpio_, [this]() {
+    controller_->enableCounting();
+  });
+  inputs_->start();
+}
+
+bool WindlassUnit::moving() const {
+  return direction_->get() != ChainDirection::FREE_FALL || controller_->isActive();
+}
+
+bool WindlassUnit::busy() const {
+  return moving() || automation_active_ ||
+         deployment_->getAutoStageObservable()->get() != AutoStage::IDLE;
+}
+
+void WindlassUnit::addWakePins(PowerManager* power) const {
+  power->addWakePin(di3_gpio_, true);  // Any chain movement
+  power->addWakePin(di1_gpio_);
+  power->addWakePin(di2_gpio_);
+  power->addWakePin(di4_gpio_);
+}
+
+/**
+ * Save the chain length. Only records the value in RAM - the journal writes
+ * it to flash from its deferred commit timer, so the pulse path never waits
+ * on a flash write. force commits now (used on stop/timeout).
+ */
+void WindlassUnit::saveChainLength(bool force) {
+  if (!inputs_->ready(di3_gpio_)) {
+    return;
+  }
+  journal_->record(position_->pulses());
+  if (force) {
+    journal_->commit(true);
+  }
+}
+
+/* Update direction observable from the relay sense lines */
+void WindlassUnit::updateDirection(bool up_relay_active, bool down_relay_active) {
+  if (up_relay_active) {
+    direction_->set(ChainDirection::UP);
+  } else if (down_relay_active) {
+    direction_->set(ChainDirection::DOWN);
+  } else {
+    direction_->set(ChainDirection::FREE_FALL);
+  }
+}
+
+/**
+ * UP or DOWN button. Direction ALWAYS follows the actual GPIO state, during
+ * manual operation and automation alike. On release, free fall is declared
+ * after release_delay ms unless the other relay is active by then.
+ */
+void WindlassUnit::onButton(int input, ChainDirection pressed, int other_gpio, ChainDirection other,
+                            int release_delay) {
+  if (button_delay_ != nullptr) {
+    event_loop()->remove(button_delay_);
+    button_delay_ = nullptr;
+  }
+  if (input == 0) {
+    SINK_LOGD(__FILE__, "%s: button %s ON", name_.c_str(), toString(pressed));
+    direction_->set(pressed);
+    return;
+  }
+  SINK_LOGD(__FILE__, "%s: button %s OFF => Free fall", name_.c_str(), toString(pressed));
+  button_delay_ = event_loop()->onDelay(release_delay, [this, other_gpio, other]() {
+    // NOTE: Relays are ACTIVE-LOW (energized = LOW, off = HIGH)
+    direction_->set(digitalRead(other_gpio) == LOW ? other : ChainDirection::FREE_FALL);
+    button_delay_ = nullptr;
+  });
+}
+
+void WindlassUnit::beginButtons() {
+  String prefix = config_prefix_;
+
+  /* React to UP action */
+  auto* di1_input = SetupArena::make<DigitalInputChange>(di1_gpio_, INPUT_PULLDOWN, CHANGE, prefix + "/di1/digital_input");
+  auto* di1_debounce = SetupArena::make<DebounceInt>(di1_dtime_, prefix + "/di1/debounce");
+  di1_input->connect_to(di1_debounce)->connect_to(SetupArena::make<LambdaConsumer<int>>([this](int input) {
+    shared_.wake("UP button");
+    onButton(input, ChainDirection::UP, di2_gpio_, ChainDirection::DOWN, up_delay_);
+  }));
+
+  /* React to DOWN action */
+  auto* di2_input = SetupArena::make<DigitalInputChange>(di2_gpio_, INPUT_PULLDOWN, CHANGE, prefix + "/di2/digital_input");
+  auto* di2_debounce = SetupArena::make<DebounceInt>(di2_dtime_, prefix + "/di2/debounce");
+  di2_input->connect_to(di2_debounce)->connect_to(SetupArena::make<LambdaConsumer<int>>([this](int input) {
+    shared_.wake("DOWN button");
+    onButton(input, ChainDirection::DOWN, di1_gpio_, ChainDirection::UP, down_delay_);
+  }));
+
+  /* React to RESET action */
+  auto* di4_input = SetupArena::make<DigitalInputChange>(di4_gpio_, INPUT_PULLDOWN, CHANGE, prefix + "/di4/digital_input");
+  auto* di4_debounce = SetupArena::make<DebounceInt>(di4_dtime_, prefix + "/di4/debounce");
+  auto* reset_handler = SetupArena::make<LambdaConsumer<int>>([this](int input) {
+    shared_.wake("reset");
+    if (!inputs_->ready(di4_gpio_)) {
+      return;
+    }
+    if (input == 1) {
+      controller_->resetPosition();  // Saved once position_ follows the task
+      SINK_LOGD(__FILE__, "%s: deployed chain reset to 0", name_.c_str());
+    }
+  });
+  di4_input->connect_to(di4_debounce)->connect_to(reset_handler);
+
+  // Set up a listener to respond to requested resets of the chain length
+  auto* reset_listener = SetupArena::make<IntSKPutRequestListener>(sk_prefix_ + ".rodeDeployed");
+  reset_listener->connect_to(reset_handler);
+}
+
+void WindlassUnit::beginCounter() {
+  PulseCounter* pulse_counter = nullptr;
+#ifndef CHAIN_SIMULATOR
+  /**
+   * COUNTER: either the PCNT hardware counts up/down, or an edge interrupt
+   * with a software debounce does. The windlass task reads the count every
+   * tick (including the both-relays safety check), so counting never waits
+   * on the event loop. Direction is updated here as the position follows.
+   * Each unit has a PCNT unit of its own.
+   */
+  pulse_counter = SetupArena::make<PulseCounter>(di3_gpio_, di1_gpio_, di3_filter_, index_);
+  bool started = di3_use_pcnt_ ? pulse_counter->begin() : pulse_counter->beginInterrupt(di3_dtime_);
+  if (started) {
+    position_->connect_to(SetupArena::make<LambdaConsumer<float>>([this](float) {
+      // NOTE: Relays are ACTIVE-LOW (energized = LOW, off = HIGH)
+      bool up_relay_active = (digitalRead(di1_gpio_) == LOW);
+      bool down_relay_active = (digitalRead(di2_gpio_) == LOW);
+      if (!(up_relay_active && down_relay_active)) {
+        updateDirection(up_relay_active, down_relay_active);
+      }
+    }));
+  } else {
+    SINK_LOGE(__FILE__, "%s: pulse counter failed to start on GPIO %d - chain counting disabled", name_.c_str(),
+              di3_gpio_);
+    pulse_counter = nullptr;
+  }
+#else
+  /**
+   * SIMULATOR build (-D CHAIN_SIMULATOR, bench use only): the hall input is
+   * ignored. The relay outputs drive a BoatSimulator in real time, its gypsy
+   * edges go to the windlass task through addPulses, and it stands in for the
+   * distance deltas - and, on unit 0, for the shared depth and wind - so
+   * autoDrop/autoRetrieve can be exercised on the real board with nothing
+   * connected to the relays.
+   */
+  auto* boat_sim = SetupArena::make<BoatSimulator>(BoatSimulator::Config());
+  event_loop()->onRepeat(BoatSimulator::BOAT_STEP_MS, [this, boat_sim, last_ms = millis()]() mutable {
+    unsigned long now = millis();
+    bool down = digitalRead(dn_relay_) == HIGH;
+    bool up = digitalRead(up_relay_) == HIGH;
+    int32_t edges = boat_sim->step(now - last_ms, down, up);
+    last_ms = now;
+    if (!inputs_->ready(di3_gpio_)) {
+      return;
+    }
+    updateDirection(boat_sim->upContact(), boat_sim->downContact());
+    if (edges != 0) {
+      controller_->addPulses(edges);
+    }
+  });
+  event_loop()->onRepeat(1000, [this, boat_sim]() {
+    if (index_ == 0) {
+      controller_->getDepthListener()->emit(boat_sim->sampleDepth());
+      controller_->getWindSpeedListener()->emit(boat_sim->sampleWindSpeed());
+    }
+    controller_->getDistanceListener()->emit(boat_sim->sampleDistance());
+  });
+#endif
+
+  controller_->begin(pulse_counter, di1_gpio_, di2_gpio_);
+}
+
+/* Every timed move gets the same safety timeout */
+void WindlassUnit::armMoveTimeout(bool clears_automation) {
+  unsigned long moveTime = controller_->getTimeout();
+  command_delay_ = event_loop()->onDelay(moveTime, [this, moveTime, clears_automation]() {
+    SINK_LOGI(__FILE__, "%s: movement timeout reached, stopping chain %1u s", name_.c_str(), moveTime);
+    controller_->stop();
+    saveChainLength(true);  // Force save on timeout
+    command_->set(AnchorCommand::IDLE);
+    if (clears_automation) {
+      automation_active_ = false;
+    }
+    command_delay_ = nullptr;
+  });
+}
+
+void WindlassUnit::beginCommands() {
+  // Set up SKOutput so that we can then receive anchor commands
+  // on this path
+  command_ = SetupArena::make<EnumValue<AnchorCommand>>(AnchorCommand::IDLE);
+  shared_.publisher->addState(command_, sk_prefix_ + ".command", config_prefix_ + "/anchorCommand/sk");
+
+  // Set completion callback for autoDrop to reset the command to idle
+  deployment_->setCompletionCallback([this]() {
+    command_->set(AnchorCommand::IDLE);
+    automation_active_ = false;
+    SINK_LOGI(__FILE__, "%s: autoDrop completed, command set to idle", name_.c_str());
+  });
+
+  auto* command_listener = SetupArena::make<StringSKPutRequestListener>(sk_prefix_ + ".command");
+
+  /*
+  This is the main command handler for the windlass commands, PUT to
+  <sk prefix>.command. As you create new String commands to be PUT to
+  this path you can register them with the dispatcher below.
+  The first thing that happens when a command is received is to
+  stop any current movement of this windlass. And if there is
+  a command timeout in progress, that is also cancelled. The new
+  command then starts right away; a direction reversal waits in the
+  windlass task for the relay dead time (see RelayDriver).
+
+  Currently setup commands:
+    "drop"       - starts lowering the anchor until depth + 4m is reached
+                    this is meant as the initial drop command
+    "raiseXX"    - starts raising the anchor by XX meters, e.g. "raise10" or "raise 10"
+                    raises the anchor by 10 meters
+    "lowerXX"    - starts lowering the anchor by XX meters e.g. "lower10" or "lower 10"
+                    lowers the anchor by 10 meters
+    "autoDropXX" - automatic staged deployment with scope ratio XX (default 5)
+    "planXX"     - publishes the autoDrop plan for scope ratio XX (default 5), does not stop the windlass
+    "autoRetrieve" - raise all chain to 2m with slack-based pause/resume
+    "stop"       - stops any movement in progress (since every command stops movement first,
+                    anything not defined here will just stop the windlass)
+
+  */
+  auto* command_dispatcher = SetupArena::make<CommandDispatcher>([this]() {
+    if (controller_->isActive()) {
+      controller_->stop();
+    }
+    deployment_->stop();  // Always stop deployment state machine
+
+    if (command_delay_ != nullptr) {
+      event_loop()->remove(command_delay_);
+      command_delay_ = nullptr;
+    }
+  });
+
+  // Handle test notifications (don't stop windlass for these)
+  command_dispatcher->registerCommand("testNotification", CommandDispatcher::ArgType::ANY_SUFFIX,
+    [this](float, bool) {
+      SINK_LOGI(__FILE__, "%s: TEST NOTIFICATION RECEIVED", name_.c_str());
+      command_->set(AnchorCommand::TEST_NOTIFICATION);
+      command_->notify();  // Acknowledge every test notification, even repeats
+    }, false);
+
+  command_dispatcher->registerCommand("drop", CommandDispatcher::ArgType::NONE,
+    [this](float, bool) {
+      SINK_LOGI(__FILE__, "%s: DROP command received", name_.c_str());
+      command_->set(AnchorCommand::DROP);
+      float drop_depth = controller_->getDepthListener()->get() + 4.0; // add 4m to the depth for slack chain on bottom
+      controller_->lowerAnchor(drop_depth);
+      armMoveTimeout(false);
+    });
+
+  command_dispatcher->registerCommand("raise", CommandDispatcher::ArgType::FLOAT,
+    [this](float raise_amount, bool) {
+      automation_active_ = true;
+      SINK_LOGI(__FILE__, "%s: raising %.2f meters", name_.c_str(), raise_amount);
+      command_->set(AnchorCommand::RAISE);
+      controller_->raiseAnchor(raise_amount);
+      armMoveTimeout(true);
+    });
+
+  command_dispatcher->registerCommand("lower", CommandDispatcher::ArgType::FLOAT,
+    [this](float lower_amount, bool) {
+      automation_active_ = true;
+      SINK_LOGI(__FILE__, "%s: lowering %.2f meters", name_.c_str(), lower_amount);
+      command_->set(AnchorCommand::LOWER);
+      controller_->lowerAnchor(lower_amount);
+      armMoveTimeout(true);
+    });
+
+  // "autoDrop" or "autoDrop7" (scope ratio 7:1)
+  command_dispatcher->registerCommand("autoDrop", CommandDispatcher::ArgType::OPTIONAL_FLOAT,
+    [this](float parsedRatio, bool has_ratio) {
+      float scopeRatio = DeploymentManager::DEFAULT_SCOPE_RATIO;
+      if (has_ratio && parsedRatio > 0) {
+        scopeRatio = parsedRatio;
+      }
+
+      automation_active_ = true;
+      SINK_LOGI(__FILE__, "%s: starting autoDrop with scope ratio %.1f:1", name_.c_str(), scopeRatio);
+      command_->set(AnchorCommand::AUTO_DROP);
+      deployment_->start(scopeRatio);
+    });
+
+  // "plan" or "plan7": publish the autoDrop plan for scope 7:1 without moving
+  command_dispatcher->registerCommand("plan", CommandDispatcher::ArgType::OPTIONAL_FLOAT,
+    [this](float parsedRatio, bool has_ratio) {
+      deployment_->preview(has_ratio && parsedRatio > 0 ? parsedRatio : DeploymentManager::DEFAULT_SCOPE_RATIO);
+    }, false);
+
+  command_dispatcher->registerCommand("autoRetrieve", CommandDispatcher::ArgType::NONE,
+    [this](float, bool) {
+      SINK_LOGI(__FILE__, "%s: AUTO-RETRIEVE command received", name_.c_str());
+
+      automation_active_ = true;
+
+      // Raise all chain to 2m completion threshold
+      // ChainController will auto-pause/resume based on slack
+      float currentRode = controller_->getChainLength();
+      float amountToRaise = currentRode - 2.0;  // Raise to 2m (min_length)
+
+      if (amountToRaise > 0.1) {
+        SINK_LOGI(__FILE__, "Auto-retrieve: raising %.2fm (from %.2fm to 2.0m)", amountToRaise, currentRode);
+        controller_->raiseAnchor(amountToRaise);
+        command_->set(AnchorCommand::AUTO_RETRIEVE);
+        // No timeout - ChainController has built-in movement timeout and slack-based pause/resume
+        // User can always stop() manually if needed
+      } else {
+        SINK_LOGI(__FILE__, "Auto-retrieve: already at or below 2m, nothing to raise");
+        command_->set(AnchorCommand::IDLE);
+        automation_active_ = false;
+      }
+    });
+
+  // "stop" and anything unrecognised: the dispatcher has already stopped everything
+  auto stop_command = [this](float, bool) {
+    saveChainLength(true);  // Force save position when manually stopped
+    automation_active_ = false;
+    command_->set(AnchorCommand::IDLE);
+  };
+  command_dispatcher->registerCommand("stop", CommandDispatcher::ArgType::NONE, stop_command);
+  command_dispatcher->setUnknownHandler(stop_command);
+
+  command_listener->connect_to(SetupArena::make<LambdaConsumer<String>>([this, command_dispatcher](String input) {
+    shared_.wake("command");
+    CHAIN_TRACE_RECORD(command(index_, input.c_str()));
+    command_dispatcher->dispatch(input);
+  }));
+}
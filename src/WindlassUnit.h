@@ -0,0 +1,120 @@
+// WindlassUnit.h
+#ifndef WINDLASSUNIT_H
+#define WINDLASSUNIT_H
+
+#include <Arduino.h>
+#include <functional>
+#include "ChainController.h"
+#include "ChainPosition.h"
+#include "ChainTypes.h"
+#include "DeploymentManager.h"
+#include "InputReadiness.h"
+#include "PositionJournal.h"
+#include "PositionSnapshot.h"
+#include "PowerManager.h"
+#include "PublishScheduler.h"
+
+/**
+ * One windlass and everything that is its own: the UP/DOWN/COUNTER/RESET
+ * inputs and the relays, the pulse count (ChainPosition, journal and RTC
+ * snapshot), the ChainController with its windlass task, the
+ * DeploymentManager and the Signal K command path.
+ *
+ * A board drives up to MAX_UNITS windlasses, e.g. bow and stern. Each unit
+ * keeps its settings under its own config prefix and publishes under its
+ * own Signal K prefix. Unit 0 uses the paths of the single-windlass firmware
+ * ("/di1/gpio", "navigation.anchor.rodeDeployed", ...), so a board that runs
+ * one windlass sees no change.
+ *
+ * What does not depend on the windlass is built once in setup() and passed
+ * in as Shared: the depth, wind and tide listeners, the publish scheduler
+ * (one batch for all units), and the wake hook of the anchor watch. The
+ * slack timer and the anchor watch in setup() go over all units.
+ */
+class WindlassUnit {
+public:
+    static constexpr uint8_t MAX_UNITS = PositionSnapshot::UNITS;
+
+    struct Shared {
+        ChainController::Environment environment;
+        PublishScheduler* publisher;
+        float slackDeadband;                      // m, chainSlack changes below this wait for the heartbeat
+        bool warmReset;                           // Anything but power-on: the RTC snapshot may hold the position
+        std::function<void(const char*)> wake;    // Activity - ends anchor watch
+    };
+
+    explicit WindlassUnit(uint8_t index);
+
+    // Register the settings of this unit; before ConfigStore::commit()
+    void configure();
+    // Build the pipeline and start the windlass task and the input settling
+    void begin(const Shared& shared);
+
+    uint8_t index() const { return index_; }
+    const String& name() const { return name_; }
+    const String& skPrefix() const { return sk_prefix_; }
+    ChainController* controller() const { return controller_; }
+    DeploymentManager* deployment() const { return deployment_; }
+
+    bool moving() const;   // Relays, buttons or the windlass task - Signal K goes fast
+    bool busy() const;     // ... or automation running - no anchor watch
+    void addWakePins(PowerManager* power) const;
+
+private:
+    struct Defaults;
+    static const Defaults DEFAULTS[MAX_UNITS];
+
+    float setting(const char* path, float default_value, const char* title, const char* description,
+                  int sort_order);
+    void beginButtons();
+    void beginCounter();
+    void beginCommands();
+    void saveChainLength(bool force);
+    void updateDirection(bool up_relay_active, bool down_relay_active);
+    void onButton(int input, ChainDirection pressed, int other_gpio, ChainDirection other, int release_delay);
+    void armMoveTimeout(bool clears_automation);
+
+    const uint8_t index_;
+    const Defaults& defaults_;
+    String name_;
+    String config_prefix_;
+    String sk_prefix_;
+    Shared shared_ = {};
+
+    // Settings, read in configure()
+    float gypsy_circum_ = 0.0;
+    int up_delay_ = 0;
+    int down_delay_ = 0;
+    int di1_gpio_ = -1;
+    int di1_dtime_ = 0;
+    int di2_gpio_ = -1;
+    int di2_dtime_ = 0;
+    int di3_gpio_ = -1;
+    int di3_dtime_ = 0;
+    bool di3_use_pcnt_ = false;
+    int di3_filter_ = 0;
+    int di4_gpio_ = -1;
+    int di4_dtime_ = 0;
+    int up_relay_ = -1;
+    int dn_relay_ = -1;
+    int relay_dead_ms_ = 0;
+    float max_chain_ = 0.0;
+    bool slack_adaptive_ = true;
+    bool settle_early_ = true;
+    bool drag_alarm_ = true;
+
+    bool warm_start_ = false;
+    bool automation_active_ = false;   // Keeps the buttons from interfering with automation
+    reactesp::Event* button_delay_ = nullptr;
+    reactesp::Event* command_delay_ = nullptr;
+
+    PositionJournal* journal_ = nullptr;
+    ChainPosition* position_ = nullptr;
+    EnumValue<ChainDirection>* direction_ = nullptr;
+    EnumValue<AnchorCommand>* command_ = nullptr;
+    InputReadiness* inputs_ = nullptr;
+    ChainController* controller_ = nullptr;
+    DeploymentManager* deployment_ = nullptr;
+};
+
+#endif // WINDLASSUNIT_H
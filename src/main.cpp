@@ -1,713 +1,304 @@
 /* Bi-directional chain counter based on SensESP */
 #include <memory>
+#include <vector>
 
 #include "sensesp.h"
-#include "sensesp/sensors/digital_input.h"
 #include "sensesp/signalk/signalk_output.h"
+#include "sensesp/signalk/signalk_ws_client.h"
 #include "sensesp/system/lambda_consumer.h"
-#include "sensesp/transforms/debounce.h"
 #include "sensesp/transforms/linear.h"
+#include "sensesp/ui/status_page_item.h"
 #include "sensesp/ui/ui_controls.h"
 #include "sensesp/sensors/sensor.h"
 #include "sensesp_app.h"
 #include "sensesp_app_builder.h"
 #include <Preferences.h>
-#include "sensesp/signalk/signalk_put_request_listener.h"
+#include <esp_system.h>
 #include "sensesp/signalk/signalk_value_listener.h"
 #include "sensesp/types/position.h"
 #include "ChainController.h"
-#include "DeploymentManager.h"
+#include "LogSink.h"
+#include "ChainTypes.h"
+#include "PerfStats.h"
+#include "PowerManager.h"
+#include "PublishScheduler.h"
+#include "SetupArena.h"
+#include "StoredNumberConfig.h"
+#include "WindlassUnit.h"
 
 using namespace sensesp;
 
-bool ignore_input = true;
-bool automation_active = false;  // Prevents button handlers from interfering with automation
+// The windlasses this board drives, each with its own pipeline (see WindlassUnit.h)
+WindlassUnit* units[WindlassUnit::MAX_UNITS] = {};
+size_t unit_count = 0;
+PowerManager* powerManager = nullptr;  // nullptr when anchor watch is disabled
 
-ChainController* chainController;
-DeploymentManager* deploymentManager = nullptr;
+// Any pulse, button or command ends anchor watch
+void wakeFromAnchorWatch(const char* reason) {
+  if (powerManager != nullptr) {
+    powerManager->wake(reason);
+  }
+}
 
 /* Prepare application */
 void setup() {
   SetupLogging();
+  // Hot-path SINK_LOGx lines are formatted and printed by the sink's task
+  LogSink::global().start();
   SensESPAppBuilder builder;
   sensesp_app = builder.set_hostname("ChainCounter")
                     ->enable_ota("transport")
                     ->get_app();
-  static reactesp::Event* buttonDelayPtr = nullptr;
-  static reactesp::Event* commandDelayPtr = nullptr;
-
-  /* Default values */
-  float gypsy_circum_default = 0.25; //Default 0.25m
-  float up_delay_default     = 2000; //Default 2000ms = 2s
-  float down_delay_default   = 2000; //Default 2000ms = 2s
-  float di1_gpio_default     = 23;   // UP Button
-  float di1_dtime_default    = 15;   // Default 15 ms
-  float di2_gpio_default     = 25;   // DOWN Button
-  float di2_dtime_default    = 15;   // Default 15 ms
-  float di3_gpio_default     = 27;   // Hall effect sensor
-  float di3_dtime_default    = 15;   // Default 15 ms
-  float di4_gpio_default     = 26;   // RESET Button
-  float di4_dtime_default    = 15;   // Default 15 ms
-  float upRelay_default      = 16;   // UP Relay
-  float dnRelay_default      = 19;   // DOWN Relay
-  float max_chain_default    = 80.0; // Default 80m
-
-
-  /* Save path */
-  String gypsy_circum_config_path = "/gypsy/circum";
-  String up_delay_config_path     = "/up/delay";
-  String down_delay_config_path   = "/down/delay";
-  String di1_gpio_config_path     = "/di1/gpio";
-  String di1_dtime_config_path    = "/di1/dbounce";
-  String di2_gpio_config_path     = "/di2/gpio";
-  String di2_dtime_config_path    = "/di2/dbounce";
-  String di3_gpio_config_path     = "/di3/gpio";
-  String di3_dtime_config_path    = "/di3/dbounce";
-  String di4_gpio_config_path     = "/di4/gpio";
-  String di4_dtime_config_path    = "/di4/dbounce";
-  String max_chain_config_path    = "/chain/max_length";
-  String upRelay_config_path     = "/di5/gpio";
-  String dnRelay_config_path     = "/di6/gpio"; 
-  
-
-
-  /* Register config parameters */
-  auto gypsy_circum_config = std::make_shared<NumberConfig>(gypsy_circum_default,  gypsy_circum_config_path );
-  auto up_delay_config     = std::make_shared<NumberConfig>(up_delay_default,      up_delay_config_path     );
-  auto down_delay_config   = std::make_shared<NumberConfig>(down_delay_default,    down_delay_config_path   );
-  auto di1_gpio_config     = std::make_shared<NumberConfig>(di1_gpio_default,      di1_gpio_config_path     );
-  auto di1_dtime_config    = std::make_shared<NumberConfig>(di1_dtime_default,     di1_dtime_config_path    );
-  auto di2_gpio_config     = std::make_shared<NumberConfig>(di2_gpio_default,      di2_gpio_config_path     );
-  auto di2_dtime_config    = std::make_shared<NumberConfig>(di2_dtime_default,     di2_dtime_config_path    );
-  auto di3_gpio_config     = std::make_shared<NumberConfig>(di3_gpio_default,      di3_gpio_config_path     );
-  auto di3_dtime_config    = std::make_shared<NumberConfig>(di3_dtime_default,     di3_dtime_config_path    );
-  auto di4_gpio_config     = std::make_shared<NumberConfig>(di4_gpio_default,      di4_gpio_config_path     );
-  auto di4_dtime_config    = std::make_shared<NumberConfig>(di4_dtime_default,     di4_dtime_config_path    );
-  auto max_chain_config    = std::make_shared<NumberConfig>(max_chain_default,     max_chain_config_path    );
-  auto upRelay_config      = std::make_shared<NumberConfig>(upRelay_default,       upRelay_config_path      );
-  auto dnRelay_config      = std::make_shared<NumberConfig>(dnRelay_default,       dnRelay_config_path      );
-  
-  
-  /* Set parameters in UI */
-  ConfigItem(gypsy_circum_config)
-    ->set_title("Gypsy Circumference")
-    ->set_description("Circumference of the gypsy in meters")
-    ->set_sort_order(100);
-  ConfigItem(up_delay_config)
-    ->set_title("Up delay")
-    ->set_description("Time after a push to up button go to free fall")
-    ->set_sort_order(200);
-  ConfigItem(down_delay_config)
-    ->set_title("Down delay")
-    ->set_description("Time after a push to down button go to free fall")
-    ->set_sort_order(200);
-  ConfigItem(di1_gpio_config)
-    ->set_title("GPIO for UP button")
-    ->set_description("GPIO number connected to UP Button relay")
-    ->set_sort_order(1100);
-  ConfigItem(upRelay_config)
-    ->set_title("GPIO for UP relay")
-    ->set_description("GPIO number connected to UP Button relay")
-    ->set_sort_order(1125);
-  ConfigItem(di1_dtime_config)
-    ->set_title("Debounce Time for UP button")
-    ->set_description("Debounce time in ms for UP Button relay")
-    ->set_sort_order(1150);
-  ConfigItem(di2_gpio_config)
-    ->set_title("GPIO for DOWN button")
-    ->set_description("GPIO number connected to DOWN Button relay")
-    ->set_sort_order(1200);
-  ConfigItem(dnRelay_config)
-    ->set_title("GPIO for DOWN relay")
-    ->set_description("GPIO number connected to DOWN Button relay")
-    ->set_sort_order(1135);   
-  ConfigItem(di2_dtime_config)
-    ->set_title("Debounce Time for DOWN button")
-    ->set_description("Debounce time in ms for DOWN Button relay")
-    ->set_sort_order(1250);
-  ConfigItem(di3_gpio_config)
-    ->set_title("GPIO for Hall effect sensor")
-    ->set_description("GPIO number connected to hall effect sensor")
-    ->set_sort_order(1300);
-  ConfigItem(di3_dtime_config)
-    ->set_title("Debounce Time for hall effect sensor")
-    ->set_description("Debounce time in ms for hall effect sensor")
-    ->set_sort_order(1350);
-  ConfigItem(di4_gpio_config)
-    ->set_title("GPIO for RESET button")
-    ->set_description("GPIO number connected to RESET button")
-    ->set_sort_order(1400);
-  ConfigItem(di4_dtime_config)
-    ->set_title("Debounce Time for RESET button")
-    ->set_description("Debounce time in ms for RESET button")
-    ->set_sort_order(1450);
-  ConfigItem(max_chain_config)
-    ->set_title("Max chain length")
-    ->set_description("Maximum length of the chain in meters")
-    ->set_sort_order(1500);
 
-  /* Get data from saved values or default parameters */
-  const float gypsy_circum = gypsy_circum_config->get_value();
-  const int   up_delay     = up_delay_config->get_value();
-  const int   down_delay   = down_delay_config->get_value();
-  const int   di1_gpio     = di1_gpio_config->get_value();
-  const int   di1_dtime    = di1_dtime_config->get_value();
-  const int   di2_gpio     = di2_gpio_config->get_value();
-  const int   di2_dtime    = di2_dtime_config->get_value();
-  const int   di3_gpio     = di3_gpio_config->get_value();
-  const int   di3_dtime    = di3_dtime_config->get_value();
-  const int   di4_gpio     = di4_gpio_config->get_value();
-  const int   di4_dtime    = di4_dtime_config->get_value();
-  const int   upRelay      = upRelay_config->get_value();
-  const int   dnRelay      = dnRelay_config->get_value();
-  const float max_chain    = max_chain_config->get_value();
- 
-
-  /* Get last saved chain length from disk */
-  Preferences prefs;
-  prefs.begin("chain", true);  // true = read only
-  float saved_length = prefs.getFloat("length", 0.0);
-  prefs.end();
-
-  ESP_LOGD(__FILE__, "the saved chain length is %f", saved_length );
-
-  /* SPIFFS write counter for diagnostics */
-  static unsigned long spiffs_write_count = 0;
-
-  /* Digital inputs */
-  auto* di1_input = new DigitalInputChange(di1_gpio, INPUT_PULLDOWN, CHANGE, "/di1/digital_input");
-  auto* di1_debounce = new DebounceInt(di1_dtime, "/di1/debounce");
-  auto* di2_input = new DigitalInputChange(di2_gpio, INPUT_PULLDOWN, CHANGE, "/di2/digital_input");
-  auto* di2_debounce = new DebounceInt(di2_dtime, "/di2/debounce");
-  auto* di3_input = new DigitalInputChange(di3_gpio, INPUT_PULLDOWN, CHANGE, "/di3/digital_input");
-  auto* di3_debounce = new DebounceInt(di3_dtime, "/di3/debounce");
-  auto* di4_input = new DigitalInputChange(di4_gpio, INPUT_PULLDOWN, CHANGE, "/di4/digital_input");
-  auto* di4_debounce = new DebounceInt(di4_dtime, "/di4/debounce");
-  
-  /*Digital Outputs*/
-  int upRelayPin = (int)upRelay;
-  int dnRelayPin = (int)dnRelay;
-
-  pinMode(upRelayPin, OUTPUT);
-  pinMode(dnRelayPin, OUTPUT);  
-  digitalWrite(upRelay, LOW); // Relay off
-  digitalWrite(dnRelay, LOW); // Relay off
+  /* Default values - the settings of each windlass are in WindlassUnit.cpp */
+  float windlass_count_default = 1;   // Windlasses on this board, up to WindlassUnit::MAX_UNITS
+  float sk_fast_ms_default   = 250;   // Signal K number updates while moving
+  float sk_slow_ms_default   = 2000;  // ... and at anchor
+  float sk_heartbeat_default = 11000; // Full re-send of every output
+  float sk_slack_db_default  = 0.05;  // Slack changes smaller than this wait for the heartbeat
+  float power_idle_default   = 5;     // Minutes idle before anchor watch (0 = never)
+  float power_sleep_default  = 1;     // 1 = automatic light sleep in anchor watch
 
 
-  /**
-   * An Integrator<int, float> called "accumulator" adds up all the counts it
-   * receives (which are ints) and multiplies each count by gypsy_circum, which
-   * is the amount of chain, in meters, that is moved by each revolution of the
-   * windlass. (Since gypsy_circum is a float, the output of this transform must
-   * be a float, which is why we use Integrator<int, float>). It can be
-   * configured in the Config UI at accum_config_path.
-   */
-  //String accum_config_path = "/accumulator/circum";
-  auto* accumulator =
-      new Integrator<float, float>(gypsy_circum, saved_length, "/accumulator/circum");
+  /* Save path */
+  String windlass_count_config_path = "/windlass/count";
+  String sk_fast_ms_config_path   = "/sk/fast_interval";
+  String sk_slow_ms_config_path   = "/sk/slow_interval";
+  String sk_heartbeat_config_path = "/sk/heartbeat";
+  String sk_slack_db_config_path  = "/sk/slack_deadband";
+  String power_idle_config_path   = "/power/idle_minutes";
+  String power_sleep_config_path  = "/power/light_sleep";
 
-  /* Observable direction ("up", "down" or "free fall") */
-  auto* direction = new ObservableValue<String>("free fall");
-  direction->connect_to(
-    new SKOutputString("navigation.anchor.chainDirection", "/chain/direction") );
 
-  /**
-   * There is no path for the amount of anchor rode deployed in the current
-   * Signal K specification. By creating an instance of SKMetaData, we can send
-   * a partial or full definition of the metadata that other consumers of Signal
-   * K data might find useful. (For example, Instrument Panel will benefit from
-   * knowing the units to be displayed.) The metadata is sent only the first
-   * time the data value is sent to the server.
-   */
-  SKMetadata* metadata = new SKMetadata();
-  metadata->units_ = "m";
-  metadata->description_ = "Anchor Rode Deployed";
-  metadata->display_name_ = "Rode Deployed";
-  metadata->short_name_ = "Rode Out";
 
   /**
-   * chain_counter is connected to accumulator, which is connected to an
-   * SKOutputNumber, which sends the final result to the indicated path on the
-   * Signal K server. (Note that each data type has its own version of SKOutput:
-   * SKOutputNumber for floats, SKOutputInt, SKOutputBool, and SKOutputString.)
+   * Register config parameters. The values come from one ConfigStore
+   * record, read in a single NVS call; the per-path JSON files are only
+   * read to migrate when there is no record yet (see ConfigStore.h).
    */
-  String sk_path = "navigation.anchor.rodeDeployed";
-  String sk_path_config_path = "/rodeDeployed/sk";
-  auto sk_output = new SKOutputFloat(sk_path, sk_path_config_path, metadata);
-  accumulator->connect_to(sk_output);
-
-  /* Publish sk data every second */
-  auto* sk_timer = new RepeatSensor<bool>(11000, [direction, accumulator] () -> bool {
-    accumulator->notify();
-    direction->notify();
-    return true;
-  });
-
-  /* Force save chain length (no thresholds, used on stop/timeout) */
-  auto force_save_chain_length = [accumulator, &spiffs_write_count]() {
-    if(ignore_input) {
-      return;
-    }
-    float current_length = accumulator->get();
-    Preferences prefs;
-    if (!prefs.begin("chain", false)) {
-      ESP_LOGE(__FILE__, "Failed to open NVS namespace 'chain' for writing");
-      return;
-    }
-    size_t written = prefs.putFloat("length", current_length);
-    prefs.end();
-    if (written == 0) {
-      ESP_LOGE(__FILE__, "Failed to write chain position to NVS");
-    } else {
-      spiffs_write_count++;
-      ESP_LOGD(__FILE__, "Chain position force-saved: %.2fm (SPIFFS writes: %lu)", current_length, spiffs_write_count);
-    }
-  };
+  ConfigStore& config_store = ConfigStore::global();
+  config_store.begin();
+  auto windlass_count_config = std::make_shared<StoredNumberConfig>(windlass_count_default, windlass_count_config_path);
+  auto sk_fast_ms_config   = std::make_shared<StoredNumberConfig>(sk_fast_ms_default,    sk_fast_ms_config_path   );
+  auto sk_slow_ms_config   = std::make_shared<StoredNumberConfig>(sk_slow_ms_default,    sk_slow_ms_config_path   );
+  auto sk_heartbeat_config = std::make_shared<StoredNumberConfig>(sk_heartbeat_default,  sk_heartbeat_config_path );
+  auto sk_slack_db_config  = std::make_shared<StoredNumberConfig>(sk_slack_db_default,   sk_slack_db_config_path  );
+  auto power_idle_config   = std::make_shared<StoredNumberConfig>(power_idle_default,    power_idle_config_path   );
+  auto power_sleep_config  = std::make_shared<StoredNumberConfig>(power_sleep_default,   power_sleep_config_path  );
 
-  /* Save the chain length function */
-  auto save_chain_length = [accumulator, &spiffs_write_count]() {
-    static float last_saved_position = 0.0;
-    static unsigned long last_save_time = 0;
-    static constexpr float SAVE_THRESHOLD_M = 2.0;  // Only save every 2m
-    static constexpr unsigned long MIN_SAVE_INTERVAL_MS = 5000;  // 5 seconds minimum
 
-    if(ignore_input) {
-      return;
-    }
-
-    float current_length = accumulator->get();
-    unsigned long now = millis();
-
-    bool distance_threshold_met = fabs(current_length - last_saved_position) >= SAVE_THRESHOLD_M;
-    bool time_threshold_met = (now - last_save_time) >= MIN_SAVE_INTERVAL_MS;
-
-    // Save if both distance AND time thresholds are met
-    // AND logic ensures minimal writes: only when significant movement (2m) has occurred
-    // AND sufficient time (5s) has passed since last save
-    if (distance_threshold_met && time_threshold_met) {
-        Preferences prefs;
-        if (!prefs.begin("chain", false)) {
-          ESP_LOGE(__FILE__, "Failed to open NVS namespace 'chain' for writing");
-          return;
-        }
-        size_t written = prefs.putFloat("length", current_length);
-        prefs.end();
-
-        if (written == 0) {
-          ESP_LOGE(__FILE__, "Failed to write chain position to NVS");
-        } else {
-          float delta = fabs(current_length - last_saved_position);
-          last_saved_position = current_length;
-          last_save_time = now;
-          spiffs_write_count++;
-          ESP_LOGD(__FILE__, "Chain position saved: %.2fm (delta: %.2fm, SPIFFS writes: %lu)", current_length, delta, spiffs_write_count);
-        }
-    }
-  };
-
-  /* React to UP action */
-  auto* up_handler = new LambdaConsumer<int>( [up_delay, direction, di1_gpio, di2_gpio](int input) {
-    ESP_LOGD(__FILE__, "Button UP Changed");
-
-    // ALWAYS update direction based on actual GPIO state (works during manual AND automation)
-    if (buttonDelayPtr != nullptr) {
-      event_loop()->remove(buttonDelayPtr);
-      buttonDelayPtr=nullptr;
-    }
-    if (input == 0) {
-      ESP_LOGD(__FILE__, "Button UP ON => Up");
-      direction->set("up");
-    } else {
-      ESP_LOGD(__FILE__, "Button UP OFF => Free fall");
-      buttonDelayPtr = event_loop()->onDelay(up_delay, [direction, di1_gpio, di2_gpio]() {
-        // Before setting free fall, check if other relay is active
-        // NOTE: Relays are ACTIVE-LOW (energized = LOW, off = HIGH)
-        if (digitalRead(di2_gpio) == LOW) {
-          direction->set("down");
-        } else {
-          direction->set("free fall");
-        }
-        buttonDelayPtr=nullptr;
-      });
-    }
+  /* Set parameters in UI */
+  ConfigItem(windlass_count_config)
+    ->set_title("Number of windlasses")
+    ->set_description("Windlasses connected to this board (1 or 2). The second one has its own \"Stern\" settings. Reboot to apply.")
+    ->set_sort_order(50);
+  ConfigItem(sk_fast_ms_config)
+    ->set_title("Signal K interval while moving")
+    ->set_description("Minimum time in ms between rode/slack updates while the windlass moves")
+    ->set_sort_order(1600);
+  ConfigItem(sk_slow_ms_config)
+    ->set_title("Signal K interval at anchor")
+    ->set_description("Minimum time in ms between rode/slack updates while the windlass is stopped")
+    ->set_sort_order(1610);
+  ConfigItem(sk_heartbeat_config)
+    ->set_title("Signal K heartbeat")
+    ->set_description("Time in ms after which every chain counter value is re-sent, changed or not")
+    ->set_sort_order(1620);
+  ConfigItem(sk_slack_db_config)
+    ->set_title("Signal K slack deadband")
+    ->set_description("Slack changes in meters below this are only sent with the heartbeat")
+    ->set_sort_order(1630);
+  ConfigItem(power_idle_config)
+    ->set_title("Anchor watch delay")
+    ->set_description("Minutes without windlass activity before the low-power anchor watch mode (0 = never). Reboot to apply.")
+    ->set_sort_order(1700);
+  ConfigItem(power_sleep_config)
+    ->set_title("Light sleep in anchor watch")
+    ->set_description("1 = let the CPU light sleep between events in anchor watch, 0 = only slow down. Reboot to apply.")
+    ->set_sort_order(1710);
+
+  // Each windlass registers its own settings, under its config prefix
+  unit_count = constrain((int)windlass_count_config->get_value(), 1, (int)WindlassUnit::MAX_UNITS);
+  for (size_t i = 0; i < unit_count; i++) {
+    units[i] = SetupArena::make<WindlassUnit>(i);
+    units[i]->configure();
+  }
 
-    // Block manual windlass control during automation (but direction is already set above)
-    if(ignore_input || automation_active) {
-      return;
-    }
-  });
-  di1_input->connect_to(di1_debounce)->connect_to(up_handler);
+  // Writes the record on the first boot after migrating, otherwise nothing
+  config_store.commit();
+  SINK_LOGI(__FILE__, "Config: %u NVS read(s), %u value(s) migrated from the legacy files, %u stored",
+            config_store.stats().reads, config_store.stats().migrated, (unsigned)config_store.storedCount());
 
-  /* React to DOWN action */
-  auto* down_handler = new LambdaConsumer<int>( [down_delay, direction, di1_gpio, di2_gpio](int input) {
-    ESP_LOGD(__FILE__, "Button DOWN Changed");
+  /* Get data from saved values or default parameters */
+  PublishScheduler::Config sk_publish;
+  sk_publish.fastIntervalMs = sk_fast_ms_config->get_value();
+  sk_publish.slowIntervalMs = sk_slow_ms_config->get_value();
+  sk_publish.heartbeatMs    = sk_heartbeat_config->get_value();
+  const float sk_slack_deadband = sk_slack_db_config->get_value();
+  const float power_idle_min = power_idle_config->get_value();
+  PowerManager::Config power_config;
+  power_config.idleMs     = power_idle_min * 60000;
+  power_config.lightSleep = power_sleep_config->get_value() >= 1;
 
-    // ALWAYS update direction based on actual GPIO state (works during manual AND automation)
-    if (buttonDelayPtr != nullptr) {
-      event_loop()->remove(buttonDelayPtr);
-      buttonDelayPtr=nullptr;
-    }
-    if (input == 0) {
-      ESP_LOGD(__FILE__, "Button DOWN ON => Down");
-      direction->set("down");
-    } else {
-      ESP_LOGD(__FILE__, "Button DOWN OFF => Free fall");
-      buttonDelayPtr = event_loop()->onDelay(down_delay, [direction, di1_gpio, di2_gpio]() {
-        // Before setting free fall, check if other relay is active
-        // NOTE: Relays are ACTIVE-LOW (energized = LOW, off = HIGH)
-        if (digitalRead(di1_gpio) == LOW) {
-          direction->set("up");
-        } else {
-          direction->set("free fall");
-        }
-        buttonDelayPtr=nullptr;
-      });
-    }
 
-    // Block manual windlass control during automation (but direction is already set above)
-    if(ignore_input || automation_active) {
-      return;
-    }
-  });
-  di2_input->connect_to(di2_debounce)->connect_to(down_handler);
-
-  /* React to COUNTER action */
-  auto* counter_handler = new LambdaConsumer<int>( [
-    gypsy_circum, max_chain, direction, save_chain_length, accumulator, di1_gpio, di2_gpio
-     ](int input) {
-    if(ignore_input) {
-      return;
+  /**
+   * All chain counter outputs, of every windlass, go to Signal K through
+   * one scheduler, which batches them into a delta per window: fast while
+   * any chain moves (from the relays or the buttons), slow at anchor, plus
+   * a heartbeat of every value (see PublishScheduler.h).
+   */
+  auto* sk_publisher = SetupArena::make<PublishScheduler>([]() {
+    for (size_t i = 0; i < unit_count; i++) {
+      if (units[i]->moving()) return true;
     }
-      // ESP_LOGD(__FILE__, "the input change is %d", input);
-    if (input == 1) {
-        float current_value = accumulator->get();
-
-      // Determine actual direction by reading GPIO pins directly
-      // This works during both manual and automated operation
-      // NOTE: Relays are ACTIVE-LOW (energized = LOW, off = HIGH)
-      bool up_relay_active = (digitalRead(di1_gpio) == LOW);
-      bool down_relay_active = (digitalRead(di2_gpio) == LOW);
-
-      // CRITICAL SAFETY CHECK - both relays should NEVER be HIGH simultaneously
-      if (up_relay_active && down_relay_active) {
-        ESP_LOGE(__FILE__, "SAFETY VIOLATION: Both relays HIGH! UP=%d DOWN=%d - Ignoring counter pulse",
-                 up_relay_active, down_relay_active);
-        return;  // DO NOT count, this is an illegal and dangerous state
-      }
-
-      // Update direction observable based on GPIO state
-      // This ensures direction is always accurate for both manual and automated operation
-      if (up_relay_active) {
-        direction->set("up");
-      } else if (down_relay_active) {
-        direction->set("down");
-      } else {
-        direction->set("free fall");
-      }
+    return false;
+  }, sk_publish);
+  // Each flush is written as one delta into a preallocated buffer and sent
+  // as is, instead of a JSON document per value (see SKDeltaWriter.h)
+  sk_publisher->setDeltaSink([](String& delta) {
+    auto ws_client = sensesp_app->get_ws_client();
+    if (!ws_client || !ws_client->is_connected()) return false;
+    ws_client->sendTXT(delta);
+    return true;
+  }, sensesp_app->get_hostname_observable()->get());
 
-      // ESP_LOGD(__FILE__, "The Gypsy is turning");
-      if (up_relay_active) {
-        // UP relay is active - chain is being raised (decrement)
-        if(current_value - gypsy_circum < 0) {
-            // ESP_LOGD(__FILE__, "Already at 0m of Chain ");
-        } else {
-            accumulator->set(-1);
-            // ESP_LOGD(__FILE__, "Decrement Deployed Chain");
-        }
-      } else if (down_relay_active) {
-        // DOWN relay is active - chain is being lowered (increment)
-        if(current_value + gypsy_circum > max_chain) {
-            // ESP_LOGD(__FILE__, "Already at the Max %fm Chain Length", max_chain);
-        } else {
-            accumulator->set(1);
-            // ESP_LOGD(__FILE__, "Increment Deployed Chain");
-        }
-      } else {
-        // Neither relay active - freefall or manual operation
-        // Chain can only deploy (lower) without powered assistance
-        if(current_value + gypsy_circum > max_chain) {
-            // ESP_LOGD(__FILE__, "Already at the Max %fm Chain Length", max_chain);
-        } else {
-            accumulator->set(1);
-            // ESP_LOGD(__FILE__, "Increment Deployed Chain (freefall)");
-        }
-      }
-      save_chain_length();
-    }
-  });
-  di3_input->connect_to(di3_debounce)->connect_to(counter_handler);
+  /**
+   * Depth, wind and tide are the boat's, not a windlass': one set of
+   * listeners serves every unit. After a warm restart (anything but
+   * power-on) each unit takes its position from its RTC snapshot.
+   */
+  const esp_reset_reason_t reset_reason = esp_reset_reason();
+  WindlassUnit::Shared shared;
+  shared.environment = ChainController::Environment::create();
+  shared.publisher = sk_publisher;
+  shared.slackDeadband = sk_slack_deadband;
+  shared.warmReset = reset_reason != ESP_RST_POWERON && reset_reason != ESP_RST_UNKNOWN;
+  shared.wake = wakeFromAnchorWatch;
+  if (shared.warmReset) {
+    SINK_LOGI(__FILE__, "Warm restart (reset reason %d)", (int)reset_reason);
+  }
+  for (size_t i = 0; i < unit_count; i++) {
+    units[i]->begin(shared);
+    SINK_LOGI(__FILE__, "Windlass %u (%s) on %s.*", (unsigned)i, units[i]->name().c_str(),
+              units[i]->skPrefix().c_str());
+  }
 
-  /* React to RESET action */
-  auto* reset_handler = new LambdaConsumer<int>( [accumulator, save_chain_length](int input) {
-    if(ignore_input) {  
-      return;
+  // 10 Hz (see ChainController::SLACK_UPDATE_MS) - the catenary math is a table lookup, fast
+  // enough for tight pause/resume in control(). 1 Hz in anchor watch, where nothing is raising.
+  // One timer for all windlasses.
+  const unsigned watch_slack_divider = 1000 / ChainController::SLACK_UPDATE_MS;
+  auto* slack_update_timer = SetupArena::make<RepeatSensor<bool>>(ChainController::SLACK_UPDATE_MS,
+                                                                  [watch_slack_divider]() -> bool {
+    static unsigned skipped = 0;
+    if (powerManager != nullptr && powerManager->mode() == PowerMode::ANCHOR_WATCH && ++skipped < watch_slack_divider) {
+      return true;
     }
-    if (input == 1) {
-      accumulator->reset();
-      accumulator->set(0);
-      ESP_LOGD(__FILE__, "Deployed chain reset to 0");
-      save_chain_length();
+    skipped = 0;
+    for (size_t i = 0; i < unit_count; i++) {
+      units[i]->controller()->calculateAndPublishHorizontalSlack();
     }
-  });
-  di4_input->connect_to(di4_debounce)->connect_to(reset_handler);
-
-
-  // Set up a listener to respond to requested resets of the chain length
-  auto* reset_listener = new IntSKPutRequestListener("navigation.anchor.rodeDeployed");
-  reset_listener->connect_to(reset_handler);
-
-
-
-//////////////////////////////////////////////////////////////////////////
-//      Windlass Control Section
-//////////////////////////////////////////////////////////////////////////
-
-
-  float min_length = 2.0;  // stop 2 meters before anchor is fully up
-  float stop_before_max = max_chain - 5.0;  // stop 5 meters before max
-
-  chainController = new ChainController(
-    min_length, 
-    max_chain, 
-    stop_before_max, 
-    accumulator, 
-    dnRelayPin,
-    upRelayPin
-  );
-
-
-// Create a feedback connection from the accumulator to the chainController
-// so that it can monitor the current chain length and stop movement at limits
-  auto* feedback = new sensesp::LambdaConsumer<float>(
-      [&](float pos){ chainController->control(pos); }
-  );
-  accumulator->connect_to(feedback);
-
-// initialize up and down speeds from preferences
-  chainController->loadSpeedsFromPrefs();
-
-  deploymentManager = new DeploymentManager(
-    chainController
-  );
-
-  auto slackChain = new SKOutputFloat(
-    "navigation.anchor.chainSlack",
-    "/slack/sk",
-    new SKMetadata("m", "Anchor Chain Slack", "Chain Slack", "Slack")
-  );
-  chainController->getHorizontalSlackObservable()->connect_to(slackChain);
-  auto* slack_update_timer = new RepeatSensor<bool>(500, []() -> bool {
-    chainController->calculateAndPublishHorizontalSlack();
     return true;
   });
 
-
-
-// Set up SKOutput so that we can then receive anchor commands
-// on this path
-  auto* anchor_command = new ObservableValue<String>("idle");
-  anchor_command->connect_to(
-  new SKOutputString("navigation.anchor.command", "/anchorCommand/sk") );
-
-  // Set completion callback for autoDrop to reset anchor_command to idle
-  deploymentManager->setCompletionCallback([anchor_command]() {
-    anchor_command->set("idle");
-    automation_active = false;
-    ESP_LOGI(__FILE__, "autoDrop completed, command set to idle");
+#if CHAIN_PERF
+  /**
+   * Hot-path latency (see PerfStats.h). A fixed-rate probe measures how late
+   * the event loop runs; every 10 s each site's summary for the window since
+   * the last report goes to sensors.chainCounter.perf.<site> and the status
+   * page, and the histograms start over.
+   */
+  const unsigned long lag_probe_ms = 100;
+  event_loop()->onRepeat(lag_probe_ms, [lag_probe_ms]() {
+    static unsigned long last_us = micros();
+    unsigned long now = micros();
+    unsigned long interval_us = now - last_us;
+    last_us = now;
+    PERF_RECORD_US(PerfSite::LOOP_LAG, interval_us > lag_probe_ms * 1000 ? interval_us - lag_probe_ms * 1000 : 0);
   });
 
-  auto* sk_timer2 = new RepeatSensor<bool>(11000, [anchor_command] () -> bool {
-    anchor_command->notify();
-    return true;
+  std::vector<SKOutputString*> perf_outputs;
+  std::vector<StatusPageItem<String>*> perf_items;
+  for (int i = 0; i < (int)PerfSite::COUNT; i++) {
+    String name = perf::siteName((PerfSite)i);
+    perf_outputs.push_back(SetupArena::make<SKOutputString>("sensors.chainCounter.perf." + name, "/perf/" + name + "/sk"));
+    perf_items.push_back(SetupArena::make<StatusPageItem<String>>("Perf " + name, "", "Performance", 3000 + i));
+  }
+  event_loop()->onRepeat(10000, [perf_outputs, perf_items]() {
+    for (int i = 0; i < (int)PerfSite::COUNT; i++) {
+      String summary = perf::summaryText((PerfSite)i);
+      perf_outputs[i]->set(summary);
+      perf_items[i]->set(summary);
+      perf::site((PerfSite)i).reset();
+    }
   });
+#endif
 
-  auto* command_listener = new StringSKPutRequestListener("navigation.anchor.command");
-  
-  /*
-  This is the main command handler for the windlass commands
-  As you create new String commands to be PUT to this path
-  you can add the controls here to respond to them.
-  The first thing that happens when a command is received is to
-  stop any current movement of the windlass. And if there is
-  a command timeout in progress, that is also cancelled.
-
-  Currently setup commands:
-    "drop"       - starts lowering the anchor until depth + 4m is reached 
-                    this is meant as the initial drop command
-    "raiseXX"    - starts raising the anchor by XX meters, e.g. "raise10" or "raise 10"
-                    raises the anchor by 10 meters
-    "lowerXX"    - starts lowering the anchor by XX meters e.g. "lower10" or "lower 10" 
-                    lowers the anchor by 10 meters                
-    "STOP"       - stops any movement in progress (since every command stops movement first,
-                    anything not defined here will just stop the windlass)
-
-  */
-  command_listener->connect_to(new LambdaConsumer<String>( [
-    dnRelayPin, upRelayPin, accumulator, anchor_command, force_save_chain_length
-     ](String input) {
-
-      ESP_LOGI(__FILE__, "Command received is %s", input.c_str());
-
-      // Handle test notifications (don't stop windlass for these)
-      if (input.startsWith("testNotification")) {
-        ESP_LOGI(__FILE__, "TEST NOTIFICATION RECEIVED");
-        anchor_command->set("testNotification");
-        return; // Don't process further, just acknowledge
-      }
+  sk_publisher->start();
 
-      // Stop any active operations before processing new command
-      if (chainController->isActive()) {
-          chainController->stop();
-      }
-      deploymentManager->stop();  // Always stop deployment state machine
-      delay(100);  // Allow stop operations to complete before starting new commands
-
-      if(commandDelayPtr != nullptr) {
-        event_loop()->remove(commandDelayPtr);
-        commandDelayPtr=nullptr;
+  /**
+   * Anchor watch (see PowerManager.h): after power_idle_min minutes with
+   * every windlass idle, its chain in free fall and no automation, the chip
+   * slows down and may light sleep. Slack drops to 1 Hz, Signal K numbers
+   * go out at most every 10 s with a 60 s heartbeat, and the windlass tasks
+   * poll every WindlassCore::WATCH_TICK_MS. A pulse, button, reset or
+   * command on any windlass restores the active settings.
+   */
+  if (power_idle_min > 0) {
+    powerManager = SetupArena::make<PowerManager>([]() {
+      for (size_t i = 0; i < unit_count; i++) {
+        if (units[i]->busy()) return true;
       }
-    float chainStart = accumulator->get();
-    if(input == "drop") {
-        ESP_LOGI(__FILE__, "DROP command received");
-        anchor_command->set("drop");
-        float drop_depth = chainController->getDepthListener()->get() + 4.0; // add 4m to the depth for slack chain on bottom
-        chainController->lowerAnchor(drop_depth);
-        unsigned long moveTime = chainController->getTimeout();
-         commandDelayPtr = event_loop()->onDelay(moveTime, [moveTime, anchor_command, force_save_chain_length]() {
-          ESP_LOGI(__FILE__, "movement timeout reached, stopping chain %1u s", moveTime);
-          chainController->stop();
-          force_save_chain_length();  // Force save on timeout
-          anchor_command->set("idle");
-          commandDelayPtr=nullptr;
-        });
+      return false;
+    }, power_config);
+    for (size_t i = 0; i < unit_count; i++) {
+      units[i]->addWakePins(powerManager);
     }
-    if (input.startsWith("raise")) {
-        int spaceIndex = input.indexOf(' ');
-        float raise_amount = 0;
-
-        if (spaceIndex != -1) {
-            // handle "raise 10" (with space)
-            String number_str = input.substring(spaceIndex + 1);
-            raise_amount = number_str.toFloat();
-        } else {
-            // handle "raise10" (no space)
-            String number_str = input.substring(5);
-            raise_amount = number_str.toFloat();
-        }
-
-        automation_active = true;
-        ESP_LOGI(__FILE__, "Raising %.2f meters", raise_amount);
-        anchor_command->set("raise");
-        chainController->raiseAnchor(raise_amount);
-        unsigned long moveTime = chainController->getTimeout();
-
-        commandDelayPtr = event_loop()->onDelay(moveTime, [moveTime, anchor_command, force_save_chain_length]() {
-            ESP_LOGI(__FILE__, "movement timeout reached, stopping chain %1u s", moveTime);
-            chainController->stop();
-            force_save_chain_length();  // Force save on timeout
-            anchor_command->set("idle");
-            automation_active = false;
-            commandDelayPtr = nullptr;
-        });
-    }
-    if (input.startsWith("lower")) {
-        int spaceIndex = input.indexOf(' ');
-        float lower_amount = 0;
-
-        if (spaceIndex != -1) {
-            // handle "lower 10" (with space)
-            String number_str = input.substring(spaceIndex + 1);
-            lower_amount = number_str.toFloat();
-        } else {
-            // handle "lower10" (no space)
-            String number_str = input.substring(5);
-            lower_amount = number_str.toFloat();
-        }
-
-        automation_active = true;
-        ESP_LOGI(__FILE__, "Lowering %.2f meters", lower_amount);
-        anchor_command->set("lower");
-        chainController->lowerAnchor(lower_amount);
-        unsigned long moveTime = chainController->getTimeout();
-
-        commandDelayPtr = event_loop()->onDelay(moveTime, [moveTime, anchor_command, force_save_chain_length]() {
-            ESP_LOGI(__FILE__, "movement timeout reached, stopping chain %1u s", moveTime);
-            chainController->stop();
-            force_save_chain_length();  // Force save on timeout
-            anchor_command->set("idle");
-            automation_active = false;
-            commandDelayPtr = nullptr;
-        });
-    }
-    if(input.startsWith("autoDrop")) {
-      float scopeRatio = 5.0;  // Default scope ratio
-
-      // Extract numeric suffix if present (e.g., "autoDrop7" → 7.0)
-      if (input.length() > 8) {  // "autoDrop" is 8 characters
-          String suffix = input.substring(8);
-          float parsedRatio = suffix.toFloat();
-          if (parsedRatio > 0) {
-              scopeRatio = parsedRatio;
-          }
-      }
 
-      automation_active = true;
-      ESP_LOGI(__FILE__, "Starting autoDrop with scope ratio %.1f:1", scopeRatio);
-      anchor_command->set("autoDrop");
-      deploymentManager->start(scopeRatio);
-    }
-    if(input == "autoRetrieve") {
-      ESP_LOGI(__FILE__, "AUTO-RETRIEVE command received");
-
-      automation_active = true;
-
-      // Raise all chain to 2m completion threshold
-      // ChainController will auto-pause/resume based on slack
-      float currentRode = chainController->getChainLength();
-      float amountToRaise = currentRode - 2.0;  // Raise to 2m (min_length)
-
-      if (amountToRaise > 0.1) {
-        ESP_LOGI(__FILE__, "Auto-retrieve: raising %.2fm (from %.2fm to 2.0m)", amountToRaise, currentRode);
-        chainController->raiseAnchor(amountToRaise);
-        anchor_command->set("autoRetrieve");
-        // No timeout - ChainController has built-in movement timeout and slack-based pause/resume
-        // User can always stop() manually if needed
-      } else {
-        ESP_LOGI(__FILE__, "Auto-retrieve: already at or below 2m, nothing to raise");
-        anchor_command->set("idle");
-        automation_active = false;
+    PublishScheduler::Config sk_watch = sk_publish;
+    sk_watch.slowIntervalMs = max(sk_publish.slowIntervalMs, 10000UL);
+    sk_watch.heartbeatMs    = max(sk_publish.heartbeatMs, 60000UL);
+    powerManager->onModeChange([sk_publisher, sk_publish, sk_watch](PowerMode mode) {
+      bool watch = mode == PowerMode::ANCHOR_WATCH;
+      sk_publisher->setConfig(watch ? sk_watch : sk_publish);
+      for (size_t i = 0; i < unit_count; i++) {
+        units[i]->controller()->setAnchorWatch(watch);
       }
-    }
-    if (input == "stop") {
-        // Both managers already stopped at top of handler
-        force_save_chain_length();  // Force save position when manually stopped
-        automation_active = false;
-        anchor_command->set("idle");
-    }
-    
-
-
-
-
-
-  }));
-
-///////////////////////////////////////////////////////////////////////////
-// End of Windlass Control Section
-///////////////////////////////////////////////////////////////////////////
-
-  // Startup delay to ignore input changes while system stabilizes
+    });
+    sk_publisher->addState(powerManager->getModeObservable(), "sensors.chainCounter.powerMode", "/power/mode/sk");
+    powerManager->begin();
+  }
 
-    int iStateCounter = digitalRead(di3_gpio);
-    ESP_LOGD(__FILE__, "Initial di3_gpio state: %d", iStateCounter);
-    int iStateUP = digitalRead(upRelayPin);
-    ESP_LOGD(__FILE__, "Initial UP button state: %d", iStateUP);
-    int iStateDOWN = digitalRead(dnRelayPin);
-    ESP_LOGD(__FILE__, "Initial DOWN button state: %d", iStateDOWN);
+  /**
+   * The setup graph is complete (see SetupArena.h). Once the memory report
+   * below is wired up, the arena is closed and what the graph took is
+   * logged. From then on the free heap, its low-water mark since boot and
+   * the largest free block go to the status page every 10 s; the low-water
+   * mark is also published on sensors.chainCounter.heapMinFree. It is the
+   * headroom the web UI and an OTA update have to fit in.
+   */
+  auto* graph_item = SetupArena::make<StatusPageItem<String>>("Setup graph", "", "Memory", 3100);
+  auto* heap_item = SetupArena::make<StatusPageItem<String>>("Heap", "", "Memory", 3101);
+  auto* heap_min_free = SetupArena::make<ObservableValue<float>>(ESP.getMinFreeHeap());
+  sk_publisher->addNumber(heap_min_free, "sensors.chainCounter.heapMinFree", "/heap/sk", 1024.0,
+                          SetupArena::make<SKMetadata>("B", "Lowest free heap since boot", "Heap Low Water", "Heap Min"));
+  event_loop()->onRepeat(10000, [graph_item, heap_item, heap_min_free]() {
+    const SetupArena& arena = SetupArena::global();
+    graph_item->set(String("arena ") + arena.used() + "/" + arena.capacity() + " B, " +
+                    arena.stats().arenaObjects + " objects; heap " + arena.stats().heapObjects +
+                    " objects, " + arena.stats().lateObjects + " after setup");
+    heap_item->set(String("free ") + ESP.getFreeHeap() + " B, min " + ESP.getMinFreeHeap() +
+                   " B, largest block " + ESP.getMaxAllocHeap() + " B");
+    heap_min_free->set(ESP.getMinFreeHeap());
+  });
 
-    event_loop()->onDelay(2000, []() {
-      ignore_input = false; 
-    });
+  SetupArena& arena = SetupArena::global();
+  arena.seal();
+  const SetupArena::Stats& graph = arena.stats();
+  SINK_LOGI(__FILE__, "Setup graph: arena %u/%u bytes, %u objects; heap %u objects, %u bytes (%u did not fit)",
+            (unsigned)arena.used(), (unsigned)arena.capacity(), (unsigned)graph.arenaObjects,
+            (unsigned)graph.heapObjects, (unsigned)graph.heapBytes, (unsigned)graph.overflowObjects);
+  SINK_LOGI(__FILE__, "Heap after setup: %u free, %u largest block", (unsigned)ESP.getFreeHeap(),
+            (unsigned)ESP.getMaxAllocHeap());
 
   // To avoid garbage collecting all shared pointers created in setup(),
   // loop from here.
@@ -723,4 +314,8 @@ void setup() {
    It simply calls `app.tick()` which will then execute all events needed. */
 void loop() {
   event_loop()->tick();
+  // Anchor watch: yield so the idle task can scale the clock down or sleep
+  if (powerManager != nullptr && powerManager->loopDelayMs() > 0) {
+    delay(powerManager->loopDelayMs());
+  }
 }
@@ -0,0 +1,251 @@
+// Arduino.h - host shim for the native environment
+#ifndef NATIVE_SHIM_ARDUINO_H
+#define NATIVE_SHIM_ARDUINO_H
+
+/**
+ * Just enough of the Arduino/ESP-IDF/FreeRTOS surface for the controller
+ * sources to compile and run on the build host.
+ *
+ * Time is virtual: millis()/micros() only move when the harness calls
+ * native::advanceMillis() (see native_host.h). GPIO is an array the harness
+ * can read (relay outputs) and write (relay sense lines). FreeRTOS tasks are
+ * stepped cooperatively - see xTaskCreatePinnedToCore below.
+ */
+
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+using std::isinf;
+using std::isnan;
+
+// ----------------------------------------------------------------------------
+// Virtual clock, GPIO and log level
+// ----------------------------------------------------------------------------
+namespace native {
+
+inline uint64_t now_us = 0;
+
+inline void setMillis(unsigned long ms) { now_us = (uint64_t)ms * 1000; }
+
+static constexpr int PIN_COUNT = 64;
+inline int pins[PIN_COUNT] = {};
+
+enum LogLevel { LOG_NONE, LOG_ERROR, LOG_WARN, LOG_INFO, LOG_DEBUG };
+inline LogLevel log_level = LOG_INFO;
+
+inline const char* baseName(const char* path) {
+    const char* slash = strrchr(path, '/');
+    return slash != nullptr ? slash + 1 : path;
+}
+
+__attribute__((format(printf, 3, 4)))
+inline void log(LogLevel level, const char* tag, const char* format, ...) {
+    if (level > log_level) return;
+    static const char LEVEL_CHARS[] = "-EWID";
+    printf("[%10.3f] %c %s: ", now_us / 1000000.0, LEVEL_CHARS[level], baseName(tag));
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    printf("\n");
+}
+
+}  // namespace native
+
+inline unsigned long millis() { return (unsigned long)(native::now_us / 1000); }
+inline unsigned long micros() { return (unsigned long)native::now_us; }
+inline void delay(unsigned long ms) { native::now_us += (uint64_t)ms * 1000; }
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define INPUT_PULLDOWN 0x09
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+#define IRAM_ATTR
+#define RTC_NOINIT_ATTR
+
+inline void pinMode(int, int) {}
+inline void digitalWrite(int pin, int value) {
+    if (pin >= 0 && pin < native::PIN_COUNT) native::pins[pin] = value;
+}
+inline int digitalRead(int pin) {
+    return (pin >= 0 && pin < native::PIN_COUNT) ? native::pins[pin] : LOW;
+}
+
+// GPIO interrupts run synchronously when the harness drives an input with
+// native::setInput()
+namespace native {
+
+struct PinInterrupt {
+    void (*handler)(void*);
+    void* arg;
+    int mode;
+};
+inline PinInterrupt interrupts[PIN_COUNT] = {};
+
+inline void setInput(int pin, int level) {
+    if (pin < 0 || pin >= PIN_COUNT) return;
+    int previous = pins[pin];
+    pins[pin] = level;
+    const PinInterrupt& irq = interrupts[pin];
+    if (irq.handler == nullptr || level == previous) return;
+    if (irq.mode == CHANGE || (irq.mode == RISING && level == HIGH) || (irq.mode == FALLING && level == LOW)) {
+        irq.handler(irq.arg);
+    }
+}
+
+}  // namespace native
+
+inline void attachInterruptArg(int pin, void (*handler)(void*), void* arg, int mode) {
+    if (pin >= 0 && pin < native::PIN_COUNT) native::interrupts[pin] = {handler, arg, mode};
+}
+inline void detachInterrupt(int pin) {
+    if (pin >= 0 && pin < native::PIN_COUNT) native::interrupts[pin] = {};
+}
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#define ESP_LOGE(tag, ...) native::log(native::LOG_ERROR, tag, __VA_ARGS__)
+#define ESP_LOGW(tag, ...) native::log(native::LOG_WARN, tag, __VA_ARGS__)
+#define ESP_LOGI(tag, ...) native::log(native::LOG_INFO, tag, __VA_ARGS__)
+#define ESP_LOGD(tag, ...) native::log(native::LOG_DEBUG, tag, __VA_ARGS__)
+#define ESP_LOGV(tag, ...) native::log(native::LOG_DEBUG, tag, __VA_ARGS__)
+
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_INVALID_STATE 0x103
+
+// ESP.getCycleCount() is wall time here, not virtual: the perf histograms
+// measure how long the host takes, which is what a benchmark wants. The
+// "CPU" runs at 1000 MHz, so one cycle is one nanosecond.
+class EspClass {
+public:
+    uint32_t getCycleCount() {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch());
+        return (uint32_t)ns.count();
+    }
+    uint32_t getCpuFreqMHz() { return 1000; }
+};
+inline EspClass ESP;
+
+// ----------------------------------------------------------------------------
+// Arduino String - std::string plus the members the sources use
+// ----------------------------------------------------------------------------
+class String : public std::string {
+public:
+    String() = default;
+    String(const char* s) : std::string(s != nullptr ? s : "") {}
+    String(const std::string& s) : std::string(s) {}
+    explicit String(int value) : std::string(std::to_string(value)) {}
+    explicit String(unsigned int value) : std::string(std::to_string(value)) {}
+    explicit String(long value) : std::string(std::to_string(value)) {}
+    explicit String(unsigned long value) : std::string(std::to_string(value)) {}
+    explicit String(float value, unsigned char decimals = 2) { assignFloat(value, decimals); }
+    explicit String(double value, unsigned char decimals = 2) { assignFloat(value, decimals); }
+
+    bool startsWith(const String& prefix) const { return compare(0, prefix.size(), prefix) == 0; }
+    bool endsWith(const String& suffix) const {
+        return size() >= suffix.size() && compare(size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+    String substring(size_t from) const { return from < size() ? String(substr(from)) : String(); }
+    String substring(size_t from, size_t to) const {
+        return from < size() && to > from ? String(substr(from, to - from)) : String();
+    }
+    int indexOf(char c) const { size_t i = find(c); return i == npos ? -1 : (int)i; }
+    float toFloat() const { return strtof(c_str(), nullptr); }
+    long toInt() const { return strtol(c_str(), nullptr, 10); }
+    void trim() {
+        size_t first = find_first_not_of(" \t\r\n");
+        size_t last = find_last_not_of(" \t\r\n");
+        *this = (first == npos) ? String() : String(substr(first, last - first + 1));
+    }
+
+private:
+    void assignFloat(double value, unsigned char decimals) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.*f", decimals, value);
+        assign(buf);
+    }
+};
+
+// ----------------------------------------------------------------------------
+// FreeRTOS
+//
+// There is no scheduler on the host. xTaskCreatePinnedToCore records the task
+// and native::runTasks() (called once per virtual millisecond) enters its
+// function. The task body runs until its vTaskDelayUntil, which throws back to
+// runTasks() - so each call is exactly one loop iteration of the real task
+// code, in lock step with the virtual clock. The period passed to
+// vTaskDelayUntil is honoured: the task is not entered again before it ends.
+// ----------------------------------------------------------------------------
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef void* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+#define pdPASS 1
+#define pdFAIL 0
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+namespace native {
+
+struct Task {
+    TaskFunction_t function;
+    void* arg;
+    unsigned long next_ms;   // Next virtual millisecond the task runs at
+    unsigned long runs;      // Loop iterations so far
+};
+inline std::vector<Task> tasks;
+inline size_t current_task = 0;
+
+struct TaskYield {};  // Thrown by vTaskDelayUntil to end one task iteration
+
+inline void runTasks() {
+    for (size_t i = 0; i < tasks.size(); i++) {
+        if ((long)(millis() - tasks[i].next_ms) < 0) continue;
+        current_task = i;
+        tasks[i].runs++;
+        try {
+            tasks[i].function(tasks[i].arg);
+        } catch (const TaskYield&) {
+        }
+    }
+}
+
+}  // namespace native
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char*, uint32_t, void* arg,
+                                          UBaseType_t, TaskHandle_t* handle, BaseType_t) {
+    native::tasks.push_back({function, arg, 0, 0});
+    if (handle != nullptr) *handle = reinterpret_cast<TaskHandle_t>(native::tasks.size());
+    return pdPASS;
+}
+inline TickType_t xTaskGetTickCount() { return (TickType_t)millis(); }
+inline void vTaskDelayUntil(TickType_t*, TickType_t period) {
+    native::tasks[native::current_task].next_ms = millis() + period;
+    throw native::TaskYield();
+}
+
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+#define portENTER_CRITICAL_ISR(mux) ((void)(mux))
+#define portEXIT_CRITICAL_ISR(mux) ((void)(mux))
+
+#endif  // NATIVE_SHIM_ARDUINO_H
@@ -0,0 +1,84 @@
+// Preferences.h - host shim for the native environment
+#ifndef NATIVE_SHIM_PREFERENCES_H
+#define NATIVE_SHIM_PREFERENCES_H
+
+#include <Arduino.h>
+#include <map>
+
+/**
+ * NVS Preferences backed by an in-memory map, so values written by one
+ * Preferences object are read back by the next - like a device that never
+ * loses power. native::clearPreferences() gives a factory-fresh store.
+ */
+namespace native {
+
+typedef std::map<std::string, std::vector<uint8_t>> PreferencesNamespace;
+inline std::map<std::string, PreferencesNamespace> preferences_store;
+inline unsigned long preferences_writes = 0;
+
+inline void clearPreferences() {
+    preferences_store.clear();
+    preferences_writes = 0;
+}
+
+}  // namespace native
+
+class Preferences {
+public:
+    bool begin(const char* name, bool read_only = false) {
+        space_ = &native::preferences_store[name];
+        read_only_ = read_only;
+        return true;
+    }
+    void end() { space_ = nullptr; }
+
+    bool isKey(const char* key) const { return space_ != nullptr && space_->count(key) > 0; }
+    bool remove(const char* key) { return writable() && space_->erase(key) > 0; }
+    bool clear() {
+        if (!writable()) return false;
+        space_->clear();
+        return true;
+    }
+
+    size_t putBytes(const char* key, const void* value, size_t len) {
+        if (!writable()) return 0;
+        const uint8_t* bytes = static_cast<const uint8_t*>(value);
+        (*space_)[key].assign(bytes, bytes + len);
+        native::preferences_writes++;
+        return len;
+    }
+    size_t getBytesLength(const char* key) const {
+        return isKey(key) ? space_->at(key).size() : 0;
+    }
+    size_t getBytes(const char* key, void* buf, size_t max_len) const {
+        if (!isKey(key)) return 0;
+        const std::vector<uint8_t>& bytes = space_->at(key);
+        size_t len = bytes.size() < max_len ? bytes.size() : max_len;
+        memcpy(buf, bytes.data(), len);
+        return len;
+    }
+
+    size_t putFloat(const char* key, float value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putInt(const char* key, int32_t value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putUInt(const char* key, uint32_t value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putBool(const char* key, bool value) { return putBytes(key, &value, sizeof(value)); }
+    float getFloat(const char* key, float default_value = 0.0f) const { return get(key, default_value); }
+    int32_t getInt(const char* key, int32_t default_value = 0) const { return get(key, default_value); }
+    uint32_t getUInt(const char* key, uint32_t default_value = 0) const { return get(key, default_value); }
+    bool getBool(const char* key, bool default_value = false) const { return get(key, default_value); }
+
+private:
+    bool writable() const { return space_ != nullptr && !read_only_; }
+
+    template <typename T>
+    T get(const char* key, T default_value) const {
+        T value;
+        return getBytesLength(key) == sizeof(T) && getBytes(key, &value, sizeof(T)) == sizeof(T)
+                   ? value : default_value;
+    }
+
+    native::PreferencesNamespace* space_ = nullptr;
+    bool read_only_ = false;
+};
+
+#endif  // NATIVE_SHIM_PREFERENCES_H
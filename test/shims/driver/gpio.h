@@ -0,0 +1,18 @@
+// driver/gpio.h - host shim for the native environment
+#ifndef NATIVE_SHIM_DRIVER_GPIO_H
+#define NATIVE_SHIM_DRIVER_GPIO_H
+
+#include <Arduino.h>
+
+typedef int gpio_num_t;
+
+typedef enum {
+    GPIO_PULLUP_ONLY,
+    GPIO_PULLDOWN_ONLY,
+    GPIO_PULLUP_PULLDOWN,
+    GPIO_FLOATING
+} gpio_pull_mode_t;
+
+inline esp_err_t gpio_set_pull_mode(gpio_num_t, gpio_pull_mode_t) { return ESP_OK; }
+
+#endif  // NATIVE_SHIM_DRIVER_GPIO_H
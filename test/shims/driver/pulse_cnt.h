@@ -0,0 +1,168 @@
+// driver/pulse_cnt.h - host shim for the native environment (IDF 5 PCNT driver)
+#ifndef NATIVE_SHIM_DRIVER_PULSE_CNT_H
+#define NATIVE_SHIM_DRIVER_PULSE_CNT_H
+
+#include <Arduino.h>
+
+/**
+ * PCNT units are plain counters. A harness feeds gypsy pulses with
+ * native::pcntCount(), which applies the channel's edge and level actions
+ * against the current level of the level GPIO - the same direction logic as
+ * the hardware, so sense-line wiring mistakes show up on the host too. A
+ * count that reaches a watch point calls on_reach, and one that reaches a
+ * limit clears, as the hardware does.
+ */
+typedef enum {
+    PCNT_CHANNEL_EDGE_ACTION_HOLD,
+    PCNT_CHANNEL_EDGE_ACTION_INCREASE,
+    PCNT_CHANNEL_EDGE_ACTION_DECREASE
+} pcnt_channel_edge_action_t;
+typedef enum {
+    PCNT_CHANNEL_LEVEL_ACTION_KEEP,
+    PCNT_CHANNEL_LEVEL_ACTION_INVERSE,
+    PCNT_CHANNEL_LEVEL_ACTION_HOLD
+} pcnt_channel_level_action_t;
+
+typedef struct {
+    int low_limit;
+    int high_limit;
+    int intr_priority;
+    struct {
+        uint32_t accum_count : 1;
+    } flags;
+} pcnt_unit_config_t;
+
+typedef struct {
+    uint32_t max_glitch_ns;
+} pcnt_glitch_filter_config_t;
+
+typedef struct {
+    int edge_gpio_num;
+    int level_gpio_num;
+} pcnt_chan_config_t;
+
+typedef struct {
+    int watch_point_value;
+} pcnt_watch_event_data_t;
+
+namespace native {
+struct PcntUnit;
+}
+typedef native::PcntUnit* pcnt_unit_handle_t;
+typedef native::PcntUnit* pcnt_channel_handle_t;   // One channel per unit here
+
+typedef bool (*pcnt_watch_cb_t)(pcnt_unit_handle_t unit, const pcnt_watch_event_data_t* event, void* user_ctx);
+typedef struct {
+    pcnt_watch_cb_t on_reach;
+} pcnt_event_callbacks_t;
+
+namespace native {
+
+constexpr int PCNT_UNITS = 8;
+constexpr int PCNT_WATCH_POINTS = 5;
+
+struct PcntUnit {
+    bool allocated;
+    bool running;
+    pcnt_unit_config_t config;
+    uint32_t glitch_ns;
+    pcnt_chan_config_t channel;
+    pcnt_channel_edge_action_t pos_action;
+    pcnt_channel_level_action_t high_action;
+    pcnt_channel_level_action_t low_action;
+    int watch_points[PCNT_WATCH_POINTS];
+    int watch_point_count;
+    pcnt_watch_cb_t on_reach;
+    void* user_ctx;
+    int count;
+};
+inline PcntUnit pcnt_units[PCNT_UNITS] = {};
+
+// One rising edge on the pulse GPIO of every running unit wired to it
+inline void pcntCount(int pulse_gpio) {
+    for (PcntUnit& unit : pcnt_units) {
+        if (!unit.running || unit.channel.edge_gpio_num != pulse_gpio) continue;
+        int step = unit.pos_action == PCNT_CHANNEL_EDGE_ACTION_INCREASE ? 1 :
+                   unit.pos_action == PCNT_CHANNEL_EDGE_ACTION_DECREASE ? -1 : 0;
+        pcnt_channel_level_action_t action = digitalRead(unit.channel.level_gpio_num) == LOW
+                                                 ? unit.low_action : unit.high_action;
+        if (action == PCNT_CHANNEL_LEVEL_ACTION_INVERSE) step = -step;
+        if (action == PCNT_CHANNEL_LEVEL_ACTION_HOLD) step = 0;
+        if (step == 0) continue;
+        unit.count += step;
+        for (int i = 0; i < unit.watch_point_count; i++) {
+            if (unit.watch_points[i] != unit.count || unit.on_reach == nullptr) continue;
+            pcnt_watch_event_data_t event = {unit.count};
+            unit.on_reach(&unit, &event, unit.user_ctx);
+        }
+        if (unit.count >= unit.config.high_limit || unit.count <= unit.config.low_limit) unit.count = 0;
+    }
+}
+
+}  // namespace native
+
+inline esp_err_t pcnt_new_unit(const pcnt_unit_config_t* config, pcnt_unit_handle_t* unit) {
+    for (native::PcntUnit& slot : native::pcnt_units) {
+        if (slot.allocated) continue;
+        slot = {};
+        slot.allocated = true;
+        slot.config = *config;
+        *unit = &slot;
+        return ESP_OK;
+    }
+    return ESP_FAIL;
+}
+inline esp_err_t pcnt_unit_set_glitch_filter(pcnt_unit_handle_t unit, const pcnt_glitch_filter_config_t* config) {
+    unit->glitch_ns = config->max_glitch_ns;
+    return ESP_OK;
+}
+inline esp_err_t pcnt_new_channel(pcnt_unit_handle_t unit, const pcnt_chan_config_t* config,
+                                  pcnt_channel_handle_t* channel) {
+    unit->channel = *config;
+    *channel = unit;
+    return ESP_OK;
+}
+inline esp_err_t pcnt_channel_set_edge_action(pcnt_channel_handle_t channel, pcnt_channel_edge_action_t pos_action,
+                                              pcnt_channel_edge_action_t) {
+    channel->pos_action = pos_action;   // Falling edges are not modelled
+    return ESP_OK;
+}
+inline esp_err_t pcnt_channel_set_level_action(pcnt_channel_handle_t channel, pcnt_channel_level_action_t high_action,
+                                               pcnt_channel_level_action_t low_action) {
+    channel->high_action = high_action;
+    channel->low_action = low_action;
+    return ESP_OK;
+}
+inline esp_err_t pcnt_unit_add_watch_point(pcnt_unit_handle_t unit, int watch_point) {
+    if (unit->watch_point_count == native::PCNT_WATCH_POINTS || watch_point > unit->config.high_limit ||
+        watch_point < unit->config.low_limit) {
+        return ESP_FAIL;
+    }
+    unit->watch_points[unit->watch_point_count++] = watch_point;
+    return ESP_OK;
+}
+inline esp_err_t pcnt_unit_register_event_callbacks(pcnt_unit_handle_t unit, const pcnt_event_callbacks_t* callbacks,
+                                                    void* user_ctx) {
+    unit->on_reach = callbacks->on_reach;
+    unit->user_ctx = user_ctx;
+    return ESP_OK;
+}
+inline esp_err_t pcnt_unit_enable(pcnt_unit_handle_t) { return ESP_OK; }
+inline esp_err_t pcnt_unit_clear_count(pcnt_unit_handle_t unit) {
+    unit->count = 0;
+    return ESP_OK;
+}
+inline esp_err_t pcnt_unit_start(pcnt_unit_handle_t unit) {
+    unit->running = true;
+    return ESP_OK;
+}
+inline esp_err_t pcnt_unit_stop(pcnt_unit_handle_t unit) {
+    unit->running = false;
+    return ESP_OK;
+}
+inline esp_err_t pcnt_unit_get_count(pcnt_unit_handle_t unit, int* count) {
+    *count = unit->count;
+    return ESP_OK;
+}
+
+#endif  // NATIVE_SHIM_DRIVER_PULSE_CNT_H
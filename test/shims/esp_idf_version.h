@@ -0,0 +1,9 @@
+// esp_idf_version.h - host shim for the native environment
+#ifndef NATIVE_SHIM_ESP_IDF_VERSION_H
+#define NATIVE_SHIM_ESP_IDF_VERSION_H
+
+// The host builds the IDF 5 code paths (pioarduino, the default env)
+#define ESP_IDF_VERSION_VAL(major, minor, patch) (((major) << 16) | ((minor) << 8) | (patch))
+#define ESP_IDF_VERSION ESP_IDF_VERSION_VAL(5, 3, 0)
+
+#endif  // NATIVE_SHIM_ESP_IDF_VERSION_H
@@ -0,0 +1,45 @@
+// esp_log.h - host shim for the native environment
+#ifndef NATIVE_SHIM_ESP_LOG_H
+#define NATIVE_SHIM_ESP_LOG_H
+
+/**
+ * The ESP-IDF log levels and esp_log_write, which LogSink prints through.
+ * Lines go to stdout when they pass native::log_level; the last one is kept
+ * so tests can check the exact text.
+ */
+
+#include "Arduino.h"
+
+typedef enum {
+    ESP_LOG_NONE,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE
+} esp_log_level_t;
+
+#ifndef LOG_LOCAL_LEVEL
+#define LOG_LOCAL_LEVEL ESP_LOG_VERBOSE
+#endif
+
+namespace native {
+
+inline std::string last_log_line;
+inline unsigned long log_lines_written = 0;
+
+}  // namespace native
+
+__attribute__((format(printf, 3, 4)))
+inline void esp_log_write(esp_log_level_t level, const char*, const char* format, ...) {
+    char buf[512];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    native::last_log_line = buf;
+    native::log_lines_written++;
+    if ((int)level <= (int)native::log_level) fputs(buf, stdout);
+}
+
+#endif  // NATIVE_SHIM_ESP_LOG_H
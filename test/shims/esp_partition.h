@@ -0,0 +1,101 @@
+// esp_partition.h - host shim for the native environment
+#ifndef NATIVE_SHIM_ESP_PARTITION_H
+#define NATIVE_SHIM_ESP_PARTITION_H
+
+#include <Arduino.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/**
+ * Data partitions in RAM with NOR flash rules: erase sets a 4 KB sector to
+ * 0xFF and a write can only clear bits. A harness adds a partition with
+ * native::addPartition() before the code under test looks it up, and can
+ * look at or corrupt its bytes directly; native::reset() removes them all.
+ */
+typedef enum {
+    ESP_PARTITION_TYPE_APP = 0x00,
+    ESP_PARTITION_TYPE_DATA = 0x01
+} esp_partition_type_t;
+typedef enum {
+    ESP_PARTITION_SUBTYPE_ANY = 0xff
+} esp_partition_subtype_t;
+
+typedef struct {
+    esp_partition_type_t type;
+    uint32_t address;
+    uint32_t size;
+    char label[17];
+} esp_partition_t;
+
+namespace native {
+
+constexpr size_t FLASH_SECTOR_SIZE = 4096;
+
+struct Partition {
+    esp_partition_t info;
+    std::vector<uint8_t> bytes;
+};
+inline std::vector<Partition*> partitions;
+
+// A fresh (erased) data partition
+inline Partition* addPartition(const char* label, uint32_t size) {
+    auto* partition = new Partition();
+    partition->info.type = ESP_PARTITION_TYPE_DATA;
+    partition->info.size = size;
+    strncpy(partition->info.label, label, sizeof(partition->info.label) - 1);
+    partition->bytes.assign(size, 0xFF);
+    partitions.push_back(partition);
+    return partition;
+}
+
+inline Partition* findPartition(const esp_partition_t* info) {
+    for (Partition* partition : partitions) {
+        if (&partition->info == info) return partition;
+    }
+    return nullptr;
+}
+
+inline void clearPartitions() {
+    for (Partition* partition : partitions) delete partition;
+    partitions.clear();
+}
+
+}  // namespace native
+
+inline const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t,
+                                                       const char* label) {
+    for (native::Partition* partition : native::partitions) {
+        if (partition->info.type == type && (label == nullptr || strcmp(partition->info.label, label) == 0)) {
+            return &partition->info;
+        }
+    }
+    return nullptr;
+}
+
+inline esp_err_t esp_partition_read(const esp_partition_t* info, size_t offset, void* dst, size_t size) {
+    native::Partition* partition = native::findPartition(info);
+    if (partition == nullptr || offset + size > info->size) return ESP_FAIL;
+    memcpy(dst, partition->bytes.data() + offset, size);
+    return ESP_OK;
+}
+
+inline esp_err_t esp_partition_write(const esp_partition_t* info, size_t offset, const void* src, size_t size) {
+    native::Partition* partition = native::findPartition(info);
+    if (partition == nullptr || offset + size > info->size) return ESP_FAIL;
+    const uint8_t* bytes = static_cast<const uint8_t*>(src);
+    for (size_t i = 0; i < size; i++) partition->bytes[offset + i] &= bytes[i];
+    return ESP_OK;
+}
+
+inline esp_err_t esp_partition_erase_range(const esp_partition_t* info, size_t offset, size_t size) {
+    native::Partition* partition = native::findPartition(info);
+    if (partition == nullptr || offset % native::FLASH_SECTOR_SIZE != 0 || size % native::FLASH_SECTOR_SIZE != 0 ||
+        offset + size > info->size) {
+        return ESP_FAIL;
+    }
+    memset(partition->bytes.data() + offset, 0xFF, size);
+    return ESP_OK;
+}
+
+#endif  // NATIVE_SHIM_ESP_PARTITION_H
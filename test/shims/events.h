@@ -0,0 +1,7 @@
+// events.h - host shim for the native environment (ReactESP events)
+#ifndef NATIVE_SHIM_EVENTS_H
+#define NATIVE_SHIM_EVENTS_H
+
+#include "sensesp_app.h"
+
+#endif  // NATIVE_SHIM_EVENTS_H
@@ -0,0 +1,44 @@
+// native_host.h - harness helpers for the native environment
+#ifndef NATIVE_SHIM_NATIVE_HOST_H
+#define NATIVE_SHIM_NATIVE_HOST_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <driver/pulse_cnt.h>
+#include <esp_partition.h>
+#include "sensesp_app.h"
+
+namespace native {
+
+/**
+ * Advance virtual time one millisecond at a time. Each step runs one loop
+ * iteration of every FreeRTOS task (the windlass task ticks at 1 ms) and
+ * then the event loop, the same order of work the device sees per
+ * millisecond. perStep, if given, runs before the tasks each step so a
+ * plant model can drive relay sense lines and pulses.
+ */
+inline void advanceMillis(unsigned long ms, const std::function<void()>& perStep = nullptr) {
+    for (unsigned long i = 0; i < ms; i++) {
+        now_us += 1000;
+        if (perStep) perStep();
+        runTasks();
+        sensesp::event_loop()->tick();
+    }
+}
+
+// Fresh host state between independent runs. Objects created by the
+// firmware code are not freed (they are never freed on the device either).
+inline void reset() {
+    now_us = 0;
+    memset(pins, 0, sizeof(pins));
+    memset(interrupts, 0, sizeof(interrupts));
+    tasks.clear();
+    sensesp::event_loop()->clear();
+    clearPreferences();
+    clearPartitions();
+    for (PcntUnit& unit : pcnt_units) unit = {};
+}
+
+}  // namespace native
+
+#endif  // NATIVE_SHIM_NATIVE_HOST_H
@@ -0,0 +1,56 @@
+// sensesp/signalk/signalk_output.h - host shim for the native environment
+#ifndef NATIVE_SHIM_SENSESP_SIGNALK_OUTPUT_H
+#define NATIVE_SHIM_SENSESP_SIGNALK_OUTPUT_H
+
+#include "sensesp/system/valueproducer.h"
+
+namespace sensesp {
+
+class SKMetadata {
+public:
+    SKMetadata(const String& units = "", const String& display_name = "",
+               const String& description = "", const String& short_name = "")
+      : units_(units), display_name_(display_name) {}
+
+    String units_;
+    String display_name_;
+};
+
+/**
+ * Signal K output without a server: keeps the last value and a count of
+ * set() calls so a harness can check what would have been published.
+ */
+template <typename T>
+class SKOutput : public ValueConsumer<T>, public ValueProducer<T> {
+public:
+    SKOutput(const String& sk_path, const String& config_path = "", SKMetadata* metadata = nullptr)
+      : sk_path_(sk_path), metadata_(metadata) {}
+
+    void set(const T& value) override {
+        publish_count_++;
+        this->emit(value);
+    }
+
+    const String& get_sk_path() const { return sk_path_; }
+    unsigned long publishCount() const { return publish_count_; }
+
+private:
+    String sk_path_;
+    SKMetadata* metadata_;
+    unsigned long publish_count_ = 0;
+};
+
+typedef SKOutput<float> SKOutputFloat;
+typedef SKOutput<int> SKOutputInt;
+typedef SKOutput<bool> SKOutputBool;
+typedef SKOutput<String> SKOutputString;
+
+// The value is a JSON document sent as is, e.g. a notification
+class SKOutputRawJson : public SKOutput<String> {
+public:
+    using SKOutput<String>::SKOutput;
+};
+
+}  // namespace sensesp
+
+#endif  // NATIVE_SHIM_SENSESP_SIGNALK_OUTPUT_H
@@ -0,0 +1,29 @@
+// sensesp/signalk/signalk_value_listener.h - host shim for the native environment
+#ifndef NATIVE_SHIM_SENSESP_SIGNALK_VALUE_LISTENER_H
+#define NATIVE_SHIM_SENSESP_SIGNALK_VALUE_LISTENER_H
+
+#include "sensesp/system/valueproducer.h"
+
+namespace sensesp {
+
+/**
+ * Signal K listener without a server: the harness delivers values with
+ * emit(), as the listener itself does when a delta arrives.
+ */
+template <typename T>
+class SKValueListener : public ValueProducer<T> {
+public:
+    SKValueListener(const String& sk_path, int listen_delay = 1000, const String& config_path = "")
+      : sk_path_(sk_path), listen_delay_(listen_delay) {}
+
+    const String& get_sk_path() const { return sk_path_; }
+    int get_listen_delay() const { return listen_delay_; }
+
+private:
+    String sk_path_;
+    int listen_delay_;
+};
+
+}  // namespace sensesp
+
+#endif  // NATIVE_SHIM_SENSESP_SIGNALK_VALUE_LISTENER_H
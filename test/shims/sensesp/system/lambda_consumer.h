@@ -0,0 +1,23 @@
+// sensesp/system/lambda_consumer.h - host shim for the native environment
+#ifndef NATIVE_SHIM_SENSESP_LAMBDA_CONSUMER_H
+#define NATIVE_SHIM_SENSESP_LAMBDA_CONSUMER_H
+
+#include <functional>
+#include "sensesp/system/valueconsumer.h"
+
+namespace sensesp {
+
+template <typename T>
+class LambdaConsumer : public ValueConsumer<T> {
+public:
+    LambdaConsumer(std::function<void(T)> function) : function_(function) {}
+
+    void set(const T& value) override { function_(value); }
+
+private:
+    std::function<void(T)> function_;
+};
+
+}  // namespace sensesp
+
+#endif  // NATIVE_SHIM_SENSESP_LAMBDA_CONSUMER_H
@@ -0,0 +1,29 @@
+// sensesp/system/observable.h - host shim for the native environment
+#ifndef NATIVE_SHIM_SENSESP_OBSERVABLE_H
+#define NATIVE_SHIM_SENSESP_OBSERVABLE_H
+
+#include <functional>
+#include <vector>
+
+namespace sensesp {
+
+/**
+ * Observer list: attach() registers a callback, notify() calls them all in
+ * attach order, synchronously - the same semantics as SensESP.
+ */
+class Observable {
+public:
+    virtual ~Observable() = default;
+
+    void attach(std::function<void()> observer) { observers_.push_back(observer); }
+    void notify() {
+        for (auto& observer : observers_) observer();
+    }
+
+private:
+    std::vector<std::function<void()>> observers_;
+};
+
+}  // namespace sensesp
+
+#endif  // NATIVE_SHIM_SENSESP_OBSERVABLE_H
@@ -0,0 +1,20 @@
+// sensesp/system/observablevalue.h - host shim for the native environment
+#ifndef NATIVE_SHIM_SENSESP_OBSERVABLEVALUE_H
+#define NATIVE_SHIM_SENSESP_OBSERVABLEVALUE_H
+
+#include "sensesp/system/valueproducer.h"
+
+namespace sensesp {
+
+template <typename T>
+class ObservableValue : public ValueConsumer<T>, public ValueProducer<T> {
+public:
+    ObservableValue() = default;
+    ObservableValue(const T& value) { this->output_ = value; }
+
+    void set(const T& value) override { this->emit(value); }
+};
+
+}  // namespace sensesp
+
+#endif  // NATIVE_SHIM_SENSESP_OBSERVABLEVALUE_H
@@ -0,0 +1,16 @@
+// sensesp/system/valueconsumer.h - host shim for the native environment
+#ifndef NATIVE_SHIM_SENSESP_VALUECONSUMER_H
+#define NATIVE_SHIM_SENSESP_VALUECONSUMER_H
+
+namespace sensesp {
+
+template <typename T>
+class ValueConsumer {
+public:
+    virtual ~ValueConsumer() = default;
+    virtual void set(const T& value) = 0;
+};
+
+}  // namespace sensesp
+
+#endif  // NATIVE_SHIM_SENSESP_VALUECONSUMER_H
@@ -0,0 +1,35 @@
+// sensesp/system/valueproducer.h - host shim for the native environment
+#ifndef NATIVE_SHIM_SENSESP_VALUEPRODUCER_H
+#define NATIVE_SHIM_SENSESP_VALUEPRODUCER_H
+
+#include <Arduino.h>
+#include "sensesp/system/observable.h"
+#include "sensesp/system/valueconsumer.h"
+
+namespace sensesp {
+
+template <typename T>
+class ValueProducer : public Observable {
+public:
+    virtual const T& get() const { return output_; }
+
+    void emit(const T& value) {
+        output_ = value;
+        notify();
+    }
+
+    // Returns the consumer so transforms can be chained like in SensESP
+    template <typename C>
+    C* connect_to(C* consumer) {
+        ValueConsumer<T>* target = consumer;
+        attach([this, target]() { target->set(this->get()); });
+        return consumer;
+    }
+
+protected:
+    T output_{};
+};
+
+}  // namespace sensesp
+
+#endif  // NATIVE_SHIM_SENSESP_VALUEPRODUCER_H
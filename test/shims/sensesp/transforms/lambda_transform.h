@@ -0,0 +1,23 @@
+// sensesp/transforms/lambda_transform.h - host shim for the native environment
+#ifndef NATIVE_SHIM_SENSESP_LAMBDA_TRANSFORM_H
+#define NATIVE_SHIM_SENSESP_LAMBDA_TRANSFORM_H
+
+#include <functional>
+#include "sensesp/system/valueproducer.h"
+
+namespace sensesp {
+
+template <typename IN, typename OUT>
+class LambdaTransform : public ValueConsumer<IN>, public ValueProducer<OUT> {
+public:
+    LambdaTransform(std::function<OUT(IN)> function) : function_(function) {}
+
+    void set(const IN& value) override { this->emit(function_(value)); }
+
+private:
+    std::function<OUT(IN)> function_;
+};
+
+}  // namespace sensesp
+
+#endif  // NATIVE_SHIM_SENSESP_LAMBDA_TRANSFORM_H
@@ -0,0 +1,93 @@
+// sensesp_app.h - host shim for the native environment
+#ifndef NATIVE_SHIM_SENSESP_APP_H
+#define NATIVE_SHIM_SENSESP_APP_H
+
+#include <Arduino.h>
+#include <algorithm>
+#include "sensesp/system/observablevalue.h"
+#include "sensesp/system/valueproducer.h"
+
+namespace reactesp {
+
+class Event {
+public:
+    Event(unsigned long due_ms, unsigned long interval_ms, std::function<void()> callback)
+      : due_ms_(due_ms), interval_ms_(interval_ms), callback_(callback) {}
+
+    unsigned long due_ms_;
+    unsigned long interval_ms_;       // 0 = one-shot (onDelay)
+    std::function<void()> callback_;
+};
+
+/**
+ * ReactESP event loop on the virtual clock. tick() runs every event that is
+ * due at millis(). As in ReactESP, a one-shot event is deleted after it
+ * fires and remove() deletes the event, so stale handles behave the same way
+ * they would on the device. remove() of a handle that is not queued is a
+ * no-op.
+ */
+class EventLoop {
+public:
+    Event* onDelay(unsigned long delay_ms, std::function<void()> callback) {
+        return add(new Event(millis() + delay_ms, 0, callback));
+    }
+    Event* onRepeat(unsigned long interval_ms, std::function<void()> callback) {
+        return add(new Event(millis() + interval_ms, interval_ms > 0 ? interval_ms : 1, callback));
+    }
+
+    void remove(Event* event) {
+        auto it = std::find(events_.begin(), events_.end(), event);
+        if (it == events_.end()) return;
+        events_.erase(it);
+        delete event;
+    }
+
+    void tick() {
+        const unsigned long now = millis();
+        // Callbacks may add or remove events, so walk a copy and re-check
+        std::vector<Event*> due;
+        for (Event* event : events_) {
+            if ((long)(now - event->due_ms_) >= 0) due.push_back(event);
+        }
+        for (Event* event : due) {
+            if (std::find(events_.begin(), events_.end(), event) == events_.end()) continue;
+            if (event->interval_ms_ > 0) {
+                event->due_ms_ += event->interval_ms_;
+                event->callback_();
+            } else {
+                events_.erase(std::find(events_.begin(), events_.end(), event));
+                std::function<void()> callback = event->callback_;
+                delete event;
+                callback();
+            }
+        }
+    }
+
+    size_t size() const { return events_.size(); }
+
+    void clear() {
+        for (Event* event : events_) delete event;
+        events_.clear();
+    }
+
+private:
+    Event* add(Event* event) {
+        events_.push_back(event);
+        return event;
+    }
+
+    std::vector<Event*> events_;
+};
+
+}  // namespace reactesp
+
+namespace sensesp {
+
+inline reactesp::EventLoop* event_loop() {
+    static reactesp::EventLoop loop;
+    return &loop;
+}
+
+}  // namespace sensesp
+
+#endif  // NATIVE_SHIM_SENSESP_APP_H
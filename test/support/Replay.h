@@ -0,0 +1,324 @@
+// Replay.h - a trace capture fed back through the firmware's controller objects on the host
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <Preferences.h>
+
+#include "native_host.h"
+#include "ChainController.h"
+#include "ChainPosition.h"
+#include "ChainTrace.h"
+#include "CommandDispatcher.h"
+#include "DeploymentManager.h"
+#include "PulseCounter.h"
+
+namespace replay {
+
+using Record = ChainTrace::Record;
+using Type = ChainTrace::Type;
+
+// Pin map of the default build (see main.cpp)
+constexpr int DOWN_RELAY_PIN = 19;
+constexpr int UP_RELAY_PIN = 16;
+constexpr int UP_SENSE_GPIO = 23;      // di1, ACTIVE-LOW
+constexpr int DOWN_SENSE_GPIO = 25;    // di2, ACTIVE-LOW
+constexpr int PULSE_GPIO = 27;         // di3, gypsy hall sensor
+
+constexpr unsigned long SLACK_PERIOD_MS = ChainController::SLACK_UPDATE_MS;   // slack_update_timer in main.cpp
+constexpr unsigned long SETTLE_MS = 3000;         // Run on after the last record
+constexpr unsigned long TOLERANCE_MS = 50;        // Output time skew that still counts as the same
+constexpr float AUTO_RETRIEVE_TO_M = 2.0;         // "autoRetrieve" handler in WindlassUnit.cpp
+
+inline bool isOutput(Type type) {
+    return type == Type::RELAY || type == Type::STAGE || type == Type::NVS;
+}
+
+inline std::string describe(const Record& record) {
+    char text[128];
+    ChainTrace::format(record, text, sizeof(text));
+    return "(" + std::to_string(record.ms) + ") " + text;
+}
+
+/**
+ * The trace records of one windlass for one boot: its begin/speeds, the
+ * shared Signal K inputs and its own inputs and outputs, in time order.
+ * Every other line (regular log output, other units) is skipped.
+ */
+struct Capture {
+    std::vector<Record> records;
+
+    bool add(const Record& record, uint8_t unit = 0) {
+        if (record.type != Type::VALUE && record.unit != unit) return false;
+        records.push_back(record);
+        return true;
+    }
+    bool addLine(const std::string& line, uint8_t unit = 0) {
+        Record record;
+        return ChainTrace::parse(line.c_str(), &record) && add(record, unit);
+    }
+    // The LogSink writes in post order; the two tasks can interleave by a tick
+    void sort() {
+        std::stable_sort(records.begin(), records.end(),
+                         [](const Record& a, const Record& b) { return a.ms < b.ms; });
+    }
+
+    // One capture per boot in the log (millis() starts over at each begin);
+    // records before the first begin are dropped
+    static std::vector<Capture> load(const std::string& path, uint8_t unit = 0) {
+        std::vector<Capture> captures;
+        std::ifstream file(path);
+        std::string line;
+        Record record;
+        while (std::getline(file, line)) {
+            if (!ChainTrace::parse(line.c_str(), &record)) continue;
+            if (record.type == Type::BEGIN && record.unit == unit) captures.emplace_back();
+            if (!captures.empty()) captures.back().add(record, unit);
+        }
+        for (Capture& capture : captures) capture.sort();
+        return captures;
+    }
+
+    const Record* find(Type type) const {
+        for (const Record& record : records) {
+            if (record.type == type) return &record;
+        }
+        return nullptr;
+    }
+    bool replayable() const { return find(Type::BEGIN) != nullptr && find(Type::SPEEDS) != nullptr; }
+
+    std::vector<Record> outputs() const {
+        std::vector<Record> outputs;
+        for (const Record& record : records) {
+            if (isOutput(record.type)) outputs.push_back(record);
+        }
+        return outputs;
+    }
+};
+
+// Settings a capture does not carry; the defaults are the firmware's
+struct Options {
+    DeploymentManager::Tuning tuning;
+    WindlassCore::SlackControl slack_control = WindlassCore::SlackControl::HYSTERESIS;
+    unsigned long settle_ms = SETTLE_MS;
+};
+
+struct Result {
+    std::vector<Record> outputs;
+    size_t inputs = 0;             // Records fed to the logic
+    size_t unknown_inputs = 0;     // Signal K paths no listener is on
+    double virtual_s = 0.0;
+    double wall_s = 0.0;
+
+    double speedup() const { return wall_s > 0.0 ? virtual_s / wall_s : 0.0; }
+};
+
+/**
+ * Outputs of the capture against those of the replay, in order: the same
+ * kind, unit and value, no more than tolerance_ms apart. Stops at the first
+ * difference - after a different decision the inputs of the capture no
+ * longer belong to what the replayed windlass is doing.
+ */
+struct Diff {
+    bool identical = true;
+    size_t matched = 0;
+    size_t expected = 0;
+    size_t actual = 0;
+    long max_skew_ms = 0;
+    std::string first;   // The first difference, empty if identical
+};
+
+inline bool sameOutput(const Record& a, const Record& b) {
+    if (a.type != b.type || a.unit != b.unit) return false;
+    switch (a.type) {
+        case Type::RELAY:
+        case Type::NVS:   return strcmp(a.text, b.text) == 0;
+        case Type::STAGE: return a.ints[0] == b.ints[0] && a.ints[1] == b.ints[1];
+        default:          return false;
+    }
+}
+
+inline Diff compare(const std::vector<Record>& expected, const std::vector<Record>& actual,
+                    unsigned long tolerance_ms = TOLERANCE_MS) {
+    Diff diff;
+    diff.expected = expected.size();
+    diff.actual = actual.size();
+    size_t n = std::min(expected.size(), actual.size());
+    for (size_t i = 0; i < n; i++) {
+        long skew = (long)actual[i].ms - (long)expected[i].ms;
+        if (!sameOutput(expected[i], actual[i]) || (unsigned long)labs(skew) > tolerance_ms) {
+            diff.identical = false;
+            diff.first = "output " + std::to_string(i) + ": expected " + describe(expected[i]) +
+                         ", replay " + describe(actual[i]);
+            return diff;
+        }
+        diff.max_skew_ms = std::max(diff.max_skew_ms, labs(skew));
+        diff.matched++;
+    }
+    if (expected.size() != actual.size()) {
+        diff.identical = false;
+        diff.first = expected.size() > actual.size()
+                         ? "missing from replay: " + describe(expected[n])
+                         : "not in capture: " + describe(actual[n]);
+    }
+    return diff;
+}
+
+/**
+ * Builds ChainPosition, ChainController (windlass task on the PCNT source)
+ * and DeploymentManager from the begin/speeds records, as setup() does, and
+ * drives them from the capture on the virtual clock, one millisecond per
+ * step and in the device's order: sense lines and pulses before the
+ * windlass task tick of their millisecond (the task read them there),
+ * Signal K values and commands after it, on the event loop. The commands
+ * go through a CommandDispatcher with the handlers of WindlassUnit that
+ * reach the controller logic; the journal, PUT acknowledgements and move
+ * timeouts of the unit are not part of the replay.
+ *
+ * The inputs are played open loop: pulses arrive when they did on the
+ * boat, whatever the replayed relays do. Up to the first different
+ * decision that is exactly what the logic saw.
+ *
+ * Only one replay may run at a time (the host state is global).
+ */
+inline Result run(const Capture& capture, const Options& options = Options()) {
+    Result result;
+    const Record* begin = capture.find(Type::BEGIN);
+    const Record* speeds = capture.find(Type::SPEEDS);
+    if (begin == nullptr || speeds == nullptr) return result;
+
+    native::reset();
+    native::log_level = native::LOG_ERROR;
+    native::setMillis(begin->ms);
+    native::pins[UP_SENSE_GPIO] = HIGH;
+    native::pins[DOWN_SENSE_GPIO] = HIGH;
+    {
+        Preferences prefs;
+        prefs.begin("speeds");
+        prefs.putFloat("upSpeed", speeds->values[0]);
+        prefs.putFloat("downSpeed", speeds->values[1]);
+        prefs.putFloat("upCoast", speeds->values[2]);
+        prefs.putFloat("downCoast", speeds->values[3]);
+        prefs.end();
+    }
+
+    // Limits are traced in pulses; half a pulse either side of the floor/ceil
+    // they were rounded with gives the same counts back
+    const float mpp = begin->values[0];
+    const float min_m = (begin->ints[1] + 0.5f) * mpp;
+    const float max_m = (begin->ints[2] + 0.5f) * mpp;
+    const float stop_m = (begin->ints[3] - 0.5f) * mpp;
+
+    ChainTrace::global().setRecorder([&result](const Record& record) {
+        if (isOutput(record.type) && record.unit == 0) result.outputs.push_back(record);
+    });
+
+    auto* position = new ChainPosition(mpp, max_m, begin->ints[0]);
+    auto* controller = new ChainController(min_m, max_m, stop_m, position, DOWN_RELAY_PIN, UP_RELAY_PIN);
+    controller->loadSpeedsFromPrefs();
+    controller->setRelayDeadTime((unsigned long)begin->values[1]);
+    controller->setSlackControl(options.slack_control);
+    auto* counter = new PulseCounter(PULSE_GPIO, UP_SENSE_GPIO, 10);
+    counter->begin();
+    controller->begin(counter, UP_SENSE_GPIO, DOWN_SENSE_GPIO);
+    controller->enableCounting();   // The trace only has the pulses that were counted
+    auto* deployment = new DeploymentManager(controller);
+    deployment->setTuning(options.tuning);
+    auto* dispatcher = new CommandDispatcher([controller, deployment]() {
+        if (controller->isActive()) controller->stop();
+        deployment->stop();
+    });
+    dispatcher->registerCommand("testNotification", CommandDispatcher::ArgType::ANY_SUFFIX,
+                                [](float, bool) {}, false);
+    dispatcher->registerCommand("drop", CommandDispatcher::ArgType::NONE, [controller](float, bool) {
+        controller->lowerAnchor(controller->getDepthListener()->get() + 4.0);
+    });
+    dispatcher->registerCommand("raise", CommandDispatcher::ArgType::FLOAT, [controller](float amount, bool) {
+        controller->raiseAnchor(amount);
+    });
+    dispatcher->registerCommand("lower", CommandDispatcher::ArgType::FLOAT, [controller](float amount, bool) {
+        controller->lowerAnchor(amount);
+    });
+    dispatcher->registerCommand("autoDrop", CommandDispatcher::ArgType::OPTIONAL_FLOAT,
+                                [deployment](float ratio, bool has_ratio) {
+        deployment->start(has_ratio && ratio > 0 ? ratio : DeploymentManager::DEFAULT_SCOPE_RATIO);
+    });
+    dispatcher->registerCommand("plan", CommandDispatcher::ArgType::OPTIONAL_FLOAT,
+                                [deployment](float ratio, bool has_ratio) {
+        deployment->preview(has_ratio && ratio > 0 ? ratio : DeploymentManager::DEFAULT_SCOPE_RATIO);
+    }, false);
+    dispatcher->registerCommand("autoRetrieve", CommandDispatcher::ArgType::NONE, [controller](float, bool) {
+        float amount = controller->getChainLength() - AUTO_RETRIEVE_TO_M;
+        if (amount > 0.1) controller->raiseAnchor(amount);
+    });
+    dispatcher->registerCommand("stop", CommandDispatcher::ArgType::NONE, [](float, bool) {});
+    dispatcher->setUnknownHandler([](float, bool) {});
+
+    sensesp::SKValueListener<float>* listeners[] = {
+        controller->getDepthListener(), controller->getDistanceListener(), controller->getWindSpeedListener(),
+        controller->getTideHeightNowListener(), controller->getTideHeightHighListener()};
+
+    const std::vector<Record>& records = capture.records;
+    const unsigned long end_ms = records.back().ms + options.settle_ms;
+    size_t task_next = 0;
+    size_t loop_next = 0;
+    auto wall_start = std::chrono::steady_clock::now();
+
+    while (millis() < end_ms) {
+        native::now_us += 1000;
+        const unsigned long now = millis();
+
+        for (; task_next < records.size() && records[task_next].ms <= now; task_next++) {
+            const Record& record = records[task_next];
+            if (record.ms < now) continue;   // Before begin
+            if (record.type == Type::SENSE) {
+                native::pins[UP_SENSE_GPIO] = record.ints[0] ? LOW : HIGH;
+                native::pins[DOWN_SENSE_GPIO] = record.ints[1] ? LOW : HIGH;
+                result.inputs++;
+            } else if (record.type == Type::PULSES) {
+                for (int32_t i = 0; i < abs(record.ints[0]); i++) native::pcntCount(PULSE_GPIO);
+                result.inputs++;
+            }
+        }
+        native::runTasks();
+
+        for (; loop_next < records.size() && records[loop_next].ms <= now; loop_next++) {
+            const Record& record = records[loop_next];
+            if (record.ms < now) continue;
+            if (record.type == Type::VALUE) {
+                sensesp::SKValueListener<float>* listener = nullptr;
+                for (auto* candidate : listeners) {
+                    if (candidate->get_sk_path() == record.text) listener = candidate;
+                }
+                if (listener != nullptr) {
+                    listener->emit(record.values[0]);
+                    result.inputs++;
+                } else {
+                    result.unknown_inputs++;
+                }
+            } else if (record.type == Type::COMMAND) {
+                dispatcher->dispatch(String(record.text));
+                result.inputs++;
+            }
+        }
+        // The capture does not carry the slack timer's phase; SimRig runs it
+        // on whole periods, and the fixed pause thresholds act on the very
+        // sample that crosses them
+        if (now % SLACK_PERIOD_MS == 0) controller->calculateAndPublishHorizontalSlack();
+        sensesp::event_loop()->tick();
+    }
+
+    result.wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+    result.virtual_s = (end_ms - begin->ms) / 1000.0;
+    ChainTrace::global().setRecorder(nullptr);
+    return result;
+}
+
+}  // namespace replay
+
+#endif  // REPLAY_H
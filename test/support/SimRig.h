@@ -0,0 +1,230 @@
+// SimRig.h - the firmware's controller objects wired to BoatSimulator on the host
+#ifndef SIMRIG_H
+#define SIMRIG_H
+
+#include <chrono>
+#include <Preferences.h>
+
+#include "native_host.h"
+#include "BoatSimulator.h"
+#include "ChainController.h"
+#include "ChainPosition.h"
+#include "DeploymentManager.h"
+#include "PulseCounter.h"
+
+namespace sim {
+
+// Pin map of the default build (see main.cpp)
+constexpr int DOWN_RELAY_PIN = 19;
+constexpr int UP_RELAY_PIN = 16;
+constexpr int UP_SENSE_GPIO = 23;      // di1, ACTIVE-LOW
+constexpr int DOWN_SENSE_GPIO = 25;    // di2, ACTIVE-LOW
+constexpr int PULSE_GPIO = 27;         // di3, gypsy hall sensor
+
+constexpr float MAX_CHAIN_M = 80.0;
+constexpr float MIN_CHAIN_M = 2.0;             // main.cpp min_length, also the autoRetrieve target
+constexpr float STOP_BEFORE_MAX_M = MAX_CHAIN_M - 5.0;
+
+constexpr unsigned long SENSOR_PERIOD_MS = 1000;   // Depth, distance and wind deltas
+constexpr unsigned long SLACK_PERIOD_MS = ChainController::SLACK_UPDATE_MS;   // RepeatSensor in main.cpp
+constexpr unsigned long SETTLE_MS = 3000;          // After a run: last stop, coast, final sync
+// Skipper motoring up the rode: PD on the distance to where the rode hangs vertical
+constexpr float HELM_GAIN_N_PER_M = 400.0;
+constexpr float HELM_DAMPING_N_PER_MPS = 3000.0;
+constexpr float HELM_MAX_EXTRA_N = 2000.0;         // Thrust available beyond holding against the wind
+constexpr float HELM_TARGET_FRACTION = 0.85;       // Aim inside that point, so chain piles up ahead
+
+inline double wallSeconds(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+struct RunResult {
+    bool completed = false;
+    double virtual_s = 0.0;
+    double wall_s = 0.0;
+    float rode_m = 0.0;              // Counted by the firmware
+    float true_rode_m = 0.0;         // From the simulator
+    float distance_m = 0.0;
+    float dragged_m = 0.0;
+    float peak_tension_n = 0.0;
+    unsigned relay_starts = 0;       // Relay coil energizations (wear, pause/resume cycling)
+
+    double speedup() const { return wall_s > 0.0 ? virtual_s / wall_s : 0.0; }
+};
+
+/**
+ * One boat: ChainPosition, ChainController (with its windlass task on the
+ * PCNT source) and DeploymentManager, exactly as setup() wires them, driven
+ * by a BoatSimulator on the virtual clock. Each millisecond the simulator
+ * reads the relay outputs, drives the sense lines and produces hall edges
+ * through the PCNT shim; every SENSOR_PERIOD_MS it emits depth, distance
+ * and wind on the same listeners the Signal K deltas would.
+ *
+ * Only one SimRig may exist at a time (the host state is global).
+ */
+class SimRig {
+public:
+    explicit SimRig(const BoatSimulator::Config& config,
+                    native::LogLevel log_level = native::LOG_ERROR)
+      : boat_(config) {
+        native::reset();
+        native::log_level = log_level;
+        native::pins[UP_SENSE_GPIO] = HIGH;
+        native::pins[DOWN_SENSE_GPIO] = HIGH;
+        // A windlass that has run before: cruise speeds learned, so the
+        // movement timeouts are the ones a boat in service would see
+        Preferences prefs;
+        prefs.begin("speeds");
+        prefs.putFloat("upSpeed", 1000.0 / config.up_speed_mps);
+        prefs.putFloat("downSpeed", 1000.0 / config.down_speed_mps);
+        prefs.end();
+
+        const float circumference = config.gypsy_circumference_m;
+        position_ = new ChainPosition(circumference, MAX_CHAIN_M,
+                                      (int32_t)floorf(boat_.rode() / circumference));
+        controller_ = new ChainController(MIN_CHAIN_M, MAX_CHAIN_M, STOP_BEFORE_MAX_M,
+                                          position_, DOWN_RELAY_PIN, UP_RELAY_PIN);
+        controller_->loadSpeedsFromPrefs();
+
+        counter_ = new PulseCounter(PULSE_GPIO, UP_SENSE_GPIO, 10);
+        counter_->begin();
+        controller_->begin(counter_, UP_SENSE_GPIO, DOWN_SENSE_GPIO);
+        controller_->enableCounting();
+        deployment_ = new DeploymentManager(controller_);
+        deployment_->setCompletionCallback([this]() { deployment_done_ = true; });
+
+        // First sensor deltas, so autoDrop sees a valid depth
+        advance(SENSOR_PERIOD_MS);
+    }
+
+    void advance(unsigned long ms) {
+        native::advanceMillis(ms, [this]() { step(); });
+    }
+
+    // Mirrors the "autoDrop" command handler
+    RunResult autoDrop(float scope_ratio, unsigned long max_ms) {
+        RunResult result;
+        begin(result);
+        deployment_done_ = false;
+        deployment_->start(scope_ratio);
+        while (!deployment_done_ && millis() - start_ms_ < max_ms) {
+            advance(100);
+        }
+        result.completed = deployment_done_;
+        if (!result.completed) deployment_->stop();
+        finish(result);
+        return result;
+    }
+
+    // Mirrors the "autoRetrieve" command handler: one raise to min_length,
+    // slack pause/resume handled by the windlass task. With motor_up the
+    // skipper motors gently up the rode, which is what creates the slack the
+    // windlass waits for; without it only gusts do.
+    RunResult autoRetrieve(unsigned long max_ms, bool motor_up = true) {
+        RunResult result;
+        begin(result);
+        helm_ = motor_up;
+        float amount = controller_->getChainLength() - MIN_CHAIN_M;
+        if (amount > 0.1) {
+            controller_->raiseAnchor(amount);
+            do {
+                advance(100);
+            } while (controller_->isActive() && millis() - start_ms_ < max_ms);
+        }
+        result.completed = !controller_->isActive() &&
+                           controller_->getChainLength() <= MIN_CHAIN_M + boat_.config().gypsy_circumference_m;
+        if (controller_->isActive()) controller_->stop();
+        helm_ = false;
+        boat_.setEngineThrust(0.0);
+        finish(result);
+        return result;
+    }
+
+    // Offline: depth, distance and wind deltas stop arriving (instrument bus down)
+    void setSensorsOnline(bool online) { sensors_online_ = online; }
+
+    BoatSimulator& boat() { return boat_; }
+    ChainController* controller() { return controller_; }
+    ChainPosition* position() { return position_; }
+    DeploymentManager* deployment() { return deployment_; }
+
+private:
+    void step() {
+        bool down = native::pins[DOWN_RELAY_PIN] == HIGH;
+        bool up = native::pins[UP_RELAY_PIN] == HIGH;
+        if (down && !was_down_) relay_starts_++;
+        if (up && !was_up_) relay_starts_++;
+        was_down_ = down;
+        was_up_ = up;
+
+        if (helm_) steer();
+        int32_t edges = boat_.step(1, down, up);
+        // ACTIVE-LOW sense lines follow the contacts; PCNT reads the UP line at each edge
+        native::pins[DOWN_SENSE_GPIO] = boat_.downContact() ? LOW : HIGH;
+        native::pins[UP_SENSE_GPIO] = boat_.upContact() ? LOW : HIGH;
+        for (int32_t i = 0; i < abs(edges); i++) {
+            native::pcntCount(PULSE_GPIO);
+        }
+
+        unsigned long now = millis();
+        if (sensors_online_ && now % SENSOR_PERIOD_MS == 0) {
+            controller_->getDepthListener()->emit(boat_.sampleDepth());
+            controller_->getDistanceListener()->emit(boat_.sampleDistance());
+            controller_->getWindSpeedListener()->emit(boat_.sampleWindSpeed());
+        }
+        if (now % SLACK_PERIOD_MS == 0) {
+            controller_->calculateAndPublishHorizontalSlack();
+        }
+    }
+
+    // Hold against the wind and close in on the point where the rode would
+    // hang vertical, so the windlass is mostly lifting chain, not hauling the boat
+    void steer() {
+        const BoatSimulator::Config& config = boat_.config();
+        float hanging = fmaxf(0.0f, boat_.rode() - config.depth_m - config.bow_height_m);
+        float target = HELM_TARGET_FRACTION * hanging;
+        float extra = HELM_GAIN_N_PER_M * (boat_.distance() - target) +
+                      HELM_DAMPING_N_PER_MPS * boat_.boatSpeed();
+        extra = constrain(extra, -boat_.windForce(), HELM_MAX_EXTRA_N);
+        boat_.setEngineThrust(boat_.windForce() + extra);
+    }
+
+    void begin(RunResult&) {
+        start_ms_ = millis();
+        start_relay_starts_ = relay_starts_;
+        boat_.clearPeakBowTension();
+        wall_start_ = std::chrono::steady_clock::now();
+    }
+
+    void finish(RunResult& result) {
+        advance(SETTLE_MS);
+        result.wall_s = wallSeconds(wall_start_);
+        result.virtual_s = (millis() - start_ms_) / 1000.0;
+        result.rode_m = controller_->getChainLength();
+        result.true_rode_m = boat_.rode();
+        result.distance_m = boat_.distance();
+        result.dragged_m = boat_.dragged();
+        result.peak_tension_n = boat_.peakBowTension();
+        result.relay_starts = relay_starts_ - start_relay_starts_;
+    }
+
+    BoatSimulator boat_;
+    ChainPosition* position_;
+    ChainController* controller_;
+    PulseCounter* counter_;
+    DeploymentManager* deployment_;
+
+    bool deployment_done_ = false;
+    bool helm_ = false;
+    bool sensors_online_ = true;
+    bool was_down_ = false;
+    bool was_up_ = false;
+    unsigned relay_starts_ = 0;
+    unsigned start_relay_starts_ = 0;
+    unsigned long start_ms_ = 0;
+    std::chrono::steady_clock::time_point wall_start_;
+};
+
+}  // namespace sim
+
+#endif  // SIMRIG_H
@@ -0,0 +1,71 @@
+// Anchor watch windlass task: pio test -e native -f test_anchor_watch
+//
+// In anchor watch the idle windlass task polls every WATCH_TICK_MS. A move
+// commanded from there must run exactly as from the normal 1 ms tick: the
+// first command and the first pulse bring the task back to full rate.
+
+#include <unity.h>
+
+#include "SimRig.h"
+
+namespace {
+
+constexpr float LOWER_M = 10.0;
+constexpr unsigned long MAX_MOVE_MS = 60000;
+
+constexpr unsigned long IDLE_MS = 5000;
+
+struct Move {
+    unsigned long idle_ticks;   // Windlass task iterations while idle
+    bool stopped;
+    float rode_m;
+    float true_rode_m;
+};
+
+Move lowerFromIdle(bool watch) {
+    BoatSimulator::Config config;
+    config.depth_m = 8.0;
+    sim::SimRig rig(config);
+    ChainController* controller = rig.controller();
+    controller->setAnchorWatch(watch);
+    // The windlass task is the only one SimRig starts
+    unsigned long runs = native::tasks[0].runs;
+    rig.advance(IDLE_MS);
+    unsigned long idle_ticks = native::tasks[0].runs - runs;
+
+    float start = controller->getChainLength();
+    controller->lowerAnchor(LOWER_M);
+    unsigned long start_ms = millis();
+    do {
+        rig.advance(100);
+    } while (controller->isActive() && millis() - start_ms < MAX_MOVE_MS);
+    bool stopped = !controller->isActive();
+    rig.advance(sim::SETTLE_MS);
+    return {idle_ticks, stopped, controller->getChainLength() - start, rig.boat().rode()};
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_move_from_anchor_watch_matches_active() {
+    Move active = lowerFromIdle(false);
+    Move watch = lowerFromIdle(true);
+    const float pulse_m = BoatSimulator::Config{}.gypsy_circumference_m;
+    printf("lower %.0f m: active %.2f m (true %.2f), anchor watch %.2f m (true %.2f)\n",
+           LOWER_M, active.rode_m, active.true_rode_m, watch.rode_m, watch.true_rode_m);
+    TEST_ASSERT_UINT32_WITHIN(1, IDLE_MS / WindlassCore::TICK_MS, active.idle_ticks);
+    TEST_ASSERT_UINT32_WITHIN(1, IDLE_MS / WindlassCore::WATCH_TICK_MS, watch.idle_ticks);
+    TEST_ASSERT_TRUE(active.stopped);
+    TEST_ASSERT_TRUE(watch.stopped);
+    TEST_ASSERT_FLOAT_WITHIN(pulse_m, LOWER_M, watch.rode_m);
+    TEST_ASSERT_FLOAT_WITHIN(pulse_m, active.rode_m, watch.rode_m);
+    TEST_ASSERT_FLOAT_WITHIN(pulse_m, active.true_rode_m, watch.true_rode_m);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_move_from_anchor_watch_matches_active);
+    return UNITY_END();
+}
@@ -0,0 +1,273 @@
+// Host benchmarks for the controller logic: pio test -e native -f test_benchmarks -v
+//
+// Times the slack and catenary math the event loop runs at 10 Hz (moving and
+// at anchor, where the cached result is reused) and a full
+// autoDrop against the boat simulator on the virtual clock. The assertions
+// are loose ceilings meant to catch order-of-magnitude regressions (a table
+// rebuilt per call, a poll loop that spins) on any CI machine; the printed
+// figures are the numbers to compare between commits.
+//
+// The slack control benchmark retrieves over the simulator matrix with both
+// raise pause/resume policies and compares virtual time and relay starts.
+// The settle benchmark drops over the same matrix with fixed dig-in holds
+// and with holds that end once the drift has settled, and compares
+// time-to-set (per stage) and anchor drag.
+
+#include <unity.h>
+
+#include "SimRig.h"
+
+namespace {
+
+// Ceilings - roughly 20x what an unoptimized test build measures on a laptop
+constexpr double MAX_SLACK_NS_PER_CALL = 5000.0;
+constexpr double MAX_IDLE_SLACK_NS_PER_CALL = 500.0;
+constexpr double MAX_TARGET_NS_PER_CALL = 1000.0;
+constexpr double MAX_AUTODROP_WALL_S = 10.0;
+
+constexpr float SCOPES[] = {3.0, 5.0, 7.0};
+constexpr float DEPTHS_M[] = {5.0, 10.0, 15.0};
+constexpr float WINDS_MPS[] = {3.0, 8.0, 14.0};
+// A drop may set a few seconds later with the GPS noise of that run
+constexpr double CELL_TIME_MARGIN_S = 5.0;
+
+// Settled holds must save time over the matrix without dragging the anchor
+// much further. Drag in a gusty cell moves by ~0.5 m between runs with the
+// GPS noise alone, and a shorter hold leaves the anchor a little less set.
+constexpr double MIN_SETTLE_SAVING = 0.15;   // Of the fixed-hold time-to-set
+constexpr float SETTLE_DRAG_MARGIN_M = 1.0;  // Per cell
+// As in test_simulator: below this the drop may wait for the skipper
+constexpr float LIGHT_AIR_MPS = 5.0;
+
+struct DropTimes {
+    sim::RunResult result;
+    unsigned long digin40_ms = 0;
+    unsigned long digin80_ms = 0;
+};
+
+DropTimes drop(float scope, float depth, float wind, bool settle_early) {
+    BoatSimulator::Config config;
+    config.depth_m = depth;
+    config.wind_mps = wind;
+    sim::SimRig rig(config);
+    DeploymentManager::Tuning tuning;
+    tuning.settleEarly = settle_early;
+    rig.deployment()->setTuning(tuning);
+    DropTimes times;
+    times.result = rig.autoDrop(scope, 30UL * 60 * 1000);
+    times.digin40_ms = rig.deployment()->stageDurationMs(AutoStage::DIGIN_40);
+    times.digin80_ms = rig.deployment()->stageDurationMs(AutoStage::DIGIN_80);
+    return times;
+}
+
+sim::RunResult dropAndRetrieve(float scope, float depth, float wind, WindlassCore::SlackControl control) {
+    BoatSimulator::Config config;
+    config.depth_m = depth;
+    config.wind_mps = wind;
+    sim::SimRig rig(config);
+    // Fixed dig-in holds, so the retrieve starts from the same boat as before
+    // the settle planner and the policies are compared on their own
+    DeploymentManager::Tuning tuning;
+    tuning.settleEarly = false;
+    rig.deployment()->setTuning(tuning);
+    rig.autoDrop(scope, 30UL * 60 * 1000);
+    rig.controller()->setSlackControl(control);
+    return rig.autoRetrieve(20UL * 60 * 1000);
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_benchmark_horizontal_slack() {
+    sim::SimRig rig(BoatSimulator::Config{});
+    ChainController* controller = rig.controller();
+    controller->getDepthListener()->emit(12.0);
+
+    const int ITERATIONS = 200000;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+        // Sweep rode and distance so the observable changes and the table is walked
+        rig.position()->setPulses(40 + (i % 240));
+        controller->getDistanceListener()->emit(5.0f + (i % 97) * 0.5f);
+        controller->calculateAndPublishHorizontalSlack();
+    }
+    double ns_per_call = sim::wallSeconds(start) * 1e9 / ITERATIONS;
+
+    printf("calculateAndPublishHorizontalSlack: %.0f ns/call (%d calls, incl. listener + position emit)\n",
+           ns_per_call, ITERATIONS);
+    TEST_ASSERT_LESS_THAN_DOUBLE(MAX_SLACK_NS_PER_CALL, ns_per_call);
+}
+
+// At anchor: the same depth, distance and wind deltas keep arriving, nothing
+// moves past its tolerance and the catenary math is skipped
+void test_benchmark_idle_slack() {
+    sim::SimRig rig(BoatSimulator::Config{});
+    ChainController* controller = rig.controller();
+    rig.position()->setPulses(150);
+    controller->getDepthListener()->emit(12.0);
+    controller->getDistanceListener()->emit(30.0);
+    controller->calculateAndPublishHorizontalSlack();
+    unsigned long recomputes = controller->slackRecomputeCount();
+
+    const int ITERATIONS = 200000;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+        if (i % 10 == 0) {   // 1 Hz deltas against the 10 Hz slack timer, GPS jitter inside tolerance
+            controller->getDepthListener()->emit(12.0);
+            controller->getDistanceListener()->emit(30.0f + (i % 3) * 0.005f);
+            controller->getWindSpeedListener()->emit(6.0);
+        }
+        controller->calculateAndPublishHorizontalSlack();
+    }
+    double ns_per_call = sim::wallSeconds(start) * 1e9 / ITERATIONS;
+
+    printf("calculateAndPublishHorizontalSlack at anchor: %.0f ns/call, %lu recomputes in %d calls\n",
+           ns_per_call, controller->slackRecomputeCount() - recomputes, ITERATIONS);
+    // One for the first wind sample (force moved past its tolerance), then none
+    TEST_ASSERT_EQUAL_UINT32(recomputes + 1, controller->slackRecomputeCount());
+    TEST_ASSERT_LESS_THAN_DOUBLE(MAX_IDLE_SLACK_NS_PER_CALL, ns_per_call);
+
+    // One pulse is a change
+    float slack = controller->getHorizontalSlackObservable()->get();
+    rig.position()->setPulses(151);
+    controller->calculateAndPublishHorizontalSlack();
+    TEST_ASSERT_EQUAL_UINT32(recomputes + 2, controller->slackRecomputeCount());
+    TEST_ASSERT_TRUE(controller->getHorizontalSlackObservable()->get() > slack);
+}
+
+void test_benchmark_target_horizontal_distance() {
+    sim::SimRig rig(BoatSimulator::Config{});
+
+    const int ITERATIONS = 500000;
+    volatile float sink = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+        float depth = 5.0f + (i % 41);           // 5..45 m incl. bow
+        float chain = depth + 1.0f + (i % 75);   // Always past vertical
+        sink = sink + rig.controller()->computeTargetHorizontalDistance(chain, depth);
+    }
+    double ns_per_call = sim::wallSeconds(start) * 1e9 / ITERATIONS;
+
+    printf("computeTargetHorizontalDistance: %.0f ns/call (%d calls)\n", ns_per_call, ITERATIONS);
+    TEST_ASSERT_LESS_THAN_DOUBLE(MAX_TARGET_NS_PER_CALL, ns_per_call);
+    TEST_ASSERT_TRUE(sink > 0.0f);
+}
+
+void test_benchmark_autodrop() {
+    const float SCOPE = 5.0;
+    const unsigned long MAX_VIRTUAL_MS = 30UL * 60 * 1000;
+
+    BoatSimulator::Config config;
+    config.depth_m = 10.0;
+    config.wind_mps = 8.0;
+    sim::SimRig rig(config);
+    // Depth and distance must be known before autoDrop is accepted
+    TEST_ASSERT_TRUE(rig.deployment()->isAutoAnchorValid());
+
+    sim::RunResult result = rig.autoDrop(SCOPE, MAX_VIRTUAL_MS);
+
+    float expected = SCOPE * (config.depth_m + ChainController::BOW_HEIGHT_M);
+    printf("autoDrop %.0f m @ %.0f:1: %.1f s virtual in %.3f s wall (%.0fx real time), rode %.2f m, distance %.1f m\n",
+           config.depth_m, SCOPE, result.virtual_s, result.wall_s, result.speedup(), result.rode_m, result.distance_m);
+
+    TEST_ASSERT_TRUE_MESSAGE(result.completed, "autoDrop did not complete");
+    TEST_ASSERT_FALSE(rig.controller()->isActive());
+    TEST_ASSERT_FLOAT_WITHIN(1.0, expected, result.rode_m);
+    // The counted position must follow the gypsy, whole pulses only
+    TEST_ASSERT_FLOAT_WITHIN(config.gypsy_circumference_m, result.true_rode_m, result.rode_m);
+    TEST_ASSERT_LESS_THAN_DOUBLE(MAX_AUTODROP_WALL_S, result.wall_s);
+}
+
+// Adaptive may only be the default once it saves time and relay starts in
+// every cell, not just over the matrix
+void test_benchmark_slack_control() {
+    double fixed_s = 0.0, adaptive_s = 0.0;
+    unsigned fixed_relays = 0, adaptive_relays = 0;
+    unsigned cells = 0, better_cells = 0;
+    printf("%5s %5s %5s | %8s %5s | %8s %5s\n", "scope", "depth", "wind", "fixed_s", "relay", "adapt_s", "relay");
+    for (float scope : SCOPES) {
+        for (float depth : DEPTHS_M) {
+            for (float wind : WINDS_MPS) {
+                char label[64];
+                snprintf(label, sizeof(label), "scope %.0f depth %.0f wind %.0f", scope, depth, wind);
+                sim::RunResult fixed = dropAndRetrieve(scope, depth, wind, WindlassCore::SlackControl::HYSTERESIS);
+                sim::RunResult adaptive = dropAndRetrieve(scope, depth, wind, WindlassCore::SlackControl::ADAPTIVE);
+                bool better = adaptive.virtual_s <= fixed.virtual_s && adaptive.relay_starts <= fixed.relay_starts;
+                printf("%5.0f %5.0f %5.0f | %8.0f %5u | %8.0f %5u%s\n", scope, depth, wind,
+                       fixed.virtual_s, fixed.relay_starts, adaptive.virtual_s, adaptive.relay_starts,
+                       better ? "" : "  *");
+
+                TEST_ASSERT_TRUE_MESSAGE(fixed.completed, label);
+                TEST_ASSERT_TRUE_MESSAGE(adaptive.completed, label);
+                cells++;
+                better_cells += better ? 1 : 0;
+                fixed_s += fixed.virtual_s;
+                adaptive_s += adaptive.virtual_s;
+                fixed_relays += fixed.relay_starts;
+                adaptive_relays += adaptive.relay_starts;
+            }
+        }
+    }
+    printf("retrieve total: fixed %.0f s, %u relay starts | adaptive %.0f s, %u relay starts\n",
+           fixed_s, fixed_relays, adaptive_s, adaptive_relays);
+    printf("adaptive saves time and starts in %u of %u cells (* = not)\n", better_cells, cells);
+
+    sim::SimRig rig(BoatSimulator::Config{});
+    if (better_cells < cells) {
+        TEST_ASSERT_TRUE_MESSAGE(rig.controller()->getSlackControl() == WindlassCore::SlackControl::HYSTERESIS,
+                                 "adaptive slack control is the default but does not win every cell");
+    }
+}
+
+void test_benchmark_settle_early() {
+    double fixed_s = 0.0, settled_s = 0.0;
+    printf("%5s %5s %5s | %8s %6s %6s %6s | %8s %6s %6s %6s\n", "scope", "depth", "wind",
+           "fixed_s", "dig40", "dig80", "drag", "settle_s", "dig40", "dig80", "drag");
+    for (float scope : SCOPES) {
+        for (float depth : DEPTHS_M) {
+            for (float wind : WINDS_MPS) {
+                char label[64];
+                snprintf(label, sizeof(label), "scope %.0f depth %.0f wind %.0f", scope, depth, wind);
+                DropTimes fixed = drop(scope, depth, wind, false);
+                DropTimes settled = drop(scope, depth, wind, true);
+                printf("%5.0f %5.0f %5.0f | %8.0f %6.0f %6.0f %6.2f | %8.0f %6.0f %6.0f %6.2f\n", scope, depth, wind,
+                       fixed.result.virtual_s, fixed.digin40_ms / 1000.0, fixed.digin80_ms / 1000.0,
+                       fixed.result.dragged_m, settled.result.virtual_s, settled.digin40_ms / 1000.0,
+                       settled.digin80_ms / 1000.0, settled.result.dragged_m);
+
+                TEST_ASSERT_TRUE_MESSAGE(settled.result.dragged_m <= fixed.result.dragged_m + SETTLE_DRAG_MARGIN_M,
+                                         label);
+                // Capped drops sit at the limit until the run ends, and in
+                // light air the drop may wait for the skipper either way;
+                // only drops that set with fixed holds have a time-to-set
+                bool capped = scope * (depth + ChainController::BOW_HEIGHT_M) > sim::STOP_BEFORE_MAX_M;
+                if (capped || (!fixed.result.completed && wind < LIGHT_AIR_MPS)) {
+                    continue;
+                }
+                TEST_ASSERT_TRUE_MESSAGE(fixed.result.completed, label);
+                TEST_ASSERT_TRUE_MESSAGE(settled.result.completed, label);
+                // The fixed holds are upper bounds, so no drop may set later
+                TEST_ASSERT_TRUE_MESSAGE(settled.result.virtual_s <= fixed.result.virtual_s + CELL_TIME_MARGIN_S,
+                                         label);
+                fixed_s += fixed.result.virtual_s;
+                settled_s += settled.result.virtual_s;
+            }
+        }
+    }
+    printf("time to set total: fixed holds %.0f s, settled holds %.0f s (%.0f%% less)\n", fixed_s, settled_s,
+           100.0 * (fixed_s - settled_s) / fixed_s);
+    TEST_ASSERT_LESS_THAN_DOUBLE((1.0 - MIN_SETTLE_SAVING) * fixed_s, settled_s);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_benchmark_horizontal_slack);
+    RUN_TEST(test_benchmark_idle_slack);
+    RUN_TEST(test_benchmark_target_horizontal_distance);
+    RUN_TEST(test_benchmark_autodrop);
+    RUN_TEST(test_benchmark_slack_control);
+    RUN_TEST(test_benchmark_settle_early);
+    return UNITY_END();
+}
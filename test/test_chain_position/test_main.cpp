@@ -0,0 +1,86 @@
+// Pulse-count chain position: pio test -e native -f test_chain_position
+
+#include <unity.h>
+
+#include "native_host.h"
+#include "ChainPosition.h"
+
+namespace {
+
+constexpr float GYPSY_M = 0.25;    // Exact in binary
+constexpr float ODD_GYPSY_M = 0.1; // Not: 3.0 / 0.1 is not exactly 30 in float
+constexpr float MAX_M = 100.0;
+
+// meters that are `pulses` gypsy turns off by `offset` of one pulse
+float at(float meters_per_pulse, int pulses, double offset) {
+    return (float)((pulses + offset) * meters_per_pulse);
+}
+
+}  // namespace
+
+void setUp() { native::reset(); }
+void tearDown() {}
+
+// Exact multiples convert to that count whichever way they round
+void test_exact_multiples() {
+    ChainPosition position(ODD_GYPSY_M, MAX_M);
+    for (int pulses = 0; pulses <= 1000; pulses++) {
+        float meters = pulses * ODD_GYPSY_M;
+        TEST_ASSERT_EQUAL_INT32(pulses, position.metersToPulsesFloor(meters));
+        TEST_ASSERT_EQUAL_INT32(pulses, position.metersToPulsesCeil(meters));
+        TEST_ASSERT_EQUAL_INT32(pulses, position.metersToPulsesNearest(meters));
+    }
+}
+
+// Within PULSE_EPSILON (1e-4 pulse) of a multiple counts as the multiple;
+// beyond it floor and ceil go their own ways
+void test_epsilon_boundaries() {
+    ChainPosition position(GYPSY_M, MAX_M);
+    TEST_ASSERT_EQUAL_INT32(30, position.metersToPulsesFloor(at(GYPSY_M, 30, -0.00005)));
+    TEST_ASSERT_EQUAL_INT32(30, position.metersToPulsesCeil(at(GYPSY_M, 30, 0.00005)));
+
+    TEST_ASSERT_EQUAL_INT32(29, position.metersToPulsesFloor(at(GYPSY_M, 30, -0.001)));
+    TEST_ASSERT_EQUAL_INT32(30, position.metersToPulsesCeil(at(GYPSY_M, 30, -0.001)));
+    TEST_ASSERT_EQUAL_INT32(30, position.metersToPulsesFloor(at(GYPSY_M, 30, 0.001)));
+    TEST_ASSERT_EQUAL_INT32(31, position.metersToPulsesCeil(at(GYPSY_M, 30, 0.001)));
+
+    TEST_ASSERT_EQUAL_INT32(29, position.metersToPulsesNearest(at(GYPSY_M, 29, 0.49)));
+    TEST_ASSERT_EQUAL_INT32(30, position.metersToPulsesNearest(at(GYPSY_M, 29, 0.5)));
+    TEST_ASSERT_EQUAL_INT32(0, position.metersToPulsesFloor(0.0f));
+    TEST_ASSERT_EQUAL_INT32(0, position.metersToPulsesCeil(0.0f));
+}
+
+// The limit is the last whole pulse inside max_length, and counts clamp to it
+void test_limits_clamp() {
+    ChainPosition position(ODD_GYPSY_M, 10.05f, 500);
+    TEST_ASSERT_EQUAL_INT32(100, position.maxPulses());
+    TEST_ASSERT_EQUAL_INT32(100, position.pulses());
+
+    TEST_ASSERT_EQUAL_INT32(-40, position.addPulses(-40));
+    TEST_ASSERT_EQUAL_INT32(-60, position.addPulses(-75));
+    TEST_ASSERT_EQUAL_INT32(0, position.pulses());
+    TEST_ASSERT_EQUAL_INT32(0, position.addPulses(-1));
+    TEST_ASSERT_EQUAL_INT32(100, position.addPulses(250));
+    TEST_ASSERT_EQUAL_FLOAT(10.0f, position.meters());
+}
+
+// Thousands of up/down cycles end where they started
+void test_cycles_do_not_drift() {
+    ChainPosition position(ODD_GYPSY_M, MAX_M);
+    position.setPulses(123);
+    for (int i = 0; i < 10000; i++) {
+        position.addPulses(37);
+        position.addPulses(-37);
+    }
+    TEST_ASSERT_EQUAL_INT32(123, position.pulses());
+    TEST_ASSERT_EQUAL_FLOAT(position.pulsesToMeters(123), position.meters());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_exact_multiples);
+    RUN_TEST(test_epsilon_boundaries);
+    RUN_TEST(test_limits_clamp);
+    RUN_TEST(test_cycles_do_not_drift);
+    return UNITY_END();
+}
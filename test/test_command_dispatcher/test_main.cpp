@@ -0,0 +1,141 @@
+// navigation.anchor.command dispatch: pio test -e native -f test_command_dispatcher
+
+#include <unity.h>
+
+#include <string>
+#include <vector>
+#include "native_host.h"
+#include "CommandDispatcher.h"
+
+namespace {
+
+// What the dispatcher did, in order: "stop-hook", "lower 10", "stop", ...
+std::vector<std::string> calls;
+
+void record(const char* name, float arg, bool has_arg) {
+    char text[48];
+    if (has_arg) {
+        snprintf(text, sizeof(text), "%s %g", name, arg);
+    } else {
+        snprintf(text, sizeof(text), "%s", name);
+    }
+    calls.push_back(text);
+}
+
+// The commands of WindlassUnit that matter here, recording instead of moving
+CommandDispatcher* makeDispatcher() {
+    auto* dispatcher = new CommandDispatcher([]() { calls.push_back("stop-hook"); });
+    auto handler = [](const char* name) {
+        return [name](float arg, bool has_arg) { record(name, arg, has_arg); };
+    };
+    dispatcher->registerCommand("testNotification", CommandDispatcher::ArgType::ANY_SUFFIX,
+                                handler("testNotification"), false);
+    dispatcher->registerCommand("raise", CommandDispatcher::ArgType::FLOAT, handler("raise"));
+    dispatcher->registerCommand("lower", CommandDispatcher::ArgType::FLOAT, handler("lower"));
+    dispatcher->registerCommand("autoDrop", CommandDispatcher::ArgType::OPTIONAL_FLOAT, handler("autoDrop"));
+    dispatcher->registerCommand("autoRetrieve", CommandDispatcher::ArgType::NONE, handler("autoRetrieve"));
+    dispatcher->registerCommand("stop", CommandDispatcher::ArgType::NONE, handler("stop"));
+    dispatcher->setUnknownHandler(handler("unknown"));
+    return dispatcher;
+}
+
+void assertCalls(const std::vector<std::string>& expected) {
+    TEST_ASSERT_EQUAL_UINT(expected.size(), calls.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        TEST_ASSERT_EQUAL_STRING(expected[i].c_str(), calls[i].c_str());
+    }
+}
+
+}  // namespace
+
+void setUp() {
+    native::reset();
+    native::log_level = native::LOG_ERROR;
+    calls.clear();
+}
+void tearDown() {}
+
+// "stop" right behind a move runs at once, never after the move it stops
+void test_stop_preempts_a_move() {
+    CommandDispatcher* dispatcher = makeDispatcher();
+    dispatcher->dispatch("lower10");
+    dispatcher->dispatch("stop");
+    assertCalls({"stop-hook", "lower 10", "stop-hook", "stop"});
+
+    // Nothing is left over to start the windlass again later
+    native::advanceMillis(1000);
+    TEST_ASSERT_EQUAL_UINT(4, calls.size());
+}
+
+// Unknown commands and bad arguments stop the windlass as "stop" does
+void test_unknown_and_invalid_commands_stop() {
+    CommandDispatcher* dispatcher = makeDispatcher();
+    dispatcher->dispatch("raise20");
+    dispatcher->dispatch("hoist");
+    dispatcher->dispatch("lower");
+    native::advanceMillis(1000);
+    assertCalls({"stop-hook", "raise 20", "stop-hook", "unknown", "stop-hook", "unknown"});
+}
+
+// testNotification does not touch the windlass
+void test_non_stopping_command_leaves_the_move() {
+    CommandDispatcher* dispatcher = makeDispatcher();
+    dispatcher->dispatch("raise5");
+    dispatcher->dispatch("testNotification:drag");
+    assertCalls({"stop-hook", "raise 5", "testNotification"});
+}
+
+// FLOAT needs a number, OPTIONAL_FLOAT takes one if it is there, NONE takes none
+void test_argument_types() {
+    CommandDispatcher* dispatcher = makeDispatcher();
+    const char* cases[][2] = {
+        {"raise10", "raise 10"},
+        {"raise 10", "raise 10"},
+        {"raise   2.5", "raise 2.5"},
+        {"raise -3", "raise -3"},
+        {"raise10x", "unknown"},          // Not a number: stop only
+        {"raise", "unknown"},             // FLOAT without one
+        {"autoDrop", "autoDrop"},
+        {"autoDrop7", "autoDrop 7"},
+        {"autoDrop 5.5", "autoDrop 5.5"},
+        {"autoDropx", "unknown"},
+        {"autoRetrieve", "autoRetrieve"},
+        {"autoRetrieve now", "unknown"},  // NONE is an exact match
+        {"stop", "stop"},
+        {"stop 1", "unknown"},
+    };
+    for (const auto& c : cases) {
+        calls.clear();
+        dispatcher->dispatch(c[0]);
+        TEST_ASSERT_EQUAL_UINT_MESSAGE(2, calls.size(), c[0]);
+        TEST_ASSERT_EQUAL_STRING_MESSAGE("stop-hook", calls[0].c_str(), c[0]);
+        TEST_ASSERT_EQUAL_STRING_MESSAGE(c[1], calls[1].c_str(), c[0]);
+    }
+}
+
+// Names are matched whole and case-sensitively
+void test_unknown_commands() {
+    CommandDispatcher* dispatcher = makeDispatcher();
+    const char* inputs[] = {"", "Stop", "STOP", "rais10", "lowerr5", " raise10", "autoRetrieveX"};
+    for (const char* input : inputs) {
+        calls.clear();
+        dispatcher->dispatch(input);
+        assertCalls({"stop-hook", "unknown"});
+    }
+
+    // A prefix match with ANY_SUFFIX takes everything after the name
+    calls.clear();
+    dispatcher->dispatch("testNotification");
+    dispatcher->dispatch("testNotification: anything at all 12");
+    assertCalls({"testNotification", "testNotification"});
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_stop_preempts_a_move);
+    RUN_TEST(test_unknown_and_invalid_commands_stop);
+    RUN_TEST(test_non_stopping_command_leaves_the_move);
+    RUN_TEST(test_argument_types);
+    RUN_TEST(test_unknown_commands);
+    return UNITY_END();
+}
@@ -0,0 +1,116 @@
+// Consolidated config record: pio test -e native -f test_config_store
+
+#include <unity.h>
+
+#include "native_host.h"
+#include "ConfigStore.h"
+
+namespace {
+
+constexpr const char* NAMESPACE = "cfgtest";
+
+std::vector<uint8_t>& record() { return native::preferences_store[NAMESPACE]["record"]; }
+
+}  // namespace
+
+void setUp() { native::reset(); }
+void tearDown() {}
+
+// First boot after the update: values come from the legacy files once,
+// then from the record, in one read
+void test_migrates_then_reads_the_record() {
+    {
+        ConfigStore store(NAMESPACE);
+        TEST_ASSERT_FALSE(store.begin());
+        TEST_ASSERT_EQUAL_FLOAT(0.3, store.add("/gypsy/circum", 0.25, []() { return 0.3f; }));
+        TEST_ASSERT_EQUAL_FLOAT(80.0, store.add("/chain/max_length", 80.0, []() { return 80.0f; }));
+        TEST_ASSERT_EQUAL_FLOAT(15.0, store.add("/di1/dbounce", 15.0));
+        TEST_ASSERT_EQUAL_UINT(2, store.stats().migrated);
+        TEST_ASSERT_TRUE(store.commit());
+        TEST_ASSERT_EQUAL_UINT(1, store.stats().writes);
+        TEST_ASSERT_EQUAL_UINT(1, store.storedCount());   // Only the circumference is not a default
+    }
+
+    ConfigStore store(NAMESPACE);
+    TEST_ASSERT_TRUE(store.begin());
+    auto no_legacy = []() {
+        TEST_ASSERT_TRUE_MESSAGE(false, "legacy read with a valid record");
+        return 0.0f;
+    };
+    TEST_ASSERT_EQUAL_FLOAT(0.3, store.add("/gypsy/circum", 0.25, no_legacy));
+    TEST_ASSERT_EQUAL_FLOAT(80.0, store.add("/chain/max_length", 80.0, no_legacy));
+    TEST_ASSERT_TRUE(store.commit());
+    TEST_ASSERT_EQUAL_UINT(1, store.stats().reads);
+    TEST_ASSERT_EQUAL_UINT(0, store.stats().writes);   // Nothing changed
+}
+
+void test_writes_only_changes() {
+    ConfigStore store(NAMESPACE);
+    store.add("/sk/heartbeat", 11000.0);
+    store.add("/sk/fast_interval", 250.0);
+    store.commit();
+    unsigned long writes = native::preferences_writes;
+
+    TEST_ASSERT_FALSE(store.set("/sk/heartbeat", 11000.0));
+    TEST_ASSERT_TRUE(store.commit());
+    TEST_ASSERT_EQUAL_UINT32(writes, native::preferences_writes);
+
+    TEST_ASSERT_TRUE(store.set("/sk/heartbeat", 5000.0));
+    TEST_ASSERT_TRUE(store.commit());
+    TEST_ASSERT_EQUAL_UINT32(writes + 1, native::preferences_writes);
+    TEST_ASSERT_EQUAL_UINT(1, store.storedCount());
+    const size_t one_entry = record().size();
+
+    // Back to the default: the entry drops out of the record
+    TEST_ASSERT_TRUE(store.set("/sk/heartbeat", 11000.0));
+    TEST_ASSERT_TRUE(store.commit());
+    TEST_ASSERT_EQUAL_UINT(0, store.storedCount());
+    TEST_ASSERT_TRUE(record().size() < one_entry);
+
+    TEST_ASSERT_FALSE(store.set("/not/registered", 1.0));
+}
+
+// A setting an older or newer firmware knows about survives this one
+void test_unknown_entries_are_kept() {
+    {
+        ConfigStore store(NAMESPACE);
+        store.add("/power/idle_minutes", 5.0, []() { return 10.0f; });
+        store.add("/future/setting", 1.0, []() { return 2.0f; });
+        store.commit();
+    }
+    {
+        ConfigStore store(NAMESPACE);
+        store.add("/power/idle_minutes", 5.0);
+        store.set("/power/idle_minutes", 15.0);
+        store.commit();
+        TEST_ASSERT_EQUAL_UINT(2, store.storedCount());
+    }
+    ConfigStore store(NAMESPACE);
+    TEST_ASSERT_EQUAL_FLOAT(15.0, store.add("/power/idle_minutes", 5.0));
+    TEST_ASSERT_EQUAL_FLOAT(2.0, store.add("/future/setting", 1.0));
+}
+
+void test_bad_record_falls_back_to_legacy() {
+    {
+        ConfigStore store(NAMESPACE);
+        store.add("/di3/gpio", 27.0, []() { return 14.0f; });
+        store.commit();
+    }
+    record()[record().size() - 6] ^= 0xFF;   // Flip a value byte
+
+    ConfigStore store(NAMESPACE);
+    TEST_ASSERT_FALSE(store.begin());
+    TEST_ASSERT_EQUAL_FLOAT(14.0, store.add("/di3/gpio", 27.0, []() { return 14.0f; }));
+    TEST_ASSERT_EQUAL_UINT(1, store.stats().migrated);
+    store.commit();
+    TEST_ASSERT_TRUE(ConfigStore(NAMESPACE).begin());   // Rewritten
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_migrates_then_reads_the_record);
+    RUN_TEST(test_writes_only_changes);
+    RUN_TEST(test_unknown_entries_are_kept);
+    RUN_TEST(test_bad_record_falls_back_to_legacy);
+    return UNITY_END();
+}
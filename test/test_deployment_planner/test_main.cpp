@@ -0,0 +1,147 @@
+// autoDrop plan cache: pio test -e native -f test_deployment_planner
+
+#include <unity.h>
+
+#include "SimRig.h"
+
+namespace {
+
+constexpr float SCOPE = 5.0;
+
+BoatSimulator::Config calm() {
+    BoatSimulator::Config config;
+    config.depth_m = 8.0;
+    config.wind_mps = 8.0;
+    return config;
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+// The plan previewed before the drop is the one start() runs on
+void test_preview_matches_start() {
+    sim::SimRig rig(calm());
+    DeploymentManager* deployment = rig.deployment();
+    DeploymentPlanner::Stats before = deployment->getPlanner().stats();
+
+    deployment->preview(SCOPE);
+    String previewed = deployment->getPlanObservable()->get();
+    printf("plan: %s\n", previewed.c_str());
+    TEST_ASSERT_TRUE(previewed.length() > 0);
+    TEST_ASSERT_FALSE(rig.controller()->isActive());   // Nothing moved
+
+    deployment->start(SCOPE);
+    TEST_ASSERT_EQUAL_STRING(previewed.c_str(), deployment->getPlanObservable()->get().c_str());
+    TEST_ASSERT_EQUAL_UINT32(before.hits + 1, deployment->getPlanner().stats().hits);
+    deployment->stop();
+}
+
+void test_plan_geometry() {
+    sim::SimRig rig(calm());
+    DeploymentPlanner planner(rig.controller());
+    planner.clear();
+
+    DeploymentPlan plan = planner.plan(8.0, SCOPE);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, SCOPE * (8.0 + ChainController::BOW_HEIGHT_M), plan.totalChain);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 0.4 * plan.totalChain, plan.chain40);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 0.8 * plan.totalChain, plan.chain80);
+    TEST_ASSERT_TRUE(plan.dropChain >= plan.anchorDepth + 3.0);
+    TEST_ASSERT_TRUE(plan.distanceInit > 0.0);
+    TEST_ASSERT_TRUE(plan.distance40 < plan.distance80);
+
+    // Shallow water: the total is capped up to 10 m
+    DeploymentPlan shallow = planner.plan(0.2, 3.0);
+    TEST_ASSERT_EQUAL_FLOAT(10.0, shallow.totalChain);
+}
+
+// Nearby inputs share a plan; the least recently used one goes first
+void test_cache_hits_and_lru() {
+    sim::SimRig rig(calm());
+    DeploymentPlanner planner(rig.controller());
+    planner.clear();
+
+    DeploymentPlan first = planner.plan(8.0, SCOPE);
+    DeploymentPlan nearby = planner.plan(8.02, SCOPE);
+    TEST_ASSERT_EQUAL_UINT32(1, planner.stats().misses);
+    TEST_ASSERT_EQUAL_UINT32(1, planner.stats().hits);
+    TEST_ASSERT_EQUAL_FLOAT(first.totalChain, nearby.totalChain);
+    TEST_ASSERT_EQUAL_FLOAT(first.dropChain, nearby.dropChain);
+
+    planner.plan(8.0, SCOPE + 1.0);   // Other scope, other plan
+    TEST_ASSERT_EQUAL_UINT32(2, planner.stats().misses);
+
+    planner.clear();
+    for (size_t i = 1; i <= DeploymentPlanner::CACHE_ENTRIES; i++) {
+        planner.plan((float)i, SCOPE);
+    }
+    TEST_ASSERT_EQUAL_UINT(DeploymentPlanner::CACHE_ENTRIES, planner.size());
+    planner.plan(1.0, SCOPE);                                  // 1 m is now the newest
+    planner.plan(DeploymentPlanner::CACHE_ENTRIES + 1.0, SCOPE); // Evicts 2 m
+    TEST_ASSERT_EQUAL_UINT(DeploymentPlanner::CACHE_ENTRIES, planner.size());
+
+    uint32_t misses = planner.stats().misses;
+    planner.plan(1.0, SCOPE);
+    TEST_ASSERT_EQUAL_UINT32(misses, planner.stats().misses);
+    planner.plan(2.0, SCOPE);
+    TEST_ASSERT_EQUAL_UINT32(misses + 1, planner.stats().misses);
+}
+
+// The cache lives outside the planner: a new one (after a reset) finds it
+void test_cache_kept_across_restart() {
+    sim::SimRig rig(calm());
+    DeploymentPlanner before(rig.controller());
+    before.clear();
+    before.plan(8.0, SCOPE);
+    before.plan(12.0, SCOPE);
+
+    DeploymentPlanner after(rig.controller());
+    TEST_ASSERT_EQUAL_UINT(2, after.stats().restored);
+    after.plan(8.0, SCOPE);
+    TEST_ASSERT_EQUAL_UINT32(1, after.stats().hits);
+    TEST_ASSERT_EQUAL_UINT32(0, after.stats().misses);
+}
+
+void test_expected_times_and_json() {
+    DeploymentPlan plan = {};
+    plan.depth = 8.0;
+    plan.scope = 5.0;
+    plan.dropChain = 18.0;
+    plan.chain40 = 20.0;
+    plan.chain80 = 40.0;
+    plan.totalChain = 50.0;
+    plan.distanceInit = 12.0;
+    plan.distance40 = 14.0;
+    plan.distance80 = 33.0;
+
+    // 1 s per meter, 100 s of holds
+    DeploymentPlanner::Times times = DeploymentPlanner::expectedTimes(plan, 1000.0, 100000);
+    TEST_ASSERT_EQUAL_FLOAT(18.0, times.dropS);
+    TEST_ASSERT_EQUAL_FLOAT(2.0, times.deploy40S);
+    TEST_ASSERT_EQUAL_FLOAT(20.0, times.deploy80S);
+    TEST_ASSERT_EQUAL_FLOAT(10.0, times.finalS);
+    TEST_ASSERT_EQUAL_FLOAT(150.0, times.totalS);
+
+    // A drop past 40 % leaves nothing for that stage
+    plan.dropChain = 25.0;
+    times = DeploymentPlanner::expectedTimes(plan, 1000.0, 0);
+    TEST_ASSERT_EQUAL_FLOAT(0.0, times.deploy40S);
+    TEST_ASSERT_EQUAL_FLOAT(15.0, times.deploy80S);
+    TEST_ASSERT_EQUAL_FLOAT(50.0, times.totalS);
+
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"depth\":8.0,\"scope\":5.0,\"chain\":[25.0,20.0,40.0,50.0],\"distance\":[12.0,14.0,33.0],"
+        "\"seconds\":[25,0,15,10,50]}",
+        DeploymentPlanner::toJson(plan, times).c_str());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_preview_matches_start);
+    RUN_TEST(test_plan_geometry);
+    RUN_TEST(test_cache_hits_and_lru);
+    RUN_TEST(test_cache_kept_across_restart);
+    RUN_TEST(test_expected_times_and_json);
+    return UNITY_END();
+}
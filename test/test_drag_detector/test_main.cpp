@@ -0,0 +1,146 @@
+// Anchor drag alarm: pio test -e native -f test_drag_detector
+
+#include <unity.h>
+
+#include <cmath>
+#include "native_host.h"
+#include "DragDetector.h"
+#include "RollingWindow.h"
+
+namespace {
+
+// Repeatable GPS-like jitter in [-amplitude, amplitude]
+float jitter(int i, float amplitude) {
+    return amplitude * sinf(i * 2.39996f);
+}
+
+}  // namespace
+
+void setUp() { native::reset(); }
+void tearDown() {}
+
+// The running sums give what a pass over the window gives
+void test_rolling_window_matches_direct() {
+    constexpr size_t N = 8;
+    RollingWindow<N> window;
+    float values[100];
+    for (int i = 0; i < 100; i++) {
+        values[i] = 20.0f + 0.3f * i + jitter(i, 2.0f);
+        window.add(values[i]);
+        size_t n = window.size();
+        TEST_ASSERT_EQUAL_UINT(i + 1 < (int)N ? i + 1 : N, n);
+
+        double sum = 0, sum_sq = 0, sum_k = 0, sum_kk = 0, sum_kx = 0;
+        for (size_t k = 0; k < n; k++) {
+            double x = values[i + 1 - n + k];
+            sum += x;
+            sum_sq += x * x;
+            sum_k += k;
+            sum_kk += (double)k * k;
+            sum_kx += k * x;
+        }
+        double mean = sum / n;
+        TEST_ASSERT_FLOAT_WITHIN(1e-3, mean, window.mean());
+        TEST_ASSERT_FLOAT_WITHIN(1e-2, sum_sq / n - mean * mean, window.variance());
+        if (n >= 2) {
+            double slope = (n * sum_kx - sum_k * sum) / (n * sum_kk - sum_k * sum_k);
+            TEST_ASSERT_FLOAT_WITHIN(1e-3, slope, window.slope());
+        }
+    }
+    TEST_ASSERT_EQUAL_FLOAT(values[99], window.newest());
+}
+
+// A boat swinging on a good set: slack noisy around +3 m, brief dips below zero
+void test_holding_does_not_alarm() {
+    DragDetector drag;
+    for (int i = 0; i < 600; i++) {
+        float slack = 3.0f + jitter(i, 3.5f);
+        TEST_ASSERT_FALSE(drag.add(slack, 40.0f + jitter(i + 7, 4.0f)));
+    }
+    TEST_ASSERT_FALSE(drag.dragging());
+}
+
+// Slack goes and stays negative: the alarm is up within the slack window
+void test_sustained_negative_slack() {
+    DragDetector drag;
+    for (int i = 0; i < 60; i++) drag.add(2.0f, 45.0f);
+    int alarm_at = -1;
+    for (int i = 0; i < 60 && alarm_at < 0; i++) {
+        if (drag.add(-3.0f + jitter(i, 0.5f), 45.0f)) alarm_at = i;
+    }
+    TEST_ASSERT_TRUE(alarm_at >= 0);
+    TEST_ASSERT_TRUE(alarm_at < (int)DragDetector::SLACK_WINDOW);
+    TEST_ASSERT_TRUE(drag.cause() == DragDetector::Cause::NEGATIVE_SLACK);
+    TEST_ASSERT_TRUE(drag.notification().find("\"state\":\"alarm\"") != std::string::npos);
+
+    // Holds until the good samples have outlasted CLEAR_SAMPLES
+    size_t cleared_at = 0;
+    for (size_t i = 1; i < 100 && cleared_at == 0; i++) {
+        if (drag.add(2.0f, 45.0f)) cleared_at = i;
+    }
+    TEST_ASSERT_TRUE(cleared_at >= DragDetector::CLEAR_SAMPLES);
+    TEST_ASSERT_TRUE(cleared_at <= DragDetector::CLEAR_SAMPLES + DragDetector::SLACK_WINDOW);
+    TEST_ASSERT_FALSE(drag.dragging());
+    TEST_ASSERT_TRUE(drag.notification().find("\"state\":\"normal\"") != std::string::npos);
+}
+
+// Just beyond scope but still moving away at 0.2 m/s
+void test_distance_growing_beyond_scope() {
+    DragDetector drag;
+    bool alarmed = false;
+    for (int i = 0; i < 60 && !alarmed; i++) {
+        alarmed = drag.add(-0.4f + jitter(i, 0.3f), 40.0f + 0.2f * i + jitter(i + 3, 1.0f));
+    }
+    TEST_ASSERT_TRUE(alarmed);
+    TEST_ASSERT_TRUE(drag.cause() == DragDetector::Cause::DISTANCE_GROWING);
+
+    // The same slack with the boat no longer moving is not a drag
+    DragDetector settled;
+    for (int i = 0; i < 120; i++) {
+        TEST_ASSERT_FALSE(settled.add(-0.4f + jitter(i, 0.3f), 52.0f + jitter(i + 3, 1.0f)));
+    }
+}
+
+// A reset (windlass moved) starts the windows over
+void test_reset_starts_a_new_watch() {
+    DragDetector drag;
+    for (size_t i = 0; i + 1 < DragDetector::SLACK_WINDOW; i++) drag.add(-3.0f, 45.0f);
+    drag.reset();
+    for (size_t i = 0; i + 1 < DragDetector::SLACK_WINDOW; i++) {
+        TEST_ASSERT_FALSE(drag.add(-3.0f, 45.0f));
+    }
+    TEST_ASSERT_TRUE(drag.add(-3.0f, 45.0f));
+}
+
+// Raising the anchor after a drag ends the alarm; a reset alone does not
+void test_clear_after_drag() {
+    DragDetector drag;
+    bool alarmed = false;
+    for (int i = 0; i < 60 && !alarmed; i++) alarmed = drag.add(-3.0f, 45.0f);
+    TEST_ASSERT_TRUE(alarmed);
+
+    drag.reset();   // Stale input
+    TEST_ASSERT_TRUE(drag.dragging());
+    TEST_ASSERT_TRUE(drag.clear());   // Rode off the bottom
+    TEST_ASSERT_FALSE(drag.dragging());
+    TEST_ASSERT_TRUE(drag.cause() == DragDetector::Cause::NONE);
+    TEST_ASSERT_TRUE(drag.notification().find("\"state\":\"normal\"") != std::string::npos);
+    TEST_ASSERT_FALSE(drag.clear());
+
+    // The next anchoring starts a fresh watch
+    for (size_t i = 0; i + 1 < DragDetector::SLACK_WINDOW; i++) {
+        TEST_ASSERT_FALSE(drag.add(-3.0f, 45.0f));
+    }
+    TEST_ASSERT_TRUE(drag.add(-3.0f, 45.0f));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_rolling_window_matches_direct);
+    RUN_TEST(test_holding_does_not_alarm);
+    RUN_TEST(test_sustained_negative_slack);
+    RUN_TEST(test_distance_growing_beyond_scope);
+    RUN_TEST(test_reset_starts_a_new_watch);
+    RUN_TEST(test_clear_after_drag);
+    return UNITY_END();
+}
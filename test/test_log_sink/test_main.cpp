@@ -0,0 +1,159 @@
+// Deferred log sink: pio test -e native -f test_log_sink
+
+#include <unity.h>
+
+#include "LogSink.h"
+
+namespace {
+
+// Formats a line the way ESP_LOGI would have, for comparison
+__attribute__((format(printf, 2, 3)))
+std::string expected(unsigned long ms, const char* format, ...) {
+    char text[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    char line[300];
+    snprintf(line, sizeof(line), "I (%lu) tag: %s\n", ms, text);
+    return line;
+}
+
+void logBurst(int count) {
+    for (int i = 0; i < count; i++) {
+        SINK_LOGI("tag", "burst %d", i);
+    }
+}
+
+void logThrottled(int i) {
+    SINK_LOGI_EVERY(1000, "tag", "throttled %d", i);
+}
+
+}  // namespace
+
+void setUp() {
+    native::log_level = native::LOG_NONE;
+    LogSink::global().drain();
+}
+void tearDown() {}
+
+// Not started yet: every record is written on the spot, as ESP_LOGx would
+void test_formats_like_printf() {
+    native::setMillis(1234);
+    SINK_LOGI("tag", "Rode: %.2f m, pulses %ld, state=%s, %u%% %c", 12.345f, -42L, "LOWERING", 7u, 'x');
+    TEST_ASSERT_EQUAL_STRING(expected(1234, "Rode: %.2f m, pulses %ld, state=%s, %u%% %c", 12.345f, -42L,
+                                      "LOWERING", 7u, 'x').c_str(),
+                             native::last_log_line.c_str());
+
+    SINK_LOGI("tag", "[%6.1f] [%-4d] [%05lu] [%x] [%+.0f]", -3.14159, 17, 99UL, 255u, 2.5);
+    TEST_ASSERT_EQUAL_STRING(expected(1234, "[%6.1f] [%-4d] [%05lu] [%x] [%+.0f]", -3.14159, 17, 99UL,
+                                      255u, 2.5).c_str(),
+                             native::last_log_line.c_str());
+
+    SINK_LOGI("tag", "no arguments");
+    TEST_ASSERT_EQUAL_STRING("I (1234) tag: no arguments\n", native::last_log_line.c_str());
+}
+
+void test_level_letters() {
+    native::setMillis(5);
+    SINK_LOGE("tag", "e");
+    TEST_ASSERT_EQUAL_STRING("E (5) tag: e\n", native::last_log_line.c_str());
+    SINK_LOGW("tag", "w");
+    TEST_ASSERT_EQUAL_STRING("W (5) tag: w\n", native::last_log_line.c_str());
+    SINK_LOGD("tag", "d");
+    TEST_ASSERT_EQUAL_STRING("D (5) tag: d\n", native::last_log_line.c_str());
+}
+
+// Strings are copied, so a temporary that dies before the drain is safe
+void test_strings_are_copied() {
+    LogSink& sink = LogSink::global();
+    TEST_ASSERT_TRUE(sink.start());
+    native::setMillis(2000);
+    {
+        String command("autoDrop5");
+        SINK_LOGI("tag", "Command received is %s", command.c_str());
+        command.assign("overwritten");
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, sink.pending());
+    TEST_ASSERT_EQUAL_UINT32(1, sink.drain());
+    TEST_ASSERT_EQUAL_STRING("I (2000) tag: Command received is autoDrop5\n", native::last_log_line.c_str());
+
+    // Past TEXT_BYTES the text is truncated, not overrun
+    std::string longText(200, 'a');
+    SINK_LOGI("tag", "%s|%s", longText.c_str(), "b");
+    sink.drain();
+    std::string line = native::last_log_line;
+    TEST_ASSERT_EQUAL_STRING(("I (2000) tag: " + std::string(LogSink::TEXT_BYTES - 1, 'a') + "|\n").c_str(),
+                             line.c_str());
+}
+
+// Records keep the time they were made, not the time they were written
+void test_timestamp_is_the_call_time() {
+    LogSink& sink = LogSink::global();
+    TEST_ASSERT_TRUE(sink.start());
+    native::setMillis(3000);
+    SINK_LOGI("tag", "at three seconds");
+    native::setMillis(3500);
+    sink.drain();
+    TEST_ASSERT_EQUAL_STRING("I (3000) tag: at three seconds\n", native::last_log_line.c_str());
+}
+
+void test_ring_overflow_is_counted() {
+    LogSink& sink = LogSink::global();
+    TEST_ASSERT_TRUE(sink.start());
+    native::setMillis(4000);
+    uint32_t dropped_before = sink.dropped();
+    unsigned long lines_before = native::log_lines_written;
+
+    logBurst(LogSink::RING_SIZE + 5);
+    TEST_ASSERT_EQUAL_UINT32(LogSink::RING_SIZE, sink.pending());
+    TEST_ASSERT_EQUAL_UINT32(5, sink.dropped() - dropped_before);
+
+    TEST_ASSERT_EQUAL_UINT32(LogSink::RING_SIZE, sink.drain());
+    // Every queued record plus one line reporting the drops
+    TEST_ASSERT_EQUAL_UINT32(LogSink::RING_SIZE + 1, native::log_lines_written - lines_before);
+    TEST_ASSERT_EQUAL_STRING(expected(4000, "burst %d", (int)LogSink::RING_SIZE - 1).c_str(),
+                             native::last_log_line.c_str());
+}
+
+void test_rate_limit_reports_suppressed() {
+    LogSink& sink = LogSink::global();
+    TEST_ASSERT_TRUE(sink.start());
+    native::setMillis(10000);
+    for (int i = 0; i < 10; i++) logThrottled(i);   // Only the first gets through
+    TEST_ASSERT_EQUAL_UINT32(1, sink.pending());
+    sink.drain();
+    TEST_ASSERT_EQUAL_STRING("I (10000) tag: throttled 0\n", native::last_log_line.c_str());
+
+    native::setMillis(10999);
+    logThrottled(10);
+    TEST_ASSERT_EQUAL_UINT32(0, sink.pending());
+    native::setMillis(11000);
+    logThrottled(11);
+    sink.drain();
+    TEST_ASSERT_EQUAL_STRING("I (11000) tag: throttled 11 (+10 suppressed)\n", native::last_log_line.c_str());
+}
+
+// Once started, the drain task empties the ring on its own
+void test_task_drains() {
+    LogSink& sink = LogSink::global();
+    TEST_ASSERT_TRUE(sink.start());
+    native::setMillis(20000);
+    SINK_LOGW("tag", "from the event loop");
+    TEST_ASSERT_EQUAL_UINT32(1, sink.pending());
+    native::runTasks();
+    TEST_ASSERT_EQUAL_UINT32(0, sink.pending());
+    TEST_ASSERT_EQUAL_STRING("W (20000) tag: from the event loop\n", native::last_log_line.c_str());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_formats_like_printf);
+    RUN_TEST(test_level_letters);
+    RUN_TEST(test_strings_are_copied);
+    RUN_TEST(test_timestamp_is_the_call_time);
+    RUN_TEST(test_ring_overflow_is_counted);
+    RUN_TEST(test_rate_limit_reports_suppressed);
+    RUN_TEST(test_task_drains);
+    return UNITY_END();
+}
@@ -0,0 +1,97 @@
+// Two windlasses on one board: pio test -e native -f test_multi_windlass
+
+#include <unity.h>
+
+#include "native_host.h"
+#include "ChainController.h"
+#include "ChainPosition.h"
+#include "PositionSnapshot.h"
+
+namespace {
+
+constexpr float CIRCUMFERENCE_M = 0.25;
+
+// Bow and stern as WindlassUnit wires them: one environment, own distance
+struct Boat {
+    ChainController::Environment environment = ChainController::Environment::create();
+    ChainPosition bow_position{CIRCUMFERENCE_M, 80.0, 40};
+    ChainPosition stern_position{CIRCUMFERENCE_M, 60.0, 0};
+    ChainController bow{2.0, 80.0, 75.0, &bow_position, 19, 16, environment,
+                        ChainController::createDistanceInput(), 0};
+    ChainController stern{2.0, 60.0, 55.0, &stern_position, 18, 17, environment,
+                          ChainController::createDistanceInput("navigation.anchor.stern", "/stern"), 1};
+
+    Boat() {
+        bow.begin();
+        stern.begin();
+        bow.enableCounting();
+        stern.enableCounting();
+    }
+};
+
+}  // namespace
+
+void setUp() {
+    native::reset();
+    PositionSnapshot::clear();
+}
+void tearDown() {}
+
+void test_snapshot_slots_per_unit() {
+    PositionSnapshot::write(40, ChainState::IDLE, 0);
+    PositionSnapshot::write(7, ChainState::LOWERING, 1);
+    PositionSnapshot::write(8, ChainState::LOWERING, 1);
+
+    PositionSnapshot::State bow;
+    PositionSnapshot::State stern;
+    TEST_ASSERT_TRUE(PositionSnapshot::read(&bow, 0));
+    TEST_ASSERT_TRUE(PositionSnapshot::read(&stern, 1));
+    TEST_ASSERT_EQUAL_INT32(40, bow.pulses);
+    TEST_ASSERT_EQUAL_UINT32(0, bow.seq);
+    TEST_ASSERT_EQUAL_INT32(8, stern.pulses);
+    TEST_ASSERT_EQUAL_UINT32(1, stern.seq);
+    TEST_ASSERT_FALSE(PositionSnapshot::read(&bow, PositionSnapshot::UNITS));
+}
+
+// Depth and wind arrive once for both; each windlass has its own distance
+void test_environment_is_shared() {
+    Boat boat;
+    TEST_ASSERT_EQUAL_PTR(boat.bow.getDepthListener(), boat.stern.getDepthListener());
+    TEST_ASSERT_EQUAL_PTR(boat.bow.getWindSpeedListener(), boat.stern.getWindSpeedListener());
+    TEST_ASSERT_TRUE(boat.bow.getDistanceListener() != boat.stern.getDistanceListener());
+
+    boat.bow.getDepthListener()->emit(6.0);
+    boat.bow.getDistanceListener()->emit(25.0);
+    boat.stern.getDistanceListener()->emit(4.0);
+    TEST_ASSERT_EQUAL_FLOAT(6.0, boat.stern.getCurrentDepth());
+    TEST_ASSERT_EQUAL_FLOAT(25.0, boat.bow.getCurrentDistance());
+    TEST_ASSERT_EQUAL_FLOAT(4.0, boat.stern.getCurrentDistance());
+}
+
+// Each unit has its own task, count, RTC slots and learned speeds
+void test_units_count_independently() {
+    Boat boat;
+    boat.stern.addPulses(8);
+    native::advanceMillis(50);
+
+    TEST_ASSERT_EQUAL_FLOAT(10.0, boat.bow.getChainLength());
+    TEST_ASSERT_EQUAL_FLOAT(2.0, boat.stern.getChainLength());
+    PositionSnapshot::State bow;
+    PositionSnapshot::State stern;
+    TEST_ASSERT_TRUE(PositionSnapshot::read(&bow, 0));
+    TEST_ASSERT_TRUE(PositionSnapshot::read(&stern, 1));
+    TEST_ASSERT_EQUAL_INT32(40, bow.pulses);
+    TEST_ASSERT_EQUAL_INT32(8, stern.pulses);
+
+    boat.stern.saveSpeedsToPrefs();
+    TEST_ASSERT_EQUAL_UINT(1, native::preferences_store.count("speeds2"));
+    TEST_ASSERT_EQUAL_UINT(0, native::preferences_store.count("speeds"));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_snapshot_slots_per_unit);
+    RUN_TEST(test_environment_is_shared);
+    RUN_TEST(test_units_count_independently);
+    return UNITY_END();
+}
@@ -0,0 +1,93 @@
+// Hot-path histograms: pio test -e native -f test_perf
+
+#include <unity.h>
+
+#include "SimRig.h"
+#include "PerfStats.h"
+
+void setUp() {
+    for (int i = 0; i < (int)PerfSite::COUNT; i++) {
+        PerfHistogram& histogram = perf::site((PerfSite)i);
+        histogram.reset();
+        histogram.record(0);   // Applies the reset...
+        histogram.reset();     // ...and this one clears that sample on the next record
+    }
+}
+void tearDown() {}
+
+void test_bucket_edges() {
+    TEST_ASSERT_EQUAL_INT(0, PerfHistogram::bucketFor(0));
+    TEST_ASSERT_EQUAL_INT(0, PerfHistogram::bucketFor(255));
+    TEST_ASSERT_EQUAL_INT(1, PerfHistogram::bucketFor(256));
+    TEST_ASSERT_EQUAL_INT(1, PerfHistogram::bucketFor(511));
+    TEST_ASSERT_EQUAL_INT(2, PerfHistogram::bucketFor(512));
+    TEST_ASSERT_EQUAL_INT(PerfHistogram::BUCKETS - 1, PerfHistogram::bucketFor(UINT32_MAX));
+    for (int b = 0; b < PerfHistogram::BUCKETS - 1; b++) {
+        TEST_ASSERT_EQUAL_INT(b, PerfHistogram::bucketFor(PerfHistogram::bucketUpperEdge(b)));
+        TEST_ASSERT_EQUAL_INT(b + 1, PerfHistogram::bucketFor(PerfHistogram::bucketUpperEdge(b) + 1));
+    }
+}
+
+void test_percentiles_and_max() {
+    PerfHistogram histogram;
+    for (int i = 0; i < 98; i++) histogram.record(300);   // Bucket 1
+    histogram.record(5000);                                 // Bucket 5
+    histogram.record(70000);                                // Bucket 9
+
+    PerfHistogram::Summary s = histogram.summary();
+    TEST_ASSERT_EQUAL_UINT32(100, s.count);
+    TEST_ASSERT_EQUAL_UINT32(511, s.p50_cycles);
+    TEST_ASSERT_EQUAL_UINT32(8191, s.p99_cycles);
+    TEST_ASSERT_EQUAL_UINT32(70000, s.max_cycles);
+    TEST_ASSERT_EQUAL_UINT32(98 * 300 + 5000 + 70000, (uint32_t)s.total_cycles);
+
+    // A percentile never reports more than the worst sample
+    PerfHistogram single;
+    single.record(300);
+    TEST_ASSERT_EQUAL_UINT32(300, single.summary().p99_cycles);
+}
+
+void test_reset_is_applied_by_the_writer() {
+    PerfHistogram histogram;
+    histogram.record(1000);
+    histogram.reset();
+    TEST_ASSERT_EQUAL_UINT32(1, histogram.summary().count);  // Reader cannot clear it
+    histogram.record(2000);
+    PerfHistogram::Summary s = histogram.summary();
+    TEST_ASSERT_EQUAL_UINT32(1, s.count);
+    TEST_ASSERT_EQUAL_UINT32(2000, s.max_cycles);
+}
+
+void test_summary_text() {
+    // Host "CPU" is 1000 MHz: 1000 cycles per microsecond
+    perf::site(PerfSite::COMMAND).record(40000);
+    TEST_ASSERT_EQUAL_STRING("n=1 p50=40 p99=40 max=40 us", perf::summaryText(PerfSite::COMMAND).c_str());
+    TEST_ASSERT_EQUAL_STRING("command", perf::siteName(PerfSite::COMMAND));
+}
+
+void test_sites_fill_during_autodrop() {
+    BoatSimulator::Config config;
+    sim::SimRig rig(config);
+    sim::RunResult result = rig.autoDrop(5.0, 30UL * 60 * 1000);
+    TEST_ASSERT_TRUE(result.completed);
+
+    // One windlass tick per virtual millisecond, one slack update per SimRig period
+    uint32_t ticks = perf::site(PerfSite::WINDLASS_TICK).summary().count;
+    uint32_t slack = perf::site(PerfSite::SLACK).summary().count;
+    TEST_ASSERT_TRUE(ticks >= (uint32_t)(result.virtual_s * 1000) - 10);
+    TEST_ASSERT_TRUE(slack >= (uint32_t)(result.virtual_s * 1000 / sim::SLACK_PERIOD_MS) - 10);
+    // Learned speeds/coasts are saved when the move ends
+    TEST_ASSERT_TRUE(perf::site(PerfSite::NVS_SAVE).summary().count > 0);
+    printf("windlassTick %s\nslack %s\n", perf::summaryText(PerfSite::WINDLASS_TICK).c_str(),
+           perf::summaryText(PerfSite::SLACK).c_str());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_bucket_edges);
+    RUN_TEST(test_percentiles_and_max);
+    RUN_TEST(test_reset_is_applied_by_the_writer);
+    RUN_TEST(test_summary_text);
+    RUN_TEST(test_sites_fill_during_autodrop);
+    return UNITY_END();
+}
@@ -0,0 +1,110 @@
+// Chain position journal: pio test -e native -f test_position_journal
+
+#include <unity.h>
+
+#include <Preferences.h>
+#include "native_host.h"
+#include "PositionJournal.h"
+
+namespace {
+
+constexpr float GYPSY_M = 0.25;
+constexpr uint32_t PARTITION_BYTES = 16384;   // partitions_chain.csv chainlog: 4 sectors
+constexpr size_t RECORD_BYTES = 16;
+constexpr size_t SLOTS = PARTITION_BYTES / RECORD_BYTES;
+
+// Commits count, count + 1, ... count + n - 1
+void commitRun(PositionJournal& journal, int32_t count, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        journal.record(count + (int32_t)i);
+        TEST_ASSERT_TRUE(journal.commit());
+    }
+}
+
+int32_t recover() {
+    PositionJournal journal(GYPSY_M);
+    TEST_ASSERT_TRUE(journal.begin());
+    TEST_ASSERT_TRUE(journal.hasRecovered());
+    return journal.recoveredPulses();
+}
+
+}  // namespace
+
+void setUp() {
+    native::reset();
+    native::log_level = native::LOG_ERROR;
+}
+void tearDown() {}
+
+// An empty journal starts from the pre-journal Preferences key
+void test_empty_journal_migrates_preferences() {
+    native::addPartition("chainlog", PARTITION_BYTES);
+    Preferences prefs;
+    prefs.begin("chain", false);
+    prefs.putFloat("length", 12.5f);
+    prefs.end();
+    TEST_ASSERT_EQUAL_INT32(50, recover());
+}
+
+// No partition (8 MB layouts): pulses go to and come back from NVS
+void test_without_partition_uses_preferences() {
+    PositionJournal journal(GYPSY_M);
+    TEST_ASSERT_TRUE(journal.begin());
+    TEST_ASSERT_FALSE(journal.usingPartition());
+    journal.record(77);
+    TEST_ASSERT_TRUE(journal.commit());
+    TEST_ASSERT_EQUAL_INT32(77, recover());
+}
+
+// The highest sequence number wins, wherever the write pointer is
+void test_latest_record_wins_after_wrapping() {
+    native::addPartition("chainlog", PARTITION_BYTES);
+    PositionJournal journal(GYPSY_M);
+    TEST_ASSERT_TRUE(journal.begin());
+    commitRun(journal, 1000, SLOTS + SLOTS / 2);   // Around once and half way again
+    TEST_ASSERT_EQUAL_INT32(1000 + (int32_t)(SLOTS + SLOTS / 2) - 1, recover());
+
+    // A journal picked up after the wrap carries on after that record
+    PositionJournal resumed(GYPSY_M);
+    TEST_ASSERT_TRUE(resumed.begin());
+    commitRun(resumed, 5, 3);
+    TEST_ASSERT_EQUAL_INT32(7, recover());
+}
+
+// A record cut short by a power loss fails its CRC; the one before it wins
+void test_torn_record_falls_back_to_the_previous() {
+    native::Partition* partition = native::addPartition("chainlog", PARTITION_BYTES);
+    PositionJournal journal(GYPSY_M);
+    TEST_ASSERT_TRUE(journal.begin());
+    commitRun(journal, 200, 10);
+
+    partition->bytes[9 * RECORD_BYTES + 13] ^= 0x5A;   // Last record's CRC
+    TEST_ASSERT_EQUAL_INT32(208, recover());
+
+    // Nothing valid at all: back to Preferences (none here, so 0)
+    for (size_t slot = 0; slot < 9; slot++) partition->bytes[slot * RECORD_BYTES + 4] ^= 0x01;
+    TEST_ASSERT_EQUAL_INT32(0, recover());
+}
+
+// Unchanged positions are not written again
+void test_commit_skips_unchanged() {
+    native::addPartition("chainlog", PARTITION_BYTES);
+    PositionJournal journal(GYPSY_M);
+    TEST_ASSERT_TRUE(journal.begin());
+    journal.record(4);
+    TEST_ASSERT_TRUE(journal.commit());
+    journal.record(4);
+    TEST_ASSERT_TRUE(journal.commit());
+    TEST_ASSERT_TRUE(journal.commit(true));
+    TEST_ASSERT_EQUAL_UINT32(1, journal.writeCount());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_journal_migrates_preferences);
+    RUN_TEST(test_without_partition_uses_preferences);
+    RUN_TEST(test_latest_record_wins_after_wrapping);
+    RUN_TEST(test_torn_record_falls_back_to_the_previous);
+    RUN_TEST(test_commit_skips_unchanged);
+    return UNITY_END();
+}
@@ -0,0 +1,220 @@
+// Coalesced Signal K publishing: pio test -e native -f test_publish_scheduler
+
+#include <unity.h>
+
+#include "native_host.h"
+#include "ChainTypes.h"
+#include "PublishScheduler.h"
+#include "SKDeltaWriter.h"
+#include "sensesp/system/observablevalue.h"
+
+using sensesp::ObservableValue;
+using sensesp::SKOutputFloat;
+using sensesp::SKOutputString;
+
+namespace {
+
+struct Outputs {
+    bool moving = false;
+    ObservableValue<float>* rode;
+    ObservableValue<float>* slack;
+    EnumValue<ChainDirection>* direction;
+    PublishScheduler* scheduler;
+    SKOutputFloat* rode_out;
+    SKOutputFloat* slack_out;
+    SKOutputString* direction_out;
+};
+
+constexpr float SLACK_DEADBAND_M = 0.05;
+
+Outputs* make() {
+    native::reset();
+    auto* o = new Outputs();
+    o->rode = new ObservableValue<float>(10.0);
+    o->slack = new ObservableValue<float>(1.0);
+    o->direction = new EnumValue<ChainDirection>(ChainDirection::FREE_FALL);
+    o->scheduler = new PublishScheduler([o]() { return o->moving; });
+    o->rode_out = o->scheduler->addNumber(o->rode, "navigation.anchor.rodeDeployed", "", 0.0);
+    o->slack_out = o->scheduler->addNumber(o->slack, "navigation.anchor.chainSlack", "", SLACK_DEADBAND_M);
+    o->direction_out = o->scheduler->addState(o->direction, "navigation.anchor.chainDirection", "");
+    o->scheduler->start();
+    return o;
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+// One pulse every 20 ms while moving: the rode goes out once per fast window
+void test_moving_rode_is_coalesced() {
+    Outputs* o = make();
+    const PublishScheduler::Config& config = o->scheduler->getConfig();
+    o->moving = true;
+    float rode = 10.0;
+    for (int i = 0; i < 200; i++) {   // 4 s
+        rode += 0.25;
+        o->rode->set(rode);
+        native::advanceMillis(20);
+    }
+    unsigned long expected = 4000 / config.fastIntervalMs;
+    TEST_ASSERT_UINT32_WITHIN(2, expected, o->rode_out->publishCount());
+    TEST_ASSERT_FLOAT_WITHIN(0.25 * (config.fastIntervalMs / 20 + 3), rode, o->rode_out->get());
+
+    // The last value goes out with the next window after the chain stops
+    o->moving = false;
+    native::advanceMillis(config.slowIntervalMs + PublishScheduler::TICK_MS);
+    TEST_ASSERT_EQUAL_FLOAT(rode, o->rode_out->get());
+}
+
+// Slack moves inside the deadband at anchor: only the heartbeat sends it
+void test_deadband_and_heartbeat() {
+    Outputs* o = make();
+    const PublishScheduler::Config& config = o->scheduler->getConfig();
+    o->slack->set(1.0);
+    native::advanceMillis(config.slowIntervalMs + PublishScheduler::TICK_MS);
+    TEST_ASSERT_EQUAL_UINT32(1, o->slack_out->publishCount());
+
+    for (int i = 0; i < 50; i++) {
+        o->slack->set(i % 2 ? 1.02 : 0.98);
+        native::advanceMillis(100);
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, o->slack_out->publishCount());
+
+    native::advanceMillis(config.heartbeatMs);
+    TEST_ASSERT_EQUAL_UINT32(2, o->slack_out->publishCount());
+    TEST_ASSERT_FLOAT_WITHIN(0.03, 1.0, o->slack_out->get());
+    // The heartbeat re-sends everything, including values that never changed
+    TEST_ASSERT_EQUAL_UINT32(1, o->rode_out->publishCount());
+    TEST_ASSERT_EQUAL_FLOAT(10.0, o->rode_out->get());
+    TEST_ASSERT_EQUAL_STRING("free fall", o->direction_out->get().c_str());
+}
+
+// A state change goes out on the next tick and takes pending numbers with it
+void test_state_change_flushes_batch() {
+    Outputs* o = make();
+    native::advanceMillis(PublishScheduler::TICK_MS);   // Let the first window open
+    o->rode->set(12.0);
+    o->direction->set(ChainDirection::DOWN);
+    unsigned long flushes = o->scheduler->flushCount();
+    native::advanceMillis(PublishScheduler::TICK_MS);
+    TEST_ASSERT_EQUAL_UINT32(flushes + 1, o->scheduler->flushCount());
+    TEST_ASSERT_EQUAL_STRING("down", o->direction_out->get().c_str());
+    TEST_ASSERT_EQUAL_FLOAT(12.0, o->rode_out->get());
+    TEST_ASSERT_EQUAL_UINT32(0, o->slack_out->publishCount());   // Nothing new, not sent
+
+    // An unchanged state that is re-emitted (a command acknowledgement) is sent too
+    o->direction->notify();
+    native::advanceMillis(PublishScheduler::TICK_MS);
+    TEST_ASSERT_EQUAL_UINT32(2, o->direction_out->publishCount());
+}
+
+// Text goes out as is, like a state, and only when set
+void test_text_flushes_like_a_state() {
+    Outputs* o = make();
+    auto* plan = new ObservableValue<String>("");
+    SKOutputString* plan_out = o->scheduler->addText(plan, "navigation.anchor.autoPlan", "");
+    native::advanceMillis(PublishScheduler::TICK_MS);
+    TEST_ASSERT_EQUAL_UINT32(0, plan_out->publishCount());
+
+    plan->set("{\"scope\":5.0}");
+    native::advanceMillis(PublishScheduler::TICK_MS);
+    TEST_ASSERT_EQUAL_UINT32(1, plan_out->publishCount());
+    TEST_ASSERT_EQUAL_STRING("{\"scope\":5.0}", plan_out->get().c_str());
+}
+
+// One delta per flush, written into the same buffer every time
+void test_delta_sink_batches_into_one_buffer() {
+    Outputs* o = make();
+    std::vector<std::string> deltas;
+    const char* buffer = nullptr;
+    bool same_buffer = true;
+    o->scheduler->setDeltaSink([&](String& delta) {
+        if (buffer != nullptr && delta.c_str() != buffer) same_buffer = false;
+        buffer = delta.c_str();
+        deltas.push_back(delta);
+        return true;
+    }, "ChainCounter");
+
+    native::advanceMillis(PublishScheduler::TICK_MS);
+    o->rode->set(12.25);
+    o->direction->set(ChainDirection::DOWN);
+    native::advanceMillis(PublishScheduler::TICK_MS);
+    TEST_ASSERT_EQUAL_UINT32(1, deltas.size());
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"context\":\"vessels.self\",\"updates\":[{\"$source\":\"ChainCounter\",\"values\":["
+        "{\"path\":\"navigation.anchor.rodeDeployed\",\"value\":12.25},"
+        "{\"path\":\"navigation.anchor.chainDirection\",\"value\":\"down\"}]}]}",
+        deltas[0].c_str());
+    TEST_ASSERT_EQUAL_UINT32(0, o->rode_out->publishCount());   // SensESP's path is bypassed
+
+    o->slack->set(NAN);
+    native::advanceMillis(o->scheduler->getConfig().slowIntervalMs);
+    TEST_ASSERT_EQUAL_UINT32(2, deltas.size());
+    TEST_ASSERT_TRUE(deltas[1].find("\"navigation.anchor.chainSlack\",\"value\":null") != std::string::npos);
+    TEST_ASSERT_TRUE(same_buffer);
+    TEST_ASSERT_EQUAL_UINT32(2, o->scheduler->deltaCount());
+}
+
+// Values that do not fit are split over several deltas; text is escaped
+void test_delta_writer_splits_and_escapes() {
+    SKDeltaWriter writer(120);
+    writer.begin();
+    TEST_ASSERT_TRUE(writer.addNumber("a.b", -0.5));
+    TEST_ASSERT_TRUE(writer.addText("a.c", "say \"hi\"\n"));
+    TEST_ASSERT_FALSE(writer.addNumber("a.much.longer.path.that.does.not.fit", 1.0));
+    const String& delta = writer.finish();
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"context\":\"vessels.self\",\"updates\":[{\"values\":["
+        "{\"path\":\"a.b\",\"value\":-0.5},{\"path\":\"a.c\",\"value\":\"say \\\"hi\\\"\\n\"}]}]}",
+        delta.c_str());
+    TEST_ASSERT_TRUE(delta.length() <= writer.capacity());
+
+    Outputs* o = make();
+    std::vector<std::string> deltas;
+    o->scheduler->setDeltaSink([&](String& delta) {
+        deltas.push_back(delta);
+        return false;   // Not connected
+    });
+    auto* plan = new ObservableValue<String>("");
+    SKOutputString* plan_out = o->scheduler->addText(plan, "navigation.anchor.autoPlan", "");
+    plan->set(std::string(SKDeltaWriter::CAPACITY, 'x'));   // Larger than a whole delta
+    native::advanceMillis(PublishScheduler::TICK_MS);
+    TEST_ASSERT_EQUAL_UINT32(1, plan_out->publishCount());
+    TEST_ASSERT_EQUAL_UINT32(0, deltas.size());
+    TEST_ASSERT_EQUAL_UINT32(0, o->scheduler->droppedDeltas());
+
+    native::advanceMillis(o->scheduler->getConfig().heartbeatMs);
+    TEST_ASSERT_EQUAL_UINT32(1, deltas.size());   // The three that fit, then the plan on its own
+    TEST_ASSERT_EQUAL_UINT32(1, o->scheduler->droppedDeltas());
+    TEST_ASSERT_EQUAL_UINT32(2, plan_out->publishCount());
+}
+
+// Notifications are JSON values: written as is, not as a string
+void test_json_goes_out_unescaped() {
+    Outputs* o = make();
+    std::vector<std::string> deltas;
+    o->scheduler->setDeltaSink([&](String& delta) {
+        deltas.push_back(delta);
+        return true;
+    });
+    auto* drag = new ObservableValue<String>("");
+    o->scheduler->addJson(drag, "notifications.anchor.drag", "");
+    drag->set("{\"state\":\"alarm\"}");
+    native::advanceMillis(PublishScheduler::TICK_MS);
+    TEST_ASSERT_EQUAL_UINT32(1, deltas.size());
+    TEST_ASSERT_TRUE(deltas[0].find("{\"path\":\"notifications.anchor.drag\",\"value\":{\"state\":\"alarm\"}}") !=
+                     std::string::npos);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_moving_rode_is_coalesced);
+    RUN_TEST(test_deadband_and_heartbeat);
+    RUN_TEST(test_state_change_flushes_batch);
+    RUN_TEST(test_text_flushes_like_a_state);
+    RUN_TEST(test_delta_sink_batches_into_one_buffer);
+    RUN_TEST(test_delta_writer_splits_and_escapes);
+    RUN_TEST(test_json_goes_out_unescaped);
+    return UNITY_END();
+}
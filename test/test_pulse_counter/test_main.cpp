@@ -0,0 +1,109 @@
+// Gypsy pulse counter: pio test -e native -f test_pulse_counter
+
+#include <unity.h>
+
+#include "native_host.h"
+#include "PulseCounter.h"
+
+namespace {
+
+constexpr int PULSE_GPIO = 27;
+constexpr int UP_SENSE_GPIO = 23;   // ACTIVE-LOW
+
+void pulses(int count) {
+    for (int i = 0; i < count; i++) native::pcntCount(PULSE_GPIO);
+}
+
+}  // namespace
+
+void setUp() {
+    native::reset();
+    native::log_level = native::LOG_ERROR;
+    native::pins[UP_SENSE_GPIO] = HIGH;
+}
+void tearDown() {}
+
+// Up relay active reverses the count
+void test_up_sense_line_reverses_the_count() {
+    PulseCounter counter(PULSE_GPIO, UP_SENSE_GPIO, 10);
+    TEST_ASSERT_TRUE(counter.begin());
+    pulses(12);
+    TEST_ASSERT_EQUAL_INT32(12, counter.takeDelta());
+    TEST_ASSERT_EQUAL_INT32(0, counter.takeDelta());
+
+    native::pins[UP_SENSE_GPIO] = LOW;
+    pulses(5);
+    TEST_ASSERT_EQUAL_INT32(-5, counter.takeDelta());
+}
+
+// The 16-bit counter clears at its limits; the watch points carry the wrap
+void test_count_survives_the_limits() {
+    PulseCounter counter(PULSE_GPIO, UP_SENSE_GPIO, 10);
+    TEST_ASSERT_TRUE(counter.begin());
+    pulses(29990);
+    TEST_ASSERT_EQUAL_INT32(29990, counter.takeDelta());
+    pulses(45);
+    TEST_ASSERT_EQUAL_INT32(45, counter.takeDelta());
+
+    native::pins[UP_SENSE_GPIO] = LOW;
+    pulses(90000);
+    TEST_ASSERT_EQUAL_INT32(-90000, counter.takeDelta());
+}
+
+// Each windlass gets a unit of its own
+void test_two_counters() {
+    PulseCounter first(PULSE_GPIO, UP_SENSE_GPIO, 10);
+    PulseCounter second(PULSE_GPIO + 1, UP_SENSE_GPIO, 10, 1);
+    TEST_ASSERT_TRUE(first.begin());
+    TEST_ASSERT_TRUE(second.begin());
+    pulses(3);
+    native::pcntCount(PULSE_GPIO + 1);
+    TEST_ASSERT_EQUAL_INT32(3, first.takeDelta());
+    TEST_ASSERT_EQUAL_INT32(1, second.takeDelta());
+}
+
+// Without PCNT the edge interrupt counts, reading the UP sense line itself
+void test_interrupt_counts_without_the_event_loop() {
+    PulseCounter counter(PULSE_GPIO, UP_SENSE_GPIO, 10);
+    TEST_ASSERT_TRUE(counter.beginInterrupt(15));
+    for (int i = 0; i < 4; i++) {
+        native::advanceMillis(100);
+        native::setInput(PULSE_GPIO, HIGH);
+        native::advanceMillis(50);
+        native::setInput(PULSE_GPIO, LOW);
+    }
+    TEST_ASSERT_EQUAL_INT32(4, counter.takeDelta());
+
+    native::pins[UP_SENSE_GPIO] = LOW;
+    native::advanceMillis(100);
+    native::setInput(PULSE_GPIO, HIGH);
+    TEST_ASSERT_EQUAL_INT32(-1, counter.takeDelta());
+}
+
+// Edges within the debounce time of a counted one are contact bounce
+void test_interrupt_debounces() {
+    PulseCounter counter(PULSE_GPIO, UP_SENSE_GPIO, 10);
+    TEST_ASSERT_TRUE(counter.beginInterrupt(15));
+    native::advanceMillis(100);
+    for (int i = 0; i < 5; i++) {
+        native::setInput(PULSE_GPIO, HIGH);
+        native::advanceMillis(2);
+        native::setInput(PULSE_GPIO, LOW);
+        native::advanceMillis(1);
+    }
+    TEST_ASSERT_EQUAL_INT32(1, counter.takeDelta());
+
+    native::advanceMillis(15);
+    native::setInput(PULSE_GPIO, HIGH);
+    TEST_ASSERT_EQUAL_INT32(1, counter.takeDelta());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_up_sense_line_reverses_the_count);
+    RUN_TEST(test_count_survives_the_limits);
+    RUN_TEST(test_two_counters);
+    RUN_TEST(test_interrupt_counts_without_the_event_loop);
+    RUN_TEST(test_interrupt_debounces);
+    return UNITY_END();
+}
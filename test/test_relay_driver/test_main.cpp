@@ -0,0 +1,128 @@
+// Relay outputs of one windlass: pio test -e native -f test_relay_driver
+
+#include <unity.h>
+
+#include "native_host.h"
+#include "RelayDriver.h"
+
+namespace {
+
+constexpr int DOWN_PIN = 19;
+constexpr int UP_PIN = 16;
+
+}  // namespace
+
+void setUp() { native::reset(); }
+void tearDown() {}
+
+void test_starts_off() {
+    digitalWrite(DOWN_PIN, HIGH);
+    digitalWrite(UP_PIN, HIGH);
+    RelayDriver relays(DOWN_PIN, UP_PIN);
+    TEST_ASSERT_EQUAL_INT(LOW, digitalRead(DOWN_PIN));
+    TEST_ASSERT_EQUAL_INT(LOW, digitalRead(UP_PIN));
+    TEST_ASSERT_TRUE(relays.output() == RelayDriver::Output::OFF);
+}
+
+// The motion loop may ask for the same output every tick
+void test_redundant_requests_skip_the_gpio() {
+    RelayDriver relays(DOWN_PIN, UP_PIN);
+    relays.set(RelayDriver::Output::DOWN, 1000);
+    for (unsigned long t = 1001; t < 2000; t++) {
+        relays.set(RelayDriver::Output::DOWN, t);
+    }
+    relays.set(RelayDriver::Output::OFF, 2000);
+    relays.set(RelayDriver::Output::OFF, 2001);
+
+    RelayDriver::Stats stats = relays.stats(2001);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.writes);
+    TEST_ASSERT_EQUAL_UINT32(1000, stats.skipped);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.down_starts);
+    TEST_ASSERT_EQUAL_UINT32(1000, stats.down_on_ms);
+}
+
+// A reversal drops the running relay at once and waits out the dead time
+void test_reversal_is_held_for_the_dead_time() {
+    RelayDriver relays(DOWN_PIN, UP_PIN, 100);
+    relays.set(RelayDriver::Output::DOWN, 1000);
+    relays.set(RelayDriver::Output::UP, 1500);
+    TEST_ASSERT_EQUAL_INT(LOW, digitalRead(DOWN_PIN));
+    TEST_ASSERT_EQUAL_INT(LOW, digitalRead(UP_PIN));
+    TEST_ASSERT_TRUE(relays.holding());
+
+    relays.update(1599);
+    TEST_ASSERT_EQUAL_INT(LOW, digitalRead(UP_PIN));
+    relays.update(1600);
+    TEST_ASSERT_EQUAL_INT(HIGH, digitalRead(UP_PIN));
+    TEST_ASSERT_FALSE(relays.holding());
+
+    RelayDriver::Stats stats = relays.stats(1700);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.held_starts);
+    TEST_ASSERT_EQUAL_UINT32(500, stats.down_on_ms);
+    TEST_ASSERT_EQUAL_UINT32(100, stats.up_on_ms);   // Run in progress
+}
+
+// Stop then start the other way: the stop already began the dead time
+void test_reversal_after_stop() {
+    RelayDriver relays(DOWN_PIN, UP_PIN, 100);
+    relays.set(RelayDriver::Output::UP, 0);
+    relays.set(RelayDriver::Output::OFF, 1000);
+    relays.set(RelayDriver::Output::DOWN, 1040);
+    TEST_ASSERT_EQUAL_INT(LOW, digitalRead(DOWN_PIN));
+    relays.set(RelayDriver::Output::DOWN, 1100);   // The motion loop asking again
+    TEST_ASSERT_EQUAL_INT(HIGH, digitalRead(DOWN_PIN));
+
+    relays.set(RelayDriver::Output::OFF, 2000);
+    relays.set(RelayDriver::Output::UP, 5000);     // Long since released
+    TEST_ASSERT_EQUAL_INT(HIGH, digitalRead(UP_PIN));
+    TEST_ASSERT_EQUAL_UINT32(1, relays.stats(5000).held_starts);
+}
+
+// Slack pause and resume restart the same relay without waiting; a held
+// start that is called off never energises
+void test_same_direction_and_cancelled_starts() {
+    RelayDriver relays(DOWN_PIN, UP_PIN, 100);
+    relays.set(RelayDriver::Output::UP, 0);
+    relays.set(RelayDriver::Output::OFF, 500);
+    relays.set(RelayDriver::Output::UP, 510);
+    TEST_ASSERT_EQUAL_INT(HIGH, digitalRead(UP_PIN));
+
+    relays.set(RelayDriver::Output::DOWN, 600);
+    relays.set(RelayDriver::Output::OFF, 650);
+    relays.update(800);
+    TEST_ASSERT_EQUAL_INT(LOW, digitalRead(DOWN_PIN));
+    TEST_ASSERT_EQUAL_INT(LOW, digitalRead(UP_PIN));
+
+    RelayDriver::Stats stats = relays.stats(800);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.up_starts);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.down_starts);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.held_starts);
+    TEST_ASSERT_EQUAL_UINT32(590, stats.up_on_ms);
+}
+
+// A dead time longer than the stall check's spin-up allowance is clamped
+void test_dead_time_is_clamped() {
+    native::log_level = native::LOG_ERROR;
+    RelayDriver relays(DOWN_PIN, UP_PIN, 5000);
+    TEST_ASSERT_EQUAL_UINT32(RelayDriver::MAX_DEAD_TIME_MS, relays.deadTime());
+    relays.setDeadTime(250);
+    TEST_ASSERT_EQUAL_UINT32(250, relays.deadTime());
+    relays.setDeadTime(60000);
+    TEST_ASSERT_EQUAL_UINT32(RelayDriver::MAX_DEAD_TIME_MS, relays.deadTime());
+
+    relays.set(RelayDriver::Output::DOWN, 1000);
+    relays.set(RelayDriver::Output::UP, 1500);
+    relays.update(1500 + RelayDriver::MAX_DEAD_TIME_MS);
+    TEST_ASSERT_EQUAL_INT(HIGH, digitalRead(UP_PIN));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_starts_off);
+    RUN_TEST(test_redundant_requests_skip_the_gpio);
+    RUN_TEST(test_reversal_is_held_for_the_dead_time);
+    RUN_TEST(test_reversal_after_stop);
+    RUN_TEST(test_same_direction_and_cancelled_starts);
+    RUN_TEST(test_dead_time_is_clamped);
+    return UNITY_END();
+}
@@ -0,0 +1,203 @@
+// Capture replay: pio test -e native_replay -v
+//
+// Reads the trace lines back (ChainTrace::parse), records an anchoring in
+// the boat simulator as a trace build would log it and replays it open
+// loop through the controller objects (test/support/Replay.h), expecting
+// the same relay actions, stage transitions and NVS writes. Then replays
+// every capture in CHAIN_REPLAY (a file or directory, default logs/replay;
+// see scripts/replay-capture.sh) and prints one line per boot.
+
+#include <unity.h>
+
+#include <dirent.h>
+#include <esp_log.h>
+#include <sys/stat.h>
+#include "Replay.h"
+#include "SimRig.h"
+
+#if !CHAIN_TRACE
+#error "test_replay needs the trace records: pio test -e native_replay"
+#endif
+
+namespace {
+
+constexpr unsigned long MAX_DROP_MS = 30UL * 60 * 1000;
+constexpr unsigned long MAX_RETRIEVE_MS = 20UL * 60 * 1000;
+constexpr double MIN_SPEEDUP = 100.0;
+const char DEFAULT_CORPUS[] = "logs/replay";
+
+// The log line the LogSink writes for a record
+std::string logLine(const ChainTrace::Record& record) {
+    char text[128];
+    ChainTrace::format(record, text, sizeof(text));
+    return "I (" + std::to_string(record.ms) + ") Trace: " + text;
+}
+
+// autoDrop 5:1 and autoRetrieve in the simulator, logged as the device would
+replay::Capture recordAnchoring(float scope) {
+    std::vector<std::string> lines;
+    ChainTrace::global().setRecorder([&lines](const ChainTrace::Record& record) {
+        lines.push_back(logLine(record));
+    });
+
+    BoatSimulator::Config config;
+    sim::SimRig rig(config);
+    char command[16];
+    snprintf(command, sizeof(command), "autoDrop%.0f", scope);
+    ChainTrace::global().command(0, command);
+    sim::RunResult drop = rig.autoDrop(scope, MAX_DROP_MS);
+    ChainTrace::global().command(0, "autoRetrieve");
+    sim::RunResult retrieve = rig.autoRetrieve(MAX_RETRIEVE_MS);
+    ChainTrace::global().setRecorder(nullptr);
+    TEST_ASSERT_TRUE(drop.completed);
+    TEST_ASSERT_TRUE(retrieve.completed);
+
+    replay::Capture capture;
+    for (const std::string& line : lines) capture.addLine(line);
+    capture.sort();
+    return capture;
+}
+
+void printResult(const char* name, const replay::Capture& capture, const replay::Result& result,
+                 const replay::Diff& diff) {
+    printf("%-32s %7zu records %5zu outputs %8.0f s %7.0fx  %s %zu/%zu, skew <= %ld ms%s%s\n",
+           name, capture.records.size(), diff.expected, result.virtual_s, result.speedup(),
+           diff.identical ? "same" : "DIFFERENT", diff.matched, diff.expected, diff.max_skew_ms,
+           diff.identical ? "" : "\n    ", diff.first.c_str());
+}
+
+std::vector<std::string> corpusFiles(const std::string& path) {
+    std::vector<std::string> files;
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) return files;
+    if (!S_ISDIR(info.st_mode)) {
+        files.push_back(path);
+        return files;
+    }
+    DIR* dir = opendir(path.c_str());
+    if (dir == nullptr) return files;
+    while (struct dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name.size() > 4 && (name.compare(name.size() - 4, 4, ".log") == 0 ||
+                                name.compare(name.size() - 4, 4, ".txt") == 0)) {
+            files.push_back(path + "/" + name);
+        }
+    }
+    closedir(dir);
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+}  // namespace
+
+void setUp() { native::log_level = native::LOG_ERROR; }
+void tearDown() { ChainTrace::global().setRecorder(nullptr); }
+
+// Every record comes back from its log line, with or without the serial monitor's prefix
+void test_trace_lines_round_trip() {
+    native::reset();
+    native::setMillis(81234);
+    std::vector<ChainTrace::Record> records;
+    ChainTrace::global().setRecorder([&records](const ChainTrace::Record& record) {
+        records.push_back(record);
+    });
+    std::vector<std::string> lines;
+    auto written = [&lines]() { lines.push_back(native::last_log_line); };
+
+    ChainTrace& trace = ChainTrace::global();
+    trace.begin(0, 160, 8, 320, 300, 0.25f, 100);                        written();
+    trace.speeds(0, 1250.0f, 1000.0f, 180.5f, 0.0f);                     written();
+    trace.input("environment.depth.belowSurface", 7.35f);                written();
+    trace.input("navigation.anchor.distanceFromBow", NAN);               written();
+    trace.command(0, "raise 10");                                        written();
+    trace.sense(0, true, false);                                         written();
+    trace.pulses(0, -3);                                                 written();
+    trace.relay(0, RelayDriver::Output::UP);                             written();
+    trace.stage(0, 4, 5);                                                written();
+    trace.nvs(0, "speeds", 1251.5f, 1000.0f, 180.5f, 0.0f);              written();
+    TEST_ASSERT_EQUAL_UINT(lines.size(), records.size());
+
+    for (size_t i = 0; i < lines.size(); i++) {
+        ChainTrace::Record parsed;
+        std::string monitor = "08:41:02.117 > " + lines[i];
+        TEST_ASSERT_TRUE_MESSAGE(ChainTrace::parse(monitor.c_str(), &parsed), lines[i].c_str());
+        TEST_ASSERT_EQUAL_UINT32(81234, parsed.ms);
+        TEST_ASSERT_EQUAL_STRING(logLine(records[i]).c_str(), logLine(parsed).c_str());
+    }
+
+    // Only changes of the sense lines and relays are written, and no empty pulse counts
+    size_t count = records.size();
+    trace.sense(0, true, false);
+    trace.relay(0, RelayDriver::Output::UP);
+    trace.pulses(0, 0);
+    TEST_ASSERT_EQUAL_UINT(count, records.size());
+
+    ChainTrace::Record parsed;
+    TEST_ASSERT_FALSE(ChainTrace::parse("I (5120) ChainController.cpp: lowerAnchor() called", &parsed));
+    TEST_ASSERT_FALSE(ChainTrace::parse("I (5120) Trace: u0 relay sideways", &parsed));
+    TEST_ASSERT_FALSE(ChainTrace::parse("Trace: u0 pulses 4", &parsed));
+}
+
+// The simulated anchoring replayed open loop makes the same decisions
+void test_replay_reproduces_an_anchoring() {
+    replay::Capture capture = recordAnchoring(5.0);
+    TEST_ASSERT_TRUE(capture.replayable());
+    std::vector<ChainTrace::Record> expected = capture.outputs();
+    TEST_ASSERT_TRUE(expected.size() > 10);
+
+    replay::Result result = replay::run(capture);
+    replay::Diff diff = replay::compare(expected, result.outputs);
+    printResult("simulator autoDrop5+autoRetrieve", capture, result, diff);
+    TEST_ASSERT_TRUE_MESSAGE(diff.identical, diff.first.c_str());
+    TEST_ASSERT_EQUAL_UINT(0, result.unknown_inputs);
+    TEST_ASSERT_TRUE(result.speedup() > MIN_SPEEDUP);
+}
+
+// A changed decision shows up as the first different output
+void test_replay_reports_a_changed_decision() {
+    replay::Capture capture = recordAnchoring(5.0);
+    std::vector<ChainTrace::Record> expected = capture.outputs();
+
+    // The same inputs, but dig-in holds that run their full time
+    replay::Options options;
+    options.tuning.settleEarly = false;
+    replay::Result result = replay::run(capture, options);
+    replay::Diff diff = replay::compare(expected, result.outputs);
+    printResult("... without early settle", capture, result, diff);
+    TEST_ASSERT_FALSE(diff.identical);
+    TEST_ASSERT_TRUE(diff.matched > 0);
+    TEST_ASSERT_TRUE(diff.first.find("stage") != std::string::npos ||
+                     diff.first.find("relay") != std::string::npos);
+}
+
+// Field captures: CHAIN_REPLAY, or every .log/.txt in logs/replay
+void test_replay_captures() {
+    const char* env = getenv("CHAIN_REPLAY");
+    std::string path = env != nullptr && env[0] != '\0' ? env : DEFAULT_CORPUS;
+    size_t boots = 0;
+    for (const std::string& file : corpusFiles(path)) {
+        std::vector<replay::Capture> captures = replay::Capture::load(file);
+        for (size_t i = 0; i < captures.size(); i++) {
+            const replay::Capture& capture = captures[i];
+            if (!capture.replayable()) continue;
+            replay::Result result = replay::run(capture);
+            replay::Diff diff = replay::compare(capture.outputs(), result.outputs);
+            std::string name = file.substr(file.find_last_of('/') + 1) + " #" + std::to_string(i + 1);
+            printResult(name.c_str(), capture, result, diff);
+            TEST_ASSERT_TRUE_MESSAGE(diff.identical, (name + ": " + diff.first).c_str());
+            boots++;
+        }
+    }
+    if (boots == 0) {
+        TEST_IGNORE_MESSAGE("no trace captures (set CHAIN_REPLAY or add them to logs/replay)");
+    }
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_trace_lines_round_trip);
+    RUN_TEST(test_replay_reproduces_an_anchoring);
+    RUN_TEST(test_replay_reports_a_changed_decision);
+    RUN_TEST(test_replay_captures);
+    return UNITY_END();
+}
@@ -0,0 +1,111 @@
+// Sensor freshness and validity: pio test -e native -f test_sensor_input
+
+#include <unity.h>
+
+#include "SimRig.h"
+#include "SensorInput.h"
+
+namespace {
+
+constexpr unsigned long MAX_AGE_MS = 5000;
+
+SensorInput* makeDepth() {
+    native::reset();
+    return new SensorInput("environment.depth.belowSurface", 2000, "", 0.01, INFINITY, MAX_AGE_MS);
+}
+
+bool deploying(sim::SimRig& rig) {
+    return rig.deployment()->getAutoStageObservable()->get() != AutoStage::IDLE;
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_nothing_received_is_not_usable() {
+    SensorInput* depth = makeDepth();
+    TEST_ASSERT_FALSE(depth->usable());
+    TEST_ASSERT_EQUAL_STRING("none", toString(depth->quality()));
+    TEST_ASSERT_EQUAL_FLOAT(-1.0, depth->valueOr(-1.0));
+}
+
+void test_valid_value_goes_stale() {
+    SensorInput* depth = makeDepth();
+    depth->listener()->emit(8.5);
+    TEST_ASSERT_TRUE(depth->usable());
+    TEST_ASSERT_EQUAL_STRING("valid", toString(depth->quality()));
+    TEST_ASSERT_EQUAL_FLOAT(8.5, depth->valueOr(0.0));
+
+    native::advanceMillis(MAX_AGE_MS);
+    TEST_ASSERT_TRUE(depth->usable());
+    native::advanceMillis(1);
+    TEST_ASSERT_FALSE(depth->usable());
+    TEST_ASSERT_EQUAL_STRING("stale", toString(depth->quality()));
+    TEST_ASSERT_EQUAL_FLOAT(0.0, depth->valueOr(0.0));
+    TEST_ASSERT_EQUAL_FLOAT(8.5, depth->value());   // Kept for logging
+
+    depth->listener()->emit(9.0);
+    TEST_ASSERT_TRUE(depth->usable());
+}
+
+// NaN, Inf and out-of-range values are rejected and leave the input unusable
+void test_invalid_value_keeps_last_good() {
+    SensorInput* depth = makeDepth();
+    depth->listener()->emit(8.5);
+    const float bad[] = {NAN, INFINITY, 0.0, -3.0};
+    for (float value : bad) {
+        depth->listener()->emit(value);
+        TEST_ASSERT_FALSE(depth->usable());
+        TEST_ASSERT_EQUAL_STRING("invalid", toString(depth->quality()));
+        TEST_ASSERT_EQUAL_FLOAT(8.5, depth->value());
+    }
+    TEST_ASSERT_EQUAL_UINT32(4, depth->rejectedCount());
+
+    depth->listener()->emit(7.0);
+    TEST_ASSERT_TRUE(depth->usable());
+    TEST_ASSERT_EQUAL_FLOAT(7.0, depth->value());
+}
+
+// Instruments drop out mid-deployment: the chain is held, then the drop finishes
+void test_deployment_holds_on_stale_inputs() {
+    BoatSimulator::Config config;
+    config.depth_m = 10.0;
+    config.wind_mps = 8.0;
+    sim::SimRig rig(config);
+    ChainController* controller = rig.controller();
+    rig.deployment()->start(5.0);
+    // Into a paying-out stage, windlass running
+    for (int i = 0; i < 3000; i++) {
+        rig.advance(100);
+        if (rig.deployment()->getAutoStageObservable()->get() == AutoStage::DEPLOY_80 && controller->isActive()) break;
+    }
+    TEST_ASSERT_TRUE(rig.deployment()->getAutoStageObservable()->get() == AutoStage::DEPLOY_80);
+    TEST_ASSERT_TRUE(controller->isActive());
+
+    rig.setSensorsOnline(false);
+    rig.advance(ChainController::DEPTH_MAX_AGE_MS + 2000);
+    TEST_ASSERT_FALSE(controller->getDepthInput()->usable());
+    TEST_ASSERT_FALSE(controller->isActive());
+    float held = controller->getChainLength();
+    rig.advance(30000);
+    TEST_ASSERT_FALSE(controller->isActive());
+    TEST_ASSERT_FLOAT_WITHIN(0.5, held, controller->getChainLength());
+
+    rig.setSensorsOnline(true);
+    float target = 5.0 * (config.depth_m + ChainController::BOW_HEIGHT_M);
+    for (int i = 0; i < 1800 && deploying(rig); i++) {
+        rig.advance(1000);
+    }
+    TEST_ASSERT_FALSE(deploying(rig));
+    TEST_ASSERT_FLOAT_WITHIN(1.0, target, controller->getChainLength());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_nothing_received_is_not_usable);
+    RUN_TEST(test_valid_value_goes_stale);
+    RUN_TEST(test_invalid_value_keeps_last_good);
+    RUN_TEST(test_deployment_holds_on_stale_inputs);
+    return UNITY_END();
+}
@@ -0,0 +1,86 @@
+// Windlass task snapshot/inputs handoff: pio test -e native -f test_seqlock
+
+#include <unity.h>
+
+#include <atomic>
+#include <thread>
+#include "Seqlock.h"
+
+namespace {
+
+// Every field the same while the struct is whole; a torn copy mixes two writes
+struct Sample {
+    uint32_t a, b, c, d, e, f, g, h;
+
+    static Sample of(uint32_t n) { return {n, n, n, n, n, n, n, n}; }
+    bool whole() const { return a == b && a == c && a == d && a == e && a == f && a == g && a == h; }
+};
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_read_returns_the_last_write() {
+    Seqlock<Sample> lock(Sample::of(7));
+    TEST_ASSERT_EQUAL_UINT32(7, lock.read().a);
+    lock.write(Sample::of(8));
+    lock.write(Sample::of(9));
+    Sample out = Sample::of(0);
+    TEST_ASSERT_TRUE(lock.tryRead(&out));
+    TEST_ASSERT_EQUAL_UINT32(9, out.a);
+    TEST_ASSERT_TRUE(out.whole());
+}
+
+// Out of attempts: false, and the caller's previous value stays
+void test_try_read_keeps_the_old_value_when_it_gives_up() {
+    Seqlock<Sample> lock(Sample::of(3));
+    Sample out = Sample::of(1);
+    TEST_ASSERT_FALSE(lock.tryRead(&out, 0));
+    TEST_ASSERT_EQUAL_UINT32(1, out.a);
+}
+
+// Against a writer on another thread: a read that returns is never torn, and
+// retries get most reads through even though every copy races a write
+void test_reads_are_never_torn() {
+    Seqlock<Sample> lock(Sample::of(0));
+    std::atomic<bool> done{false};
+    std::thread writer([&lock, &done]() {
+        for (uint32_t n = 1; !done.load(std::memory_order_relaxed); n++) lock.write(Sample::of(n));
+    });
+
+    while (lock.read().a == 0) std::this_thread::yield();   // Writer running
+
+    constexpr int READS = 200000;
+    int torn = 0, gave_up = 0;
+    uint32_t last = 0;
+    bool monotonic = true;
+    for (int i = 0; i < READS; i++) {
+        Sample out = Sample::of(last);
+        if (!lock.tryRead(&out)) {
+            gave_up++;
+            continue;
+        }
+        if (!out.whole()) torn++;
+        monotonic = monotonic && out.a >= last;
+        last = out.a;
+    }
+    Sample final_read = lock.read();
+    done = true;
+    writer.join();
+
+    printf("%d reads: %d gave up after %d attempts, last value %u\n", READS, gave_up,
+           Seqlock<Sample>::MAX_READ_ATTEMPTS, (unsigned)last);
+    TEST_ASSERT_EQUAL_INT(0, torn);
+    TEST_ASSERT_TRUE(monotonic);
+    TEST_ASSERT_TRUE(final_read.whole());
+    TEST_ASSERT_TRUE(gave_up < READS / 2);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_read_returns_the_last_write);
+    RUN_TEST(test_try_read_keeps_the_old_value_when_it_gives_up);
+    RUN_TEST(test_reads_are_never_torn);
+    return UNITY_END();
+}
@@ -0,0 +1,84 @@
+// Setup graph arena: pio test -e native -f test_setup_arena
+
+#include <unity.h>
+
+#include "SetupArena.h"
+
+void setUp() {}
+void tearDown() {}
+
+namespace {
+
+struct alignas(8) Wide {
+    double value;
+};
+
+}  // namespace
+
+void test_allocations_are_aligned_and_packed() {
+    alignas(16) uint8_t buffer[64];
+    SetupArena arena(buffer, sizeof(buffer));
+
+    void* a = arena.allocate(1, 1);
+    void* b = arena.allocate(sizeof(Wide), alignof(Wide));
+    TEST_ASSERT_TRUE(a == buffer);
+    TEST_ASSERT_TRUE(b == buffer + 8);   // Padded up to the 8-byte boundary
+    TEST_ASSERT_EQUAL_UINT(16, arena.used());
+    TEST_ASSERT_EQUAL_UINT(2, arena.stats().arenaObjects);
+    TEST_ASSERT_EQUAL_UINT(16, arena.stats().arenaBytes);
+    TEST_ASSERT_EQUAL_UINT(0, arena.stats().heapObjects);
+
+    // Alignment follows the real address, not the offset
+    SetupArena offset(buffer + 1, sizeof(buffer) - 1);
+    void* c = offset.allocate(sizeof(Wide), alignof(Wide));
+    TEST_ASSERT_TRUE(c == buffer + 8);
+}
+
+void test_overflow_goes_to_the_heap() {
+    alignas(16) uint8_t buffer[32];
+    SetupArena arena(buffer, sizeof(buffer));
+
+    TEST_ASSERT_TRUE(arena.allocate(24, 8) != nullptr);
+    TEST_ASSERT_TRUE(arena.allocate(16, 8) == nullptr);   // Does not fit
+    TEST_ASSERT_TRUE(arena.allocate(8, 8) != nullptr);    // Still fills the rest
+    TEST_ASSERT_EQUAL_UINT(32, arena.used());
+    TEST_ASSERT_EQUAL_UINT(2, arena.stats().arenaObjects);
+    TEST_ASSERT_EQUAL_UINT(1, arena.stats().overflowObjects);
+    TEST_ASSERT_EQUAL_UINT(1, arena.stats().heapObjects);
+    TEST_ASSERT_EQUAL_UINT(16, arena.stats().heapBytes);
+}
+
+void test_sealed_arena_hands_out_nothing() {
+    alignas(16) uint8_t buffer[32];
+    SetupArena arena(buffer, sizeof(buffer));
+
+    arena.seal();
+    TEST_ASSERT_TRUE(arena.allocate(4, 4) == nullptr);
+    TEST_ASSERT_EQUAL_UINT(0, arena.used());
+    TEST_ASSERT_EQUAL_UINT(1, arena.stats().lateObjects);
+    TEST_ASSERT_EQUAL_UINT(1, arena.stats().heapObjects);
+    TEST_ASSERT_EQUAL_UINT(0, arena.stats().overflowObjects);
+}
+
+void test_make_counts_the_graph() {
+    const SetupArena& arena = SetupArena::global();
+    SetupArena::Stats before = arena.stats();
+    Wide* wide = SetupArena::make<Wide>(Wide{2.5});
+    TEST_ASSERT_EQUAL_FLOAT(2.5, wide->value);
+#if CHAIN_STATIC_GRAPH
+    TEST_ASSERT_EQUAL_UINT(before.arenaObjects + 1, arena.stats().arenaObjects);
+#else
+    // No arena: make() is new, and the global arena only counts it
+    TEST_ASSERT_EQUAL_UINT(0, arena.capacity());
+    TEST_ASSERT_EQUAL_UINT(before.heapObjects + 1, arena.stats().heapObjects);
+#endif
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_allocations_are_aligned_and_packed);
+    RUN_TEST(test_overflow_goes_to_the_heap);
+    RUN_TEST(test_sealed_arena_hands_out_nothing);
+    RUN_TEST(test_make_counts_the_graph);
+    return UNITY_END();
+}
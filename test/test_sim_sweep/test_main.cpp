@@ -0,0 +1,81 @@
+// Deployment tuning sweep against the boat simulator: pio test -e native_sweep -v
+//
+// Runs a 5:1 autoDrop at 10 m for each combination of slack hysteresis
+// (DeploymentManager maxSlackRatio/resumeSlackRatio) and hold-time scale in
+// light, moderate and strong wind, and prints one CSV row per run for
+// plotting. Not part of the default test run - it is a tuning tool, and the
+// only assertion is that the shipped defaults still complete everywhere.
+
+#include <unity.h>
+
+#include "SimRig.h"
+
+namespace {
+
+constexpr float SCOPE = 5.0;
+constexpr float DEPTH_M = 10.0;
+constexpr float WINDS_MPS[] = {3.0, 8.0, 14.0};
+
+constexpr float MAX_SLACK_RATIOS[] = {0.8, 1.2, 1.6};
+constexpr float RESUME_SLACK_RATIOS[] = {0.3, 0.6, 0.9};
+constexpr float HOLD_SCALES[] = {0.5, 1.0, 2.0};
+
+constexpr unsigned long MAX_DROP_MS = 15UL * 60 * 1000;
+
+sim::RunResult runDrop(float wind, const DeploymentManager::Tuning& tuning) {
+    BoatSimulator::Config config;
+    config.depth_m = DEPTH_M;
+    config.wind_mps = wind;
+    sim::SimRig rig(config);
+    rig.deployment()->setTuning(tuning);
+    return rig.autoDrop(SCOPE, MAX_DROP_MS);
+}
+
+DeploymentManager::Tuning scaledHolds(float scale) {
+    DeploymentManager::Tuning tuning;
+    tuning.holdDropMs = (unsigned long)(tuning.holdDropMs * scale);
+    tuning.holdFirstMs = (unsigned long)(tuning.holdFirstMs * scale);
+    tuning.holdSecondMs = (unsigned long)(tuning.holdSecondMs * scale);
+    return tuning;
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_sweep_defaults_complete() {
+    for (float wind : WINDS_MPS) {
+        sim::RunResult result = runDrop(wind, DeploymentManager::Tuning{});
+        TEST_ASSERT_TRUE_MESSAGE(result.completed, "default tuning did not complete");
+    }
+}
+
+void test_sweep_slack_and_hold() {
+    printf("wind_mps,max_slack_ratio,resume_slack_ratio,hold_scale,completed,virtual_s,rode_m,"
+           "distance_m,peak_tension_n,dragged_m,relay_starts\n");
+    for (float wind : WINDS_MPS) {
+        for (float max_ratio : MAX_SLACK_RATIOS) {
+            for (float resume_ratio : RESUME_SLACK_RATIOS) {
+                if (resume_ratio >= max_ratio) continue;  // No hysteresis
+                for (float hold_scale : HOLD_SCALES) {
+                    DeploymentManager::Tuning tuning = scaledHolds(hold_scale);
+                    tuning.maxSlackRatio = max_ratio;
+                    tuning.resumeSlackRatio = resume_ratio;
+                    sim::RunResult r = runDrop(wind, tuning);
+                    printf("%.0f,%.1f,%.1f,%.1f,%d,%.0f,%.2f,%.1f,%.0f,%.2f,%u\n",
+                           wind, max_ratio, resume_ratio, hold_scale, r.completed ? 1 : 0,
+                           r.virtual_s, r.rode_m, r.distance_m, r.peak_tension_n, r.dragged_m,
+                           r.relay_starts);
+                }
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_sweep_defaults_complete);
+    RUN_TEST(test_sweep_slack_and_hold);
+    return UNITY_END();
+}
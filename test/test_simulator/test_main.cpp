@@ -0,0 +1,148 @@
+// Deployment matrix against the boat simulator: pio test -e native -f test_simulator -v
+//
+// Runs autoDrop and then autoRetrieve (skipper motoring up the rode) for
+// every scope x depth x wind cell on the virtual clock, prints one line per
+// cell and checks that each deployment ends where it should, that the
+// counted rode follows the gypsy, and that the runs stay well above 100x
+// real time so the matrix remains cheap enough to run on every change.
+
+#include <unity.h>
+
+#include "SimRig.h"
+
+namespace {
+
+constexpr float SCOPES[] = {3.0, 5.0, 7.0};
+constexpr float DEPTHS_M[] = {5.0, 10.0, 15.0};
+constexpr float WINDS_MPS[] = {3.0, 8.0, 14.0};
+
+constexpr unsigned long MAX_DROP_MS = 30UL * 60 * 1000;
+constexpr unsigned long CAPPED_DROP_MS = 10UL * 60 * 1000;  // Long enough to sit at the limit
+constexpr unsigned long MAX_RETRIEVE_MS = 20UL * 60 * 1000;
+constexpr double MIN_SPEEDUP = 100.0;
+// Below this the boat may never stretch the rode enough to bring the slack
+// under the resume threshold; the drop then waits, paused, for the skipper
+constexpr float LIGHT_AIR_MPS = 5.0;
+
+void printHeader() {
+    printf("%5s %5s %5s | %-8s %6s %6s %6s %6s %6s %5s | %-8s %6s %6s %5s %5s\n",
+           "scope", "depth", "wind",
+           "drop", "virt_s", "x_rt", "rode", "true", "peak_N", "drag",
+           "retrieve", "virt_s", "rode", "true", "relay");
+}
+
+void printRow(float scope, float depth, float wind, const char* drop_status,
+              const sim::RunResult& drop, const sim::RunResult& retrieve) {
+    printf("%5.0f %5.0f %5.0f | %-8s %6.0f %6.0f %6.2f %6.2f %6.0f %5.2f | %-8s %6.0f %6.2f %5.2f %5u\n",
+           scope, depth, wind,
+           drop_status, drop.virtual_s, drop.speedup(), drop.rode_m, drop.true_rode_m,
+           drop.peak_tension_n, drop.dragged_m,
+           retrieve.completed ? "done" : "FAILED", retrieve.virtual_s, retrieve.rode_m,
+           retrieve.true_rode_m, retrieve.relay_starts);
+}
+
+void runCell(float scope, float depth, float wind) {
+    char label[64];
+    snprintf(label, sizeof(label), "scope %.0f depth %.0f wind %.0f", scope, depth, wind);
+
+    BoatSimulator::Config config;
+    config.depth_m = depth;
+    config.wind_mps = wind;
+    sim::SimRig rig(config);
+    TEST_ASSERT_TRUE_MESSAGE(rig.deployment()->isAutoAnchorValid(), label);
+
+    const float circumference = config.gypsy_circumference_m;
+    float target = scope * (depth + ChainController::BOW_HEIGHT_M);
+    // DEPLOY_100 is never reached past stop_before_max; the drop must end
+    // safely at the limit instead
+    bool capped = target > sim::STOP_BEFORE_MAX_M;
+
+    sim::RunResult drop = rig.autoDrop(scope, capped ? CAPPED_DROP_MS : MAX_DROP_MS);
+    sim::RunResult retrieve = rig.autoRetrieve(MAX_RETRIEVE_MS);
+    const char* drop_status = capped ? "capped" : drop.completed ? "done" : wind < LIGHT_AIR_MPS ? "waiting" : "FAILED";
+    printRow(scope, depth, wind, drop_status, drop, retrieve);
+
+    if (capped) {
+        TEST_ASSERT_FALSE_MESSAGE(drop.completed, label);
+        TEST_ASSERT_TRUE_MESSAGE(drop.rode_m <= sim::STOP_BEFORE_MAX_M + circumference, label);
+        TEST_ASSERT_TRUE_MESSAGE(drop.rode_m >= sim::STOP_BEFORE_MAX_M - 2.0f, label);
+    } else if (drop.completed || wind >= LIGHT_AIR_MPS) {
+        TEST_ASSERT_TRUE_MESSAGE(drop.completed, label);
+        TEST_ASSERT_FLOAT_WITHIN_MESSAGE(1.0, target, drop.rode_m, label);
+    } else {
+        TEST_ASSERT_TRUE_MESSAGE(drop.rode_m < target, label);
+    }
+    // Whole pulses only, but every one of them (no pauses on the way out)
+    TEST_ASSERT_FLOAT_WITHIN_MESSAGE(circumference, drop.true_rode_m, drop.rode_m, label);
+    TEST_ASSERT_TRUE_MESSAGE(drop.speedup() >= MIN_SPEEDUP, label);
+
+    TEST_ASSERT_TRUE_MESSAGE(retrieve.completed, label);
+    TEST_ASSERT_FALSE_MESSAGE(rig.controller()->isActive(), label);
+    // The sense line drops with the relay at each slack pause, so the coast
+    // edges after it count as paying out: up to two pulses off per pause
+    unsigned pauses = retrieve.relay_starts > 0 ? retrieve.relay_starts - 1 : 0;
+    TEST_ASSERT_FLOAT_WITHIN_MESSAGE(circumference * (1 + 2 * pauses), retrieve.true_rode_m, retrieve.rode_m, label);
+    TEST_ASSERT_TRUE_MESSAGE(retrieve.speedup() >= MIN_SPEEDUP, label);
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_catenary_matches_closed_form() {
+    // Boat just far enough out to lift the whole rode: a = (L^2 - h^2) / 2h
+    BoatSimulator::Config config;
+    BoatSimulator boat(config);
+    const float h = config.depth_m + config.bow_height_m;
+    const float rode = 40.0;
+    float a = (rode * rode - h * h) / (2.0f * h);
+    float reach = a * acoshf(1.0f + h / a);
+
+    TEST_ASSERT_EQUAL_FLOAT(0.0, boat.tensionFor(rode - h, rode));  // Hangs straight down
+    TEST_ASSERT_FLOAT_WITHIN(5.0, config.chain_weight_n_per_m * a, boat.tensionFor(reach - 0.001f, rode));
+    // Monotonic in distance, then taut
+    TEST_ASSERT_TRUE(boat.tensionFor(reach - 5.0f, rode) < boat.tensionFor(reach - 1.0f, rode));
+    TEST_ASSERT_TRUE(boat.tensionFor(reach + 0.1f, rode) > boat.tensionFor(reach - 0.1f, rode) + 1000.0f);
+}
+
+void test_relay_latency_and_pulses() {
+    BoatSimulator::Config config;
+    BoatSimulator boat(config);
+
+    boat.step(config.relay_latency_ms - 1, true, false);
+    TEST_ASSERT_FALSE(boat.downContact());
+    boat.step(1, true, false);
+    TEST_ASSERT_TRUE(boat.downContact());
+
+    // 10 s at 1 m/s less spin-up: one edge per gypsy circumference
+    int32_t edges = boat.step(10000, true, false);
+    TEST_ASSERT_INT_WITHIN(1, (int32_t)(boat.rode() / config.gypsy_circumference_m), edges);
+    TEST_ASSERT_FLOAT_WITHIN(0.3, 10.0, boat.rode());
+
+    // Coasts on after the coil drops, then stops
+    float cut = boat.rode();
+    boat.step(2000, false, false);
+    TEST_ASSERT_FALSE(boat.downContact());
+    TEST_ASSERT_TRUE(boat.rode() > cut);
+    TEST_ASSERT_EQUAL_FLOAT(0.0, boat.gypsySpeed());
+}
+
+void test_deployment_matrix() {
+    printHeader();
+    for (float scope : SCOPES) {
+        for (float depth : DEPTHS_M) {
+            for (float wind : WINDS_MPS) {
+                runCell(scope, depth, wind);
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_catenary_matches_closed_form);
+    RUN_TEST(test_relay_latency_and_pulses);
+    RUN_TEST(test_deployment_matrix);
+    return UNITY_END();
+}
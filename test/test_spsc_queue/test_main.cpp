@@ -0,0 +1,77 @@
+// Windlass task command/event ring: pio test -e native -f test_spsc_queue
+
+#include <unity.h>
+
+#include <thread>
+#include "SpscQueue.h"
+
+void setUp() {}
+void tearDown() {}
+
+// N slots hold N - 1 items; a full ring refuses the push and keeps what it has
+void test_full_and_empty() {
+    SpscQueue<int, 4> queue;
+    int item = -1;
+    TEST_ASSERT_TRUE(queue.empty());
+    TEST_ASSERT_FALSE(queue.pop(&item));
+    TEST_ASSERT_EQUAL_INT(-1, item);
+
+    TEST_ASSERT_TRUE(queue.push(1));
+    TEST_ASSERT_TRUE(queue.push(2));
+    TEST_ASSERT_TRUE(queue.push(3));
+    TEST_ASSERT_FALSE(queue.push(4));
+    TEST_ASSERT_FALSE(queue.empty());
+
+    for (int expected = 1; expected <= 3; expected++) {
+        TEST_ASSERT_TRUE(queue.pop(&item));
+        TEST_ASSERT_EQUAL_INT(expected, item);
+    }
+    TEST_ASSERT_FALSE(queue.pop(&item));
+    TEST_ASSERT_TRUE(queue.empty());
+}
+
+// Head and tail wrap past the end of the buffer many times, in order
+void test_wraparound_keeps_order() {
+    SpscQueue<int, 4> queue;
+    int next_in = 0, next_out = 0, item;
+    for (int round = 0; round < 100; round++) {
+        int fill = round % 3 + 1;
+        for (int i = 0; i < fill; i++) TEST_ASSERT_TRUE(queue.push(next_in++));
+        int drain = round % 2 == 0 ? fill : fill - 1;
+        for (int i = 0; i < drain; i++) {
+            TEST_ASSERT_TRUE(queue.pop(&item));
+            TEST_ASSERT_EQUAL_INT(next_out++, item);
+        }
+        while (queue.pop(&item)) TEST_ASSERT_EQUAL_INT(next_out++, item);
+    }
+    TEST_ASSERT_EQUAL_INT(next_in, next_out);
+}
+
+// One producer thread, one consumer thread: every item arrives once, in order
+void test_two_threads() {
+    constexpr int ITEMS = 200000;
+    SpscQueue<int, 16> queue;
+    std::thread producer([&queue]() {
+        for (int i = 0; i < ITEMS; i++) {
+            while (!queue.push(i)) std::this_thread::yield();
+        }
+    });
+    int expected = 0, item;
+    bool in_order = true;
+    while (expected < ITEMS) {
+        if (!queue.pop(&item)) continue;
+        in_order = in_order && item == expected;
+        expected++;
+    }
+    producer.join();
+    TEST_ASSERT_TRUE(in_order);
+    TEST_ASSERT_TRUE(queue.empty());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_full_and_empty);
+    RUN_TEST(test_wraparound_keeps_order);
+    RUN_TEST(test_two_threads);
+    return UNITY_END();
+}
@@ -0,0 +1,117 @@
+// Warm restart position and input settling: pio test -e native -f test_warm_restart
+
+#include <unity.h>
+
+#include "InputReadiness.h"
+#include "PositionSnapshot.h"
+#include "SimRig.h"
+
+namespace {
+
+constexpr int HALL_GPIO = 4;
+constexpr int RESET_GPIO = 5;
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_snapshot_keeps_the_newest_slot() {
+    PositionSnapshot::clear();
+    PositionSnapshot::State state;
+    TEST_ASSERT_FALSE(PositionSnapshot::read(&state));
+
+    PositionSnapshot::write(10, ChainState::LOWERING);
+    PositionSnapshot::write(11, ChainState::LOWERING);
+    PositionSnapshot::write(11, ChainState::IDLE);
+    TEST_ASSERT_TRUE(PositionSnapshot::read(&state));
+    TEST_ASSERT_EQUAL_INT32(11, state.pulses);
+    TEST_ASSERT_EQUAL_INT((int)ChainState::IDLE, (int)state.motion);
+    TEST_ASSERT_EQUAL_UINT32(2, state.seq);
+}
+
+// The windlass task mirrors every pulse, so a reset mid-move restores the
+// count the controller had, not the last journal commit
+void test_windlass_mirrors_the_count() {
+    BoatSimulator::Config config;
+    config.depth_m = 8.0;
+    sim::SimRig rig(config);
+    ChainController* controller = rig.controller();
+
+    controller->lowerAnchor(10.0);
+    rig.advance(3000);   // Part way down
+    PositionSnapshot::State state;
+    TEST_ASSERT_TRUE(PositionSnapshot::read(&state));
+    TEST_ASSERT_EQUAL_INT((int)ChainState::LOWERING, (int)state.motion);
+    TEST_ASSERT_INT32_WITHIN(1, rig.boat().rode() / config.gypsy_circumference_m, state.pulses);
+
+    while (controller->isActive()) rig.advance(100);
+    rig.advance(sim::SETTLE_MS);
+    TEST_ASSERT_TRUE(PositionSnapshot::read(&state));
+    TEST_ASSERT_EQUAL_INT((int)ChainState::IDLE, (int)state.motion);
+    TEST_ASSERT_EQUAL_FLOAT(controller->getChainLength(), state.pulses * config.gypsy_circumference_m);
+}
+
+void test_input_ready_once_stable() {
+    native::reset();
+    native::pins[HALL_GPIO] = LOW;
+    native::pins[RESET_GPIO] = LOW;
+    InputReadiness inputs;
+    inputs.add("COUNTER", HALL_GPIO, 50);
+    inputs.add("RESET", RESET_GPIO, 0);   // MIN_STABLE_MS
+    bool counting = false;
+    inputs.onReady(HALL_GPIO, [&counting]() { counting = true; });
+    inputs.start();
+
+    // The pin floats for a while, then settles
+    for (int i = 0; i < 6; i++) {
+        native::pins[HALL_GPIO] = !native::pins[HALL_GPIO];
+        native::advanceMillis(10);
+    }
+    TEST_ASSERT_TRUE(inputs.ready(RESET_GPIO));
+    TEST_ASSERT_FALSE(inputs.ready(HALL_GPIO));
+    TEST_ASSERT_FALSE(counting);
+    native::advanceMillis(50 + InputReadiness::POLL_MS);
+    TEST_ASSERT_TRUE(inputs.ready(HALL_GPIO));
+    TEST_ASSERT_TRUE(counting);
+    TEST_ASSERT_TRUE(inputs.allReady());
+    TEST_ASSERT_TRUE(millis() < InputReadiness::MAX_SETTLE_MS / 10);   // Far from the old fixed blackout
+}
+
+void test_input_live_at_the_settle_limit() {
+    native::reset();
+    InputReadiness inputs;
+    inputs.add("COUNTER", HALL_GPIO, 50);
+    inputs.start();
+    // A chain already running: an edge every 20 ms, never 50 ms stable
+    while (!inputs.ready(HALL_GPIO) && millis() < 2 * InputReadiness::MAX_SETTLE_MS) {
+        native::pins[HALL_GPIO] = !native::pins[HALL_GPIO];
+        native::advanceMillis(20);
+    }
+    TEST_ASSERT_TRUE(inputs.ready(HALL_GPIO));
+    TEST_ASSERT_UINT32_WITHIN(20 + InputReadiness::POLL_MS, InputReadiness::MAX_SETTLE_MS, millis());
+}
+
+void test_marked_input_is_ready_at_once() {
+    native::reset();
+    InputReadiness inputs;
+    inputs.add("COUNTER", HALL_GPIO, 50);
+    inputs.add("RESET", RESET_GPIO, 50);
+    inputs.markReady(HALL_GPIO);   // Warm restart
+    bool counting = false;
+    inputs.onReady(HALL_GPIO, [&counting]() { counting = true; });
+    TEST_ASSERT_TRUE(counting);
+    inputs.start();
+    TEST_ASSERT_TRUE(inputs.ready(HALL_GPIO));
+    TEST_ASSERT_FALSE(inputs.ready(RESET_GPIO));   // The others still settle
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_snapshot_keeps_the_newest_slot);
+    RUN_TEST(test_windlass_mirrors_the_count);
+    RUN_TEST(test_input_ready_once_stable);
+    RUN_TEST(test_input_live_at_the_settle_limit);
+    RUN_TEST(test_marked_input_is_ready_at_once);
+    return UNITY_END();
+}